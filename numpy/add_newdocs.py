@@ -243,10 +243,14 @@ add_newdoc('numpy.core', 'nditer',
         dimension.
     buffersize : int, optional
         When buffering is enabled, controls the size of the temporary
-        buffers. Set to 0 for the default value.
+        buffers. Set to 0 for the default value, which is chosen from
+        the operand item sizes and the size of the CPU's L2 cache.
 
     Attributes
     ----------
+    buffersize : int
+        The size of the temporary buffers in elements, or 0 if buffering
+        is not enabled.
     dtypes : tuple of dtype(s)
         The data types of the values provided in `value`. This may be
         different from the operand data types if buffering is enabled.
@@ -925,6 +929,112 @@ add_newdoc('numpy.core.multiarray', 'count_nonzero',
     5
     """)
 
+add_newdoc('numpy.core.multiarray', 'minmax',
+    """
+    minmax(a, axis=None)
+
+    Return the minimum and the maximum of an array or along an axis.
+
+    For boolean, integer, float32, float64, datetime and timedelta arrays
+    both are found in a single pass over the data, which is about twice as
+    fast as calling `amin` and `amax`.
+
+    .. versionadded:: 1.8.0
+
+    Parameters
+    ----------
+    a : array_like
+        Input data.
+    axis : int, optional
+        Axis along which to operate.  By default the flattened input is
+        used.
+
+    Returns
+    -------
+    amin, amax : ndarray or scalar
+        The minimum and the maximum of `a`, like the results of ``amin(a,
+        axis)`` and ``amax(a, axis)``.  Both are NaN if a NaN is compared.
+
+    See Also
+    --------
+    amin, amax, ptp
+
+    Examples
+    --------
+    >>> a = np.array([[3, 1], [0, 4]])
+    >>> np.minmax(a)
+    (0, 4)
+    >>> np.minmax(a, axis=0)
+    (array([0, 1]), array([3, 4]))
+
+    """)
+
+add_newdoc('numpy.core.multiarray', 'topk',
+    """
+    topk(a, k, axis=-1, largest=True, sorted=True)
+
+    Return the `k` largest or smallest elements along an axis and their
+    indices.
+
+    The elements are selected with a heap of size `k`, which takes
+    ``O(n log(k))`` time for ``n`` elements along the axis, much less than
+    a full sort when `k` is small.  Lanes along the axis are processed
+    concurrently by the thread pool.
+
+    .. versionadded:: 1.8.0
+
+    Parameters
+    ----------
+    a : array_like
+        Input data.
+    k : int
+        Number of elements to select, ``0 <= k <= a.shape[axis]``.
+    axis : int or None, optional
+        Axis along which to select.  The default is -1 (the last axis).
+        If None, the flattened array is used.
+    largest : bool, optional
+        Select the largest elements if True (default), otherwise the
+        smallest.
+    sorted : bool, optional
+        If True (default) the selected elements are returned from the
+        best to the worst, otherwise in no particular order.
+
+    Returns
+    -------
+    values : ndarray
+        The selected elements, of the type of `a` and with the shape of
+        `a` except that `axis` has length `k`.
+    indices : ndarray
+        The indices of the selected elements along `axis`, of the same
+        shape as `values`.
+
+    See Also
+    --------
+    argsort : Indirect sort.
+    partition : Partial sort.
+
+    Notes
+    -----
+    NaNs are treated as larger than all other values, as in `sort`.  Of
+    equal elements those with the lowest indices are selected, and a
+    sorted result lists them in index order.
+
+    Examples
+    --------
+    >>> a = np.array([[3, 1, 4, 1], [5, 9, 2, 6]])
+    >>> np.topk(a, 2)
+    (array([[4, 3],
+           [9, 6]]), array([[2, 0],
+           [1, 3]]))
+    >>> np.topk(a, 2, largest=False)
+    (array([[1, 1],
+           [2, 5]]), array([[1, 3],
+           [2, 0]]))
+    >>> np.topk(a, 3, axis=None)
+    (array([9, 6, 5]), array([5, 7, 4]))
+
+    """)
+
 add_newdoc('numpy.core.multiarray','set_typeDict',
     """set_typeDict(dict)
 
@@ -3030,6 +3140,23 @@ add_newdoc('numpy.core.multiarray', 'ndarray', ('argmin',
     """))
 
 
+add_newdoc('numpy.core.multiarray', 'ndarray', ('argpartition',
+    """
+    a.argpartition(kth, axis=-1, kind='introselect', order=None)
+
+    Returns the indices that would partition this array.
+
+    Refer to `numpy.argpartition` for full documentation.
+
+    .. versionadded:: 1.8.0
+
+    See Also
+    --------
+    numpy.argpartition : equivalent function
+
+    """))
+
+
 add_newdoc('numpy.core.multiarray', 'ndarray', ('argsort',
     """
     a.argsort(axis=-1, kind='quicksort', order=None)
@@ -3674,6 +3801,58 @@ add_newdoc('numpy.core.multiarray', 'may_share_memory',
     """)
 
 
+add_newdoc('numpy.core.multiarray', 'setnumthreads',
+    """
+    setnumthreads(n)
+
+    Set the number of threads used to execute ufunc loops and other
+    operations that support multithreading.
+
+    Work is only split across threads for large operations on data
+    types which do not require the Python API (e.g. not object arrays),
+    so small operations are unaffected.  A value of 1, the default,
+    runs everything on the calling thread.  The initial value can also
+    be set with the ``NPY_NUM_THREADS`` environment variable.
+
+    Parameters
+    ----------
+    n : int
+        Number of threads, including the calling thread.
+
+    Returns
+    -------
+    old : int
+        The previous number of threads.
+
+    See Also
+    --------
+    getnumthreads
+
+    Examples
+    --------
+    >>> old = np.setnumthreads(4)
+    >>> np.getnumthreads()
+    4
+    >>> np.setnumthreads(old)
+    4
+
+    """)
+
+
+add_newdoc('numpy.core.multiarray', 'getnumthreads',
+    """
+    getnumthreads()
+
+    Return the number of threads used by operations that support
+    multithreading.
+
+    See Also
+    --------
+    setnumthreads
+
+    """)
+
+
 add_newdoc('numpy.core.multiarray', 'ndarray', ('newbyteorder',
     """
     arr.newbyteorder(new_order='S')
@@ -3731,6 +3910,60 @@ add_newdoc('numpy.core.multiarray', 'ndarray', ('nonzero',
     """))
 
 
+add_newdoc('numpy.core.multiarray', 'ndarray', ('partition',
+    """
+    a.partition(kth, axis=-1, kind='introselect', order=None)
+
+    Rearranges the elements in the array in such a way that value of the
+    element in kth position is in the position it would be in a sorted array.
+    All elements smaller than the kth element are moved before this element and
+    all equal or greater are moved behind it. The ordering of the elements in
+    the two partitions is undefined.
+
+    .. versionadded:: 1.8.0
+
+    Parameters
+    ----------
+    kth : int or sequence of ints
+        Element index to partition by. The kth element value will be in its
+        final sorted position and all smaller elements will be moved before it
+        and all equal or greater elements behind it.
+        If provided with a sequence of kth it will partition all elements
+        indexed by kth of them into their sorted position at once.
+    axis : int, optional
+        Axis along which to sort. Default is -1, which means sort along the
+        last axis.
+    kind : {'introselect'}, optional
+        Selection algorithm. Default is 'introselect'.
+    order : list, optional
+        When `a` is an array with fields defined, this argument specifies
+        which fields to compare first, second, etc.  Not all fields need be
+        specified.
+
+    See Also
+    --------
+    numpy.partition : Return a partitioned copy of an array.
+    argpartition : Indirect partition.
+    sort : Full sort.
+
+    Notes
+    -----
+    See ``np.partition`` for notes on the different algorithms.
+
+    Examples
+    --------
+    >>> a = np.array([3, 4, 2, 1])
+    >>> a.partition(3)
+    >>> a
+    array([2, 1, 3, 4])
+
+    >>> a.partition((1, 3))
+    >>> a
+    array([1, 2, 3, 4])
+
+    """))
+
+
 add_newdoc('numpy.core.multiarray', 'ndarray', ('prod',
     """
     a.prod(axis=None, dtype=None, out=None)
@@ -4159,7 +4392,7 @@ add_newdoc('numpy.core.multiarray', 'ndarray', ('sort',
     axis : int, optional
         Axis along which to sort. Default is -1, which means sort along the
         last axis.
-    kind : {'quicksort', 'mergesort', 'heapsort'}, optional
+    kind : {'quicksort', 'mergesort', 'heapsort', 'stable', 'radixsort'}, optional
         Sorting algorithm. Default is 'quicksort'.
     order : list, optional
         When `a` is an array with fields defined, this argument specifies
@@ -4706,6 +4939,7 @@ add_newdoc('numpy.core.umath', 'geterrobj',
     errobj : list
         The error object, a list containing three elements:
         [internal numpy buffer size, error mask, error callback function].
+        A buffer size of 0 means that it is chosen for each operation.
 
         The error mask is a single integer that holds the treatment information
         on all four floating point errors. The information for each error type
@@ -4733,7 +4967,7 @@ add_newdoc('numpy.core.umath', 'geterrobj',
     Examples
     --------
     >>> np.geterrobj()  # first get the defaults
-    [10000, 0, None]
+    [0, 0, None]
 
     >>> def err_handler(type, flag):
     ...     print "Floating point error (%s), with flag %s" % (type, flag)
@@ -4769,6 +5003,7 @@ add_newdoc('numpy.core.umath', 'seterrobj',
     errobj : list
         The error object, a list containing three elements:
         [internal numpy buffer size, error mask, error callback function].
+        A buffer size of 0 means that it is chosen for each operation.
 
         The error mask is a single integer that holds the treatment information
         on all four floating point errors. The information for each error type
@@ -4912,7 +5147,8 @@ add_newdoc('numpy.lib._compiled_base', 'bincount',
     x : array_like, 1 dimension, nonnegative ints
         Input array.
     weights : array_like, optional
-        Weights, array of the same shape as `x`.
+        Weights, array of the same shape as `x`.  Complex weights are
+        supported.
     minlength : int, optional
         .. versionadded:: 1.6.0
 
@@ -4922,7 +5158,8 @@ add_newdoc('numpy.lib._compiled_base', 'bincount',
     -------
     out : ndarray of ints
         The result of binning the input array.
-        The length of `out` is equal to ``np.amax(x)+1``.
+        The length of `out` is equal to ``np.amax(x)+1``.  With weights it
+        is of type float, or complex if the weights are complex.
 
     Raises
     ------
@@ -5684,6 +5921,144 @@ add_newdoc('numpy.core', 'ufunc', ('reduceat',
 
     """))
 
+add_newdoc('numpy.core', 'ufunc', ('reduceby',
+    """
+    reduceby(a, labels, ngroups=None, axis=0, dtype=None, out=None)
+
+    Reduces the elements of `a` which share a label along one axis.
+
+    For ``g`` in ``range(ngroups)``, `reduceby` computes
+    ``ufunc.reduce(a[labels == g])`` along `axis`, which becomes the g-th
+    generalized "row" parallel to `axis` in the result.  Unlike sorting
+    `a` by `labels` and using `reduceat`, this takes a single pass over
+    `a` and does not reorder it.
+
+    .. versionadded:: 1.8.0
+
+    Parameters
+    ----------
+    a : array_like
+        The array to act on.
+    labels : array_like
+        The group of each element along `axis`, integers in
+        ``[0, ngroups)``.  Must have the length of `a` along `axis`.
+    ngroups : int, optional
+        The number of groups.  Defaults to one more than the largest label.
+    axis : int, optional
+        The axis along which to reduce.  The default is 0.
+    dtype : data-type code, optional
+        The type used to represent the intermediate results. Defaults
+        to the data type of the output array if this is provided, or
+        the data type of the input array if no output array is provided.
+    out : ndarray, optional
+        A location into which the result is stored. If not provided a
+        freshly-allocated array is returned.
+
+    Returns
+    -------
+    r : ndarray
+        The reduced values, with the length of `axis` being `ngroups`.
+        If `out` was supplied, `r` is a reference to `out`.
+
+    Raises
+    ------
+    ValueError
+        If the ufunc has no identity and is not reorderable, like
+        `subtract`, or if it has no identity and a group has no elements.
+    IndexError
+        If a label is out of bounds.
+
+    See Also
+    --------
+    ufunc.reduceat, bincount
+
+    Notes
+    -----
+    Groups without elements are set to the identity of the ufunc.  For
+    `maximum` and `minimum`, which have none, every group must have at
+    least one element.
+
+    Large reductions into few groups are split across the threads set
+    by `setnumthreads`, so floating point sums may round differently
+    than a serial reduction.
+
+    Examples
+    --------
+    >>> np.add.reduceby([1, 2, 3, 4, 5], [0, 1, 0, 2, 1])
+    array([4, 7, 4])
+    >>> np.maximum.reduceby([1, 2, 3, 4, 5], [0, 1, 0, 1, 1])
+    array([3, 5])
+
+    A 2-D example, reducing the columns:
+
+    >>> x = np.arange(8).reshape(2, 4)
+    >>> np.add.reduceby(x, [1, 0, 1, 1], ngroups=3, axis=1)
+    array([[ 1,  5,  0],
+           [ 5, 17,  0]])
+
+    """))
+
+add_newdoc('numpy.core', 'ufunc', ('at',
+    """
+    at(a, indices, b=None)
+
+    Performs unbuffered in place operation on operand 'a' for elements
+    specified by 'indices'. For addition ufunc, this method is equivalent to
+    ``a[indices] += b``, except that results are accumulated for elements
+    that are indexed more than once. For example, ``a[[0,0]] += 1`` will
+    only increment the first element once because of buffering, whereas
+    ``add.at(a, [0,0], 1)`` will increment the first element twice.
+
+    .. versionadded:: 1.8.0
+
+    Parameters
+    ----------
+    a : array_like
+        The array to perform in place operation on.
+    indices : array_like or tuple
+        Array like index object or slice object for indexing into first
+        operand. If first operand has multiple dimensions, indices can be a
+        tuple of array like index objects or slice objects.
+    b : array_like
+        Second operand for ufuncs requiring two operands. Operand must be
+        broadcastable over first operand after indexing or slicing.
+
+    See Also
+    --------
+    ufunc.reduceby, bincount
+
+    Notes
+    -----
+    For a 1-D array indexed by a single integer array, `add`, `multiply`,
+    `maximum` and `minimum` of integers and floats use a typed loop.
+
+    Examples
+    --------
+    Set items 0 and 1 to their negative values:
+
+    >>> a = np.array([1, 2, 3, 4])
+    >>> np.negative.at(a, [0, 1])
+    >>> print(a)
+    [-1 -2  3  4]
+
+    Increment items 0 and 1, and increment item 2 twice:
+
+    >>> a = np.array([1, 2, 3, 4])
+    >>> np.add.at(a, [0, 1, 2, 2], 1)
+    >>> print(a)
+    [2 3 5 4]
+
+    Add items 0 and 1 in first array to second array,
+    and store results in first array:
+
+    >>> a = np.array([1, 2, 3, 4])
+    >>> b = np.array([1, 2])
+    >>> np.add.at(a, [0, 1], b)
+    >>> print(a)
+    [2 4 3 4]
+
+    """))
+
 add_newdoc('numpy.core', 'ufunc', ('outer',
     """
     outer(A, B)
@@ -56,6 +56,7 @@ API_FILES = [join('multiarray', 'array_assign_array.c'),
              join('multiarray', 'scalarapi.c'),
              join('multiarray', 'sequence.c'),
              join('multiarray', 'shape.c'),
+             join('multiarray', 'threadpool.c'),
              join('multiarray', 'usertypes.c'),
              join('umath', 'loops.c.src'),
              join('umath', 'ufunc_object.c'),
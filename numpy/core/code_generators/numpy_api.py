@@ -335,6 +335,15 @@ multiarray_funcs_api = {
     'PyArray_MapIterSwapAxes':              293,
     'PyArray_MapIterArray':                 294,
     'PyArray_MapIterNext':                  295,
+    'PyArray_GetNumThreads':                296,
+    'PyArray_SetNumThreads':                297,
+    'PyArray_ParallelTaskCount':            298,
+    'PyArray_ParallelRun':                  299,
+    'PyArray_Partition':                    300,
+    'PyArray_ArgPartition':                 301,
+    'PyArray_SelectkindConverter':          302,
+    'PyArray_MinMax':                       303,
+    'PyArray_TopK':                         304,
 }
 
 ufunc_types_api = {
@@ -385,6 +394,7 @@ ufunc_funcs_api = {
     'PyUFunc_DefaultTypeResolver':              39,
     'PyUFunc_ValidateCasting':                  40,
     'PyUFunc_RegisterLoopForDescr':             41,
+    'PyUFunc_SetProfileHook':                   42,
 }
 
 # List of all the dicts which define the C API
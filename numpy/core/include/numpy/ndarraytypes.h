@@ -150,11 +150,23 @@ enum NPY_TYPECHAR {
 typedef enum {
         NPY_QUICKSORT=0,
         NPY_HEAPSORT=1,
-        NPY_MERGESORT=2
+        NPY_MERGESORT=2,
+        NPY_STABLESORT=2,
+        NPY_RADIXSORT=3
 } NPY_SORTKIND;
+/*
+ * The number of sort kinds with a slot in PyArray_ArrFuncs, the
+ * functions of the later kinds are looked up by type number.
+ */
 #define NPY_NSORTS (NPY_MERGESORT + 1)
 
 
+typedef enum {
+        NPY_INTROSELECT=0
+} NPY_SELECTKIND;
+#define NPY_NSELECTS (NPY_INTROSELECT + 1)
+
+
 typedef enum {
         NPY_SEARCHLEFT=0,
         NPY_SEARCHRIGHT=1
@@ -1735,6 +1747,12 @@ typedef struct {
 typedef void (PyDataMem_EventHookFunc)(void *inp, void *outp, size_t size,
                                        void *user_data);
 
+/*
+ * A task of a parallel region, see the documentation for
+ * PyArray_ParallelRun.
+ */
+typedef void (PyArray_ParallelTaskFunc)(void *data, npy_intp itask);
+
 /*
  * Use the keyword NPY_DEPRECATED_INCLUDES to ensure that the header files
  * npy_*_*_deprecated_api.h are only included from here and nowhere else.
@@ -226,6 +226,14 @@ typedef struct _tagPyUFuncObject {
          * set by nditer object.
          */
         npy_uint32 iter_flags;
+
+        /*
+         * For generalized ufuncs, set to 1 if the inner loops may be
+         * called concurrently from several threads, each call getting
+         * its own part of the outer loop. Such loops must not use the
+         * Python API or scratch space shared between calls.
+         */
+        int core_threadsafe;
 } PyUFuncObject;
 
 #include "arrayobject.h"
@@ -303,6 +311,7 @@ typedef struct _tagPyUFuncObject {
 #define UFUNC_ACCUMULATE 1
 #define UFUNC_REDUCEAT 2
 #define UFUNC_OUTER 3
+#define UFUNC_REDUCEBY 4
 
 
 typedef struct {
@@ -323,6 +332,38 @@ typedef struct _loop1d_info {
         PyArray_Descr **arg_dtypes;
 } PyUFunc_Loop1d;
 
+/*
+ * The counters of one ufunc call, passed to the hook set with
+ * PyUFunc_SetProfileHook.  Times are in seconds.
+ */
+typedef struct {
+        /*
+         * The number of elements of the broadcast operands, or of the
+         * outer loop for generalized ufuncs and of the input array for
+         * reductions.
+         */
+        npy_intp nelements;
+        /*
+         * Time spent on argument handling, type resolution and
+         * iterator construction, in the inner loop, and copying or
+         * casting data to and from the iterator buffers.
+         */
+        double setup_time;
+        double loop_time;
+        double buffer_time;
+        /* The number of times the iterator buffers were filled */
+        npy_intp buffer_fills;
+} PyUFunc_ProfileInfo;
+
+/*
+ * This is a function for profiling ufunc calls.
+ * See the documentation for PyUFunc_SetProfileHook.
+ */
+typedef void (PyUFunc_ProfileHookFunc)(PyUFuncObject *ufunc,
+                                       const char *method,
+                                       PyUFunc_ProfileInfo *info,
+                                       void *user_data);
+
 
 #include "__ufunc_api.h"
 
@@ -416,8 +457,10 @@ typedef struct _loop1d_info {
                 | ((FE_OVERFLOW   & fpstatus) ? UFUNC_FPE_OVERFLOW : 0) \
                 | ((FE_UNDERFLOW  & fpstatus) ? UFUNC_FPE_UNDERFLOW : 0) \
                 | ((FE_INVALID    & fpstatus) ? UFUNC_FPE_INVALID : 0); \
-        (void) feclearexcept(FE_DIVBYZERO | FE_OVERFLOW | \
-                             FE_UNDERFLOW | FE_INVALID); \
+        if (fpstatus) { \
+            (void) feclearexcept(FE_DIVBYZERO | FE_OVERFLOW | \
+                                 FE_UNDERFLOW | FE_INVALID); \
+        } \
 }
 
 #elif defined(_AIX)
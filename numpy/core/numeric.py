@@ -3,6 +3,7 @@ from __future__ import division, absolute_import, print_function
 import sys
 import warnings
 import collections
+from numpy.compat import getargspec
 from . import multiarray
 from . import umath
 from .umath import *
@@ -19,7 +20,7 @@ loads = pickle.loads
 
 
 __all__ = ['newaxis', 'ndarray', 'flatiter', 'nditer', 'nested_iters', 'ufunc',
-           'arange', 'array', 'zeros', 'count_nonzero',
+           'arange', 'array', 'zeros', 'count_nonzero', 'minmax', 'topk',
            'empty', 'broadcast', 'dtype', 'fromstring', 'fromfile',
            'frombuffer', 'int_asbuffer', 'where', 'argwhere', 'copyto',
            'concatenate', 'fastCopyAndTranspose', 'lexsort', 'set_numeric_ops',
@@ -36,7 +37,9 @@ __all__ = ['newaxis', 'ndarray', 'flatiter', 'nditer', 'nested_iters', 'ufunc',
            'load', 'loads', 'isscalar', 'binary_repr', 'base_repr',
            'ones', 'identity', 'allclose', 'compare_chararrays', 'putmask',
            'seterr', 'geterr', 'setbufsize', 'getbufsize',
-           'seterrcall', 'geterrcall', 'errstate', 'flatnonzero',
+           'setnumthreads', 'getnumthreads', 'fuse',
+           'seterrcall', 'geterrcall', 'errstate', 'ufunc_profile',
+           'flatnonzero',
            'Inf', 'inf', 'infty', 'Infinity',
            'nan', 'NaN', 'False_', 'True_', 'bitwise_not',
            'CLIP', 'RAISE', 'WRAP', 'MAXDIMS', 'BUFSIZE', 'ALLOW_THREADS',
@@ -365,6 +368,8 @@ arange = multiarray.arange
 array = multiarray.array
 zeros = multiarray.zeros
 count_nonzero = multiarray.count_nonzero
+minmax = multiarray.minmax
+topk = multiarray.topk
 empty = multiarray.empty
 empty_like = multiarray.empty_like
 fromstring = multiarray.fromstring
@@ -388,6 +393,8 @@ lexsort = multiarray.lexsort
 compare_chararrays = multiarray.compare_chararrays
 putmask = multiarray.putmask
 einsum = multiarray.einsum
+setnumthreads = multiarray.setnumthreads
+getnumthreads = multiarray.getnumthreads
 
 def asarray(a, dtype=None, order=None):
     """
@@ -2470,18 +2477,26 @@ def setbufsize(size):
     Parameters
     ----------
     size : int
-        Size of buffer.
+        Size of buffer.  If 0, the default, the size is chosen for each
+        operation from the item sizes of the operands and the size of the
+        CPU's L2 cache.
+
+    Returns
+    -------
+    old : int
+        The previous setting, which is 0 if the size was chosen
+        automatically, so that it can be restored.
 
     """
     if size > 10e6:
         raise ValueError("Buffer size, %s, is too big." % size)
-    if size < 5:
+    if size != 0 and size < 5:
         raise ValueError("Buffer size, %s, is too small." %size)
     if size % 16 != 0:
         raise ValueError("Buffer size, %s, is not a multiple of 16." %size)
 
     pyvals = umath.geterrobj()
-    old = getbufsize()
+    old = pyvals[0]
     pyvals[0] = size
     umath.seterrobj(pyvals)
     return old
@@ -2493,10 +2508,15 @@ def getbufsize():
     Returns
     -------
     getbufsize : int
-        Size of ufunc buffer in bytes.
+        Size of ufunc buffer in elements.  When it is chosen for each
+        operation, which is the default, this is the size chosen for
+        operations on 8 byte types.
 
     """
-    return umath.geterrobj()[0]
+    size = umath.geterrobj()[0]
+    if size == 0:
+        size = multiarray._default_buffersize()
+    return size
 
 def seterrcall(func):
     """
@@ -2713,6 +2733,241 @@ class errstate(object):
             seterrcall(self.oldcall)
 
 
+class ufunc_profile(object):
+    """
+    ufunc_profile()
+
+    Context manager for recording where the time of ufunc calls goes.
+
+    Using an instance of `ufunc_profile` as a context manager counts
+    every successful ufunc call and every call of the ``reduce``,
+    ``accumulate`` and ``reduceat`` methods made while the context is
+    active, from any thread.
+
+    Attributes
+    ----------
+    stats : dict
+        Maps each ufunc name, with the method appended for the ufunc
+        methods (``'add.reduce'``), to a dict of the summed counters:
+
+        * calls : the number of calls.
+        * elements : the number of elements of the broadcast operands,
+          of the outer loop for generalized ufuncs, or of the input
+          array for the methods.
+        * setup_time : seconds spent handling the arguments, resolving
+          the types and constructing the iterator.
+        * loop_time : seconds spent in the inner loops.
+        * buffer_time : seconds spent copying or casting data to and from
+          the iterator buffers.
+        * buffer_fills : the number of times the buffers were filled.
+
+    Notes
+    -----
+    The methods set up their own iterators, which are counted as loop
+    time, as are the buffer copies of loops using the ``where`` argument.
+    For loops split across threads (see `setnumthreads`), the buffer
+    fills of all threads are counted, and their elapsed time is split
+    between loop and buffer time in the proportion the threads spent on
+    each.  Timing adds a small cost to every call, so the counters of
+    very small calls are overestimated.
+
+    Profiles don't nest: calls made within an inner `ufunc_profile` are
+    only counted by the inner one.  C code can use its own hook instead,
+    set with ``PyUFunc_SetProfileHook``.
+
+    Examples
+    --------
+    >>> with np.ufunc_profile() as prof:
+    ...     x = np.arange(1000, dtype=np.float32) + np.arange(1000.)
+    ...     y = np.add.reduce(x)
+    ...
+    >>> prof.stats['add']['calls']
+    1
+    >>> prof.stats['add']['elements']
+    1000
+    >>> sorted(prof.stats)
+    ['add', 'add.reduce']
+
+    """
+    _fields = ('calls', 'elements', 'buffer_fills',
+               'setup_time', 'loop_time', 'buffer_time')
+
+    def __init__(self):
+        self._counters = {}
+
+    def __enter__(self):
+        self._oldcounters = umath._setprofile(self._counters)
+        return self
+
+    def __exit__(self, *exc_info):
+        umath._setprofile(self._oldcounters)
+
+    @property
+    def stats(self):
+        return dict((name, dict(zip(self._fields, counters)))
+                    for name, counters in self._counters.items())
+
+
+def _fuse_binary(ufunc):
+    def op(self, other):
+        return _FusedValue(ufunc, (self, other))
+    def rop(self, other):
+        return _FusedValue(ufunc, (other, self))
+    return op, rop
+
+def _fuse_unary(ufunc):
+    def op(self):
+        return _FusedValue(ufunc, (self,))
+    return op
+
+class _FusedValue(object):
+    """
+    An argument or intermediate result of a function traced by `fuse`.
+
+    Operators return new values recording the ufunc and its arguments.
+    Ufuncs called on a value compute on the dummy array returned by
+    ``__array__``, and ``__array_wrap__`` records the call instead.
+    """
+    __array_priority__ = 1e10
+
+    def __init__(self, ufunc=None, args=(), index=None):
+        self.ufunc = ufunc
+        self.args = args
+        self.index = index
+
+    def __array__(self, dtype=None):
+        return multiarray.array(1, dtype=dtype or 'b')
+
+    def __array_wrap__(self, arr, context=None):
+        if context is None:
+            raise TypeError("only ufuncs can be applied to the arguments "
+                            "of a fused function")
+        ufunc, args = context[:2]
+        if ufunc.nout != 1 or len(args) > ufunc.nin:
+            raise TypeError("ufunc %s can't be fused, only ufuncs with a "
+                            "single output and no out argument can" %
+                            ufunc.__name__)
+        return _FusedValue(ufunc, args)
+
+    def __nonzero__(self):
+        raise TypeError("the truth value of the arguments of a fused "
+                        "function is unknown")
+    __bool__ = __nonzero__
+    __hash__ = object.__hash__
+
+    __add__, __radd__ = _fuse_binary(umath.add)
+    __sub__, __rsub__ = _fuse_binary(umath.subtract)
+    __mul__, __rmul__ = _fuse_binary(umath.multiply)
+    __div__, __rdiv__ = _fuse_binary(umath.divide)
+    __truediv__, __rtruediv__ = _fuse_binary(umath.true_divide)
+    __floordiv__, __rfloordiv__ = _fuse_binary(umath.floor_divide)
+    __mod__, __rmod__ = _fuse_binary(umath.remainder)
+    __pow__, __rpow__ = _fuse_binary(umath.power)
+    __lshift__, __rlshift__ = _fuse_binary(umath.left_shift)
+    __rshift__, __rrshift__ = _fuse_binary(umath.right_shift)
+    __and__, __rand__ = _fuse_binary(umath.bitwise_and)
+    __or__, __ror__ = _fuse_binary(umath.bitwise_or)
+    __xor__, __rxor__ = _fuse_binary(umath.bitwise_xor)
+    __lt__ = _fuse_binary(umath.less)[0]
+    __le__ = _fuse_binary(umath.less_equal)[0]
+    __eq__ = _fuse_binary(umath.equal)[0]
+    __ne__ = _fuse_binary(umath.not_equal)[0]
+    __gt__ = _fuse_binary(umath.greater)[0]
+    __ge__ = _fuse_binary(umath.greater_equal)[0]
+    __neg__ = _fuse_unary(umath.negative)
+    __abs__ = _fuse_unary(umath.absolute)
+    __invert__ = _fuse_unary(umath.invert)
+
+    def __pos__(self):
+        return self
+
+def fuse(func, nin=None):
+    """
+    Compile a function of ufunc calls into a single fused ufunc.
+
+    Evaluating an expression like ``a*b + c*d - e`` allocates a full size
+    temporary array for every intermediate result, and goes through memory
+    once per operator.  The ufunc returned by `fuse` evaluates the whole
+    expression in blocks small enough for the intermediate results to stay
+    in the CPU cache, which avoids the temporaries and is faster for large
+    arrays.
+
+    Parameters
+    ----------
+    func : callable
+        Function to fuse.  It is called once with placeholder arguments to
+        record its operations, which may only be arithmetic, comparison
+        and bitwise operators and calls of ufuncs with a single output,
+        applied to the arguments, to intermediate results or to scalar
+        constants.
+    nin : int, optional
+        The number of arguments of `func`.  By default the number of
+        positional arguments in its definition.
+
+    Returns
+    -------
+    out : ufunc
+        A ufunc with `nin` inputs and one output, which supports
+        broadcasting, the `out` argument, `reduce` and `outer`, but not
+        `accumulate` and `reduceat`.  The `dtype` and `sig` arguments can
+        only request the types it resolves by itself.
+
+    See Also
+    --------
+    frompyfunc, vectorize
+
+    Notes
+    -----
+    The types of the intermediate results are resolved like for the
+    unfused operations, so the result is the same as calling `func`
+    with arrays, up to the floating point errors which are reported for
+    the fused ufunc.  Only boolean and numeric types are supported.
+
+    Examples
+    --------
+    >>> f = np.fuse(lambda a, b, c: a * b + np.sin(c) - 1)
+    >>> f(np.arange(3.), 2., 0.)
+    array([-1.,  1.,  3.])
+
+    """
+    if nin is None:
+        try:
+            nin = len(getargspec(func)[0])
+        except TypeError:
+            raise TypeError("the number of arguments of %r is unknown, "
+                            "use the nin argument" % (func,))
+        if getattr(func, '__self__', None) is not None:
+            nin -= 1
+    inputs = [_FusedValue(index=i) for i in range(nin)]
+    with errstate(all='ignore'):
+        result = func(*inputs)
+    if not isinstance(result, _FusedValue) or result.ufunc is None:
+        raise TypeError("a fused function must return the result of "
+                        "ufuncs applied to its arguments")
+
+    nodes = []
+    values = {}
+    def visit(value):
+        if value.index is not None:
+            return value.index
+        if id(value) not in values:
+            args = []
+            for arg in value.args:
+                if isinstance(arg, _FusedValue):
+                    args.append(visit(arg))
+                elif isscalar(arg):
+                    args.append(asarray(arg))
+                else:
+                    raise TypeError("fused functions only support scalar "
+                                    "constants, got %r" % (arg,))
+            nodes.append((value.ufunc, tuple(args)))
+            values[id(value)] = nin + len(nodes) - 1
+        return values[id(value)]
+    visit(result)
+
+    return umath._fuse(getattr(func, '__name__', 'fused'), nin, nodes)
+
+
 def _setdef():
     defval = [UFUNC_BUFSIZE_DEFAULT, ERR_DEFAULT2, None]
     umath.seterrobj(defval)
@@ -175,6 +175,22 @@ def check_math_capabilities(config, moredefs, mathlibs):
                                    call=False):
             moredefs.append((fname2def(fn), 1))
 
+    for dec, fn, code, header in OPTIONAL_GCC_ATTRIBUTES_WITH_INTRINSICS:
+        body = """
+#include <%s>
+int %s %s(void)
+{
+    %s;
+}
+
+int main(void)
+{
+    return %s();
+}
+""" % (header, dec, fn, code, fn)
+        if config.try_compile(body, None, None):
+            moredefs.append((fname2def(fn), 1))
+
     # C99 functions: float and long double versions
     check_funcs(C99_FUNCS_SINGLE)
     check_funcs(C99_FUNCS_EXTENDED)
@@ -693,7 +709,11 @@ def configuration(parent_package='',top_path=None):
     config.add_library('npysort',
             sources = [join('src', 'npysort', 'quicksort.c.src'),
                        join('src', 'npysort', 'mergesort.c.src'),
-                       join('src', 'npysort', 'heapsort.c.src')])
+                       join('src', 'npysort', 'heapsort.c.src'),
+                       join('src', 'npysort', 'radixsort.c.src'),
+                       join('src', 'npysort', 'timsort.c.src'),
+                       join('src', 'npysort', 'selection.c.src'),
+                       join('src', 'npysort', 'binsearch.c.src')])
 
 
     #######################################################################
@@ -746,6 +766,7 @@ def configuration(parent_package='',top_path=None):
             join('src', 'multiarray', 'scalartypes.h'),
             join('src', 'multiarray', 'sequence.h'),
             join('src', 'multiarray', 'shape.h'),
+            join('src', 'multiarray', 'threadpool.h'),
             join('src', 'multiarray', 'ucsnarrow.h'),
             join('src', 'multiarray', 'usertypes.h'),
             join('src', 'private', 'lowlevel_strided_loops.h'),
@@ -811,6 +832,7 @@ def configuration(parent_package='',top_path=None):
             join('src', 'multiarray', 'shape.c'),
             join('src', 'multiarray', 'scalarapi.c'),
             join('src', 'multiarray', 'scalartypes.c.src'),
+            join('src', 'multiarray', 'threadpool.c'),
             join('src', 'multiarray', 'usertypes.c'),
             join('src', 'multiarray', 'ucsnarrow.c')]
 
@@ -871,15 +893,18 @@ def configuration(parent_package='',top_path=None):
     umath_src = [
             join('src', 'umath', 'umathmodule.c'),
             join('src', 'umath', 'reduction.c'),
+            join('src', 'umath', 'cpuid.c'),
             join('src', 'umath', 'funcs.inc.src'),
             join('src', 'umath', 'simd.inc.src'),
             join('src', 'umath', 'loops.c.src'),
             join('src', 'umath', 'ufunc_object.c'),
-            join('src', 'umath', 'ufunc_type_resolution.c')]
+            join('src', 'umath', 'ufunc_type_resolution.c'),
+            join('src', 'umath', 'fused.c')]
 
     umath_deps = [
             generate_umath_py,
             join('src', 'umath', 'simd.inc.src'),
+            join('src', 'umath', 'cpuid.h'),
             join(codegen_dir,'generate_ufunc_api.py')]
 
     if not ENABLE_SEPARATE_COMPILATION:
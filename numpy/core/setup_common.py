@@ -102,6 +102,7 @@ OPTIONAL_HEADERS = [
 # sse headers only enabled automatically on amd64/x32 builds
                 "xmmintrin.h", # SSE
                 "emmintrin.h", # SSE2
+                "immintrin.h", # AVX
 ]
 
 # optional gcc compiler builtins and their call arguments
@@ -111,6 +112,7 @@ OPTIONAL_INTRINSICS = [("__builtin_isnan", '5.'),
                        ("__builtin_isfinite", '5.'),
                        ("__builtin_bswap32", '5u'),
                        ("__builtin_bswap64", '5u'),
+                       ("__builtin_cpu_supports", '"avx512f"'),
                        ]
 
 # gcc function attributes
@@ -120,6 +122,29 @@ OPTIONAL_GCC_ATTRIBUTES = [('__attribute__((optimize("unroll-loops")))',
                             'attribute_optimize_unroll_loops'),
                           ]
 
+# gcc function attributes which must also allow using the intrinsics of
+# the instruction set inside the function
+# (attribute as understood by gcc, function name, code using the intrinsics,
+#  header with the intrinsics),
+# function name will be converted to HAVE_<upper-case-name> preprocessor macro
+OPTIONAL_GCC_ATTRIBUTES_WITH_INTRINSICS = [
+        ('__attribute__((target("avx2")))',
+         'attribute_target_avx2_with_intrinsics',
+         '__m256 temp = _mm256_set1_ps(1.0); return _mm256_movemask_ps(temp)',
+         'immintrin.h'),
+        ('__attribute__((target("avx2,fma")))',
+         'attribute_target_avx2_fma_with_intrinsics',
+         '__m256 temp = _mm256_set1_ps(1.0); '
+         'temp = _mm256_fmadd_ps(temp, temp, temp); '
+         'return _mm256_movemask_ps(temp)',
+         'immintrin.h'),
+        ('__attribute__((target("avx512f")))',
+         'attribute_target_avx512f_with_intrinsics',
+         '__m512i temp = _mm512_set1_epi32(1); '
+         'return _mm512_cmpeq_epi32_mask(temp, temp)',
+         'immintrin.h'),
+        ]
+
 # Subset of OPTIONAL_STDFUNCS which may alreay have HAVE_* defined by Python.h
 OPTIONAL_STDFUNCS_MAYBE = ["expm1", "log1p", "acosh", "atanh", "asinh", "hypot",
         "copysign"]
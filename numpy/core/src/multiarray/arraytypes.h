@@ -10,4 +10,17 @@ extern NPY_NO_EXPORT PyArray_Descr INT_Descr;
 NPY_NO_EXPORT int
 set_typeinfo(PyObject *dict);
 
+/*
+ * Computes the minimum and the maximum of n contiguous values, or
+ * updates n minima and maxima elementwise with them.
+ */
+typedef void (PyArray_MinMaxFunc)(const char *ip, npy_intp n,
+                                  char *mn, char *mx);
+
+NPY_NO_EXPORT PyArray_MinMaxFunc *
+get_minmax_func(int type_num);
+
+NPY_NO_EXPORT PyArray_MinMaxFunc *
+get_minmax_update_func(int type_num);
+
 #endif
@@ -15,6 +15,7 @@
 
 #include "calculation.h"
 #include "array_assign.h"
+#include "arraytypes.h"
 
 static double
 power_of_ten(int n)
@@ -297,6 +298,134 @@ PyArray_Min(PyArrayObject *ap, int axis, PyArrayObject *out)
     return ret;
 }
 
+/*
+ * Finds the minimum and the maximum of arr along axis in one pass, if
+ * the type has one pass functions.  Returns -1 on error, otherwise 0
+ * with *mn and *mx set to the results or to NULL if the reductions have
+ * to be used instead.
+ */
+static int
+_minmax_onepass(PyArrayObject *arr, int axis, PyObject **mn, PyObject **mx)
+{
+    int type_num = PyArray_DESCR(arr)->type_num;
+    PyArray_MinMaxFunc *minmax = get_minmax_func(type_num);
+    PyArray_MinMaxFunc *update = get_minmax_update_func(type_num);
+    PyArray_Descr *descr = PyArray_DESCR(arr);
+    PyArrayObject *carr, *rmn, *rmx;
+    npy_intp shape[NPY_MAXDIMS], outer = 1, inner = 1, n, nbytes, o, k;
+    int i, j, ndim = PyArray_NDIM(arr);
+    char *ip, *pmn, *pmx;
+    NPY_BEGIN_THREADS_DEF;
+
+    *mn = *mx = NULL;
+    if (minmax == NULL || !PyArray_ISNOTSWAPPED(arr) ||
+            PyArray_DIM(arr, axis) == 0) {
+        return 0;
+    }
+
+    for (i = 0, j = 0; i < ndim; i++) {
+        if (i < axis) {
+            outer *= PyArray_DIM(arr, i);
+        }
+        else if (i > axis) {
+            inner *= PyArray_DIM(arr, i);
+        }
+        if (i != axis) {
+            shape[j++] = PyArray_DIM(arr, i);
+        }
+    }
+    n = PyArray_DIM(arr, axis);
+    nbytes = inner * descr->elsize;
+
+    /* The one pass functions need aligned, contiguous data */
+    carr = (PyArrayObject *)PyArray_FROM_OF((PyObject *)arr, NPY_ARRAY_CARRAY);
+    if (carr == NULL) {
+        return -1;
+    }
+    Py_INCREF(descr);
+    rmn = (PyArrayObject *)PyArray_NewFromDescr(&PyArray_Type, descr,
+                                        ndim - 1, shape, NULL, NULL, 0, NULL);
+    Py_INCREF(descr);
+    rmx = (PyArrayObject *)PyArray_NewFromDescr(&PyArray_Type, descr,
+                                        ndim - 1, shape, NULL, NULL, 0, NULL);
+    if (rmn == NULL || rmx == NULL) {
+        Py_DECREF(carr);
+        Py_XDECREF(rmn);
+        Py_XDECREF(rmx);
+        return -1;
+    }
+
+    ip = PyArray_DATA(carr);
+    pmn = PyArray_DATA(rmn);
+    pmx = PyArray_DATA(rmx);
+    NPY_BEGIN_THREADS;
+    for (o = 0; o < outer; o++) {
+        if (inner == 1) {
+            /* reduce the contiguous lanes */
+            minmax(ip, n, pmn, pmx);
+            ip += n * descr->elsize;
+        }
+        else {
+            /* update the results with the rows, which vectorizes */
+            memcpy(pmn, ip, nbytes);
+            memcpy(pmx, ip, nbytes);
+            ip += nbytes;
+            for (k = 1; k < n; k++) {
+                update(ip, inner, pmn, pmx);
+                ip += nbytes;
+            }
+        }
+        pmn += nbytes;
+        pmx += nbytes;
+    }
+    NPY_END_THREADS;
+    Py_DECREF(carr);
+
+    *mn = PyArray_Return(rmn);
+    *mx = PyArray_Return(rmx);
+    return 0;
+}
+
+/*NUMPY_API
+ * MinMax
+ *
+ * Returns a tuple of the minimum and the maximum along axis, found in
+ * one pass for the boolean, integer, float, double, datetime and
+ * timedelta types of exact arrays.
+ */
+NPY_NO_EXPORT PyObject *
+PyArray_MinMax(PyArrayObject *ap, int axis)
+{
+    PyArrayObject *arr;
+    PyObject *mn = NULL, *mx = NULL;
+
+    arr = (PyArrayObject *)PyArray_CheckAxis(ap, &axis, 0);
+    if (arr == NULL) {
+        return NULL;
+    }
+    if (PyArray_CheckExact(ap) && _minmax_onepass(arr, axis, &mn, &mx) < 0) {
+        goto fail;
+    }
+    if (mn == NULL) {
+        mn = PyArray_Min(arr, axis, NULL);
+        if (mn == NULL) {
+            goto fail;
+        }
+        mx = PyArray_Max(arr, axis, NULL);
+        if (mx == NULL) {
+            goto fail;
+        }
+    }
+    Py_DECREF(arr);
+    return Py_BuildValue("NN", mn, mx);
+
+ fail:
+    Py_DECREF(arr);
+    Py_XDECREF(mn);
+    Py_XDECREF(mx);
+    return NULL;
+}
+
 /*NUMPY_API
  * Ptp
  */
@@ -311,17 +440,23 @@ PyArray_Ptp(PyArrayObject *ap, int axis, PyArrayObject *out)
     if (arr == NULL) {
         return NULL;
     }
-    obj1 = PyArray_Max(arr, axis, out);
-    if (obj1 == NULL) {
+    if (PyArray_CheckExact(ap) &&
+            _minmax_onepass(arr, axis, &obj2, &obj1) < 0) {
         goto fail;
     }
-    obj2 = PyArray_Min(arr, axis, NULL);
-    if (obj2 == NULL) {
-        goto fail;
+    if (obj1 == NULL) {
+        obj1 = PyArray_Max(arr, axis, out);
+        if (obj1 == NULL) {
+            goto fail;
+        }
+        obj2 = PyArray_Min(arr, axis, NULL);
+        if (obj2 == NULL) {
+            goto fail;
+        }
     }
     Py_DECREF(arr);
     if (out) {
-        ret = PyObject_CallFunction(n_ops.subtract, "OOO", out, obj2, out);
+        ret = PyObject_CallFunction(n_ops.subtract, "OOO", obj1, obj2, out);
     }
     else {
         ret = PyNumber_Subtract(obj1, obj2);
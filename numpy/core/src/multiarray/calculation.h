@@ -13,6 +13,9 @@ PyArray_Max(PyArrayObject* self, int axis, PyArrayObject* out);
 NPY_NO_EXPORT PyObject*
 PyArray_Min(PyArrayObject* self, int axis, PyArrayObject* out);
 
+NPY_NO_EXPORT PyObject*
+PyArray_MinMax(PyArrayObject* self, int axis);
+
 NPY_NO_EXPORT PyObject*
 PyArray_Ptp(PyArrayObject* self, int axis, PyArrayObject* out);
 
@@ -394,6 +394,12 @@ PyArray_SortkindConverter(PyObject *obj, NPY_SORTKIND *sortkind)
     else if (str[0] == 'm' || str[0] == 'M') {
         *sortkind = NPY_MERGESORT;
     }
+    else if (str[0] == 'r' || str[0] == 'R') {
+        *sortkind = NPY_RADIXSORT;
+    }
+    else if (str[0] == 's' || str[0] == 'S') {
+        *sortkind = NPY_STABLESORT;
+    }
     else {
         PyErr_Format(PyExc_ValueError,
                      "%s is an unrecognized kind of sort",
@@ -405,6 +411,45 @@ PyArray_SortkindConverter(PyObject *obj, NPY_SORTKIND *sortkind)
     return NPY_SUCCEED;
 }
 
+/*NUMPY_API
+ * Convert object to select kind
+ */
+NPY_NO_EXPORT int
+PyArray_SelectkindConverter(PyObject *obj, NPY_SELECTKIND *selectkind)
+{
+    char *str;
+    PyObject *tmp = NULL;
+
+    if (PyUnicode_Check(obj)) {
+        obj = tmp = PyUnicode_AsASCIIString(obj);
+    }
+
+    *selectkind = NPY_INTROSELECT;
+    str = PyBytes_AsString(obj);
+    if (!str) {
+        Py_XDECREF(tmp);
+        return NPY_FAIL;
+    }
+    if (strlen(str) < 1) {
+        PyErr_SetString(PyExc_ValueError,
+                        "Select kind string must be at least length 1");
+        Py_XDECREF(tmp);
+        return NPY_FAIL;
+    }
+    if (strcmp(str, "introselect") == 0) {
+        *selectkind = NPY_INTROSELECT;
+    }
+    else {
+        PyErr_Format(PyExc_ValueError,
+                     "%s is an unrecognized kind of select",
+                     str);
+        Py_XDECREF(tmp);
+        return NPY_FAIL;
+    }
+    Py_XDECREF(tmp);
+    return NPY_SUCCEED;
+}
+
 /*NUMPY_API
  * Convert object to searchsorted side
  */
@@ -1768,7 +1768,8 @@ PyArray_CheckFromAny(PyObject *op, PyArray_Descr *descr, int min_depth,
         else if (descr && !PyArray_ISNBO(descr->byteorder)) {
             PyArray_DESCR_REPLACE(descr);
         }
-        if (descr) {
+        /* descr may be a builtin one, which must keep NPY_IGNORE */
+        if (descr && descr->byteorder != NPY_IGNORE) {
             descr->byteorder = NPY_NATIVE;
         }
     }
@@ -13,6 +13,10 @@
 
 #include "npy_pycompat.h"
 
+#ifdef HAVE_EMMINTRIN_H
+#include <emmintrin.h>
+#endif
+
 #include "common.h"
 #include "arrayobject.h"
 #include "ctors.h"
@@ -20,6 +24,66 @@
 
 #include "item_selection.h"
 #include "npy_sort.h"
+#include "npy_partition.h"
+#include "npy_binsearch.h"
+#include "threadpool.h"
+
+/*
+ * Returns the indices moved into [0, max_item) as the clip mode asks,
+ * in a new array if any of them changes, or NULL if one is out of bounds
+ * in raise mode, reporting 'axis'.  The copy loops need no checks then.
+ */
+static PyArrayObject *
+_prepare_take_indices(PyArrayObject *indices, npy_intp max_item,
+                      NPY_CLIPMODE clipmode, int axis)
+{
+    PyArrayObject *ret;
+    npy_intp *ind = (npy_intp *)PyArray_DATA(indices);
+    npy_intp i, n = PyArray_SIZE(indices), v;
+
+    for (i = 0; i < n; i++) {
+        if (ind[i] < 0 || ind[i] >= max_item) {
+            break;
+        }
+    }
+    if (i == n) {
+        Py_INCREF(indices);
+        return indices;
+    }
+    if (max_item == 0) {
+        PyErr_SetString(PyExc_IndexError,
+                        "cannot index into an empty axis");
+        return NULL;
+    }
+    ret = (PyArrayObject *)PyArray_NewCopy(indices, NPY_CORDER);
+    if (ret == NULL) {
+        return NULL;
+    }
+    ind = (npy_intp *)PyArray_DATA(ret);
+    switch (clipmode) {
+        case NPY_RAISE:
+            for (; i < n; i++) {
+                if (check_and_adjust_index(&ind[i], max_item, axis) < 0) {
+                    Py_DECREF(ret);
+                    return NULL;
+                }
+            }
+            break;
+        case NPY_WRAP:
+            for (; i < n; i++) {
+                v = ind[i] % max_item;
+                ind[i] = (v < 0) ? v + max_item : v;
+            }
+            break;
+        case NPY_CLIP:
+            for (; i < n; i++) {
+                v = ind[i];
+                ind[i] = (v < 0) ? 0 : ((v >= max_item) ? max_item - 1 : v);
+            }
+            break;
+    }
+    return ret;
+}
 
 /*NUMPY_API
  * Take
@@ -125,7 +189,37 @@ PyArray_TakeFrom(PyArrayObject *self0, PyObject *indices0, int axis,
     }
 
     func = PyArray_DESCR(self)->f->fasttake;
-    if (func == NULL) {
+    if (!needs_refcounting) {
+        npy_index_copy_info info;
+        PyArrayObject *checked;
+
+        if (PyArray_SIZE(obj) == 0) {
+            goto finish;
+        }
+        /* the typed loops reported errors without the axis */
+        checked = _prepare_take_indices(indices, max_item, clipmode,
+                                        (func != NULL) ? -1 : axis);
+        if (checked == NULL) {
+            goto fail;
+        }
+        Py_DECREF(indices);
+        indices = checked;
+
+        info.data = src;
+        info.nouterdim = 1;
+        info.outershape[0] = info.nouter = n;
+        info.outerstrides[0] = chunk * max_item;
+        info.axisstride = chunk;
+        info.ind = (npy_intp *)PyArray_DATA(indices);
+        info.nind = m;
+        info.chunk = chunk;
+        info.typed = npy_index_copy_typed(self, chunk);
+        info.buf = dest;
+        info.period = n * m * chunk;
+        info.gather = 1;
+        npy_index_copy(&info);
+    }
+    else if (func == NULL) {
         switch(clipmode) {
         case NPY_RAISE:
             for (i = 0; i < n; i++) {
@@ -222,6 +316,7 @@ PyArray_TakeFrom(PyArrayObject *self0, PyObject *indices0, int axis,
         }
     }
 
+ finish:
     Py_XDECREF(indices);
     Py_XDECREF(self);
     if (out != NULL && out != obj) {
@@ -291,7 +386,33 @@ PyArray_PutTo(PyArrayObject *self, PyObject* values0, PyObject *indices0,
     if (nv <= 0) {
         goto finish;
     }
-    if (PyDataType_REFCHK(PyArray_DESCR(self))) {
+    if (!PyDataType_REFCHK(PyArray_DESCR(self))) {
+        npy_index_copy_info info;
+        PyArrayObject *checked;
+
+        checked = _prepare_take_indices(indices, max_item, clipmode, 0);
+        if (checked == NULL) {
+            goto fail;
+        }
+        Py_DECREF(indices);
+        indices = checked;
+
+        /* assignments stay in order, as repeated indices take the last */
+        info.data = dest;
+        info.nouterdim = 0;
+        info.nouter = 1;
+        info.axisstride = chunk;
+        info.ind = (npy_intp *)PyArray_DATA(indices);
+        info.nind = ni;
+        info.chunk = chunk;
+        info.typed = npy_index_copy_typed(self, chunk) &&
+                     PyArray_ISALIGNED(values);
+        info.buf = PyArray_BYTES(values);
+        info.period = nv * chunk;
+        info.gather = 0;
+        npy_index_copy(&info);
+    }
+    else {
         switch(clipmode) {
         case NPY_RAISE:
             for (i = 0; i < ni; i++) {
@@ -341,50 +462,6 @@ PyArray_PutTo(PyArrayObject *self, PyObject* values0, PyObject *indices0,
             break;
         }
     }
-    else {
-        switch(clipmode) {
-        case NPY_RAISE:
-            for (i = 0; i < ni; i++) {
-                src = PyArray_BYTES(values) + chunk * (i % nv);
-                tmp = ((npy_intp *)(PyArray_DATA(indices)))[i];
-                if (check_and_adjust_index(&tmp, max_item, 0) < 0) {
-                    goto fail;
-                }
-                memmove(dest + tmp * chunk, src, chunk);
-            }
-            break;
-        case NPY_WRAP:
-            for (i = 0; i < ni; i++) {
-                src = PyArray_BYTES(values) + chunk * (i % nv);
-                tmp = ((npy_intp *)(PyArray_DATA(indices)))[i];
-                if (tmp < 0) {
-                    while (tmp < 0) {
-                        tmp += max_item;
-                    }
-                }
-                else if (tmp >= max_item) {
-                    while (tmp >= max_item) {
-                        tmp -= max_item;
-                    }
-                }
-                memmove(dest + tmp * chunk, src, chunk);
-            }
-            break;
-        case NPY_CLIP:
-            for (i = 0; i < ni; i++) {
-                src = PyArray_BYTES(values) + chunk * (i % nv);
-                tmp = ((npy_intp *)(PyArray_DATA(indices)))[i];
-                if (tmp < 0) {
-                    tmp = 0;
-                }
-                else if (tmp >= max_item) {
-                    tmp = max_item - 1;
-                }
-                memmove(dest + tmp * chunk, src, chunk);
-            }
-            break;
-        }
-    }
 
  finish:
     Py_XDECREF(values);
@@ -760,215 +837,738 @@ PyArray_Choose(PyArrayObject *ip, PyObject *op, PyArrayObject *out,
 }
 
 /*
- * These algorithms use special sorting.  They are not called unless the
- * underlying sort function for the type is available.  Note that axis is
- * already valid. The sort functions require 1-d contiguous and well-behaved
- * data.  Therefore, a copy will be made of the data if needed before handing
- * it to the sorting routine.  An iterator is constructed and adjusted to walk
- * over all but the desired sorting axis.
+ * Minimum number of elements per thread of the parallel sorts.  Several
+ * lanes are sorted concurrently in blocks of lanes, a single lane is cut
+ * into one chunk per thread when it is long enough.
  */
-static int
-_new_sort(PyArrayObject *op, int axis, NPY_SORTKIND which)
-{
-    PyArrayIterObject *it;
-    int needcopy = 0, swap;
-    npy_intp N, size;
+#define NPY_SORT_PARALLEL_MIN (1 << 16)
+
+/* The operation applied to every lane by _new_sortlike and _new_argsortlike */
+typedef struct {
+    PyArrayObject *op;
+    PyArray_SortFunc *sort;
+    PyArray_ArgSortFunc *argsort;
+    PyArray_PartitionFunc *part;
+    PyArray_ArgPartitionFunc *argpart;
+    npy_intp *kth;
+    npy_intp nkth;
+    npy_intp N;
     int elsize;
+    int swap;
+    int needcopy;
     npy_intp astride;
-    PyArray_SortFunc *sort;
-    NPY_BEGIN_THREADS_DEF;
+    npy_intp rstride;
+    /* number of chunks the (single) lane is split into, 1 for no split */
+    int nsplit;
+} _sortlike_info;
+
+/* Start of part i when n items are split into nparts nearly equal parts */
+static NPY_INLINE npy_intp
+_split_point(npy_intp n, npy_intp nparts, npy_intp i)
+{
+    return i * (n / nparts) + PyArray_MIN(i, n % nparts);
+}
 
-    it = (PyArrayIterObject *)PyArray_IterAllButAxis((PyObject *)op, &axis);
-    swap = !PyArray_ISNOTSWAPPED(op);
-    if (it == NULL) {
-        return -1;
+/*
+ * Copying blocks selected by an index between an array and a buffer.
+ * The indices are checked and wrapped before, so the loops only copy.
+ * Blocks that are single items of 1, 2, 4, 8 or 16 bytes are copied as
+ * integers.
+ */
+
+/* Minimum number of bytes copied per task of the thread pool */
+#define INDEX_COPY_PARALLEL_MIN 65536
+
+typedef struct {
+    npy_uint64 lo, hi;
+} _index_copy_16;
+
+NPY_NO_EXPORT int
+npy_index_copy_typed(PyArrayObject *arr, npy_intp chunk)
+{
+    int alignment = PyArray_DESCR(arr)->alignment;
+
+    if (chunk != PyArray_ITEMSIZE(arr) || !PyArray_ISALIGNED(arr)) {
+        return 0;
+    }
+    switch (chunk) {
+        case 1:
+        case 2:
+        case 4:
+        case 8:
+            return alignment >= chunk;
+        case 16:
+            return alignment >= 8;
     }
+    return 0;
+}
 
-    NPY_BEGIN_THREADS_DESCR(PyArray_DESCR(op));
-    sort = PyArray_DESCR(op)->f->sort[which];
-    size = it->size;
-    N = PyArray_DIMS(op)[axis];
-    elsize = PyArray_DESCR(op)->elsize;
-    astride = PyArray_STRIDES(op)[axis];
-
-    needcopy = !(PyArray_FLAGS(op) & NPY_ARRAY_ALIGNED) ||
-                (astride != (npy_intp) elsize) || swap;
-    if (needcopy) {
-        char *buffer = PyDataMem_NEW(N*elsize);
-        if (buffer == NULL) {
-            goto fail;
-        }
+#define _INDEX_COPY_LOOP(type)                                          \
+    if (info->gather) {                                                 \
+        for (j = jstart; j < jend; j++) {                               \
+            *(type *)buf = *(type *)(base + ind[j] * axisstride);       \
+            buf += sizeof(type);                                        \
+        }                                                               \
+    }                                                                   \
+    else {                                                              \
+        for (j = jstart; j < jend; j++) {                               \
+            *(type *)(base + ind[j] * axisstride) = *(type *)buf;       \
+            buf += sizeof(type);                                        \
+            if (buf == bufend) {                                        \
+                buf = info->buf;                                        \
+            }                                                           \
+        }                                                               \
+    }
 
-        while (size--) {
-            _unaligned_strided_byte_copy(buffer, (npy_intp) elsize, it->dataptr,
-                                         astride, N, elsize);
-            if (swap) {
-                _strided_byte_swap(buffer, (npy_intp) elsize, N, elsize);
-            }
-            if (sort(buffer, N, op) < 0) {
-                PyDataMem_FREE(buffer);
-                goto fail;
-            }
-            if (swap) {
-                _strided_byte_swap(buffer, (npy_intp) elsize, N, elsize);
+/*
+ * Copies the blocks for the positions 'start' to 'stop' of the result,
+ * counted in blocks.
+ */
+static void
+_index_copy(const npy_index_copy_info *info, npy_intp start, npy_intp stop)
+{
+    npy_intp nind = info->nind, chunk = info->chunk;
+    npy_intp axisstride = info->axisstride;
+    npy_intp *ind = info->ind;
+    npy_intp outer = start / nind, jstart = start % nind, jend, j;
+    npy_intp coord[NPY_MAXDIMS];
+    char *buf = info->buf + (start * chunk) % info->period;
+    char *bufend = info->buf + info->period;
+    char *base = info->data;
+    int idim;
+
+    for (idim = info->nouterdim - 1; idim >= 0; idim--) {
+        coord[idim] = outer % info->outershape[idim];
+        outer /= info->outershape[idim];
+        base += coord[idim] * info->outerstrides[idim];
+    }
+    while (start < stop) {
+        jend = PyArray_MIN(nind, jstart + (stop - start));
+        if (!info->typed) {
+            for (j = jstart; j < jend; j++) {
+                if (info->gather) {
+                    memcpy(buf, base + ind[j] * axisstride, chunk);
+                    buf += chunk;
+                }
+                else {
+                    memcpy(base + ind[j] * axisstride, buf, chunk);
+                    buf += chunk;
+                    if (buf == bufend) {
+                        buf = info->buf;
+                    }
+                }
             }
-            _unaligned_strided_byte_copy(it->dataptr, astride, buffer,
-                                         (npy_intp) elsize, N, elsize);
-            PyArray_ITER_NEXT(it);
         }
-        PyDataMem_FREE(buffer);
-    }
-    else {
-        while (size--) {
-            if (sort(it->dataptr, N, op) < 0) {
-                goto fail;
+        else if (chunk == 1) {
+            _INDEX_COPY_LOOP(npy_uint8);
+        }
+        else if (chunk == 2) {
+            _INDEX_COPY_LOOP(npy_uint16);
+        }
+        else if (chunk == 4) {
+            _INDEX_COPY_LOOP(npy_uint32);
+        }
+        else if (chunk == 8) {
+            _INDEX_COPY_LOOP(npy_uint64);
+        }
+        else {
+            _INDEX_COPY_LOOP(_index_copy_16);
+        }
+        start += jend - jstart;
+        jstart = 0;
+        /* advance to the next leading position */
+        for (idim = info->nouterdim - 1; idim >= 0; idim--) {
+            base += info->outerstrides[idim];
+            if (++coord[idim] < info->outershape[idim]) {
+                break;
             }
-            PyArray_ITER_NEXT(it);
+            base -= coord[idim] * info->outerstrides[idim];
+            coord[idim] = 0;
         }
     }
-    NPY_END_THREADS_DESCR(PyArray_DESCR(op));
-    Py_DECREF(it);
-    return 0;
-
- fail:
-    /* Out of memory during sorting or buffer creation */
-    NPY_END_THREADS;
-    PyErr_NoMemory();
-    Py_DECREF(it);
-    return -1;
 }
 
-static PyObject*
-_new_argsort(PyArrayObject *op, int axis, NPY_SORTKIND which)
+#undef _INDEX_COPY_LOOP
+
+static void
+_index_copy_task(void *data, npy_intp itask)
 {
+    const npy_index_copy_info *info = (const npy_index_copy_info *)data;
 
-    PyArrayIterObject *it = NULL;
-    PyArrayIterObject *rit = NULL;
-    PyArrayObject *ret;
-    npy_intp N, size, i;
-    npy_intp astride, rstride, *iptr;
-    int elsize;
-    int needcopy = 0, swap;
-    PyArray_ArgSortFunc *argsort;
-    NPY_BEGIN_THREADS_DEF;
+    if (info->gather) {
+        npy_intp n = info->nouter * info->nind;
 
-    ret = (PyArrayObject *)PyArray_New(Py_TYPE(op),
-                            PyArray_NDIM(op),
-                            PyArray_DIMS(op),
-                            NPY_INTP,
-                            NULL, NULL, 0, 0, (PyObject *)op);
-    if (ret == NULL) {
-        return NULL;
+        _index_copy(info, _split_point(n, info->ntasks, itask),
+                          _split_point(n, info->ntasks, itask + 1));
     }
-    it = (PyArrayIterObject *)PyArray_IterAllButAxis((PyObject *)op, &axis);
-    rit = (PyArrayIterObject *)PyArray_IterAllButAxis((PyObject *)ret, &axis);
-    if (rit == NULL || it == NULL) {
-        goto fail;
+    else {
+        /*
+         * Repeated indices must be assigned in order, so assignments are
+         * only split between the leading positions.
+         */
+        _index_copy(info,
+                    _split_point(info->nouter, info->ntasks, itask) *
+                                                            info->nind,
+                    _split_point(info->nouter, info->ntasks, itask + 1) *
+                                                            info->nind);
     }
-    swap = !PyArray_ISNOTSWAPPED(op);
+}
 
-    NPY_BEGIN_THREADS_DESCR(PyArray_DESCR(op));
-    argsort = PyArray_DESCR(op)->f->argsort[which];
-    size = it->size;
-    N = PyArray_DIMS(op)[axis];
-    elsize = PyArray_DESCR(op)->elsize;
-    astride = PyArray_STRIDES(op)[axis];
-    rstride = PyArray_STRIDE(ret,axis);
-
-    needcopy = swap || !(PyArray_FLAGS(op) & NPY_ARRAY_ALIGNED) ||
-                         (astride != (npy_intp) elsize) ||
-            (rstride != sizeof(npy_intp));
-    if (needcopy) {
-        char *valbuffer, *indbuffer;
-
-        valbuffer = PyDataMem_NEW(N*elsize);
-        if (valbuffer == NULL) {
-            goto fail;
-        }
-        indbuffer = PyDataMem_NEW(N*sizeof(npy_intp));
-        if (indbuffer == NULL) {
-            PyDataMem_FREE(valbuffer);
-            goto fail;
-        }
-        while (size--) {
-            _unaligned_strided_byte_copy(valbuffer, (npy_intp) elsize, it->dataptr,
-                                         astride, N, elsize);
-            if (swap) {
-                _strided_byte_swap(valbuffer, (npy_intp) elsize, N, elsize);
-            }
-            iptr = (npy_intp *)indbuffer;
-            for (i = 0; i < N; i++) {
-                *iptr++ = i;
-            }
-            if (argsort(valbuffer, (npy_intp *)indbuffer, N, op) < 0) {
-                PyDataMem_FREE(valbuffer);
-                PyDataMem_FREE(indbuffer);
-                goto fail;
-            }
-            _unaligned_strided_byte_copy(rit->dataptr, rstride, indbuffer,
-                                         sizeof(npy_intp), N, sizeof(npy_intp));
-            PyArray_ITER_NEXT(it);
-            PyArray_ITER_NEXT(rit);
-        }
-        PyDataMem_FREE(valbuffer);
-        PyDataMem_FREE(indbuffer);
+NPY_NO_EXPORT void
+npy_index_copy(npy_index_copy_info *info)
+{
+    npy_intp nbytes = info->nouter * info->nind * info->chunk;
+    NPY_BEGIN_THREADS_DEF;
+
+    if (nbytes == 0) {
+        return;
+    }
+    info->ntasks = PyArray_ParallelTaskCount(nbytes,
+                                             INDEX_COPY_PARALLEL_MIN);
+    if (!info->gather) {
+        info->ntasks = PyArray_MIN(info->ntasks, info->nouter);
+    }
+    NPY_BEGIN_THREADS_THRESHOLDED(nbytes);
+    if (info->ntasks > 1) {
+        PyArray_ParallelRun(&_index_copy_task, info, info->ntasks);
     }
     else {
-        while (size--) {
-            iptr = (npy_intp *)rit->dataptr;
-            for (i = 0; i < N; i++) {
-                *iptr++ = i;
-            }
-            if (argsort(it->dataptr, (npy_intp *)rit->dataptr, N, op) < 0) {
-                goto fail;
-            }
-            PyArray_ITER_NEXT(it);
-            PyArray_ITER_NEXT(rit);
-        }
+        _index_copy(info, 0, info->nouter * info->nind);
     }
+    NPY_END_THREADS;
+}
 
-    NPY_END_THREADS_DESCR(PyArray_DESCR(op));
+/*
+ * A lane split into chunks is sorted by sorting the chunks concurrently
+ * and then merging neighbouring runs of chunks pairwise, each round
+ * merging twice as long runs with half the tasks.  The merges use the
+ * stable sort of the type, which is timsort for the types split here:
+ * it finds the two sorted runs and merges them in linear time.  As the
+ * left run stays first on ties, stable sorts stay stable.
+ */
+typedef struct {
+    const _sortlike_info *info;
+    char *v;
+    npy_intp *tosort;
+    npy_intp *bounds;
+    /* number of chunks in each run merged in the current round */
+    npy_intp width;
+    int *results;
+} _split_lane_data;
 
-    Py_DECREF(it);
-    Py_DECREF(rit);
-    return (PyObject *)ret;
+static void
+_split_lane_sort_task(void *data, npy_intp itask)
+{
+    _split_lane_data *d = (_split_lane_data *)data;
+    const _sortlike_info *info = d->info;
+    npy_intp lo = d->bounds[itask];
+    npy_intp num = d->bounds[itask + 1] - lo;
 
- fail:
-    NPY_END_THREADS;
-    if (!PyErr_Occurred()) {
-        /* Out of memory during sorting or buffer creation */
-        PyErr_NoMemory();
+    if (d->tosort == NULL) {
+        d->results[itask] = info->sort(d->v + lo * info->elsize, num,
+                                       info->op);
+    }
+    else {
+        d->results[itask] = info->argsort(d->v, d->tosort + lo, num,
+                                          info->op);
     }
-    Py_DECREF(ret);
-    Py_XDECREF(it);
-    Py_XDECREF(rit);
-    return NULL;
 }
 
-
-/* Be sure to save this global_compare when necessary */
-static PyArrayObject *global_obj;
+static void
+_split_lane_merge_task(void *data, npy_intp itask)
+{
+    _split_lane_data *d = (_split_lane_data *)data;
+    const _sortlike_info *info = d->info;
+    PyArray_ArrFuncs *f = PyArray_DESCR(info->op)->f;
+    npy_intp first = 2 * d->width * itask;
+    npy_intp last = PyArray_MIN(first + 2 * d->width, info->nsplit);
+    npy_intp lo = d->bounds[first];
+    npy_intp num = d->bounds[last] - lo;
+
+    if (d->tosort == NULL) {
+        d->results[itask] = f->sort[NPY_MERGESORT](
+                                d->v + lo * info->elsize, num, info->op);
+    }
+    else {
+        d->results[itask] = f->argsort[NPY_MERGESORT](
+                                d->v, d->tosort + lo, num, info->op);
+    }
+}
 
 static int
-sortCompare (const void *a, const void *b)
+_sortlike_split_lane(const _sortlike_info *info, char *v, npy_intp *tosort)
 {
-    return PyArray_DESCR(global_obj)->f->compare(a,b,global_obj);
+    npy_intp bounds[NPY_MAX_THREADS + 1];
+    int results[NPY_MAX_THREADS];
+    _split_lane_data d;
+    npy_intp i, ntasks;
+
+    for (i = 0; i <= info->nsplit; i++) {
+        bounds[i] = _split_point(info->N, info->nsplit, i);
+    }
+    d.info = info;
+    d.v = v;
+    d.tosort = tosort;
+    d.bounds = bounds;
+    d.results = results;
+
+    ntasks = info->nsplit;
+    PyArray_ParallelRun(&_split_lane_sort_task, &d, ntasks);
+    for (d.width = 1; ; d.width *= 2) {
+        for (i = 0; i < ntasks; i++) {
+            if (results[i] < 0) {
+                return results[i];
+            }
+        }
+        if (d.width >= info->nsplit) {
+            return 0;
+        }
+        /* the runs with a right neighbour, a last odd run waits */
+        ntasks = (info->nsplit + d.width - 1) / (2 * d.width);
+        PyArray_ParallelRun(&_split_lane_merge_task, &d, ntasks);
+    }
 }
 
 /*
- * Consumes reference to ap (op gets it) op contains a version of
- * the array with axes swapped if local variable axis is not the
- * last dimension.  Origin must be defined locally.
+ * Sorts or partitions one contiguous lane of N elements, or its indices in
+ * tosort when it is not NULL.  For the partitions the kth are sorted and
+ * unique, going from the last one down lets each call work on the part
+ * left of the previous kth only.
  */
-#define SWAPAXES(op, ap) { \
-        orign = PyArray_NDIM(ap)-1; \
-        if (axis != orign) { \
-            (op) = (PyArrayObject *)PyArray_SwapAxes((ap), axis, orign); \
-            Py_DECREF((ap)); \
-            if ((op) == NULL) return NULL; \
-        } \
-        else (op) = (ap); \
-    }
+static int
+_sortlike_lane(const _sortlike_info *info, char *v, npy_intp *tosort)
+{
+    npy_intp i, hi;
+
+    if (info->nsplit > 1) {
+        return _sortlike_split_lane(info, v, tosort);
+    }
+    if (info->sort != NULL) {
+        return info->sort(v, info->N, info->op);
+    }
+    if (info->argsort != NULL) {
+        return info->argsort(v, tosort, info->N, info->op);
+    }
+    for (i = info->nkth - 1, hi = info->N; i >= 0; hi = info->kth[i], i--) {
+        int ret;
+        if (info->part != NULL) {
+            ret = info->part(v, hi, info->kth[i], info->op);
+        }
+        else {
+            ret = info->argpart(v, tosort, hi, info->kth[i], info->op);
+        }
+        if (ret < 0) {
+            return ret;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Sorts or partitions the lane of values starting at vdata, for the index
+ * variants into the lane of indices starting at rdata.  The lane goes
+ * through valbuffer and indbuffer if it needs a copy.
+ */
+static int
+_sortlike_strided_lane(const _sortlike_info *info, char *vdata, char *rdata,
+                       char *valbuffer, char *indbuffer)
+{
+    const npy_intp N = info->N;
+    const npy_intp elsize = info->elsize;
+    const int indices = (rdata != NULL);
+    char *v = vdata;
+    npy_intp *tosort = (npy_intp *)rdata;
+    npy_intp i;
+    int ret;
+
+    if (info->needcopy) {
+        v = valbuffer;
+        _unaligned_strided_byte_copy(v, elsize, vdata, info->astride,
+                                     N, elsize);
+        if (info->swap) {
+            _strided_byte_swap(v, elsize, N, elsize);
+        }
+        if (indices) {
+            tosort = (npy_intp *)indbuffer;
+        }
+    }
+    if (indices) {
+        for (i = 0; i < N; i++) {
+            tosort[i] = i;
+        }
+    }
+
+    ret = _sortlike_lane(info, v, tosort);
+    if (ret < 0) {
+        return ret;
+    }
+
+    if (info->needcopy) {
+        if (indices) {
+            _unaligned_strided_byte_copy(rdata, info->rstride, indbuffer,
+                                         sizeof(npy_intp), N,
+                                         sizeof(npy_intp));
+        }
+        else {
+            if (info->swap) {
+                _strided_byte_swap(v, elsize, N, elsize);
+            }
+            _unaligned_strided_byte_copy(vdata, info->astride, v, elsize,
+                                         N, elsize);
+        }
+    }
+    return 0;
+}
+
+/*
+ * Decides how to use the thread pool for nlanes lanes, returns the number
+ * of tasks the lanes are distributed over and sets info->nsplit.  Types
+ * needing the Python API are sorted serially.  Only a single lane of a
+ * type whose stable sort is timsort is split.
+ */
+static npy_intp
+_sortlike_plan(_sortlike_info *info, npy_intp nlanes)
+{
+    PyArray_Descr *descr = PyArray_DESCR(info->op);
+    int type_num = descr->type_num;
+
+    info->nsplit = 1;
+    if (PyDataType_FLAGCHK(descr, NPY_NEEDS_PYAPI)) {
+        return 1;
+    }
+    if (nlanes > 1) {
+        return PyArray_MIN(nlanes, PyArray_ParallelTaskCount(
+                                nlanes * info->N, NPY_SORT_PARALLEL_MIN));
+    }
+    if ((info->sort != NULL || info->argsort != NULL) &&
+            (PyTypeNum_ISBOOL(type_num) || PyTypeNum_ISNUMBER(type_num) ||
+             PyTypeNum_ISDATETIME(type_num)) &&
+            descr->f->sort[NPY_MERGESORT] != NULL &&
+            descr->f->argsort[NPY_MERGESORT] != NULL) {
+        info->nsplit = PyArray_ParallelTaskCount(info->N,
+                                                 NPY_SORT_PARALLEL_MIN);
+    }
+    return 1;
+}
+
+typedef struct {
+    const _sortlike_info *info;
+    char **vlanes;
+    char **rlanes;
+    npy_intp nlanes;
+    npy_intp ntasks;
+    char *valbuffers;
+    char *indbuffers;
+    int *results;
+} _sortlike_lanes_data;
+
+static void
+_sortlike_lanes_task(void *data, npy_intp itask)
+{
+    _sortlike_lanes_data *d = (_sortlike_lanes_data *)data;
+    const _sortlike_info *info = d->info;
+    npy_intp start = _split_point(d->nlanes, d->ntasks, itask);
+    npy_intp stop = _split_point(d->nlanes, d->ntasks, itask + 1);
+    char *valbuffer = NULL, *indbuffer = NULL;
+    npy_intp i;
+
+    if (d->valbuffers != NULL) {
+        valbuffer = d->valbuffers + itask * info->N * info->elsize;
+    }
+    if (d->indbuffers != NULL) {
+        indbuffer = d->indbuffers + itask * info->N * sizeof(npy_intp);
+    }
+    d->results[itask] = 0;
+    for (i = start; i < stop; i++) {
+        int ret = _sortlike_strided_lane(info, d->vlanes[i],
+                                         d->rlanes ? d->rlanes[i] : NULL,
+                                         valbuffer, indbuffer);
+        if (ret < 0) {
+            d->results[itask] = ret;
+            return;
+        }
+    }
+}
+
+/*
+ * Sorts or partitions the lanes of it, and of rit for the index variants,
+ * distributing blocks of lanes over ntasks tasks of the thread pool.
+ * Called without the GIL.
+ */
+static int
+_sortlike_lanes_parallel(const _sortlike_info *info, PyArrayIterObject *it,
+                         PyArrayIterObject *rit, npy_intp ntasks)
+{
+    _sortlike_lanes_data d;
+    int results[NPY_MAX_THREADS];
+    npy_intp i;
+    int ret = 0;
+
+    d.info = info;
+    d.nlanes = it->size;
+    d.ntasks = ntasks;
+    d.results = results;
+    d.valbuffers = NULL;
+    d.indbuffers = NULL;
+    d.rlanes = NULL;
+    d.vlanes = malloc((rit ? 2 : 1) * d.nlanes * sizeof(char *));
+    if (d.vlanes == NULL) {
+        return -1;
+    }
+    if (info->needcopy) {
+        d.valbuffers = PyDataMem_NEW(ntasks * info->N * info->elsize);
+        if (d.valbuffers == NULL) {
+            ret = -1;
+            goto finish;
+        }
+        if (rit != NULL) {
+            d.indbuffers = PyDataMem_NEW(ntasks * info->N * sizeof(npy_intp));
+            if (d.indbuffers == NULL) {
+                ret = -1;
+                goto finish;
+            }
+        }
+    }
+
+    if (rit != NULL) {
+        d.rlanes = d.vlanes + d.nlanes;
+    }
+    for (i = 0; i < d.nlanes; i++) {
+        d.vlanes[i] = it->dataptr;
+        PyArray_ITER_NEXT(it);
+        if (rit != NULL) {
+            d.rlanes[i] = rit->dataptr;
+            PyArray_ITER_NEXT(rit);
+        }
+    }
+
+    PyArray_ParallelRun(&_sortlike_lanes_task, &d, ntasks);
+    for (i = 0; i < ntasks; i++) {
+        if (results[i] < 0) {
+            ret = results[i];
+        }
+    }
+
+ finish:
+    if (d.valbuffers != NULL) {
+        PyDataMem_FREE(d.valbuffers);
+    }
+    if (d.indbuffers != NULL) {
+        PyDataMem_FREE(d.indbuffers);
+    }
+    free(d.vlanes);
+    return ret;
+}
+
+/*
+ * These algorithms use special sorting.  They are not called unless the
+ * underlying sort function for the type is available.  Note that axis is
+ * already valid. The sort functions require 1-d contiguous and well-behaved
+ * data.  Therefore, a copy will be made of the data if needed before handing
+ * it to the sorting routine.  An iterator is constructed and adjusted to walk
+ * over all but the desired sorting axis.  With several threads in the pool,
+ * large arrays are sorted in parallel, see _sortlike_plan.
+ */
+static int
+_new_sortlike(PyArrayObject *op, int axis,
+              PyArray_SortFunc *sort,
+              PyArray_PartitionFunc *part,
+              npy_intp *kth, npy_intp nkth)
+{
+    PyArrayIterObject *it;
+    _sortlike_info info;
+    npy_intp size, ntasks;
+    NPY_BEGIN_THREADS_DEF;
+
+    it = (PyArrayIterObject *)PyArray_IterAllButAxis((PyObject *)op, &axis);
+    if (it == NULL) {
+        return -1;
+    }
+
+    info.op = op;
+    info.sort = sort;
+    info.argsort = NULL;
+    info.part = part;
+    info.argpart = NULL;
+    info.kth = kth;
+    info.nkth = nkth;
+    info.N = PyArray_DIMS(op)[axis];
+    info.elsize = PyArray_DESCR(op)->elsize;
+    info.swap = !PyArray_ISNOTSWAPPED(op);
+    info.astride = PyArray_STRIDES(op)[axis];
+    info.rstride = 0;
+    info.needcopy = !(PyArray_FLAGS(op) & NPY_ARRAY_ALIGNED) ||
+                    (info.astride != (npy_intp) info.elsize) || info.swap;
+    size = it->size;
+    ntasks = _sortlike_plan(&info, size);
+
+    NPY_BEGIN_THREADS_DESCR(PyArray_DESCR(op));
+    if (ntasks > 1) {
+        if (_sortlike_lanes_parallel(&info, it, NULL, ntasks) < 0) {
+            goto fail;
+        }
+    }
+    else {
+        char *buffer = NULL;
+
+        if (info.needcopy) {
+            buffer = PyDataMem_NEW(info.N * info.elsize);
+            if (buffer == NULL) {
+                goto fail;
+            }
+        }
+        while (size--) {
+            if (_sortlike_strided_lane(&info, it->dataptr, NULL,
+                                       buffer, NULL) < 0) {
+                if (buffer != NULL) {
+                    PyDataMem_FREE(buffer);
+                }
+                goto fail;
+            }
+            PyArray_ITER_NEXT(it);
+        }
+        if (buffer != NULL) {
+            PyDataMem_FREE(buffer);
+        }
+    }
+    NPY_END_THREADS_DESCR(PyArray_DESCR(op));
+    Py_DECREF(it);
+    return 0;
+
+ fail:
+    /* Out of memory during sorting or buffer creation */
+    NPY_END_THREADS;
+    PyErr_NoMemory();
+    Py_DECREF(it);
+    return -1;
+}
+
+static PyObject*
+_new_argsortlike(PyArrayObject *op, int axis,
+                 PyArray_ArgSortFunc *argsort,
+                 PyArray_ArgPartitionFunc *argpart,
+                 npy_intp *kth, npy_intp nkth)
+{
+
+    PyArrayIterObject *it = NULL;
+    PyArrayIterObject *rit = NULL;
+    PyArrayObject *ret;
+    _sortlike_info info;
+    npy_intp size, ntasks;
+    NPY_BEGIN_THREADS_DEF;
+
+    ret = (PyArrayObject *)PyArray_New(Py_TYPE(op),
+                            PyArray_NDIM(op),
+                            PyArray_DIMS(op),
+                            NPY_INTP,
+                            NULL, NULL, 0, 0, (PyObject *)op);
+    if (ret == NULL) {
+        return NULL;
+    }
+    it = (PyArrayIterObject *)PyArray_IterAllButAxis((PyObject *)op, &axis);
+    rit = (PyArrayIterObject *)PyArray_IterAllButAxis((PyObject *)ret, &axis);
+    if (rit == NULL || it == NULL) {
+        goto fail;
+    }
+
+    info.op = op;
+    info.sort = NULL;
+    info.argsort = argsort;
+    info.part = NULL;
+    info.argpart = argpart;
+    info.kth = kth;
+    info.nkth = nkth;
+    info.N = PyArray_DIMS(op)[axis];
+    info.elsize = PyArray_DESCR(op)->elsize;
+    info.swap = !PyArray_ISNOTSWAPPED(op);
+    info.astride = PyArray_STRIDES(op)[axis];
+    info.rstride = PyArray_STRIDE(ret, axis);
+    info.needcopy = info.swap || !(PyArray_FLAGS(op) & NPY_ARRAY_ALIGNED) ||
+                    (info.astride != (npy_intp) info.elsize) ||
+                    (info.rstride != sizeof(npy_intp));
+    size = it->size;
+    ntasks = _sortlike_plan(&info, size);
+
+    NPY_BEGIN_THREADS_DESCR(PyArray_DESCR(op));
+    if (ntasks > 1) {
+        if (_sortlike_lanes_parallel(&info, it, rit, ntasks) < 0) {
+            goto fail;
+        }
+    }
+    else {
+        char *valbuffer = NULL, *indbuffer = NULL;
+
+        if (info.needcopy) {
+            valbuffer = PyDataMem_NEW(info.N * info.elsize);
+            if (valbuffer == NULL) {
+                goto fail;
+            }
+            indbuffer = PyDataMem_NEW(info.N * sizeof(npy_intp));
+            if (indbuffer == NULL) {
+                PyDataMem_FREE(valbuffer);
+                goto fail;
+            }
+        }
+        while (size--) {
+            if (_sortlike_strided_lane(&info, it->dataptr, rit->dataptr,
+                                       valbuffer, indbuffer) < 0) {
+                if (info.needcopy) {
+                    PyDataMem_FREE(valbuffer);
+                    PyDataMem_FREE(indbuffer);
+                }
+                goto fail;
+            }
+            PyArray_ITER_NEXT(it);
+            PyArray_ITER_NEXT(rit);
+        }
+        if (info.needcopy) {
+            PyDataMem_FREE(valbuffer);
+            PyDataMem_FREE(indbuffer);
+        }
+    }
+
+    NPY_END_THREADS_DESCR(PyArray_DESCR(op));
+
+    Py_DECREF(it);
+    Py_DECREF(rit);
+    return (PyObject *)ret;
+
+ fail:
+    NPY_END_THREADS;
+    if (!PyErr_Occurred()) {
+        /* Out of memory during sorting or buffer creation */
+        PyErr_NoMemory();
+    }
+    Py_DECREF(ret);
+    Py_XDECREF(it);
+    Py_XDECREF(rit);
+    return NULL;
+}
+
+
+/* Be sure to save this global_compare when necessary */
+static PyArrayObject *global_obj;
+
+static int
+sortCompare (const void *a, const void *b)
+{
+    return PyArray_DESCR(global_obj)->f->compare(a,b,global_obj);
+}
+
+/*
+ * Consumes reference to ap (op gets it) op contains a version of
+ * the array with axes swapped if local variable axis is not the
+ * last dimension.  Origin must be defined locally.
+ */
+#define SWAPAXES(op, ap) { \
+        orign = PyArray_NDIM(ap)-1; \
+        if (axis != orign) { \
+            (op) = (PyArrayObject *)PyArray_SwapAxes((ap), axis, orign); \
+            Py_DECREF((ap)); \
+            if ((op) == NULL) return NULL; \
+        } \
+        else (op) = (ap); \
+    }
 
 /*
  * Consumes reference to ap (op gets it) origin must be previously
@@ -1005,6 +1605,76 @@ sortCompare (const void *a, const void *b)
         } \
     }
 
+/*
+ * Below this length of the sorted axis the quick sort is faster than the
+ * radix sort for the small integer types.
+ */
+#define NPY_RADIX_QUICKSORT_MIN 256
+
+/*
+ * Whether a quick sort of num elements of the type is better done by the
+ * radix sort.  With at most two bytes per key only one or two passes are
+ * needed, so that the radix sort is faster than any comparison sort.
+ */
+static int
+_use_radix_for_quicksort(PyArray_Descr *descr, npy_intp num)
+{
+    switch (descr->type_num) {
+        case NPY_BOOL:
+        case NPY_BYTE:
+        case NPY_UBYTE:
+        case NPY_SHORT:
+        case NPY_USHORT:
+            return num >= NPY_RADIX_QUICKSORT_MIN;
+        default:
+            return 0;
+    }
+}
+
+/*
+ * Returns the type specific sort function of the kind for sorting num
+ * elements, or NULL if the type has none.  Types without a radix sort
+ * use the merge sort, which is stable as well.
+ */
+static PyArray_SortFunc *
+_get_sort_func(PyArray_Descr *descr, NPY_SORTKIND which, npy_intp num)
+{
+    if (which == NPY_QUICKSORT && _use_radix_for_quicksort(descr, num)) {
+        which = NPY_RADIXSORT;
+    }
+    if (which == NPY_RADIXSORT) {
+        PyArray_SortFunc *sort = get_radixsort_func(descr->type_num);
+        if (sort != NULL) {
+            return sort;
+        }
+        which = NPY_MERGESORT;
+    }
+    if (which < 0 || which >= NPY_NSORTS) {
+        return NULL;
+    }
+    return descr->f->sort[which];
+}
+
+/* As _get_sort_func, for the index sort functions */
+static PyArray_ArgSortFunc *
+_get_argsort_func(PyArray_Descr *descr, NPY_SORTKIND which, npy_intp num)
+{
+    if (which == NPY_QUICKSORT && _use_radix_for_quicksort(descr, num)) {
+        which = NPY_RADIXSORT;
+    }
+    if (which == NPY_RADIXSORT) {
+        PyArray_ArgSortFunc *argsort = get_aradixsort_func(descr->type_num);
+        if (argsort != NULL) {
+            return argsort;
+        }
+        which = NPY_MERGESORT;
+    }
+    if (which < 0 || which >= NPY_NSORTS) {
+        return NULL;
+    }
+    return descr->f->argsort[which];
+}
+
 /*NUMPY_API
  * Sort an array in-place
  */
@@ -1018,6 +1688,7 @@ PyArray_Sort(PyArrayObject *op, int axis, NPY_SORTKIND which)
     int res = 0;
     int axis_orig = axis;
     int (*sort)(void *, size_t, size_t, npy_comparator);
+    PyArray_SortFunc *typed_sort;
 
     n = PyArray_NDIM(op);
     if ((n == 0) || (PyArray_SIZE(op) == 1)) {
@@ -1035,8 +1706,10 @@ PyArray_Sort(PyArrayObject *op, int axis, NPY_SORTKIND which)
     }
 
     /* Determine if we should use type-specific algorithm or not */
-    if (PyArray_DESCR(op)->f->sort[which] != NULL) {
-        return _new_sort(op, axis, which);
+    typed_sort = _get_sort_func(PyArray_DESCR(op), which,
+                                PyArray_DIM(op, axis));
+    if (typed_sort != NULL) {
+        return _new_sortlike(op, axis, typed_sort, NULL, NULL, 0);
     }
 
     if (PyArray_DESCR(op)->f->compare == NULL) {
@@ -1055,7 +1728,9 @@ PyArray_Sort(PyArrayObject *op, int axis, NPY_SORTKIND which)
             sort = npy_heapsort;
             break;
         case NPY_MERGESORT :
-            sort = npy_mergesort;
+        case NPY_RADIXSORT :
+            /* the stable sorts use timsort, which profits from runs */
+            sort = npy_timsort;
             break;
         default:
             PyErr_SetString(PyExc_TypeError,
@@ -1139,6 +1814,7 @@ PyArray_ArgSort(PyArrayObject *op, int axis, NPY_SORTKIND which)
     char *store_ptr;
     int res = 0;
     int (*sort)(void *, size_t, size_t, npy_comparator);
+    PyArray_ArgSortFunc *argsort;
 
     n = PyArray_NDIM(op);
     if ((n == 0) || (PyArray_SIZE(op) == 1)) {
@@ -1159,8 +1835,11 @@ PyArray_ArgSort(PyArrayObject *op, int axis, NPY_SORTKIND which)
         return NULL;
     }
     /* Determine if we should use new algorithm or not */
-    if (PyArray_DESCR(op2)->f->argsort[which] != NULL) {
-        ret = (PyArrayObject *)_new_argsort(op2, axis, which);
+    argsort = _get_argsort_func(PyArray_DESCR(op2), which,
+                                PyArray_DIM(op2, axis));
+    if (argsort != NULL) {
+        ret = (PyArrayObject *)_new_argsortlike(op2, axis, argsort,
+                                                NULL, NULL, 0);
         Py_DECREF(op2);
         return (PyObject *)ret;
     }
@@ -1181,7 +1860,9 @@ PyArray_ArgSort(PyArrayObject *op, int axis, NPY_SORTKIND which)
             sort = npy_heapsort;
             break;
         case NPY_MERGESORT :
-            sort = npy_mergesort;
+        case NPY_RADIXSORT :
+            /* the stable sorts use timsort, which profits from runs */
+            sort = npy_timsort;
             break;
         default:
             PyErr_SetString(PyExc_TypeError,
@@ -1200,59 +1881,828 @@ PyArray_ArgSort(PyArrayObject *op, int axis, NPY_SORTKIND which)
     if (op == NULL) {
         return NULL;
     }
-    ret = (PyArrayObject *)PyArray_New(Py_TYPE(op), PyArray_NDIM(op),
-                                       PyArray_DIMS(op), NPY_INTP,
-                                       NULL, NULL, 0, 0, (PyObject *)op);
-    if (ret == NULL) {
-        goto fail;
-    }
-    ip = (npy_intp *)PyArray_DATA(ret);
-    argsort_elsize = PyArray_DESCR(op)->elsize;
-    m = PyArray_DIMS(op)[PyArray_NDIM(op)-1];
-    if (m == 0) {
+    ret = (PyArrayObject *)PyArray_New(Py_TYPE(op), PyArray_NDIM(op),
+                                       PyArray_DIMS(op), NPY_INTP,
+                                       NULL, NULL, 0, 0, (PyObject *)op);
+    if (ret == NULL) {
+        goto fail;
+    }
+    ip = (npy_intp *)PyArray_DATA(ret);
+    argsort_elsize = PyArray_DESCR(op)->elsize;
+    m = PyArray_DIMS(op)[PyArray_NDIM(op)-1];
+    if (m == 0) {
+        goto finish;
+    }
+    n = PyArray_SIZE(op)/m;
+    store_ptr = global_data;
+    global_data = PyArray_DATA(op);
+    store = global_obj;
+    global_obj = op;
+    for (i = 0; i < n; i++, ip += m, global_data += m*argsort_elsize) {
+        for (j = 0; j < m; j++) {
+            ip[j] = j;
+        }
+        res = sort((char *)ip, m, sizeof(npy_intp), argsort_static_compare);
+        if (res < 0) {
+            break;
+        }
+    }
+    global_data = store_ptr;
+    global_obj = store;
+
+    if (PyErr_Occurred()) {
+        goto fail;
+    }
+    else if (res == -NPY_ENOMEM) {
+        PyErr_NoMemory();
+        goto fail;
+    }
+    else if (res == -NPY_ECOMP) {
+        PyErr_SetString(PyExc_TypeError,
+                "sort comparison failed");
+        goto fail;
+    }
+
+ finish:
+    Py_DECREF(op);
+    SWAPBACK(op, ret);
+    return (PyObject *)op;
+
+ fail:
+    Py_XDECREF(op);
+    Py_XDECREF(ret);
+    return NULL;
+}
+
+
+/*
+ * Converts the kth of a partition along an axis of length N to a sorted
+ * array of unique non-negative indices, negative kth counting from the
+ * end.  The number of unique indices is returned in nkth.
+ */
+static PyArrayObject *
+partition_prep_kth_array(PyArrayObject *ktharray, npy_intp N, npy_intp *nkth)
+{
+    PyArrayObject *kthrvl;
+    npy_intp *kth;
+    npy_intp i, n;
+
+    if (!PyArray_ISINTEGER(ktharray)) {
+        PyErr_SetString(PyExc_TypeError, "Partition index must be integer");
+        return NULL;
+    }
+    if (PyArray_NDIM(ktharray) > 1) {
+        PyErr_Format(PyExc_ValueError, "kth array must have dimension <= 1");
+        return NULL;
+    }
+    kthrvl = (PyArrayObject *)PyArray_FromArray(ktharray,
+                                    PyArray_DescrFromType(NPY_INTP),
+                                    NPY_ARRAY_DEFAULT | NPY_ARRAY_ENSURECOPY |
+                                    NPY_ARRAY_FORCECAST);
+    if (kthrvl == NULL) {
+        return NULL;
+    }
+
+    kth = (npy_intp *)PyArray_DATA(kthrvl);
+    n = PyArray_SIZE(kthrvl);
+    for (i = 0; i < n; i++) {
+        if (kth[i] < 0) {
+            kth[i] += N;
+        }
+        if (kth[i] < 0 || kth[i] >= N) {
+            PyErr_Format(PyExc_ValueError, "kth(=%zd) out of bounds (%zd)",
+                         kth[i], N);
+            Py_DECREF(kthrvl);
+            return NULL;
+        }
+    }
+
+    /* a single kth is common, e.g. for the median */
+    if (n > 1) {
+        npy_intp j;
+
+        if (PyArray_Sort(kthrvl, -1, NPY_QUICKSORT) < 0) {
+            Py_DECREF(kthrvl);
+            return NULL;
+        }
+        for (i = 1, j = 0; i < n; i++) {
+            if (kth[i] != kth[j]) {
+                kth[++j] = kth[i];
+            }
+        }
+        n = j + 1;
+    }
+    *nkth = n;
+    return kthrvl;
+}
+
+
+/*NUMPY_API
+ * Partition an array in-place
+ */
+NPY_NO_EXPORT int
+PyArray_Partition(PyArrayObject *op, PyArrayObject *ktharray, int axis,
+                  NPY_SELECTKIND which)
+{
+    PyArrayObject *kthrvl;
+    PyArray_PartitionFunc *part;
+    npy_intp nkth;
+    int n, ret;
+    int axis_orig = axis;
+
+    n = PyArray_NDIM(op);
+    if (axis < 0) {
+        axis += n;
+    }
+    if ((axis < 0) || (axis >= n)) {
+        PyErr_Format(PyExc_ValueError, "axis(=%d) out of bounds", axis_orig);
+        return -1;
+    }
+    if (which < 0 || which >= NPY_NSELECTS) {
+        PyErr_SetString(PyExc_ValueError, "not a valid partition kind");
+        return -1;
+    }
+    if (PyArray_FailUnlessWriteable(op, "partition array") < 0) {
+        return -1;
+    }
+
+    kthrvl = partition_prep_kth_array(ktharray, PyArray_DIM(op, axis), &nkth);
+    if (kthrvl == NULL) {
+        return -1;
+    }
+
+    part = get_partition_func(PyArray_TYPE(op), which);
+    if (part == NULL) {
+        /* types without a selection are fully sorted */
+        Py_DECREF(kthrvl);
+        return PyArray_Sort(op, axis, NPY_QUICKSORT);
+    }
+
+    ret = _new_sortlike(op, axis, NULL, part,
+                        (npy_intp *)PyArray_DATA(kthrvl), nkth);
+    Py_DECREF(kthrvl);
+    return ret;
+}
+
+
+/*NUMPY_API
+ * ArgPartition an array
+ */
+NPY_NO_EXPORT PyObject *
+PyArray_ArgPartition(PyArrayObject *op, PyArrayObject *ktharray, int axis,
+                     NPY_SELECTKIND which)
+{
+    PyArrayObject *op2, *kthrvl;
+    PyArray_ArgPartitionFunc *argpart;
+    PyObject *ret;
+    npy_intp nkth;
+
+    if (which < 0 || which >= NPY_NSELECTS) {
+        PyErr_SetString(PyExc_ValueError, "not a valid partition kind");
+        return NULL;
+    }
+
+    /* Creates new reference op2 */
+    if ((op2 = (PyArrayObject *)PyArray_CheckAxis(op, &axis, 0)) == NULL) {
+        return NULL;
+    }
+
+    kthrvl = partition_prep_kth_array(ktharray, PyArray_DIM(op2, axis), &nkth);
+    if (kthrvl == NULL) {
+        Py_DECREF(op2);
+        return NULL;
+    }
+
+    argpart = get_argpartition_func(PyArray_TYPE(op2), which);
+    if (argpart == NULL) {
+        /* types without a selection are fully sorted */
+        ret = PyArray_ArgSort(op2, axis, NPY_QUICKSORT);
+    }
+    else {
+        ret = _new_argsortlike(op2, axis, NULL, argpart,
+                               (npy_intp *)PyArray_DATA(kthrvl), nkth);
+    }
+
+    Py_DECREF(kthrvl);
+    Py_DECREF(op2);
+    return ret;
+}
+
+
+/* The k best values of every lane and their indices */
+typedef struct {
+    PyArrayObject *op;
+    PyArray_ArgTopkFunc *topk;
+    npy_intp k;
+    int largest;
+    int sorted;
+    char **alanes;
+    char **vlanes;
+    char **rlanes;
+    npy_intp nlanes;
+    npy_intp N;
+    npy_intp astride;
+    npy_intp vstride;
+    npy_intp rstride;
+    int needcopy;
+} _topk_info;
+
+typedef struct {
+    const _topk_info *info;
+    npy_intp ntasks;
+    char *valbuffers;
+    npy_intp *heaps;
+    int *results;
+} _topk_lanes_data;
+
+static int
+_topk_lane(const _topk_info *info, npy_intp lane,
+           char *valbuffer, npy_intp *heap)
+{
+    PyArrayObject *op = info->op;
+    PyArray_Descr *descr = PyArray_DESCR(op);
+    int elsize = descr->elsize;
+    int refchk = PyDataType_REFCHK(descr);
+    char *a = info->alanes[lane];
+    char *vout = info->vlanes[lane];
+    char *rout = info->rlanes[lane];
+    char *v = a;
+    npy_intp j;
+
+    if (info->needcopy) {
+        _unaligned_strided_byte_copy(valbuffer, (npy_intp)elsize, a,
+                                     info->astride, info->N, elsize);
+        if (PyArray_ISBYTESWAPPED(op)) {
+            _strided_byte_swap(valbuffer, (npy_intp)elsize, info->N, elsize);
+        }
+        v = valbuffer;
+    }
+    if (info->topk(v, info->N, info->k, heap,
+                   info->largest, info->sorted, op) < 0) {
+        return -1;
+    }
+
+    /* the values are taken from the lane, in its byte order */
+    for (j = 0; j < info->k; j++) {
+        char *src = a + heap[j] * info->astride;
+
+        if (refchk) {
+            descr->f->copyswap(vout, src, 0, op);
+        }
+        else {
+            memcpy(vout, src, elsize);
+        }
+        *(npy_intp *)rout = heap[j];
+        vout += info->vstride;
+        rout += info->rstride;
+    }
+    return 0;
+}
+
+static void
+_topk_lanes_task(void *data, npy_intp itask)
+{
+    _topk_lanes_data *d = (_topk_lanes_data *)data;
+    const _topk_info *info = d->info;
+    npy_intp start = _split_point(info->nlanes, d->ntasks, itask);
+    npy_intp stop = _split_point(info->nlanes, d->ntasks, itask + 1);
+    char *valbuffer = NULL;
+    npy_intp *heap = d->heaps + itask * info->k;
+    npy_intp i;
+
+    if (info->needcopy) {
+        valbuffer = d->valbuffers +
+                    itask * info->N * PyArray_DESCR(info->op)->elsize;
+    }
+    d->results[itask] = 0;
+    for (i = start; i < stop; i++) {
+        if (_topk_lane(info, i, valbuffer, heap) < 0) {
+            d->results[itask] = -1;
+            return;
+        }
+    }
+}
+
+/*
+ * Selects the k best of every lane, in blocks of lanes spread over ntasks
+ * tasks of the thread pool.  Returns -1 on failure.
+ */
+static int
+_topk_lanes_parallel(const _topk_info *info, npy_intp ntasks, int object)
+{
+    _topk_lanes_data d;
+    int results[NPY_MAX_THREADS];
+    npy_intp i;
+    int ret = 0;
+    NPY_BEGIN_THREADS_DEF;
+
+    d.info = info;
+    d.ntasks = ntasks;
+    d.results = results;
+    d.valbuffers = NULL;
+    /* one more byte, as empty allocations may fail */
+    d.heaps = (npy_intp *)PyDataMem_NEW(
+                    ntasks * info->k * sizeof(npy_intp) + 1);
+    if (d.heaps == NULL) {
+        return -1;
+    }
+    if (info->needcopy) {
+        d.valbuffers = PyDataMem_NEW(
+                ntasks * info->N * PyArray_DESCR(info->op)->elsize + 1);
+        if (d.valbuffers == NULL) {
+            ret = -1;
+            goto finish;
+        }
+    }
+
+    if (!object) {
+        NPY_BEGIN_THREADS;
+    }
+    PyArray_ParallelRun(&_topk_lanes_task, &d, ntasks);
+    if (!object) {
+        NPY_END_THREADS;
+    }
+    for (i = 0; i < ntasks; i++) {
+        if (results[i] < 0) {
+            ret = -1;
+        }
+    }
+
+ finish:
+    PyDataMem_FREE(d.heaps);
+    if (d.valbuffers != NULL) {
+        PyDataMem_FREE(d.valbuffers);
+    }
+    return ret;
+}
+
+
+/*NUMPY_API
+ * The k largest, or smallest, values along the given axis and their
+ * indices, in a tuple of two arrays whose axis has length k.  If sorted
+ * is true the best value comes first, otherwise their order is
+ * unspecified.  Ties are resolved in favour of the lowest index.
+ */
+NPY_NO_EXPORT PyObject *
+PyArray_TopK(PyArrayObject *op, npy_intp k, int axis, int largest, int sorted)
+{
+    PyArrayObject *op2, *values = NULL, *indices = NULL;
+    PyArrayIterObject *it = NULL, *vit = NULL, *rit = NULL;
+    PyArray_Descr *descr;
+    npy_intp dims[NPY_MAXDIMS];
+    _topk_info info;
+    npy_intp i, ntasks;
+    int object, res;
+
+    /* Creates new reference op2 */
+    if ((op2 = (PyArrayObject *)PyArray_CheckAxis(op, &axis, 0)) == NULL) {
+        return NULL;
+    }
+    descr = PyArray_DESCR(op2);
+
+    info.topk = get_argtopk_func(descr->type_num);
+    if (info.topk == NULL) {
+        if (descr->f->compare == NULL) {
+            PyErr_SetString(PyExc_TypeError,
+                            "type does not have compare function");
+            goto fail;
+        }
+        info.topk = &npy_atopk;
+    }
+    info.N = PyArray_DIM(op2, axis);
+    if (k < 0 || k > info.N) {
+        PyErr_Format(PyExc_ValueError,
+                     "k = %" NPY_INTP_FMT " out of bounds (%" NPY_INTP_FMT ")",
+                     k, info.N);
+        goto fail;
+    }
+
+    memcpy(dims, PyArray_DIMS(op2), PyArray_NDIM(op2) * sizeof(npy_intp));
+    dims[axis] = k;
+    Py_INCREF(descr);
+    values = (PyArrayObject *)PyArray_NewFromDescr(&PyArray_Type, descr,
+                                                   PyArray_NDIM(op2), dims,
+                                                   NULL, NULL, 0, NULL);
+    indices = (PyArrayObject *)PyArray_New(&PyArray_Type, PyArray_NDIM(op2),
+                                           dims, NPY_INTP,
+                                           NULL, NULL, 0, 0, NULL);
+    if (values == NULL || indices == NULL) {
+        goto fail;
+    }
+    if (k == 0) {
+        goto finish;
+    }
+
+    it = (PyArrayIterObject *)PyArray_IterAllButAxis((PyObject *)op2, &axis);
+    vit = (PyArrayIterObject *)PyArray_IterAllButAxis((PyObject *)values,
+                                                     &axis);
+    rit = (PyArrayIterObject *)PyArray_IterAllButAxis((PyObject *)indices,
+                                                     &axis);
+    if (it == NULL || vit == NULL || rit == NULL) {
+        goto fail;
+    }
+
+    info.op = op2;
+    info.k = k;
+    info.largest = largest;
+    info.sorted = sorted;
+    info.nlanes = it->size;
+    info.astride = PyArray_STRIDE(op2, axis);
+    info.vstride = PyArray_STRIDE(values, axis);
+    info.rstride = PyArray_STRIDE(indices, axis);
+    info.needcopy = PyArray_ISBYTESWAPPED(op2) || !PyArray_ISALIGNED(op2) ||
+                    info.astride != (npy_intp)descr->elsize;
+    info.alanes = PyArray_malloc(3 * info.nlanes * sizeof(char *));
+    if (info.alanes == NULL) {
+        goto fail;
+    }
+    info.vlanes = info.alanes + info.nlanes;
+    info.rlanes = info.vlanes + info.nlanes;
+    for (i = 0; i < info.nlanes; i++) {
+        info.alanes[i] = it->dataptr;
+        info.vlanes[i] = vit->dataptr;
+        info.rlanes[i] = rit->dataptr;
+        PyArray_ITER_NEXT(it);
+        PyArray_ITER_NEXT(vit);
+        PyArray_ITER_NEXT(rit);
+    }
+
+    /* the compare and copy of structured types use the array's descr */
+    object = PyDataType_FLAGCHK(descr, NPY_NEEDS_PYAPI) ||
+             PyDataType_HASFIELDS(descr);
+    ntasks = 1;
+    if (!object) {
+        ntasks = PyArray_MIN(info.nlanes, PyArray_ParallelTaskCount(
+                                info.nlanes * info.N, NPY_SORT_PARALLEL_MIN));
+    }
+    res = _topk_lanes_parallel(&info, ntasks, object);
+    PyArray_free(info.alanes);
+    if (res < 0 || PyErr_Occurred()) {
+        goto fail;
+    }
+
+ finish:
+    Py_XDECREF(it);
+    Py_XDECREF(vit);
+    Py_XDECREF(rit);
+    Py_DECREF(op2);
+    return Py_BuildValue("NN", values, indices);
+
+ fail:
+    if (!PyErr_Occurred()) {
+        PyErr_NoMemory();
+    }
+    Py_XDECREF(it);
+    Py_XDECREF(vit);
+    Py_XDECREF(rit);
+    Py_XDECREF(values);
+    Py_XDECREF(indices);
+    Py_DECREF(op2);
+    return NULL;
+}
+
+
+/* A lexsort of keys that aren't packed, which sorts them one by one */
+typedef struct {
+    PyArrayObject **mps;
+    npy_intp nkeys;
+    PyArray_ArgSortFunc **argsort;
+    /* the lanes of every key one after the other */
+    char **keylanes;
+    char **rlanes;
+    npy_intp nlanes;
+    npy_intp N;
+    int axis;
+    npy_intp rstride;
+    int maxelsize;
+    int needcopy;
+} _lexsort_info;
+
+typedef struct {
+    const _lexsort_info *info;
+    npy_intp ntasks;
+    char *valbuffers;
+    npy_intp *indbuffers;
+    int *results;
+} _lexsort_lanes_data;
+
+/*
+ * Sorts the indices of a lane stably by each key in turn, so that the
+ * last key is the primary one.
+ */
+static int
+_lexsort_lane(const _lexsort_info *info, npy_intp lane,
+              char *valbuffer, npy_intp *indbuffer)
+{
+    npy_intp N = info->N;
+    npy_intp *iptr;
+    npy_intp i, j;
+
+    iptr = info->needcopy ? indbuffer : (npy_intp *)info->rlanes[lane];
+    for (i = 0; i < N; i++) {
+        iptr[i] = i;
+    }
+    for (j = 0; j < info->nkeys; j++) {
+        PyArrayObject *mp = info->mps[j];
+        char *v = info->keylanes[j * info->nlanes + lane];
+
+        if (info->needcopy) {
+            int elsize = PyArray_DESCR(mp)->elsize;
+
+            _unaligned_strided_byte_copy(valbuffer, (npy_intp)elsize, v,
+                                         PyArray_STRIDES(mp)[info->axis],
+                                         N, elsize);
+            if (PyArray_ISBYTESWAPPED(mp)) {
+                _strided_byte_swap(valbuffer, (npy_intp)elsize, N, elsize);
+            }
+            v = valbuffer;
+        }
+        if (info->argsort[j](v, iptr, N, mp) < 0) {
+            return -1;
+        }
+    }
+    if (info->needcopy) {
+        _unaligned_strided_byte_copy(info->rlanes[lane], info->rstride,
+                                     (char *)indbuffer, sizeof(npy_intp),
+                                     N, sizeof(npy_intp));
+    }
+    return 0;
+}
+
+static void
+_lexsort_lanes_task(void *data, npy_intp itask)
+{
+    _lexsort_lanes_data *d = (_lexsort_lanes_data *)data;
+    const _lexsort_info *info = d->info;
+    npy_intp start = _split_point(info->nlanes, d->ntasks, itask);
+    npy_intp stop = _split_point(info->nlanes, d->ntasks, itask + 1);
+    char *valbuffer = NULL;
+    npy_intp *indbuffer = NULL;
+    npy_intp i;
+
+    if (info->needcopy) {
+        valbuffer = d->valbuffers + itask * info->N * info->maxelsize;
+        indbuffer = d->indbuffers + itask * info->N;
+    }
+    d->results[itask] = 0;
+    for (i = start; i < stop; i++) {
+        if (_lexsort_lane(info, i, valbuffer, indbuffer) < 0) {
+            d->results[itask] = -1;
+            return;
+        }
+    }
+}
+
+/*
+ * Sorts the lanes, in blocks of lanes spread over ntasks tasks of the
+ * thread pool.  Returns -1 on failure.
+ */
+static int
+_lexsort_lanes_parallel(const _lexsort_info *info, npy_intp ntasks,
+                        int object)
+{
+    _lexsort_lanes_data d;
+    int results[NPY_MAX_THREADS];
+    npy_intp i;
+    int ret = 0;
+    NPY_BEGIN_THREADS_DEF;
+
+    d.info = info;
+    d.ntasks = ntasks;
+    d.results = results;
+    d.valbuffers = NULL;
+    d.indbuffers = NULL;
+    if (info->needcopy) {
+        /* one more byte, as empty allocations may fail */
+        d.valbuffers = PyDataMem_NEW(ntasks * info->N * info->maxelsize + 1);
+        d.indbuffers = (npy_intp *)PyDataMem_NEW(
+                            ntasks * info->N * sizeof(npy_intp) + 1);
+        if (d.valbuffers == NULL || d.indbuffers == NULL) {
+            ret = -1;
+            goto finish;
+        }
+    }
+
+    if (!object) {
+        NPY_BEGIN_THREADS;
+    }
+    PyArray_ParallelRun(&_lexsort_lanes_task, &d, ntasks);
+    if (!object) {
+        NPY_END_THREADS;
+    }
+    for (i = 0; i < ntasks; i++) {
+        if (results[i] < 0) {
+            ret = -1;
+        }
+    }
+
+ finish:
+    if (d.valbuffers != NULL) {
+        PyDataMem_FREE(d.valbuffers);
+    }
+    if (d.indbuffers != NULL) {
+        PyDataMem_FREE(d.indbuffers);
+    }
+    return ret;
+}
+
+/*
+ * Integer keys whose ranges fit in 64 bits together are packed into one
+ * unsigned 64 bit key per element, the last key in the highest bits, so
+ * that lexsort is a single stable argsort of the packed keys.  The values
+ * are first mapped to unsigned 64 bit values in the same order, flipping
+ * the sign bit of the signed ones, and then stored relative to the
+ * minimum of their key in as many bits as its range needs.
+ */
+#define _LEXSORT_SIGNED(type, p) \
+    ((npy_uint64)(npy_int64)*(const type *)(p) ^ ((npy_uint64)1 << 63))
+#define _LEXSORT_UNSIGNED(type, p) ((npy_uint64)*(const type *)(p))
+
+/*
+ * Updates *mn and *mx with the n values of the given integer type at p,
+ * stride bytes apart, or if out is not NULL, stores (init) or adds their
+ * offsets from *mn shifted by shift to out instead.  Returns -1 if the
+ * type can't be packed.
+ */
+static int
+_lexsort_pack_loop(int type_num, const char *p, npy_intp stride, npy_intp n,
+                   npy_uint64 *mn, npy_uint64 *mx,
+                   npy_uint64 *out, int shift, int init)
+{
+    npy_intp i;
+
+#define _LEXSORT_LOOP(type, UKEY) \
+    if (out == NULL) { \
+        npy_uint64 lo = *mn, hi = *mx; \
+        for (i = 0; i < n; i++, p += stride) { \
+            const npy_uint64 u = UKEY(type, p); \
+            lo = (u < lo) ? u : lo; \
+            hi = (u > hi) ? u : hi; \
+        } \
+        *mn = lo; \
+        *mx = hi; \
+    } \
+    else if (init) { \
+        for (i = 0; i < n; i++, p += stride) { \
+            out[i] = (UKEY(type, p) - *mn) << shift; \
+        } \
+    } \
+    else { \
+        for (i = 0; i < n; i++, p += stride) { \
+            out[i] |= (UKEY(type, p) - *mn) << shift; \
+        } \
+    } \
+    return 0
+
+    switch (type_num) {
+        case NPY_BOOL:
+            _LEXSORT_LOOP(npy_bool, _LEXSORT_UNSIGNED);
+        case NPY_BYTE:
+            _LEXSORT_LOOP(npy_byte, _LEXSORT_SIGNED);
+        case NPY_UBYTE:
+            _LEXSORT_LOOP(npy_ubyte, _LEXSORT_UNSIGNED);
+        case NPY_SHORT:
+            _LEXSORT_LOOP(npy_short, _LEXSORT_SIGNED);
+        case NPY_USHORT:
+            _LEXSORT_LOOP(npy_ushort, _LEXSORT_UNSIGNED);
+        case NPY_INT:
+            _LEXSORT_LOOP(npy_int, _LEXSORT_SIGNED);
+        case NPY_UINT:
+            _LEXSORT_LOOP(npy_uint, _LEXSORT_UNSIGNED);
+        case NPY_LONG:
+            _LEXSORT_LOOP(npy_long, _LEXSORT_SIGNED);
+        case NPY_ULONG:
+            _LEXSORT_LOOP(npy_ulong, _LEXSORT_UNSIGNED);
+        case NPY_LONGLONG:
+        case NPY_DATETIME:
+        case NPY_TIMEDELTA:
+            _LEXSORT_LOOP(npy_longlong, _LEXSORT_SIGNED);
+        case NPY_ULONGLONG:
+            _LEXSORT_LOOP(npy_ulonglong, _LEXSORT_UNSIGNED);
+        default:
+            return -1;
+    }
+#undef _LEXSORT_LOOP
+}
+
+#undef _LEXSORT_SIGNED
+#undef _LEXSORT_UNSIGNED
+
+/*
+ * Returns the packed keys of the n keys in mps, or NULL, with an error
+ * set if one occurred, if they can't be packed.
+ */
+static PyArrayObject *
+_lexsort_pack(PyArrayObject **mps, npy_intp n)
+{
+    PyArrayObject *op[NPY_MAXARGS];
+    npy_uint32 op_flags[NPY_MAXARGS];
+    PyArray_Descr *op_dtypes[NPY_MAXARGS];
+    npy_uint64 mn[NPY_MAXARGS], mx[NPY_MAXARGS];
+    int shifts[NPY_MAXARGS], bits[NPY_MAXARGS];
+    NpyIter *iter;
+    NpyIter_IterNextFunc *iternext;
+    char **dataptr;
+    npy_intp *strides, *countptr;
+    PyArrayObject *ret = NULL;
+    npy_intp j;
+    int total = 0, init;
+    NPY_BEGIN_THREADS_DEF;
+
+    if (n + 1 > NPY_MAXARGS || PyArray_SIZE(mps[0]) == 0) {
+        return NULL;
+    }
+    for (j = 0; j < n; j++) {
+        npy_uint64 dummy = 0;
+
+        /* the loop of an empty array only checks the type */
+        if (!PyArray_ISNOTSWAPPED(mps[j]) || !PyArray_ISALIGNED(mps[j]) ||
+                _lexsort_pack_loop(PyArray_DESCR(mps[j])->type_num, NULL,
+                                   0, 0, &dummy, &dummy,
+                                   NULL, 0, 0) < 0) {
+            return NULL;
+        }
+        op[j] = mps[j];
+        op_flags[j] = NPY_ITER_READONLY;
+        op_dtypes[j] = NULL;
+        mn[j] = NPY_MAX_UINT64;
+        mx[j] = 0;
+    }
+    op[n] = NULL;
+    op_flags[n] = NPY_ITER_WRITEONLY | NPY_ITER_ALLOCATE;
+    op_dtypes[n] = PyArray_DescrFromType(NPY_UINT64);
+
+    iter = NpyIter_AdvancedNew(n + 1, op,
+                               NPY_ITER_EXTERNAL_LOOP | NPY_ITER_ZEROSIZE_OK,
+                               NPY_KEEPORDER, NPY_NO_CASTING,
+                               op_flags, op_dtypes, -1, NULL, NULL, 0);
+    Py_DECREF(op_dtypes[n]);
+    if (iter == NULL) {
+        return NULL;
+    }
+    iternext = NpyIter_GetIterNext(iter, NULL);
+    if (iternext == NULL) {
+        NpyIter_Deallocate(iter);
+        return NULL;
+    }
+    dataptr = NpyIter_GetDataPtrArray(iter);
+    strides = NpyIter_GetInnerStrideArray(iter);
+    countptr = NpyIter_GetInnerLoopSizePtr(iter);
+    if (strides[n] != sizeof(npy_uint64)) {
         goto finish;
     }
-    n = PyArray_SIZE(op)/m;
-    store_ptr = global_data;
-    global_data = PyArray_DATA(op);
-    store = global_obj;
-    global_obj = op;
-    for (i = 0; i < n; i++, ip += m, global_data += m*argsort_elsize) {
-        for (j = 0; j < m; j++) {
-            ip[j] = j;
-        }
-        res = sort((char *)ip, m, sizeof(npy_intp), argsort_static_compare);
-        if (res < 0) {
-            break;
+
+    /* The ranges of the keys */
+    NPY_BEGIN_THREADS;
+    do {
+        for (j = 0; j < n; j++) {
+            _lexsort_pack_loop(PyArray_DESCR(mps[j])->type_num, dataptr[j],
+                               strides[j], *countptr, &mn[j], &mx[j],
+                               NULL, 0, 0);
         }
-    }
-    global_data = store_ptr;
-    global_obj = store;
+    } while (iternext(iter));
+    NPY_END_THREADS;
 
-    if (PyErr_Occurred()) {
-        goto fail;
+    for (j = 0; j < n; j++) {
+        npy_uint64 range = mx[j] - mn[j];
+
+        for (bits[j] = 0; range != 0; range >>= 1) {
+            bits[j]++;
+        }
+        shifts[j] = total;
+        total += bits[j];
     }
-    else if (res == -NPY_ENOMEM) {
-        PyErr_NoMemory();
-        goto fail;
+    if (total > 64) {
+        goto finish;
     }
-    else if (res == -NPY_ECOMP) {
-        PyErr_SetString(PyExc_TypeError,
-                "sort comparison failed");
-        goto fail;
+
+    /* Pack the keys, keys that are constant take no bits */
+    if (NpyIter_Reset(iter, NULL) != NPY_SUCCEED) {
+        goto finish;
     }
+    NPY_BEGIN_THREADS;
+    do {
+        npy_uint64 *out = (npy_uint64 *)dataptr[n];
 
- finish:
-    Py_DECREF(op);
-    SWAPBACK(op, ret);
-    return (PyObject *)op;
+        init = 1;
+        for (j = 0; j < n; j++) {
+            if (bits[j] > 0 || (init && j == n - 1)) {
+                _lexsort_pack_loop(PyArray_DESCR(mps[j])->type_num,
+                                   dataptr[j], strides[j], *countptr,
+                                   &mn[j], &mx[j], out, shifts[j], init);
+                init = 0;
+            }
+        }
+    } while (iternext(iter));
+    NPY_END_THREADS;
 
- fail:
-    Py_XDECREF(op);
-    Py_XDECREF(ret);
-    return NULL;
-}
+    ret = NpyIter_GetOperandArray(iter)[n];
+    Py_INCREF(ret);
 
+ finish:
+    NpyIter_Deallocate(iter);
+    return ret;
+}
 
 /*NUMPY_API
  *LexSort an array providing indices that will sort a collection of arrays
@@ -1267,17 +2717,13 @@ PyArray_LexSort(PyObject *sort_keys, int axis)
 {
     PyArrayObject **mps;
     PyArrayIterObject **its;
-    PyArrayObject *ret = NULL;
+    PyArrayObject *ret = NULL, *packed;
     PyArrayIterObject *rit = NULL;
-    npy_intp n, N, size, i, j;
-    npy_intp astride, rstride, *iptr;
+    _lexsort_info info;
+    npy_intp n, i, j, ntasks;
     int nd;
-    int needcopy = 0;
-    int elsize;
-    int maxelsize;
     int object = 0;
-    PyArray_ArgSortFunc *argsort;
-    NPY_BEGIN_THREADS_DEF;
+    int res;
 
     if (!PySequence_Check(sort_keys)
            || ((n = PySequence_Size(sort_keys)) <= 0)) {
@@ -1316,7 +2762,7 @@ PyArray_LexSort(PyObject *sort_keys, int axis)
                 goto fail;
             }
         }
-        if (!PyArray_DESCR(mps[i])->f->argsort[NPY_MERGESORT]) {
+        if (!_get_argsort_func(PyArray_DESCR(mps[i]), NPY_RADIXSORT, 0)) {
             PyErr_Format(PyExc_TypeError,
                          "merge sort not available for item %zd", i);
             goto fail;
@@ -1357,6 +2803,19 @@ PyArray_LexSort(PyObject *sort_keys, int axis)
     }
 
     /* Now do the sorting */
+    packed = _lexsort_pack(mps, n);
+    if (packed != NULL) {
+        ret = (PyArrayObject *)PyArray_ArgSort(packed, axis, NPY_RADIXSORT);
+        Py_DECREF(packed);
+        if (ret == NULL) {
+            goto fail;
+        }
+        goto finish;
+    }
+    if (PyErr_Occurred()) {
+        goto fail;
+    }
+
     ret = (PyArrayObject *)PyArray_New(&PyArray_Type, PyArray_NDIM(mps[0]),
                                        PyArray_DIMS(mps[0]), NPY_INTP,
                                        NULL, NULL, 0, 0, NULL);
@@ -1368,91 +2827,56 @@ PyArray_LexSort(PyObject *sort_keys, int axis)
     if (rit == NULL) {
         goto fail;
     }
-    if (!object) {
-        NPY_BEGIN_THREADS;
-    }
-    size = rit->size;
-    N = PyArray_DIMS(mps[0])[axis];
-    rstride = PyArray_STRIDE(ret, axis);
-    maxelsize = PyArray_DESCR(mps[0])->elsize;
-    needcopy = (rstride != sizeof(npy_intp));
+
+    info.mps = mps;
+    info.nkeys = n;
+    info.nlanes = rit->size;
+    info.N = PyArray_DIMS(mps[0])[axis];
+    info.axis = axis;
+    info.rstride = PyArray_STRIDE(ret, axis);
+    info.maxelsize = 0;
+    info.needcopy = (info.rstride != sizeof(npy_intp));
     for (j = 0; j < n; j++) {
-        needcopy = needcopy
+        info.needcopy = info.needcopy
             || PyArray_ISBYTESWAPPED(mps[j])
             || !(PyArray_FLAGS(mps[j]) & NPY_ARRAY_ALIGNED)
             || (PyArray_STRIDES(mps[j])[axis] != (npy_intp)PyArray_DESCR(mps[j])->elsize);
-        if (PyArray_DESCR(mps[j])->elsize > maxelsize) {
-            maxelsize = PyArray_DESCR(mps[j])->elsize;
+        if (PyArray_DESCR(mps[j])->elsize > info.maxelsize) {
+            info.maxelsize = PyArray_DESCR(mps[j])->elsize;
         }
     }
-
-    if (needcopy) {
-        char *valbuffer, *indbuffer;
-        int *swaps;
-
-        valbuffer = PyDataMem_NEW(N*maxelsize);
-        if (valbuffer == NULL) {
-            goto fail;
-        }
-        indbuffer = PyDataMem_NEW(N*sizeof(npy_intp));
-        if (indbuffer == NULL) {
-            PyDataMem_FREE(indbuffer);
-            goto fail;
-        }
-        swaps = malloc(n*sizeof(int));
-        for (j = 0; j < n; j++) {
-            swaps[j] = PyArray_ISBYTESWAPPED(mps[j]);
-        }
-        while (size--) {
-            iptr = (npy_intp *)indbuffer;
-            for (i = 0; i < N; i++) {
-                *iptr++ = i;
-            }
-            for (j = 0; j < n; j++) {
-                elsize = PyArray_DESCR(mps[j])->elsize;
-                astride = PyArray_STRIDES(mps[j])[axis];
-                argsort = PyArray_DESCR(mps[j])->f->argsort[NPY_MERGESORT];
-                _unaligned_strided_byte_copy(valbuffer, (npy_intp) elsize,
-                                             its[j]->dataptr, astride, N, elsize);
-                if (swaps[j]) {
-                    _strided_byte_swap(valbuffer, (npy_intp) elsize, N, elsize);
-                }
-                if (argsort(valbuffer, (npy_intp *)indbuffer, N, mps[j]) < 0) {
-                    PyDataMem_FREE(valbuffer);
-                    PyDataMem_FREE(indbuffer);
-                    free(swaps);
-                    goto fail;
-                }
-                PyArray_ITER_NEXT(its[j]);
-            }
-            _unaligned_strided_byte_copy(rit->dataptr, rstride, indbuffer,
-                                         sizeof(npy_intp), N, sizeof(npy_intp));
-            PyArray_ITER_NEXT(rit);
-        }
-        PyDataMem_FREE(valbuffer);
-        PyDataMem_FREE(indbuffer);
-        free(swaps);
+    info.argsort = PyArray_malloc(n * sizeof(PyArray_ArgSortFunc *));
+    info.keylanes = PyArray_malloc((n + 1) * info.nlanes * sizeof(char *));
+    if (info.argsort == NULL || info.keylanes == NULL) {
+        PyArray_free(info.argsort);
+        PyArray_free(info.keylanes);
+        goto fail;
     }
-    else {
-        while (size--) {
-            iptr = (npy_intp *)rit->dataptr;
-            for (i = 0; i < N; i++) {
-                *iptr++ = i;
-            }
-            for (j = 0; j < n; j++) {
-                argsort = PyArray_DESCR(mps[j])->f->argsort[NPY_MERGESORT];
-                if (argsort(its[j]->dataptr, (npy_intp *)rit->dataptr,
-                            N, mps[j]) < 0) {
-                    goto fail;
-                }
-                PyArray_ITER_NEXT(its[j]);
-            }
-            PyArray_ITER_NEXT(rit);
+    info.rlanes = info.keylanes + n * info.nlanes;
+    for (j = 0; j < n; j++) {
+        /* the stable radix sort where available, else merge sort */
+        info.argsort[j] = _get_argsort_func(PyArray_DESCR(mps[j]),
+                                            NPY_RADIXSORT, info.N);
+        for (i = 0; i < info.nlanes; i++) {
+            info.keylanes[j * info.nlanes + i] = its[j]->dataptr;
+            PyArray_ITER_NEXT(its[j]);
         }
     }
+    for (i = 0; i < info.nlanes; i++) {
+        info.rlanes[i] = rit->dataptr;
+        PyArray_ITER_NEXT(rit);
+    }
 
+    ntasks = 1;
     if (!object) {
-        NPY_END_THREADS;
+        ntasks = PyArray_MIN(info.nlanes, PyArray_ParallelTaskCount(
+                                info.nlanes * info.N, NPY_SORT_PARALLEL_MIN));
+    }
+    res = _lexsort_lanes_parallel(&info, ntasks, object);
+    PyArray_free(info.argsort);
+    PyArray_free(info.keylanes);
+    if (res < 0) {
+        goto fail;
     }
 
  finish:
@@ -1466,7 +2890,6 @@ PyArray_LexSort(PyObject *sort_keys, int axis)
     return (PyObject *)ret;
 
  fail:
-    NPY_END_THREADS;
     if (!PyErr_Occurred()) {
         /* Out of memory during sorting or buffer creation */
         PyErr_NoMemory();
@@ -1696,7 +3119,8 @@ local_argsearch_right(PyArrayObject *arr, PyArrayObject *key,
  *
  * Notes
  * -----
- * Binary search is used to find the indexes.
+ * Binary search is used to find the indexes.  The numeric types have
+ * typed kernels which are fastest when the items in op2 are sorted.
  */
 NPY_NO_EXPORT PyObject *
 PyArray_SearchSorted(PyArrayObject *op1, PyObject *op2,
@@ -1783,30 +3207,43 @@ PyArray_SearchSorted(PyArrayObject *op1, PyObject *op2,
     }
 
     if (ap3 == NULL) {
-        if (side == NPY_SEARCHLEFT) {
-            NPY_BEGIN_THREADS_DESCR(PyArray_DESCR(ap2));
+        PyArray_BinSearchFunc *binsearch;
+
+        binsearch = get_binsearch_func(PyArray_DESCR(ap2)->type_num, side);
+        NPY_BEGIN_THREADS_DESCR(PyArray_DESCR(ap2));
+        if (binsearch != NULL) {
+            binsearch(PyArray_DATA(ap1), PyArray_DATA(ap2),
+                      (npy_intp *)PyArray_DATA(ret),
+                      PyArray_SIZE(ap1), PyArray_SIZE(ap2));
+        }
+        else if (side == NPY_SEARCHLEFT) {
             local_search_left(ap1, ap2, ret);
-            NPY_END_THREADS_DESCR(PyArray_DESCR(ap2));
         }
         else if (side == NPY_SEARCHRIGHT) {
-            NPY_BEGIN_THREADS_DESCR(PyArray_DESCR(ap2));
             local_search_right(ap1, ap2, ret);
-            NPY_END_THREADS_DESCR(PyArray_DESCR(ap2));
         }
+        NPY_END_THREADS_DESCR(PyArray_DESCR(ap2));
     }
     else {
+        PyArray_ArgBinSearchFunc *argbinsearch;
         int err=0;
 
-        if (side == NPY_SEARCHLEFT) {
-            NPY_BEGIN_THREADS_DESCR(PyArray_DESCR(ap2));
+        argbinsearch = get_argbinsearch_func(PyArray_DESCR(ap2)->type_num,
+                                             side);
+        NPY_BEGIN_THREADS_DESCR(PyArray_DESCR(ap2));
+        if (argbinsearch != NULL) {
+            err = argbinsearch(PyArray_DATA(ap1), PyArray_DATA(ap2),
+                               (npy_intp *)PyArray_DATA(sorter),
+                               (npy_intp *)PyArray_DATA(ret),
+                               PyArray_SIZE(ap1), PyArray_SIZE(ap2));
+        }
+        else if (side == NPY_SEARCHLEFT) {
             err = local_argsearch_left(ap1, ap2, sorter, ret);
-            NPY_END_THREADS_DESCR(PyArray_DESCR(ap2));
         }
         else if (side == NPY_SEARCHRIGHT) {
-            NPY_BEGIN_THREADS_DESCR(PyArray_DESCR(ap2));
             err = local_argsearch_right(ap1, ap2, sorter, ret);
-            NPY_END_THREADS_DESCR(PyArray_DESCR(ap2));
         }
+        NPY_END_THREADS_DESCR(PyArray_DESCR(ap2));
         if (err < 0) {
             PyErr_SetString(PyExc_ValueError,
                     "Sorter index out of range.");
@@ -1962,6 +3399,74 @@ PyArray_Diagonal(PyArrayObject *self, int offset, int axis1, int axis2)
     return copy;
 }
 
+/*
+ * Compress with a contiguous boolean condition, which selects blocks of
+ * the trailing dimensions directly.  Returns Py_NotImplemented (a new
+ * reference) for conditions longer than the axis, which are checked by
+ * the general path.
+ */
+static PyObject *
+_compress_boolean(PyArrayObject *self0, PyArrayObject *cond, int axis)
+{
+    PyArrayObject *self, *ret;
+    PyArray_Descr *dtype;
+    npy_intp shape[NPY_MAXDIMS];
+    npy_intp n = 1, chunk, ncond = PyArray_DIM(cond, 0), i;
+    char *src, *dst, *dst_end;
+    int idim, aligned;
+    NPY_BEGIN_THREADS_DEF;
+
+    self = (PyArrayObject *)PyArray_CheckAxis(self0, &axis,
+                                    NPY_ARRAY_CARRAY);
+    if (self == NULL) {
+        return NULL;
+    }
+    if (ncond > PyArray_DIM(self, axis)) {
+        Py_DECREF(self);
+        Py_INCREF(Py_NotImplemented);
+        return Py_NotImplemented;
+    }
+    chunk = PyArray_ITEMSIZE(self);
+    for (idim = 0; idim < PyArray_NDIM(self); idim++) {
+        shape[idim] = PyArray_DIM(self, idim);
+        if (idim < axis) {
+            n *= shape[idim];
+        }
+        else if (idim > axis) {
+            chunk *= shape[idim];
+        }
+    }
+    shape[axis] = count_boolean_trues(1, PyArray_BYTES(cond),
+                                      PyArray_DIMS(cond),
+                                      PyArray_STRIDES(cond));
+
+    dtype = PyArray_DESCR(self);
+    Py_INCREF(dtype);
+    ret = (PyArrayObject *)PyArray_NewFromDescr(Py_TYPE(self), dtype,
+                                PyArray_NDIM(self), shape,
+                                NULL, NULL, 0, (PyObject *)self);
+    if (ret == NULL) {
+        Py_DECREF(self);
+        return NULL;
+    }
+    if (PyArray_SIZE(ret) != 0) {
+        src = PyArray_BYTES(self);
+        dst = PyArray_BYTES(ret);
+        dst_end = dst + PyArray_NBYTES(ret);
+        aligned = PyArray_ISALIGNED(self);
+        NPY_BEGIN_THREADS;
+        for (i = 0; i < n; i++) {
+            dst = npy_boolean_compress(dst, dst_end, src, chunk,
+                                       PyArray_BYTES(cond), ncond,
+                                       chunk, aligned);
+            src += chunk * PyArray_DIM(self, axis);
+        }
+        NPY_END_THREADS;
+    }
+    Py_DECREF(self);
+    return (PyObject *)ret;
+}
+
 /*NUMPY_API
  * Compress
  */
@@ -1995,6 +3500,17 @@ PyArray_Compress(PyArrayObject *self, PyObject *condition, int axis,
         return NULL;
     }
 
+    if (out == NULL && PyArray_DESCR(cond)->type_num == NPY_BOOL &&
+                            PyArray_STRIDE(cond, 0) == 1 &&
+                            !PyDataType_REFCHK(PyArray_DESCR(self))) {
+        ret = _compress_boolean(self, cond, axis);
+        if (ret != Py_NotImplemented) {
+            Py_DECREF(cond);
+            return ret;
+        }
+        Py_DECREF(ret);
+    }
+
     res = PyArray_Nonzero(cond);
     Py_DECREF(cond);
     if (res == NULL) {
@@ -2006,6 +3522,313 @@ PyArray_Compress(PyArrayObject *self, PyObject *condition, int axis,
     return ret;
 }
 
+/*
+ * Boolean masks are scanned eight bytes at a time: words of only False
+ * values are skipped, words of only True values (bytes equal to 1) extend
+ * runs which are copied as a whole, and the remaining words are handled
+ * item by item.
+ */
+#define NPY_MASK_WORD_ONES ((((npy_uint64)0x01010101) << 32) | 0x01010101)
+
+static NPY_INLINE npy_uint64
+_mask_word(const char *mask)
+{
+    npy_uint64 w;
+
+    memcpy(&w, mask, sizeof(w));
+    return w;
+}
+
+/* Length of the run of whole words of True values starting at mask */
+static NPY_INLINE npy_intp
+_mask_true_run(const char *mask, npy_intp n)
+{
+    npy_intp i = 0;
+
+    while (i + 8 <= n && _mask_word(mask + i) == NPY_MASK_WORD_ONES) {
+        i += 8;
+    }
+    return i;
+}
+
+/* Copies n items between strided buffers, in one memmove if contiguous */
+static void
+_copy_items(char *dst, npy_intp dst_stride, char *src, npy_intp src_stride,
+            npy_intp n, npy_intp itemsize, int aligned)
+{
+    npy_intp i;
+
+    if (dst_stride == itemsize && src_stride == itemsize) {
+        memmove(dst, src, n * itemsize);
+        return;
+    }
+#define _COPY_ITEMS_LOOP(type)                                          \
+    for (i = 0; i < n; i++) {                                           \
+        *(type *)dst = *(type *)src;                                    \
+        dst += dst_stride;                                              \
+        src += src_stride;                                              \
+    }                                                                   \
+    return
+
+    if (aligned) {
+        switch (itemsize) {
+            case 1:
+                _COPY_ITEMS_LOOP(npy_uint8);
+            case 2:
+                _COPY_ITEMS_LOOP(npy_uint16);
+            case 4:
+                _COPY_ITEMS_LOOP(npy_uint32);
+            case 8:
+                _COPY_ITEMS_LOOP(npy_uint64);
+        }
+    }
+#undef _COPY_ITEMS_LOOP
+    for (i = 0; i < n; i++) {
+        memmove(dst, src, itemsize);
+        dst += dst_stride;
+        src += src_stride;
+    }
+}
+
+/*
+ * Copies the items of 'src' at which the contiguous boolean 'mask' of
+ * length 'n' is nonzero to the contiguous buffer 'dst', which ends at
+ * 'dst_end'.  The items are copied as integers if 'aligned' and of size
+ * 1, 2, 4 or 8, without a branch per item where there is room to write
+ * a full word's items past the current position.
+ *
+ * Returns the end of the copied items in 'dst'.
+ */
+NPY_NO_EXPORT char *
+npy_boolean_compress(char *dst, char *dst_end, char *src,
+                     npy_intp src_stride, const char *mask, npy_intp n,
+                     npy_intp itemsize, int aligned)
+{
+    npy_intp i = 0, end, k, run;
+    int typed = aligned && (itemsize == 1 || itemsize == 2 ||
+                            itemsize == 4 || itemsize == 8);
+
+    while (i < n) {
+        if (i + 8 <= n) {
+            npy_uint64 w = _mask_word(mask + i);
+
+            if (w == 0) {
+                i += 8;
+                continue;
+            }
+            if (w == NPY_MASK_WORD_ONES) {
+                run = _mask_true_run(mask + i, n - i);
+                _copy_items(dst, itemsize, src + i * src_stride, src_stride,
+                            run, itemsize, aligned);
+                dst += run * itemsize;
+                i += run;
+                continue;
+            }
+            end = i + 8;
+        }
+        else {
+            end = n;
+        }
+#define _COMPRESS_LOOP(type)                                            \
+        for (k = i; k < end; k++) {                                     \
+            *(type *)dst = *(type *)(src + k * src_stride);             \
+            dst += (mask[k] != 0) * sizeof(type);                       \
+        }                                                               \
+        break
+
+        if (typed && dst + 8 * itemsize <= dst_end) {
+            switch (itemsize) {
+                case 1:
+                    _COMPRESS_LOOP(npy_uint8);
+                case 2:
+                    _COMPRESS_LOOP(npy_uint16);
+                case 4:
+                    _COMPRESS_LOOP(npy_uint32);
+                default:
+                    _COMPRESS_LOOP(npy_uint64);
+            }
+        }
+        else {
+            for (k = i; k < end; k++) {
+                if (mask[k]) {
+                    memcpy(dst, src + k * src_stride, itemsize);
+                    dst += itemsize;
+                }
+            }
+        }
+#undef _COMPRESS_LOOP
+        i = end;
+    }
+    return dst;
+}
+
+/*
+ * Assigns consecutive items of 'src' to the items of 'dst' at which the
+ * contiguous boolean 'mask' of length 'n' is nonzero.  A 'src_stride'
+ * of 0 assigns the same item everywhere.
+ *
+ * Returns the position after the last item read from 'src'.
+ */
+NPY_NO_EXPORT char *
+npy_boolean_expand(char *dst, npy_intp dst_stride, char *src,
+                   npy_intp src_stride, const char *mask, npy_intp n,
+                   npy_intp itemsize, int aligned)
+{
+    npy_intp i = 0, end, k, run;
+    int typed = aligned && (itemsize == 1 || itemsize == 2 ||
+                            itemsize == 4 || itemsize == 8);
+
+    while (i < n) {
+        if (i + 8 <= n) {
+            npy_uint64 w = _mask_word(mask + i);
+
+            if (w == 0) {
+                i += 8;
+                continue;
+            }
+            if (w == NPY_MASK_WORD_ONES) {
+                run = _mask_true_run(mask + i, n - i);
+                _copy_items(dst + i * dst_stride, dst_stride, src, src_stride,
+                            run, itemsize, aligned);
+                src += run * src_stride;
+                i += run;
+                continue;
+            }
+            end = i + 8;
+        }
+        else {
+            end = n;
+        }
+#define _EXPAND_LOOP(type)                                              \
+        for (k = i; k < end; k++) {                                     \
+            if (mask[k]) {                                              \
+                *(type *)(dst + k * dst_stride) = *(type *)src;         \
+                src += src_stride;                                      \
+            }                                                           \
+        }                                                               \
+        break
+
+        if (typed) {
+            switch (itemsize) {
+                case 1:
+                    _EXPAND_LOOP(npy_uint8);
+                case 2:
+                    _EXPAND_LOOP(npy_uint16);
+                case 4:
+                    _EXPAND_LOOP(npy_uint32);
+                default:
+                    _EXPAND_LOOP(npy_uint64);
+            }
+        }
+        else {
+            for (k = i; k < end; k++) {
+                if (mask[k]) {
+                    memmove(dst + k * dst_stride, src, itemsize);
+                    src += src_stride;
+                }
+            }
+        }
+#undef _EXPAND_LOOP
+        i = end;
+    }
+    return src;
+}
+
+/*
+ * Writes offset + i for the positions i at which the contiguous boolean
+ * 'mask' of length 'n' is nonzero to 'dst', which ends at 'dst_end'.
+ *
+ * Returns the end of the written indices.
+ */
+NPY_NO_EXPORT npy_intp *
+npy_boolean_nonzero(npy_intp *dst, npy_intp *dst_end, const char *mask,
+                    npy_intp n, npy_intp offset)
+{
+    npy_intp i = 0, end, k, run;
+
+    while (i < n) {
+        if (i + 8 <= n) {
+            npy_uint64 w = _mask_word(mask + i);
+
+            if (w == 0) {
+                i += 8;
+                continue;
+            }
+            if (w == NPY_MASK_WORD_ONES) {
+                run = _mask_true_run(mask + i, n - i);
+                for (k = i; k < i + run; k++) {
+                    *dst++ = offset + k;
+                }
+                i += run;
+                continue;
+            }
+            end = i + 8;
+        }
+        else {
+            end = n;
+        }
+        if (dst + 8 <= dst_end) {
+            for (k = i; k < end; k++) {
+                *dst = offset + k;
+                dst += (mask[k] != 0);
+            }
+        }
+        else {
+            for (k = i; k < end; k++) {
+                if (mask[k]) {
+                    *dst++ = offset + k;
+                }
+            }
+        }
+        i = end;
+    }
+    return dst;
+}
+
+#undef NPY_MASK_WORD_ONES
+
+/* Counts the nonzero bytes of a contiguous boolean buffer */
+static npy_intp
+_count_true_bytes(const char *d, npy_intp n)
+{
+    npy_intp count = 0, i = 0;
+#ifdef HAVE_EMMINTRIN_H
+    const __m128i zero = _mm_setzero_si128();
+
+    while (i + 16 <= n) {
+        /* the byte counters of zeros hold at most 255 blocks */
+        npy_intp blockend = i + (PyArray_MIN(n - i, 255 * 16) & ~15);
+        npy_intp nblock = blockend - i;
+        __m128i acc = zero;
+
+        for (; i < blockend; i += 16) {
+            __m128i v = _mm_loadu_si128((const __m128i *)(d + i));
+            acc = _mm_sub_epi8(acc, _mm_cmpeq_epi8(v, zero));
+        }
+        acc = _mm_sad_epu8(acc, zero);
+        count += nblock - _mm_cvtsi128_si32(acc) -
+                          _mm_cvtsi128_si32(_mm_srli_si128(acc, 8));
+    }
+#else
+    const npy_uint64 ones = (((npy_uint64)0x01010101) << 32) | 0x01010101;
+
+    for (; i + 8 <= n; i += 8) {
+        npy_uint64 w;
+
+        memcpy(&w, d + i, sizeof(w));
+        /* fold every byte into its lowest bit, then add the bytes */
+        w |= w >> 4;
+        w |= w >> 2;
+        w |= w >> 1;
+        count += ((w & ones) * ones) >> 56;
+    }
+#endif
+    for (; i < n; i++) {
+        count += (d[i] != 0);
+    }
+    return count;
+}
+
 /*
  * Counts the number of True values in a raw boolean array. This
  * is a low-overhead function which does no heap allocations.
@@ -2037,11 +3860,8 @@ count_boolean_trues(int ndim, char *data, npy_intp *ashape, npy_intp *astrides)
     /* Special case for contiguous inner loop */
     if (strides[0] == 1) {
         NPY_RAW_ITER_START(idim, ndim, coord, shape) {
-            char *d = data;
             /* Process the innermost dimension */
-            for (i = 0; i < shape[0]; ++i, ++d) {
-                count += (*d != 0);
-            }
+            count += _count_true_bytes(data, shape[0]);
         } NPY_RAW_ITER_ONE_NEXT(idim, ndim, coord, shape, data, strides);
     }
     /* General inner loop */
@@ -2189,6 +4009,28 @@ PyArray_Nonzero(PyArrayObject *self)
         return NULL;
     }
 
+    /* Boolean arrays in C order are searched word by word */
+    if (PyArray_DESCR(self)->type_num == NPY_BOOL &&
+                                PyArray_IS_C_CONTIGUOUS(self)) {
+        npy_intp j, flat, *dims = PyArray_DIMS(self);
+        int idim;
+
+        multi_index = (npy_intp *)PyArray_DATA(ret);
+        npy_boolean_nonzero(multi_index, multi_index + nonzero_count,
+                            PyArray_BYTES(self), PyArray_SIZE(self), 0);
+        /* unravel the flat indices in place, starting from the last */
+        if (ndim > 1) {
+            for (j = nonzero_count - 1; j >= 0; j--) {
+                flat = multi_index[j];
+                for (idim = ndim - 1; idim >= 0; idim--) {
+                    multi_index[j * ndim + idim] = flat % dims[idim];
+                    flat /= dims[idim];
+                }
+            }
+        }
+        goto finish;
+    }
+
     /* If it's a one-dimensional result, don't use an iterator */
     if (ndim <= 1) {
         npy_intp j;
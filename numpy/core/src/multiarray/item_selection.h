@@ -10,6 +10,80 @@
 NPY_NO_EXPORT npy_intp
 count_boolean_trues(int ndim, char *data, npy_intp *ashape, npy_intp *astrides);
 
+/*
+ * Describes the copy of the blocks selected by an index along one axis
+ * of an array, for every position of the leading dimensions, between
+ * the array and a C contiguous buffer.
+ */
+typedef struct {
+    char *data;
+    /* leading dimensions of the indexed array */
+    int nouterdim;
+    npy_intp outershape[NPY_MAXDIMS];
+    npy_intp outerstrides[NPY_MAXDIMS];
+    npy_intp nouter;
+    /* the indexed axis, with the indices already checked and wrapped */
+    npy_intp axisstride;
+    npy_intp *ind;
+    npy_intp nind;
+    /* the contiguous block every index selects */
+    npy_intp chunk;
+    /* whether the blocks can be copied as integers */
+    int typed;
+    /*
+     * The result of a gather, or the values to assign, which repeat
+     * with a period of 'period' bytes (a multiple of 'chunk').
+     */
+    char *buf;
+    npy_intp period;
+    int gather;
+    npy_intp ntasks;
+} npy_index_copy_info;
+
+/*
+ * Returns 1 if blocks of 'chunk' bytes of 'arr' are single items which
+ * can be copied as integers.
+ */
+NPY_NO_EXPORT int
+npy_index_copy_typed(PyArrayObject *arr, npy_intp chunk);
+
+/*
+ * Gathers the blocks into the buffer, or assigns the buffer to them in
+ * the order of the indices, on several threads if large.  Releases the
+ * GIL, so the data must not hold objects.
+ */
+NPY_NO_EXPORT void
+npy_index_copy(npy_index_copy_info *info);
+
+/*
+ * Copies the items of 'src' at which the contiguous boolean 'mask' of
+ * length 'n' is nonzero to the contiguous buffer 'dst' ending at
+ * 'dst_end'.  Returns the end of the copied items.
+ */
+NPY_NO_EXPORT char *
+npy_boolean_compress(char *dst, char *dst_end, char *src,
+                     npy_intp src_stride, const char *mask, npy_intp n,
+                     npy_intp itemsize, int aligned);
+
+/*
+ * Assigns consecutive items of 'src' (the same item if 'src_stride' is 0)
+ * to the items of 'dst' at which the contiguous boolean 'mask' of length
+ * 'n' is nonzero.  Returns the position after the last item read.
+ */
+NPY_NO_EXPORT char *
+npy_boolean_expand(char *dst, npy_intp dst_stride, char *src,
+                   npy_intp src_stride, const char *mask, npy_intp n,
+                   npy_intp itemsize, int aligned);
+
+/*
+ * Writes offset + i for the positions i at which the contiguous boolean
+ * 'mask' of length 'n' is nonzero to 'dst' ending at 'dst_end'.  Returns
+ * the end of the written indices.
+ */
+NPY_NO_EXPORT npy_intp *
+npy_boolean_nonzero(npy_intp *dst, npy_intp *dst_end, const char *mask,
+                    npy_intp n, npy_intp offset);
+
 /*
  * Gets a single item from the array, based on a single multi-index
  * array of values, which must be of length PyArray_NDIM(self).
@@ -17,6 +17,7 @@
 #include "mapping.h"
 #include "lowlevel_strided_loops.h"
 #include "item_selection.h"
+#include "array_assign.h"
 
 #define SOBJ_NOTFANCY 0
 #define SOBJ_ISFANCY 1
@@ -679,6 +680,10 @@ array_boolean_subscript(PyArrayObject *self,
         npy_intp self_stride, bmask_stride, subloopsize;
         char *self_data;
         char *bmask_data;
+        char *ret_end = ret_data + size * itemsize;
+        int aligned = PyArray_ISALIGNED(self);
+        int compress = !PyDataType_REFCHK(dtype);
+        NPY_BEGIN_THREADS_DEF;
 
         /* Set up the iterator */
         flags = NPY_ITER_EXTERNAL_LOOP | NPY_ITER_REFS_OK;
@@ -718,11 +723,21 @@ array_boolean_subscript(PyArrayObject *self,
 
         self_stride = innerstrides[0];
         bmask_stride = innerstrides[1];
+        if (!needs_api) {
+            NPY_BEGIN_THREADS;
+        }
         do {
             innersize = *NpyIter_GetInnerLoopSizePtr(iter);
             self_data = dataptrs[0];
             bmask_data = dataptrs[1];
 
+            /* A contiguous mask selects the items word by word */
+            if (compress && bmask_stride == 1) {
+                ret_data = npy_boolean_compress(ret_data, ret_end,
+                                    self_data, self_stride, bmask_data,
+                                    innersize, itemsize, aligned);
+                continue;
+            }
             while (innersize > 0) {
                 /* Skip masked values */
                 subloopsize = 0;
@@ -745,6 +760,7 @@ array_boolean_subscript(PyArrayObject *self,
                 ret_data += subloopsize * itemsize;
             }
         } while (iternext(iter));
+        NPY_END_THREADS;
 
         NpyIter_Deallocate(iter);
         NPY_AUXDATA_FREE(transferdata);
@@ -840,6 +856,11 @@ array_ass_boolean_subscript(PyArrayObject *self,
         npy_intp self_stride, bmask_stride, subloopsize;
         char *self_data;
         char *bmask_data;
+        int aligned = PyArray_ISALIGNED(self) && PyArray_ISALIGNED(v);
+        int expand = !PyDataType_REFCHK(PyArray_DESCR(self)) &&
+                     PyArray_EquivTypes(PyArray_DESCR(self),
+                                        PyArray_DESCR(v));
+        NPY_BEGIN_THREADS_DEF;
 
         /* Set up the iterator */
         flags = NPY_ITER_EXTERNAL_LOOP | NPY_ITER_REFS_OK;
@@ -877,11 +898,21 @@ array_ass_boolean_subscript(PyArrayObject *self,
             return -1;
         }
 
+        if (!needs_api) {
+            NPY_BEGIN_THREADS;
+        }
         do {
             innersize = *NpyIter_GetInnerLoopSizePtr(iter);
             self_data = dataptrs[0];
             bmask_data = dataptrs[1];
 
+            /* A contiguous mask assigns runs of items at once */
+            if (expand && bmask_stride == 1) {
+                v_data = npy_boolean_expand(self_data, self_stride,
+                                    v_data, v_stride, bmask_data,
+                                    innersize, src_itemsize, aligned);
+                continue;
+            }
             while (innersize > 0) {
                 /* Skip masked values */
                 subloopsize = 0;
@@ -904,6 +935,7 @@ array_ass_boolean_subscript(PyArrayObject *self,
                 v_data += subloopsize * v_stride;
             }
         } while (iternext(iter));
+        NPY_END_THREADS;
 
         NPY_AUXDATA_FREE(transferdata);
         NpyIter_Deallocate(iter);
@@ -981,13 +1013,339 @@ _check_ellipses(PyObject *op)
     return NPY_FALSE;
 }
 
+/*
+ * Fast path for the common integer array indexing a[ind] and
+ * a[:, ..., :, ind, :, ...], where a single integer index array (or list)
+ * is combined with full slices only.  The indexed axis is replaced by the
+ * dimensions of the index, so every element of the index selects one
+ * contiguous block of the trailing dimensions for every position of the
+ * leading ones, and the blocks can be copied directly in the final layout
+ * instead of element by element through a map iterator.
+ */
+
+/*
+ * Checks if 'op' is a single integer index combined with full slices.
+ * Returns 1 and sets the C contiguous, in-bounds indices and the indexed
+ * axis if so, 0 if the index has to take the general path and -1 on error.
+ */
+static int
+_single_fancy_index(PyArrayObject *self, PyObject *op,
+                    PyArrayObject **indices, int *axis)
+{
+    PyObject *indexobj = NULL;
+    PyArrayObject *arr;
+    npy_intp *ind, dim, n, i;
+    int ndim = PyArray_NDIM(self), nindex = 1, oned;
+
+    if (PyTuple_Check(op)) {
+        nindex = PyTuple_GET_SIZE(op);
+        if (nindex > ndim) {
+            return 0;
+        }
+        for (i = 0; i < nindex; i++) {
+            PyObject *obj = PyTuple_GET_ITEM(op, i);
+            PySliceObject *slice = (PySliceObject *)obj;
+
+            if (PySlice_Check(obj) && slice->start == Py_None &&
+                    slice->stop == Py_None && slice->step == Py_None) {
+                continue;
+            }
+            if (indexobj != NULL) {
+                return 0;
+            }
+            indexobj = obj;
+            *axis = i;
+        }
+    }
+    else {
+        indexobj = op;
+        *axis = 0;
+    }
+    if (indexobj == NULL ||
+            !(PyList_Check(indexobj) || PyArray_Check(indexobj)) ||
+            (PyArray_Check(indexobj) &&
+                    PyArray_ISBOOL((PyArrayObject *)indexobj)) ||
+            PyDataType_REFCHK(PyArray_DESCR(self))) {
+        return 0;
+    }
+    /* the same conversion as in PyArray_MapIterNew */
+    arr = (PyArrayObject *)PyArray_FromAny(indexobj,
+                                PyArray_DescrFromType(NPY_INTP), 0, 0,
+                                NPY_ARRAY_FORCECAST | NPY_ARRAY_CARRAY, NULL);
+    if (arr == NULL) {
+        return -1;
+    }
+    if (ndim - 1 + PyArray_NDIM(arr) > NPY_MAXDIMS) {
+        Py_DECREF(arr);
+        return 0;
+    }
+
+    /* check the indices once, before any data is copied */
+    dim = PyArray_DIM(self, *axis);
+    n = PyArray_SIZE(arr);
+    ind = (npy_intp *)PyArray_DATA(arr);
+    for (i = 0; i < ndim; i++) {
+        if (i != *axis) {
+            n *= PyArray_DIM(self, i);
+        }
+    }
+    if (PyArray_SIZE(self) == 0 && n != 0) {
+        PyErr_SetString(PyExc_IndexError,
+                        "invalid index into a 0-size array");
+        Py_DECREF(arr);
+        return -1;
+    }
+    n = PyArray_SIZE(arr);
+    /* the one-dimensional case reports errors like the flat iterator */
+    oned = (ndim == 1 && nindex == 1);
+    for (i = 0; i < n; i++) {
+        npy_intp v = ind[i];
+
+        if (v < -dim || v >= dim) {
+            check_and_adjust_index(&v, dim, oned ? -1 : *axis);
+            Py_DECREF(arr);
+            return -1;
+        }
+        if (v < 0) {
+            break;
+        }
+    }
+    if (i < n) {
+        /* wrap negative indices in a private copy */
+        if ((PyObject *)arr == indexobj) {
+            PyArrayObject *copy;
+
+            copy = (PyArrayObject *)PyArray_NewCopy(arr, NPY_CORDER);
+            Py_DECREF(arr);
+            if (copy == NULL) {
+                return -1;
+            }
+            arr = copy;
+            ind = (npy_intp *)PyArray_DATA(arr);
+        }
+        for (; i < n; i++) {
+            npy_intp v = ind[i];
+
+            if (v < -dim || v >= dim) {
+                check_and_adjust_index(&v, dim, oned ? -1 : *axis);
+                Py_DECREF(arr);
+                return -1;
+            }
+            if (v < 0) {
+                ind[i] = v + dim;
+            }
+        }
+    }
+    *indices = arr;
+    return 1;
+}
+
+/*
+ * Fills in the part of the info describing the indexed array, returns
+ * 0 if the trailing dimensions are not contiguous.
+ */
+static int
+_index_copy_info_init(npy_index_copy_info *info, PyArrayObject *self,
+                      PyArrayObject *indices, int axis)
+{
+    int ndim = PyArray_NDIM(self), itemsize = PyArray_ITEMSIZE(self);
+    npy_intp *shape = PyArray_DIMS(self), *strides = PyArray_STRIDES(self);
+    npy_intp chunk = itemsize;
+    int i;
+
+    for (i = ndim - 1; i > axis; i--) {
+        if (shape[i] != 1 && strides[i] != chunk) {
+            return 0;
+        }
+        chunk *= shape[i];
+    }
+    info->data = PyArray_BYTES(self);
+    info->nouterdim = axis;
+    info->nouter = 1;
+    for (i = 0; i < axis; i++) {
+        info->outershape[i] = shape[i];
+        info->outerstrides[i] = strides[i];
+        info->nouter *= shape[i];
+    }
+    info->axisstride = strides[axis];
+    info->ind = (npy_intp *)PyArray_DATA(indices);
+    info->nind = PyArray_SIZE(indices);
+    info->chunk = chunk;
+    info->typed = npy_index_copy_typed(self, chunk);
+    return 1;
+}
+
+/*
+ * Returns a[ind] or a[:, ..., ind] for an index accepted by
+ * _single_fancy_index, or Py_NotImplemented (a new reference) if the
+ * array does not allow the direct copy.
+ */
+static PyObject *
+array_subscript_single_fancy(PyArrayObject *self, PyArrayObject *indices,
+                             int axis)
+{
+    npy_index_copy_info info;
+    PyArrayObject *ret;
+    npy_intp shape[NPY_MAXDIMS];
+    int ndim = PyArray_NDIM(self), nd;
+
+    if (PyArray_ISFORTRAN(self) ||
+            !_index_copy_info_init(&info, self, indices, axis)) {
+        Py_INCREF(Py_NotImplemented);
+        return Py_NotImplemented;
+    }
+    nd = PyArray_NDIM(indices);
+    memcpy(shape, PyArray_DIMS(self), axis * sizeof(npy_intp));
+    memcpy(shape + axis, PyArray_DIMS(indices), nd * sizeof(npy_intp));
+    memcpy(shape + axis + nd, PyArray_DIMS(self) + axis + 1,
+           (ndim - axis - 1) * sizeof(npy_intp));
+
+    Py_INCREF(PyArray_DESCR(self));
+    ret = (PyArrayObject *)PyArray_NewFromDescr(Py_TYPE(self),
+                                PyArray_DESCR(self),
+                                ndim - 1 + nd, shape,
+                                NULL, NULL, 0, (PyObject *)self);
+    if (ret == NULL) {
+        return NULL;
+    }
+    if (PyArray_SIZE(ret) != 0) {
+        info.buf = PyArray_BYTES(ret);
+        info.period = info.nouter * info.nind * info.chunk;
+        info.gather = 1;
+        npy_index_copy(&info);
+    }
+    /* like the flat iterator, a 0-d index into a 1-d array gives a scalar */
+    if (PyArray_NDIM(ret) == 0) {
+        return PyArray_Return(ret);
+    }
+    return (PyObject *)ret;
+}
+
+/*
+ * Assigns op to a[ind] or a[:, ..., ind] for an index accepted by
+ * _single_fancy_index.  The values may be broadcast by repeating them
+ * along leading dimensions only, other values return 1 to take the
+ * general path.  Returns 0 on success and -1 on error.
+ */
+static int
+array_ass_sub_single_fancy(PyArrayObject *self, PyArrayObject *indices,
+                           int axis, PyObject *op)
+{
+    npy_index_copy_info info;
+    PyArrayObject *values = NULL;
+    PyArray_Descr *descr = PyArray_DESCR(self);
+    npy_intp shape[NPY_MAXDIMS], *vshape;
+    npy_intp vbytes;
+    char *block = NULL;
+    int ndim = PyArray_NDIM(self), nd, vnd, i;
+    int ret = 1;
+
+    if (!_index_copy_info_init(&info, self, indices, axis)) {
+        return 1;
+    }
+    nd = PyArray_NDIM(indices);
+    memcpy(shape, PyArray_DIMS(self), axis * sizeof(npy_intp));
+    memcpy(shape + axis, PyArray_DIMS(indices), nd * sizeof(npy_intp));
+    memcpy(shape + axis + nd, PyArray_DIMS(self) + axis + 1,
+           (ndim - axis - 1) * sizeof(npy_intp));
+    nd += ndim - 1;
+
+    /* the same conversion as in PyArray_SetMap */
+    Py_INCREF(descr);
+    values = (PyArrayObject *)PyArray_FromAny(op, descr, 0, 0,
+                                NPY_ARRAY_FORCECAST | NPY_ARRAY_CARRAY_RO,
+                                NULL);
+    if (values == NULL) {
+        return -1;
+    }
+    /* ignoring leading ones, the values must match the trailing shape */
+    vnd = PyArray_NDIM(values);
+    vshape = PyArray_DIMS(values);
+    while (vnd > 0 && vshape[0] == 1) {
+        vnd--;
+        vshape++;
+    }
+    if (vnd > nd || PyArray_NDIM(values) > nd) {
+        goto finish;
+    }
+    for (i = 0; i < vnd; i++) {
+        if (vshape[i] != shape[nd - vnd + i]) {
+            goto finish;
+        }
+    }
+    if (info.nouter * info.nind * info.chunk == 0) {
+        ret = 0;
+        goto finish;
+    }
+    if (arrays_overlap(self, values)) {
+        PyArrayObject *copy;
+
+        copy = (PyArrayObject *)PyArray_NewCopy(values, NPY_CORDER);
+        if (copy == NULL) {
+            ret = -1;
+            goto finish;
+        }
+        Py_DECREF(values);
+        values = copy;
+    }
+
+    vbytes = PyArray_NBYTES(values);
+    if (vbytes >= info.chunk) {
+        info.buf = PyArray_BYTES(values);
+        info.period = vbytes;
+    }
+    else {
+        /* the values repeat within every block, fill one block with them */
+        npy_intp k;
+
+        block = PyArray_malloc(info.chunk);
+        if (block == NULL) {
+            PyErr_NoMemory();
+            ret = -1;
+            goto finish;
+        }
+        for (k = 0; k < info.chunk; k += vbytes) {
+            memcpy(block + k, PyArray_BYTES(values), vbytes);
+        }
+        info.buf = block;
+        info.period = info.chunk;
+    }
+    if (info.typed && !PyArray_ISALIGNED(values)) {
+        info.typed = 0;
+    }
+    info.gather = 0;
+    npy_index_copy(&info);
+    ret = 0;
+
+ finish:
+    PyArray_free(block);
+    Py_DECREF(values);
+    return ret;
+}
+
 NPY_NO_EXPORT PyObject *
 array_subscript_fancy(PyArrayObject *self, PyObject *op, int fancy)
  {
-    int oned;
+    int oned, axis, single;
     PyObject *other;
     PyArrayMapIterObject *mit;
-    
+    PyArrayObject *indices;
+
+    if (fancy == SOBJ_ISFANCY) {
+        single = _single_fancy_index(self, op, &indices, &axis);
+        if (single < 0) {
+            return NULL;
+        }
+        if (single) {
+            other = array_subscript_single_fancy(self, indices, axis);
+            Py_DECREF(indices);
+            if (other != Py_NotImplemented) {
+                return other;
+            }
+            Py_DECREF(other);
+        }
+    }
+
     oned = ((PyArray_NDIM(self) == 1) &&
             !(PyTuple_Check(op) && PyTuple_GET_SIZE(op) > 1));
 
@@ -1298,8 +1656,24 @@ array_ass_sub_simple(PyArrayObject *self, PyObject *ind, PyObject *op)
 static int
 array_ass_sub_fancy(PyArrayObject *self, PyObject *ind, PyObject *op, int fancy)
 {
-    int oned, ret;
+    int oned, ret, axis;
     PyArrayMapIterObject *mit;
+    PyArrayObject *indices;
+
+    if (fancy == SOBJ_ISFANCY) {
+        ret = _single_fancy_index(self, ind, &indices, &axis);
+        if (ret < 0) {
+            return -1;
+        }
+        if (ret) {
+            ret = array_ass_sub_single_fancy(self, indices, axis, op);
+            Py_DECREF(indices);
+            if (ret <= 0) {
+                return ret;
+            }
+        }
+    }
+
     oned = ((PyArray_NDIM(self) == 1) &&
             !(PyTuple_Check(ind) && PyTuple_GET_SIZE(ind) > 1));
     mit = (PyArrayMapIterObject *) PyArray_MapIterNew(ind, oned, fancy);
@@ -53,6 +53,7 @@ NPY_NO_EXPORT int NPY_NUMUSERTYPES = 0;
 #include "ctors.h"
 #include "array_assign.h"
 #include "common.h"
+#include "threadpool.h"
 
 /* Only here for API compatibility */
 NPY_NO_EXPORT PyTypeObject PyBigArray_Type;
@@ -1938,6 +1939,56 @@ array_count_nonzero(PyObject *NPY_UNUSED(self), PyObject *args, PyObject *kwds)
 #endif
 }
 
+static PyObject *
+array_minmax(PyObject *NPY_UNUSED(self), PyObject *args, PyObject *kwds)
+{
+    PyObject *array_in, *ret;
+    PyArrayObject *array;
+    int axis = NPY_MAXDIMS;
+    static char *kwlist[] = {"a", "axis", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O&", kwlist,
+                &array_in, PyArray_AxisConverter, &axis)) {
+        return NULL;
+    }
+
+    array = (PyArrayObject *)PyArray_FromAny(array_in, NULL, 0, 0, 0, NULL);
+    if (array == NULL) {
+        return NULL;
+    }
+
+    ret = PyArray_MinMax(array, axis);
+
+    Py_DECREF(array);
+    return ret;
+}
+
+static PyObject *
+array_topk(PyObject *NPY_UNUSED(self), PyObject *args, PyObject *kwds)
+{
+    PyObject *array_in, *ret;
+    PyArrayObject *array;
+    npy_intp k;
+    int axis = -1, largest = 1, sorted = 1;
+    static char *kwlist[] = {"a", "k", "axis", "largest", "sorted", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O" NPY_SSIZE_T_PYFMT "|O&ii",
+                kwlist, &array_in, &k, PyArray_AxisConverter, &axis,
+                &largest, &sorted)) {
+        return NULL;
+    }
+
+    array = (PyArrayObject *)PyArray_FromAny(array_in, NULL, 0, 0, 0, NULL);
+    if (array == NULL) {
+        return NULL;
+    }
+
+    ret = PyArray_TopK(array, k, axis, largest, sorted);
+
+    Py_DECREF(array);
+    return ret;
+}
+
 static PyObject *
 array_fromstring(PyObject *NPY_UNUSED(ignored), PyObject *args, PyObject *keywds)
 {
@@ -3569,6 +3620,9 @@ static struct PyMethodDef array_module_methods[] = {
     {"_reconstruct",
         (PyCFunction)array__reconstruct,
         METH_VARARGS, NULL},
+    {"_default_buffersize",
+        (PyCFunction)NpyIter_DefaultBufferSize,
+        METH_NOARGS, NULL},
     {"set_string_function",
         (PyCFunction)array_set_string_function,
         METH_VARARGS|METH_KEYWORDS, NULL},
@@ -3599,6 +3653,12 @@ static struct PyMethodDef array_module_methods[] = {
     {"count_nonzero",
         (PyCFunction)array_count_nonzero,
         METH_VARARGS|METH_KEYWORDS, NULL},
+    {"minmax",
+        (PyCFunction)array_minmax,
+        METH_VARARGS|METH_KEYWORDS, NULL},
+    {"topk",
+        (PyCFunction)array_topk,
+        METH_VARARGS|METH_KEYWORDS, NULL},
     {"empty",
         (PyCFunction)array_empty,
         METH_VARARGS|METH_KEYWORDS, NULL},
@@ -3705,6 +3765,12 @@ static struct PyMethodDef array_module_methods[] = {
     {"test_interrupt",
         (PyCFunction)test_interrupt,
         METH_VARARGS, NULL},
+    {"setnumthreads",
+        (PyCFunction)array_setnumthreads,
+        METH_VARARGS, NULL},
+    {"getnumthreads",
+        (PyCFunction)array_getnumthreads,
+        METH_VARARGS, NULL},
     {NULL, NULL, 0, NULL}                /* sentinel */
 };
 
@@ -3955,6 +4021,10 @@ PyMODINIT_FUNC initmultiarray(void) {
     /* Initialize access to the PyDateTime API */
     numpy_pydatetime_import();
 
+    if (_npy_threadpool_init() < 0) {
+        goto err;
+    }
+
     /* Add some symbolic constants to the module */
     d = PyModule_GetDict(m);
     if (!d) {
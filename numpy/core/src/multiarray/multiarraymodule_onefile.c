@@ -37,6 +37,7 @@
 #include "refcount.c"
 #include "conversion_utils.c"
 #include "buffer.c"
+#include "threadpool.c"
 
 #include "nditer_constr.c"
 #include "nditer_api.c"
@@ -17,6 +17,14 @@
 
 #include "arrayobject.h"
 
+#if defined(__APPLE__)
+#include <sys/sysctl.h>
+#endif
+
+/* Limits of the automatically chosen buffer size, in elements */
+#define NPY_ITER_MIN_AUTO_BUFSIZE (NPY_BUFSIZE / 8)
+#define NPY_ITER_MAX_AUTO_BUFSIZE (NPY_BUFSIZE * 8)
+
 /* Internal helper functions private to this file */
 static int
 npyiter_check_global_flags(npy_uint32 flags, npy_uint32* itflags);
@@ -45,6 +53,9 @@ npyiter_prepare_operands(int nop,
                     npy_uint32 flags,
                     npy_uint32 *op_flags, npyiter_opitflags *op_itflags,
                     npy_int8 *out_maskop);
+static npy_intp
+npyiter_default_buffersize(int nop, PyArrayObject **op,
+                    PyArray_Descr **op_dtype);
 static int
 npyiter_check_casting(int nop, PyArrayObject **op,
                     PyArray_Descr **op_dtype,
@@ -253,7 +264,7 @@ NpyIter_AdvancedNew(int nop, PyArrayObject **op_in, npy_uint32 flags,
          * small enough to be cache-friendly.
          */
         if (buffersize <= 0) {
-            buffersize = NPY_BUFSIZE;
+            buffersize = npyiter_default_buffersize(nop, op, op_dtype);
         }
         /* No point in a buffer bigger than the iteration size */
         if (buffersize > NIT_ITERSIZE(iter)) {
@@ -1304,6 +1315,108 @@ npyiter_shape_string(npy_intp n, npy_intp *vals, char *ending)
     return ret;
 }
 
+/*
+ * Returns the size of the L2 cache in bytes, or 0 if it is unknown.
+ */
+static npy_intp
+npyiter_l2_cache_size(void)
+{
+    static npy_intp l2_size = -1;
+
+    if (l2_size < 0) {
+        npy_intp size = 0;
+#if defined(_SC_LEVEL2_CACHE_SIZE)
+        long res = sysconf(_SC_LEVEL2_CACHE_SIZE);
+
+        if (res > 0) {
+            size = res;
+        }
+#elif defined(__APPLE__)
+        npy_int64 res = 0;
+        size_t len = sizeof(res);
+
+        if (sysctlbyname("hw.l2cachesize", &res, &len, NULL, 0) == 0 &&
+                                                            res > 0) {
+            size = (npy_intp)res;
+        }
+#endif
+        l2_size = size;
+    }
+    return l2_size;
+}
+
+/*
+ * Returns the buffer size for which one buffer's worth of elements
+ * taking 'elsize' bytes in total fills about half of the L2 cache,
+ * or NPY_BUFSIZE without a known cache size.
+ */
+static npy_intp
+npyiter_l2_buffersize(npy_intp elsize)
+{
+    npy_intp l2_size = npyiter_l2_cache_size();
+    npy_intp buffersize;
+
+    if (l2_size <= 0) {
+        return NPY_BUFSIZE;
+    }
+    if (elsize < 1) {
+        elsize = 1;
+    }
+
+    buffersize = (l2_size / 2 / elsize) & ~(npy_intp)15;
+    if (buffersize < NPY_ITER_MIN_AUTO_BUFSIZE) {
+        buffersize = NPY_ITER_MIN_AUTO_BUFSIZE;
+    }
+    else if (buffersize > NPY_ITER_MAX_AUTO_BUFSIZE) {
+        buffersize = NPY_ITER_MAX_AUTO_BUFSIZE;
+    }
+    return buffersize;
+}
+
+/*
+ * Chooses the buffer size used when none was requested.  One buffer's
+ * worth of elements of all the operands, counting both the buffers
+ * and the array data they are copied from, should take about half of
+ * the L2 cache, so that a mixed-type loop with many or wide operands
+ * doesn't thrash it, while one with few narrow operands gets longer
+ * inner loops.
+ */
+static npy_intp
+npyiter_default_buffersize(int nop, PyArrayObject **op,
+                    PyArray_Descr **op_dtype)
+{
+    npy_intp elsize = 0;
+    int iop;
+
+    for (iop = 0; iop < nop; ++iop) {
+        /* Operands allocated later with a dtype still unknown */
+        if (op_dtype[iop] == NULL) {
+            elsize += sizeof(npy_double);
+        }
+        else {
+            elsize += op_dtype[iop]->elsize;
+        }
+        if (op[iop] != NULL) {
+            elsize += PyArray_DESCR(op[iop])->elsize;
+        }
+    }
+    return npyiter_l2_buffersize(elsize);
+}
+
+/*
+ * Implements numpy.core.multiarray._default_buffersize, the buffer size
+ * an iterator chooses when none is requested for two inputs and an
+ * output of doubles.  numpy.getbufsize reports it for the default
+ * buffer size of 0.
+ */
+NPY_NO_EXPORT PyObject *
+NpyIter_DefaultBufferSize(PyObject *NPY_UNUSED(self),
+                          PyObject *NPY_UNUSED(args))
+{
+    return PyInt_FromLong(
+            (long)npyiter_l2_buffersize(2 * 3 * sizeof(npy_double)));
+}
+
 static int
 npyiter_check_casting(int nop, PyArrayObject **op,
                     PyArray_Descr **op_dtype,
@@ -1914,6 +1914,17 @@ static PyObject *npyiter_itersize_get(NewNpyArrayIterObject *self)
     return PyInt_FromLong(NpyIter_GetIterSize(self->iter));
 }
 
+static PyObject *npyiter_buffersize_get(NewNpyArrayIterObject *self)
+{
+    if (self->iter == NULL) {
+        PyErr_SetString(PyExc_ValueError,
+                "Iterator is invalid");
+        return NULL;
+    }
+
+    return PyInt_FromLong(NpyIter_GetBufferSize(self->iter));
+}
+
 static PyObject *npyiter_finished_get(NewNpyArrayIterObject *self)
 {
     if (self->iter == NULL || !self->finished) {
@@ -2389,6 +2400,9 @@ static PyGetSetDef npyiter_getsets[] = {
     {"itersize",
         (getter)npyiter_itersize_get,
         NULL, NULL, NULL},
+    {"buffersize",
+        (getter)npyiter_buffersize_get,
+        NULL, NULL, NULL},
     {"finished",
         (getter)npyiter_finished_get,
         NULL, NULL, NULL},
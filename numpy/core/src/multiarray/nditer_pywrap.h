@@ -5,4 +5,8 @@ NPY_NO_EXPORT PyObject *
 NpyIter_NestedIters(PyObject *NPY_UNUSED(self),
                     PyObject *args, PyObject *kwds);
 
+NPY_NO_EXPORT PyObject *
+NpyIter_DefaultBufferSize(PyObject *NPY_UNUSED(self),
+                          PyObject *NPY_UNUSED(args));
+
 #endif
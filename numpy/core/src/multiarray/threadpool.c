@@ -0,0 +1,350 @@
+/*
+ * This file implements a small fork-join thread pool used to split
+ * GIL-free inner loops (ufunc loops, reductions, sorts, ...) across
+ * several threads.
+ *
+ * The pool is opt-in: it starts with a single thread (the caller),
+ * which makes every parallel region run serially inline.  The number
+ * of threads is controlled with PyArray_SetNumThreads (or
+ * numpy.setnumthreads from Python), and initialized from the
+ * NPY_NUM_THREADS environment variable at import time.
+ *
+ * Worker threads never touch Python objects.  A parallel region is
+ * described by a task function and an opaque data pointer, and the
+ * tasks 0 .. ntasks-1 are handed out dynamically to the workers and
+ * the calling thread.  The call returns once every task has finished.
+ *
+ * Only one parallel region can be active at a time.  If the pool is
+ * already busy (another Python thread is using it, or a task itself
+ * tries to start a nested region), the tasks are simply executed
+ * serially by the calling thread.
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#define NPY_NO_DEPRECATED_API NPY_API_VERSION
+#define _MULTIARRAYMODULE
+#include "numpy/arrayobject.h"
+
+#include "npy_config.h"
+#include "npy_pycompat.h"
+
+#include "threadpool.h"
+
+#include <stdlib.h>
+
+#if !defined(_WIN32)
+#define NPY_HAVE_THREADPOOL 1
+#include <pthread.h>
+#else
+#define NPY_HAVE_THREADPOOL 0
+#endif
+
+/* The requested number of threads, including the calling thread */
+static int npy_num_threads = 1;
+
+#if NPY_HAVE_THREADPOOL
+
+typedef struct {
+    PyArray_ParallelTaskFunc *func;
+    void *data;
+    npy_intp ntasks;
+    /* The next task to be handed out */
+    npy_intp next;
+    /* The number of workers still running tasks of this region */
+    int active;
+} npy_parallel_region;
+
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pool_work_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t pool_done_cond = PTHREAD_COND_INITIALIZER;
+/* Held by the thread running a parallel region */
+static pthread_mutex_t pool_busy = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_t *pool_workers = NULL;
+static int pool_nworkers = 0;
+/* Incremented for every new region, so workers can spot new work */
+static npy_uintp pool_generation = 0;
+/* The generation at the time the current workers were started */
+static npy_uintp pool_start_generation = 0;
+static int pool_shutdown = 0;
+static npy_parallel_region pool_region;
+
+/*
+ * Hands out tasks of the current region until none are left.
+ * Must be called with pool_lock held, returns with it held.
+ */
+static void
+run_region_tasks(npy_parallel_region *region)
+{
+    while (region->next < region->ntasks) {
+        npy_intp itask = region->next++;
+
+        pthread_mutex_unlock(&pool_lock);
+        region->func(region->data, itask);
+        pthread_mutex_lock(&pool_lock);
+    }
+}
+
+static void *
+pool_worker_main(void *NPY_UNUSED(arg))
+{
+    npy_uintp seen_generation;
+
+    pthread_mutex_lock(&pool_lock);
+    seen_generation = pool_start_generation;
+    for (;;) {
+        while (!pool_shutdown && seen_generation == pool_generation) {
+            pthread_cond_wait(&pool_work_cond, &pool_lock);
+        }
+        if (pool_shutdown) {
+            break;
+        }
+        seen_generation = pool_generation;
+
+        run_region_tasks(&pool_region);
+
+        if (--pool_region.active == 0) {
+            pthread_cond_signal(&pool_done_cond);
+        }
+    }
+    pthread_mutex_unlock(&pool_lock);
+
+    return NULL;
+}
+
+/*
+ * Stops and joins all the worker threads.  The caller must hold
+ * pool_busy, so no region is running.
+ */
+static void
+pool_stop(void)
+{
+    int i;
+
+    if (pool_nworkers == 0) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool_lock);
+    pool_shutdown = 1;
+    pthread_cond_broadcast(&pool_work_cond);
+    pthread_mutex_unlock(&pool_lock);
+
+    for (i = 0; i < pool_nworkers; ++i) {
+        pthread_join(pool_workers[i], NULL);
+    }
+    free(pool_workers);
+    pool_workers = NULL;
+    pool_nworkers = 0;
+    pool_shutdown = 0;
+}
+
+/*
+ * Starts 'nworkers' worker threads.  The caller must hold pool_busy.
+ * If some threads fail to start, the pool just runs with fewer.
+ */
+static void
+pool_start(int nworkers)
+{
+    int i;
+
+    pool_workers = malloc(nworkers * sizeof(pthread_t));
+    if (pool_workers == NULL) {
+        return;
+    }
+    pool_start_generation = pool_generation;
+    for (i = 0; i < nworkers; ++i) {
+        if (pthread_create(&pool_workers[i], NULL,
+                            &pool_worker_main, NULL) != 0) {
+            break;
+        }
+    }
+    pool_nworkers = i;
+}
+
+/*
+ * After a fork only the forking thread exists in the child, so the
+ * pool state is reset and the workers will be started again lazily.
+ */
+static void
+pool_atfork_child(void)
+{
+    pthread_mutex_init(&pool_lock, NULL);
+    pthread_mutex_init(&pool_busy, NULL);
+    pthread_cond_init(&pool_work_cond, NULL);
+    pthread_cond_init(&pool_done_cond, NULL);
+    free(pool_workers);
+    pool_workers = NULL;
+    pool_nworkers = 0;
+    pool_shutdown = 0;
+}
+
+#endif /* NPY_HAVE_THREADPOOL */
+
+/*NUMPY_API
+ * Returns the number of threads (including the calling thread) which
+ * parallel regions started with PyArray_ParallelRun use.
+ */
+NPY_NO_EXPORT int
+PyArray_GetNumThreads(void)
+{
+    return npy_num_threads;
+}
+
+/*NUMPY_API
+ * Sets the number of threads (including the calling thread) used by
+ * PyArray_ParallelRun.  A value of 1 disables multithreading.
+ *
+ * Returns the previous value, or -1 with an exception set if
+ * 'nthreads' is invalid.  Must be called with the GIL held.
+ */
+NPY_NO_EXPORT int
+PyArray_SetNumThreads(int nthreads)
+{
+    int old = npy_num_threads;
+
+    if (nthreads < 1 || nthreads > NPY_MAX_THREADS) {
+        PyErr_Format(PyExc_ValueError,
+                "number of threads must be between 1 and %d, got %d",
+                NPY_MAX_THREADS, nthreads);
+        return -1;
+    }
+#if NPY_HAVE_THREADPOOL
+    if (nthreads != old) {
+        NPY_BEGIN_THREADS_DEF;
+
+        /* Wait for any running region to complete */
+        NPY_BEGIN_THREADS;
+        pthread_mutex_lock(&pool_busy);
+        pool_stop();
+        npy_num_threads = nthreads;
+        pthread_mutex_unlock(&pool_busy);
+        NPY_END_THREADS;
+    }
+#else
+    npy_num_threads = nthreads;
+#endif
+    return old;
+}
+
+/*NUMPY_API
+ * Returns the number of tasks into which an operation over 'size'
+ * elements should be split, so that every task processes at least
+ * 'minchunk' elements.  Returns 1 when the operation should run
+ * serially.
+ */
+NPY_NO_EXPORT int
+PyArray_ParallelTaskCount(npy_intp size, npy_intp minchunk)
+{
+    npy_intp ntasks;
+
+    if (npy_num_threads <= 1) {
+        return 1;
+    }
+    if (minchunk < 1) {
+        minchunk = 1;
+    }
+    ntasks = size / minchunk;
+    if (ntasks > npy_num_threads) {
+        ntasks = npy_num_threads;
+    }
+    return ntasks < 1 ? 1 : (int)ntasks;
+}
+
+/*NUMPY_API
+ * Calls func(data, itask) for every itask in 0 .. ntasks-1, spreading
+ * the calls over the thread pool.  Returns when all tasks are done.
+ *
+ * The task function is run without the GIL and must not use the
+ * Python API.  The order in which tasks are run is unspecified.  The
+ * calling thread should release the GIL before calling this, so that
+ * other Python threads can run while it waits.
+ */
+NPY_NO_EXPORT void
+PyArray_ParallelRun(PyArray_ParallelTaskFunc *func, void *data,
+                    npy_intp ntasks)
+{
+    npy_intp itask;
+
+#if NPY_HAVE_THREADPOOL
+    if (ntasks > 1 && npy_num_threads > 1 &&
+                        pthread_mutex_trylock(&pool_busy) == 0) {
+        if (pool_nworkers == 0) {
+            pool_start(npy_num_threads - 1);
+        }
+        if (pool_nworkers > 0) {
+            pthread_mutex_lock(&pool_lock);
+            pool_region.func = func;
+            pool_region.data = data;
+            pool_region.ntasks = ntasks;
+            pool_region.next = 0;
+            pool_region.active = pool_nworkers;
+            pool_generation++;
+            pthread_cond_broadcast(&pool_work_cond);
+
+            /* The calling thread works on the region too */
+            run_region_tasks(&pool_region);
+
+            while (pool_region.active > 0) {
+                pthread_cond_wait(&pool_done_cond, &pool_lock);
+            }
+            pthread_mutex_unlock(&pool_lock);
+            pthread_mutex_unlock(&pool_busy);
+            return;
+        }
+        pthread_mutex_unlock(&pool_busy);
+    }
+#endif
+
+    for (itask = 0; itask < ntasks; ++itask) {
+        func(data, itask);
+    }
+}
+
+NPY_NO_EXPORT int
+_npy_threadpool_init(void)
+{
+    char *env = getenv("NPY_NUM_THREADS");
+
+#if NPY_HAVE_THREADPOOL
+    if (pthread_atfork(NULL, NULL, &pool_atfork_child) != 0) {
+        PyErr_SetString(PyExc_RuntimeError,
+                "could not register the numpy thread pool fork handler");
+        return -1;
+    }
+#endif
+    if (env != NULL && *env != '\0') {
+        long nthreads = strtol(env, NULL, 10);
+
+        if (nthreads >= 1 && nthreads <= NPY_MAX_THREADS) {
+            npy_num_threads = (int)nthreads;
+        }
+    }
+    return 0;
+}
+
+NPY_NO_EXPORT PyObject *
+array_getnumthreads(PyObject *NPY_UNUSED(ignored), PyObject *args)
+{
+    if (!PyArg_ParseTuple(args, "")) {
+        return NULL;
+    }
+    return PyInt_FromLong(PyArray_GetNumThreads());
+}
+
+NPY_NO_EXPORT PyObject *
+array_setnumthreads(PyObject *NPY_UNUSED(ignored), PyObject *args)
+{
+    int nthreads, old;
+
+    if (!PyArg_ParseTuple(args, "i", &nthreads)) {
+        return NULL;
+    }
+    old = PyArray_SetNumThreads(nthreads);
+    if (old < 0) {
+        return NULL;
+    }
+    return PyInt_FromLong(old);
+}
@@ -0,0 +1,30 @@
+#ifndef _NPY_PRIVATE_THREADPOOL_H_
+#define _NPY_PRIVATE_THREADPOOL_H_
+
+/* Upper limit accepted by PyArray_SetNumThreads */
+#define NPY_MAX_THREADS 1024
+
+NPY_NO_EXPORT int
+PyArray_GetNumThreads(void);
+
+NPY_NO_EXPORT int
+PyArray_SetNumThreads(int nthreads);
+
+NPY_NO_EXPORT int
+PyArray_ParallelTaskCount(npy_intp size, npy_intp minchunk);
+
+NPY_NO_EXPORT void
+PyArray_ParallelRun(PyArray_ParallelTaskFunc *func, void *data,
+                    npy_intp ntasks);
+
+/* Reads NPY_NUM_THREADS and installs the fork handler */
+NPY_NO_EXPORT int
+_npy_threadpool_init(void);
+
+NPY_NO_EXPORT PyObject *
+array_getnumthreads(PyObject *NPY_UNUSED(ignored), PyObject *args);
+
+NPY_NO_EXPORT PyObject *
+array_setnumthreads(PyObject *NPY_UNUSED(ignored), PyObject *args);
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef __NPY_BINSEARCH_H__
+#define __NPY_BINSEARCH_H__
+
+#include <Python.h>
+#include <numpy/npy_common.h>
+#include <numpy/ndarraytypes.h>
+
+/*
+ * Typed searchsorted kernels, looked up by type number like the
+ * partition functions.  arr holds arr_len sorted values, key key_len
+ * values to search for, both contiguous and of the type of the kernel;
+ * the insertion indices are written to ret.  The argbinsearch variants
+ * go through the sorter indices and return -1 if one is out of range.
+ */
+typedef void (PyArray_BinSearchFunc)(const char *arr, const char *key,
+                                     npy_intp *ret, npy_intp arr_len,
+                                     npy_intp key_len);
+typedef int (PyArray_ArgBinSearchFunc)(const char *arr, const char *key,
+                                       const npy_intp *sorter, npy_intp *ret,
+                                       npy_intp arr_len, npy_intp key_len);
+
+PyArray_BinSearchFunc *get_binsearch_func(int type_num, NPY_SEARCHSIDE side);
+PyArray_ArgBinSearchFunc *get_argbinsearch_func(int type_num,
+                                                NPY_SEARCHSIDE side);
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef __NPY_PARTITION_H__
+#define __NPY_PARTITION_H__
+
+#include <Python.h>
+#include <numpy/npy_common.h>
+#include <numpy/ndarraytypes.h>
+
+/*
+ * The partition functions are looked up by type number rather than
+ * stored in PyArray_ArrFuncs, whose layout is part of the ABI.
+ */
+typedef int (PyArray_PartitionFunc)(void *, npy_intp, npy_intp, void *);
+typedef int (PyArray_ArgPartitionFunc)(void *, npy_intp *, npy_intp,
+                                       npy_intp, void *);
+
+PyArray_PartitionFunc *get_partition_func(int type_num, NPY_SELECTKIND which);
+PyArray_ArgPartitionFunc *get_argpartition_func(int type_num,
+                                                NPY_SELECTKIND which);
+
+/*
+ * The top k functions store the indices of the k largest, or smallest,
+ * of the num values at v in ind, best first if sorted is true.
+ */
+typedef int (PyArray_ArgTopkFunc)(void *v, npy_intp num, npy_intp k,
+                                  npy_intp *ind, int largest, int sorted,
+                                  void *arr);
+
+PyArray_ArgTopkFunc *get_argtopk_func(int type_num);
+int npy_atopk(void *v, npy_intp num, npy_intp k, npy_intp *ind,
+              int largest, int sorted, void *arr);
+
+int introselect_bool(npy_bool *vec, npy_intp cnt, npy_intp kth, void *null);
+int aintroselect_bool(npy_bool *vec, npy_intp *ind, npy_intp cnt, npy_intp kth, void *null);
+
+int introselect_byte(npy_byte *vec, npy_intp cnt, npy_intp kth, void *null);
+int aintroselect_byte(npy_byte *vec, npy_intp *ind, npy_intp cnt, npy_intp kth, void *null);
+
+int introselect_ubyte(npy_ubyte *vec, npy_intp cnt, npy_intp kth, void *null);
+int aintroselect_ubyte(npy_ubyte *vec, npy_intp *ind, npy_intp cnt, npy_intp kth, void *null);
+
+int introselect_short(npy_short *vec, npy_intp cnt, npy_intp kth, void *null);
+int aintroselect_short(npy_short *vec, npy_intp *ind, npy_intp cnt, npy_intp kth, void *null);
+
+int introselect_ushort(npy_ushort *vec, npy_intp cnt, npy_intp kth, void *null);
+int aintroselect_ushort(npy_ushort *vec, npy_intp *ind, npy_intp cnt, npy_intp kth, void *null);
+
+int introselect_int(npy_int *vec, npy_intp cnt, npy_intp kth, void *null);
+int aintroselect_int(npy_int *vec, npy_intp *ind, npy_intp cnt, npy_intp kth, void *null);
+
+int introselect_uint(npy_uint *vec, npy_intp cnt, npy_intp kth, void *null);
+int aintroselect_uint(npy_uint *vec, npy_intp *ind, npy_intp cnt, npy_intp kth, void *null);
+
+int introselect_long(npy_long *vec, npy_intp cnt, npy_intp kth, void *null);
+int aintroselect_long(npy_long *vec, npy_intp *ind, npy_intp cnt, npy_intp kth, void *null);
+
+int introselect_ulong(npy_ulong *vec, npy_intp cnt, npy_intp kth, void *null);
+int aintroselect_ulong(npy_ulong *vec, npy_intp *ind, npy_intp cnt, npy_intp kth, void *null);
+
+int introselect_longlong(npy_longlong *vec, npy_intp cnt, npy_intp kth, void *null);
+int aintroselect_longlong(npy_longlong *vec, npy_intp *ind, npy_intp cnt, npy_intp kth, void *null);
+
+int introselect_ulonglong(npy_ulonglong *vec, npy_intp cnt, npy_intp kth, void *null);
+int aintroselect_ulonglong(npy_ulonglong *vec, npy_intp *ind, npy_intp cnt, npy_intp kth, void *null);
+
+int introselect_half(npy_ushort *vec, npy_intp cnt, npy_intp kth, void *null);
+int aintroselect_half(npy_ushort *vec, npy_intp *ind, npy_intp cnt, npy_intp kth, void *null);
+
+int introselect_float(npy_float *vec, npy_intp cnt, npy_intp kth, void *null);
+int aintroselect_float(npy_float *vec, npy_intp *ind, npy_intp cnt, npy_intp kth, void *null);
+
+int introselect_double(npy_double *vec, npy_intp cnt, npy_intp kth, void *null);
+int aintroselect_double(npy_double *vec, npy_intp *ind, npy_intp cnt, npy_intp kth, void *null);
+
+int introselect_longdouble(npy_longdouble *vec, npy_intp cnt, npy_intp kth, void *null);
+int aintroselect_longdouble(npy_longdouble *vec, npy_intp *ind, npy_intp cnt, npy_intp kth, void *null);
+
+int introselect_cfloat(npy_cfloat *vec, npy_intp cnt, npy_intp kth, void *null);
+int aintroselect_cfloat(npy_cfloat *vec, npy_intp *ind, npy_intp cnt, npy_intp kth, void *null);
+
+int introselect_cdouble(npy_cdouble *vec, npy_intp cnt, npy_intp kth, void *null);
+int aintroselect_cdouble(npy_cdouble *vec, npy_intp *ind, npy_intp cnt, npy_intp kth, void *null);
+
+int introselect_clongdouble(npy_clongdouble *vec, npy_intp cnt, npy_intp kth, void *null);
+int aintroselect_clongdouble(npy_clongdouble *vec, npy_intp *ind, npy_intp cnt, npy_intp kth, void *null);
+
+#endif
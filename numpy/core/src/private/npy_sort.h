@@ -171,8 +171,84 @@ int aheapsort_unicode(npy_ucs4 *vec, npy_intp *ind, npy_intp cnt, PyArrayObject
 int amergesort_unicode(npy_ucs4 *vec, npy_intp *ind, npy_intp cnt, PyArrayObject *arr);
 
 
+int timsort_bool(npy_bool *vec, npy_intp cnt, void *null);
+int atimsort_bool(npy_bool *vec, npy_intp *ind, npy_intp cnt, void *null);
+int timsort_byte(npy_byte *vec, npy_intp cnt, void *null);
+int atimsort_byte(npy_byte *vec, npy_intp *ind, npy_intp cnt, void *null);
+int timsort_ubyte(npy_ubyte *vec, npy_intp cnt, void *null);
+int atimsort_ubyte(npy_ubyte *vec, npy_intp *ind, npy_intp cnt, void *null);
+int timsort_short(npy_short *vec, npy_intp cnt, void *null);
+int atimsort_short(npy_short *vec, npy_intp *ind, npy_intp cnt, void *null);
+int timsort_ushort(npy_ushort *vec, npy_intp cnt, void *null);
+int atimsort_ushort(npy_ushort *vec, npy_intp *ind, npy_intp cnt, void *null);
+int timsort_int(npy_int *vec, npy_intp cnt, void *null);
+int atimsort_int(npy_int *vec, npy_intp *ind, npy_intp cnt, void *null);
+int timsort_uint(npy_uint *vec, npy_intp cnt, void *null);
+int atimsort_uint(npy_uint *vec, npy_intp *ind, npy_intp cnt, void *null);
+int timsort_long(npy_long *vec, npy_intp cnt, void *null);
+int atimsort_long(npy_long *vec, npy_intp *ind, npy_intp cnt, void *null);
+int timsort_ulong(npy_ulong *vec, npy_intp cnt, void *null);
+int atimsort_ulong(npy_ulong *vec, npy_intp *ind, npy_intp cnt, void *null);
+int timsort_longlong(npy_longlong *vec, npy_intp cnt, void *null);
+int atimsort_longlong(npy_longlong *vec, npy_intp *ind, npy_intp cnt, void *null);
+int timsort_ulonglong(npy_ulonglong *vec, npy_intp cnt, void *null);
+int atimsort_ulonglong(npy_ulonglong *vec, npy_intp *ind, npy_intp cnt, void *null);
+int timsort_half(npy_ushort *vec, npy_intp cnt, void *null);
+int atimsort_half(npy_ushort *vec, npy_intp *ind, npy_intp cnt, void *null);
+int timsort_float(npy_float *vec, npy_intp cnt, void *null);
+int atimsort_float(npy_float *vec, npy_intp *ind, npy_intp cnt, void *null);
+int timsort_double(npy_double *vec, npy_intp cnt, void *null);
+int atimsort_double(npy_double *vec, npy_intp *ind, npy_intp cnt, void *null);
+int timsort_longdouble(npy_longdouble *vec, npy_intp cnt, void *null);
+int atimsort_longdouble(npy_longdouble *vec, npy_intp *ind, npy_intp cnt, void *null);
+int timsort_cfloat(npy_cfloat *vec, npy_intp cnt, void *null);
+int atimsort_cfloat(npy_cfloat *vec, npy_intp *ind, npy_intp cnt, void *null);
+int timsort_cdouble(npy_cdouble *vec, npy_intp cnt, void *null);
+int atimsort_cdouble(npy_cdouble *vec, npy_intp *ind, npy_intp cnt, void *null);
+int timsort_clongdouble(npy_clongdouble *vec, npy_intp cnt, void *null);
+int atimsort_clongdouble(npy_clongdouble *vec, npy_intp *ind, npy_intp cnt, void *null);
+
+
+/*
+ * The radix sorts don't have a slot in PyArray_ArrFuncs, they are
+ * looked up by type number.
+ */
+PyArray_SortFunc *get_radixsort_func(int type_num);
+PyArray_ArgSortFunc *get_aradixsort_func(int type_num);
+
+int radixsort_bool(npy_bool *vec, npy_intp cnt, void *null);
+int aradixsort_bool(npy_bool *vec, npy_intp *ind, npy_intp cnt, void *null);
+int radixsort_byte(npy_byte *vec, npy_intp cnt, void *null);
+int aradixsort_byte(npy_byte *vec, npy_intp *ind, npy_intp cnt, void *null);
+int radixsort_ubyte(npy_ubyte *vec, npy_intp cnt, void *null);
+int aradixsort_ubyte(npy_ubyte *vec, npy_intp *ind, npy_intp cnt, void *null);
+int radixsort_short(npy_short *vec, npy_intp cnt, void *null);
+int aradixsort_short(npy_short *vec, npy_intp *ind, npy_intp cnt, void *null);
+int radixsort_ushort(npy_ushort *vec, npy_intp cnt, void *null);
+int aradixsort_ushort(npy_ushort *vec, npy_intp *ind, npy_intp cnt, void *null);
+int radixsort_int(npy_int *vec, npy_intp cnt, void *null);
+int aradixsort_int(npy_int *vec, npy_intp *ind, npy_intp cnt, void *null);
+int radixsort_uint(npy_uint *vec, npy_intp cnt, void *null);
+int aradixsort_uint(npy_uint *vec, npy_intp *ind, npy_intp cnt, void *null);
+int radixsort_long(npy_long *vec, npy_intp cnt, void *null);
+int aradixsort_long(npy_long *vec, npy_intp *ind, npy_intp cnt, void *null);
+int radixsort_ulong(npy_ulong *vec, npy_intp cnt, void *null);
+int aradixsort_ulong(npy_ulong *vec, npy_intp *ind, npy_intp cnt, void *null);
+int radixsort_longlong(npy_longlong *vec, npy_intp cnt, void *null);
+int aradixsort_longlong(npy_longlong *vec, npy_intp *ind, npy_intp cnt, void *null);
+int radixsort_ulonglong(npy_ulonglong *vec, npy_intp cnt, void *null);
+int aradixsort_ulonglong(npy_ulonglong *vec, npy_intp *ind, npy_intp cnt, void *null);
+int radixsort_half(npy_ushort *vec, npy_intp cnt, void *null);
+int aradixsort_half(npy_ushort *vec, npy_intp *ind, npy_intp cnt, void *null);
+int radixsort_float(npy_float *vec, npy_intp cnt, void *null);
+int aradixsort_float(npy_float *vec, npy_intp *ind, npy_intp cnt, void *null);
+int radixsort_double(npy_double *vec, npy_intp cnt, void *null);
+int aradixsort_double(npy_double *vec, npy_intp *ind, npy_intp cnt, void *null);
+
+
 int npy_quicksort(void *base, size_t num, size_t size, npy_comparator cmp);
 int npy_heapsort(void *base, size_t num, size_t size, npy_comparator cmp);
 int npy_mergesort(void *base, size_t num, size_t size, npy_comparator cmp);
+int npy_timsort(void *base, size_t num, size_t size, npy_comparator cmp);
 
 #endif
@@ -0,0 +1,42 @@
+/*
+ * This file implements the detection of cpu features at runtime, used to
+ * select the SIMD kernels in simd.inc.src.
+ */
+#define _UMATHMODULE
+#define NPY_NO_DEPRECATED_API NPY_API_VERSION
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "npy_config.h"
+
+#include "cpuid.h"
+
+#include <string.h>
+
+/*
+ * Returns 1 if the cpu the process runs on supports the instruction set
+ * 'feature', and 0 otherwise or if it can't be determined.
+ *
+ * Only the x86 features "avx2", "fma" and "avx512f" are known, and only on
+ * compilers providing __builtin_cpu_supports.  The builtin executes cpuid
+ * once, and also checks with xgetbv that the operating system saves the
+ * wider vector registers, so a supported feature can be used.
+ */
+NPY_NO_EXPORT int
+npy_cpu_supports(const char * feature)
+{
+#ifdef HAVE___BUILTIN_CPU_SUPPORTS
+    __builtin_cpu_init();
+    if (strcmp(feature, "avx2") == 0) {
+        return __builtin_cpu_supports("avx2") != 0;
+    }
+    else if (strcmp(feature, "fma") == 0) {
+        return __builtin_cpu_supports("fma") != 0;
+    }
+    else if (strcmp(feature, "avx512f") == 0) {
+        return __builtin_cpu_supports("avx512f") != 0;
+    }
+#endif
+    return 0;
+}
@@ -0,0 +1,1087 @@
+/*
+ * This file implements fused ufuncs, which evaluate an expression built
+ * from several ufuncs in a single pass over the operands.
+ *
+ * A fused ufunc is described by a list of nodes.  Every node applies an
+ * existing single output ufunc to inputs of the fused ufunc, results of
+ * earlier nodes, or 0-d constants, and the last node produces the
+ * output.  Instead of allocating a full size temporary for every
+ * intermediate result, the fused inner loop works on blocks small enough
+ * for the intermediate results to stay in the cache, and calls the inner
+ * loops of the node ufuncs on each block.
+ *
+ * Type resolution runs the type resolvers of the node ufuncs in order,
+ * so the types are the same as when the ufuncs are called one after the
+ * other.  The resolved types of all the nodes select a plan, which lists
+ * the inner loops and casts run on each block.  The plans are cached in
+ * the fused ufunc.
+ */
+#define _UMATHMODULE
+#define NPY_NO_DEPRECATED_API NPY_API_VERSION
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "npy_config.h"
+#ifdef ENABLE_SEPARATE_COMPILATION
+#define PY_ARRAY_UNIQUE_SYMBOL _npy_umathmodule_ARRAY_API
+#define NO_IMPORT_ARRAY
+#endif
+
+#include <numpy/arrayobject.h>
+
+#include <stdlib.h>
+
+#include "npy_pycompat.h"
+
+#include "numpy/ufuncobject.h"
+#include "ufunc_type_resolution.h"
+#include "fused.h"
+
+/* The size in bytes of the buffer for each intermediate result */
+#define NPY_FUSED_BUFSIZE 8192
+
+/*
+ * The size in bytes of the scratch space fused_loop keeps on the stack.
+ * Plans whose buffers don't fit in it allocate them, and use smaller
+ * blocks in it if that fails, since the loop can't report errors.
+ */
+#define NPY_FUSED_STACKSIZE 32768
+
+/* Where an operand of a plan step lives */
+enum {
+    /* An operand of the fused inner loop, 'index' is its position */
+    NPY_FUSED_ARG,
+    /* A block buffer, 'index' is the buffer number */
+    NPY_FUSED_TEMP,
+    /* A constant, which is passed with a zero stride */
+    NPY_FUSED_CONST
+};
+
+typedef struct {
+    int kind, index;
+    int type_num;
+    npy_intp itemsize;
+    /* The data of a constant */
+    char *data;
+} fused_operand;
+
+typedef struct {
+    /* The inner loop run by the step, or NULL if the step is a cast */
+    PyUFuncGenericFunction loop;
+    void *loopdata;
+    PyArray_VectorUnaryFunc *cast;
+    int nin, nargs;
+    fused_operand args[NPY_MAXARGS];
+} fused_step;
+
+typedef struct _fused_plan {
+    struct _fused_plan *next;
+    /* The type numbers of the inputs and of all the node operands */
+    char *signature;
+    npy_intp siglen;
+    fused_step *steps;
+    npy_intp nsteps;
+    /* The number of block buffers, without the one for gathering */
+    int nbuffers;
+    /*
+     * The number of elements per block, the bytes per buffer, and the
+     * largest item size stored in a buffer
+     */
+    npy_intp blocksize, bufsize, bufitemsize;
+    /* The constants cast to the types the node loops need */
+    PyObject *constants;
+    /* The itemsizes of the inner loop operands */
+    int nin;
+    npy_intp itemsizes[NPY_MAXARGS];
+} fused_plan;
+
+typedef struct {
+    PyUFuncObject *ufunc;
+    /*
+     * For every input of the node ufunc, the input of the fused ufunc
+     * (below nin) or the node (nin and up) it reads, or -1 if it reads
+     * the constant in 'constants'.
+     */
+    int src[NPY_MAXARGS];
+    PyArrayObject *constants[NPY_MAXARGS];
+} fused_node;
+
+typedef struct {
+    int nin, nnodes;
+    fused_node *nodes;
+    fused_plan *plans;
+    /* The plan picked by the last type resolution */
+    fused_plan *current;
+} fused_program;
+
+static void
+fused_program_free(fused_program *prog)
+{
+    int j, i;
+    fused_plan *plan = prog->plans;
+
+    while (plan != NULL) {
+        fused_plan *next = plan->next;
+
+        PyArray_free(plan->signature);
+        PyArray_free(plan->steps);
+        Py_XDECREF(plan->constants);
+        PyArray_free(plan);
+        plan = next;
+    }
+    if (prog->nodes != NULL) {
+        for (j = 0; j < prog->nnodes; ++j) {
+            Py_XDECREF(prog->nodes[j].ufunc);
+            for (i = 0; i < NPY_MAXARGS; ++i) {
+                Py_XDECREF(prog->nodes[j].constants[i]);
+            }
+        }
+        PyArray_free(prog->nodes);
+    }
+    PyArray_free(prog);
+}
+
+#if defined(NPY_PY3K)
+static void
+fused_program_capsule_dtor(PyObject *capsule)
+{
+    fused_program_free(NpyCapsule_AsVoidPtr(capsule));
+}
+#else
+static void
+fused_program_capsule_dtor(void *ptr)
+{
+    fused_program_free(ptr);
+}
+#endif
+
+/*
+ * The node loops and casts are called directly on the buffers, which
+ * is only possible for the plain numeric types.
+ */
+static int
+fused_dtype_supported(PyArray_Descr *dtype)
+{
+    return (PyTypeNum_ISBOOL(dtype->type_num) ||
+            PyTypeNum_ISNUMBER(dtype->type_num)) &&
+           PyArray_ISNBO(dtype->byteorder);
+}
+
+/*
+ * Returns 1 if the output elements depend on earlier output elements,
+ * as in the loops of reductions and accumulations, which then have to
+ * be evaluated one element at a time.
+ */
+static int
+fused_loop_is_recurrent(fused_plan *plan, char **args, npy_intp n,
+                        npy_intp *steps)
+{
+    int i, nin = plan->nin;
+    char *out_lo, *out_hi;
+
+    if (n <= 1) {
+        return 0;
+    }
+    if (steps[nin] == 0) {
+        return 1;
+    }
+    out_lo = args[nin] + (steps[nin] < 0 ? (n - 1) * steps[nin] : 0);
+    out_hi = args[nin] + (steps[nin] < 0 ? 0 : (n - 1) * steps[nin]) +
+             plan->itemsizes[nin];
+    for (i = 0; i < nin; ++i) {
+        char *lo, *hi;
+
+        /* Operating in place is fine */
+        if (args[i] == args[nin] && steps[i] == steps[nin]) {
+            continue;
+        }
+        lo = args[i] + (steps[i] < 0 ? (n - 1) * steps[i] : 0);
+        hi = args[i] + (steps[i] < 0 ? 0 : (n - 1) * steps[i]) +
+             plan->itemsizes[i];
+        if (lo < out_hi && out_lo < hi) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void
+fused_loop(char **args, npy_intp *dimensions, npy_intp *steps, void *data)
+{
+    fused_plan *plan = (fused_plan *)data;
+    npy_intp n = dimensions[0], start, count, istep, blocksize, bufsize;
+    char *buffers = NULL, *heap = NULL, *gather = NULL;
+    char stack[NPY_FUSED_STACKSIZE], *op_args[NPY_MAXARGS];
+    npy_intp op_steps[NPY_MAXARGS];
+    int i;
+
+    blocksize = plan->blocksize;
+    if (fused_loop_is_recurrent(plan, args, n, steps)) {
+        blocksize = 1;
+    }
+
+    bufsize = plan->bufsize;
+    if (bufsize > 0) {
+        npy_intp nbytes = (plan->nbuffers + 1) * bufsize;
+
+        if (nbytes <= NPY_FUSED_STACKSIZE) {
+            buffers = stack;
+        }
+        else {
+            /* This may run without the GIL, so PyArray_malloc can't be used */
+            heap = malloc(nbytes);
+            buffers = heap;
+        }
+        if (buffers == NULL) {
+            /* fused_build_plan made sure one element of each fits */
+            npy_intp stack_blocksize = NPY_FUSED_STACKSIZE /
+                            ((plan->nbuffers + 1) * plan->bufitemsize);
+
+            if (blocksize > stack_blocksize) {
+                blocksize = stack_blocksize;
+            }
+            bufsize = stack_blocksize * plan->bufitemsize;
+            buffers = stack;
+        }
+        gather = buffers + plan->nbuffers * bufsize;
+    }
+
+    for (start = 0; start < n; start += count) {
+        count = n - start;
+        if (count > blocksize) {
+            count = blocksize;
+        }
+        for (istep = 0; istep < plan->nsteps; ++istep) {
+            fused_step *step = &plan->steps[istep];
+
+            for (i = 0; i < step->nargs; ++i) {
+                fused_operand *op = &step->args[i];
+
+                switch (op->kind) {
+                    case NPY_FUSED_ARG:
+                        op_args[i] = args[op->index] +
+                                        start * steps[op->index];
+                        op_steps[i] = steps[op->index];
+                        break;
+                    case NPY_FUSED_TEMP:
+                        op_args[i] = buffers + op->index * bufsize;
+                        op_steps[i] = op->itemsize;
+                        break;
+                    default:
+                        op_args[i] = op->data;
+                        op_steps[i] = 0;
+                        break;
+                }
+            }
+            if (step->loop != NULL) {
+                step->loop(op_args, &count, op_steps, step->loopdata);
+            }
+            else {
+                /* The cast functions only handle contiguous data */
+                char *src = op_args[0];
+                npy_intp itemsize = step->args[0].itemsize;
+
+                if (op_steps[0] != itemsize) {
+                    npy_intp k;
+
+                    for (k = 0; k < count; ++k) {
+                        memcpy(gather + k * itemsize,
+                               src + k * op_steps[0], itemsize);
+                    }
+                    src = gather;
+                }
+                step->cast(src, op_args[1], count, NULL, NULL);
+            }
+        }
+    }
+
+    free(heap);
+}
+
+/*
+ * Sets 'op' to the operand holding the value 'src' of the program with
+ * the type 'dtype'.  If the value has another type a cast step is
+ * appended to the plan, casts which were already done are reused.
+ */
+static int
+fused_plan_operand(fused_program *prog, fused_plan *plan, int src,
+                   PyArray_Descr *dtype, PyArray_Descr **dtypes,
+                   PyArray_Descr **in_dtypes, int *node_temp,
+                   npy_intp *temp_itemsize, int *ntemps,
+                   fused_operand *op)
+{
+    PyArray_Descr *src_dtype;
+    fused_step *step;
+    npy_intp istep;
+
+    if (src < prog->nin) {
+        op->kind = NPY_FUSED_ARG;
+        op->index = src;
+        src_dtype = in_dtypes[src];
+    }
+    else {
+        fused_node *node = &prog->nodes[src - prog->nin];
+
+        op->kind = NPY_FUSED_TEMP;
+        op->index = node_temp[src - prog->nin];
+        src_dtype = dtypes[(src - prog->nin) * NPY_MAXARGS +
+                           node->ufunc->nin];
+    }
+    op->type_num = src_dtype->type_num;
+    op->itemsize = src_dtype->elsize;
+    if (PyArray_EquivTypes(src_dtype, dtype)) {
+        return 0;
+    }
+
+    for (istep = 0; istep < plan->nsteps; ++istep) {
+        step = &plan->steps[istep];
+        if (step->loop == NULL && step->args[0].kind == op->kind &&
+                    step->args[0].index == op->index &&
+                    step->args[1].type_num == dtype->type_num) {
+            *op = step->args[1];
+            return 0;
+        }
+    }
+
+    step = &plan->steps[plan->nsteps];
+    step->loop = NULL;
+    step->loopdata = NULL;
+    step->cast = PyArray_GetCastFunc(src_dtype, dtype->type_num);
+    if (step->cast == NULL) {
+        return -1;
+    }
+    step->nin = 1;
+    step->nargs = 2;
+    step->args[0] = *op;
+    op->kind = NPY_FUSED_TEMP;
+    op->index = (*ntemps)++;
+    op->type_num = dtype->type_num;
+    op->itemsize = dtype->elsize;
+    temp_itemsize[op->index] = dtype->elsize;
+    step->args[1] = *op;
+    plan->nsteps++;
+
+    return 0;
+}
+
+/*
+ * Assigns the intermediate results to block buffers, reusing a buffer
+ * once the last step reading its value is done.
+ */
+static int
+fused_plan_buffers(fused_plan *plan, int ntemps)
+{
+    npy_intp *last_use = NULL, istep;
+    int *buffer = NULL, *free_buffers = NULL, nfree = 0, i, j;
+
+    last_use = PyArray_malloc(ntemps * sizeof(npy_intp));
+    buffer = PyArray_malloc(ntemps * sizeof(int));
+    free_buffers = PyArray_malloc(ntemps * sizeof(int));
+    if (ntemps > 0 && (last_use == NULL || buffer == NULL ||
+                                    free_buffers == NULL)) {
+        PyArray_free(last_use);
+        PyArray_free(buffer);
+        PyArray_free(free_buffers);
+        PyErr_NoMemory();
+        return -1;
+    }
+    for (i = 0; i < ntemps; ++i) {
+        last_use[i] = -1;
+        buffer[i] = -1;
+    }
+    for (istep = 0; istep < plan->nsteps; ++istep) {
+        fused_step *step = &plan->steps[istep];
+
+        for (i = 0; i < step->nin; ++i) {
+            if (step->args[i].kind == NPY_FUSED_TEMP) {
+                last_use[step->args[i].index] = istep;
+            }
+        }
+    }
+
+    plan->nbuffers = 0;
+    for (istep = 0; istep < plan->nsteps; ++istep) {
+        fused_step *step = &plan->steps[istep];
+
+        /* Outputs get a buffer none of the inputs of the step uses */
+        for (i = step->nin; i < step->nargs; ++i) {
+            fused_operand *op = &step->args[i];
+
+            if (op->kind == NPY_FUSED_TEMP) {
+                buffer[op->index] = nfree > 0 ? free_buffers[--nfree]
+                                              : plan->nbuffers++;
+                if (last_use[op->index] < 0) {
+                    free_buffers[nfree++] = buffer[op->index];
+                }
+                op->index = buffer[op->index];
+            }
+        }
+        for (i = 0; i < step->nin; ++i) {
+            fused_operand *op = &step->args[i];
+
+            if (op->kind != NPY_FUSED_TEMP) {
+                continue;
+            }
+            /* An input used twice by the step is released once */
+            for (j = 0; j < i; ++j) {
+                if (step->args[j].kind == NPY_FUSED_TEMP &&
+                                step->args[j].index == op->index) {
+                    break;
+                }
+            }
+            if (j == i && last_use[op->index] == istep) {
+                free_buffers[nfree++] = buffer[op->index];
+            }
+        }
+        for (i = 0; i < step->nin; ++i) {
+            fused_operand *op = &step->args[i];
+
+            if (op->kind == NPY_FUSED_TEMP) {
+                op->index = buffer[op->index];
+            }
+        }
+    }
+
+    PyArray_free(last_use);
+    PyArray_free(buffer);
+    PyArray_free(free_buffers);
+    return 0;
+}
+
+/*
+ * Builds the plan for the node operand types 'dtypes' (NPY_MAXARGS per
+ * node) and the inner loop input types 'in_dtypes'.
+ */
+static fused_plan *
+fused_build_plan(fused_program *prog, PyArray_Descr **dtypes,
+                 PyArray_Descr **in_dtypes,
+                 char *signature, npy_intp siglen)
+{
+    fused_plan *plan;
+    int nin = prog->nin, nnodes = prog->nnodes, ntemps = 0, i, j;
+    int *node_temp = NULL;
+    npy_intp *temp_itemsize = NULL, maxsteps = 0, maxitemsize = 0, istep;
+
+    for (j = 0; j < nnodes; ++j) {
+        maxsteps += prog->nodes[j].ufunc->nin + 1;
+    }
+
+    plan = PyArray_malloc(sizeof(fused_plan));
+    if (plan == NULL) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    memset(plan, 0, sizeof(fused_plan));
+    plan->signature = PyArray_malloc(siglen);
+    plan->steps = PyArray_malloc(maxsteps * sizeof(fused_step));
+    node_temp = PyArray_malloc(nnodes * sizeof(int));
+    temp_itemsize = PyArray_malloc(maxsteps * sizeof(npy_intp));
+    if (plan->signature == NULL || plan->steps == NULL ||
+                    node_temp == NULL || temp_itemsize == NULL) {
+        PyErr_NoMemory();
+        goto fail;
+    }
+    memcpy(plan->signature, signature, siglen);
+    plan->siglen = siglen;
+    plan->nin = nin;
+    for (i = 0; i < nin; ++i) {
+        plan->itemsizes[i] = in_dtypes[i]->elsize;
+    }
+    plan->itemsizes[nin] = dtypes[(nnodes - 1) * NPY_MAXARGS +
+                                  prog->nodes[nnodes - 1].ufunc->nin]->elsize;
+    plan->constants = PyList_New(0);
+    if (plan->constants == NULL) {
+        goto fail;
+    }
+
+    for (j = 0; j < nnodes; ++j) {
+        fused_node *node = &prog->nodes[j];
+        PyUFuncObject *ufunc = node->ufunc;
+        PyArray_Descr **node_dtypes = dtypes + j * NPY_MAXARGS;
+        fused_step step;
+        int needs_api = 0;
+
+        if (ufunc->legacy_inner_loop_selector(ufunc, node_dtypes,
+                        &step.loop, &step.loopdata, &needs_api) < 0) {
+            goto fail;
+        }
+        if (needs_api) {
+            PyErr_Format(PyExc_TypeError,
+                    "the loop of ufunc %s needs the Python API and "
+                    "can't be fused", ufunc->name);
+            goto fail;
+        }
+        step.cast = NULL;
+        step.nin = ufunc->nin;
+        step.nargs = ufunc->nin + 1;
+
+        for (i = 0; i < ufunc->nin; ++i) {
+            fused_operand *op = &step.args[i];
+
+            if (node->src[i] < 0) {
+                PyArrayObject *constant;
+
+                Py_INCREF(node_dtypes[i]);
+                constant = (PyArrayObject *)PyArray_CastToType(
+                                node->constants[i], node_dtypes[i], 0);
+                if (constant == NULL) {
+                    goto fail;
+                }
+                if (PyList_Append(plan->constants,
+                                  (PyObject *)constant) < 0) {
+                    Py_DECREF(constant);
+                    goto fail;
+                }
+                Py_DECREF(constant);
+                op->kind = NPY_FUSED_CONST;
+                op->index = -1;
+                op->type_num = node_dtypes[i]->type_num;
+                op->itemsize = 0;
+                op->data = PyArray_DATA(constant);
+            }
+            else if (fused_plan_operand(prog, plan, node->src[i],
+                                node_dtypes[i], dtypes, in_dtypes,
+                                node_temp, temp_itemsize, &ntemps,
+                                op) < 0) {
+                goto fail;
+            }
+        }
+
+        if (j == nnodes - 1) {
+            step.args[ufunc->nin].kind = NPY_FUSED_ARG;
+            step.args[ufunc->nin].index = nin;
+        }
+        else {
+            step.args[ufunc->nin].kind = NPY_FUSED_TEMP;
+            step.args[ufunc->nin].index = ntemps;
+            node_temp[j] = ntemps;
+            temp_itemsize[ntemps++] = node_dtypes[ufunc->nin]->elsize;
+        }
+        step.args[ufunc->nin].type_num = node_dtypes[ufunc->nin]->type_num;
+        step.args[ufunc->nin].itemsize = node_dtypes[ufunc->nin]->elsize;
+        plan->steps[plan->nsteps++] = step;
+    }
+
+    /* Casts of strided inputs are gathered into a buffer first */
+    for (i = 0; i < ntemps; ++i) {
+        if (temp_itemsize[i] > maxitemsize) {
+            maxitemsize = temp_itemsize[i];
+        }
+    }
+    for (istep = 0; istep < plan->nsteps; ++istep) {
+        fused_step *step = &plan->steps[istep];
+
+        if (step->loop == NULL && step->args[0].itemsize > maxitemsize) {
+            maxitemsize = step->args[0].itemsize;
+        }
+    }
+    plan->bufitemsize = maxitemsize;
+    if (maxitemsize == 0) {
+        plan->blocksize = NPY_MAX_INTP;
+        plan->bufsize = 0;
+    }
+    else {
+        plan->blocksize = NPY_FUSED_BUFSIZE / maxitemsize;
+        if (plan->blocksize < 16) {
+            plan->blocksize = 16;
+        }
+        plan->bufsize = plan->blocksize * maxitemsize;
+    }
+
+    if (fused_plan_buffers(plan, ntemps) < 0) {
+        goto fail;
+    }
+    /* fused_loop needs room for one element of every buffer on the stack */
+    if ((plan->nbuffers + 1) * maxitemsize > NPY_FUSED_STACKSIZE) {
+        PyErr_SetString(PyExc_ValueError,
+                "fused expression has too many intermediate results");
+        goto fail;
+    }
+
+    PyArray_free(node_temp);
+    PyArray_free(temp_itemsize);
+    return plan;
+
+fail:
+    PyArray_free(node_temp);
+    PyArray_free(temp_itemsize);
+    PyArray_free(plan->signature);
+    PyArray_free(plan->steps);
+    Py_XDECREF(plan->constants);
+    PyArray_free(plan);
+    return NULL;
+}
+
+/*
+ * The type of input 'iin' of the inner loop.  This is the type of the
+ * operand if a node reads it with that type, otherwise the type the
+ * first node reading it uses.  Other nodes get a cast in the plan.
+ */
+static PyArray_Descr *
+fused_input_dtype(fused_program *prog, PyArray_Descr **dtypes, int iin,
+                  PyArrayObject *operand)
+{
+    PyArray_Descr *first = NULL;
+    int j, i;
+
+    for (j = 0; j < prog->nnodes; ++j) {
+        fused_node *node = &prog->nodes[j];
+
+        for (i = 0; i < node->ufunc->nin; ++i) {
+            PyArray_Descr *dtype = dtypes[j * NPY_MAXARGS + i];
+
+            if (node->src[i] != iin) {
+                continue;
+            }
+            if (PyArray_EquivTypes(dtype, PyArray_DESCR(operand))) {
+                return dtype;
+            }
+            if (first == NULL) {
+                first = dtype;
+            }
+        }
+    }
+    return first;
+}
+
+/*
+ * The types of a fused ufunc follow from its nodes, so the types
+ * requested with the dtype or sig arguments, or by reductions, are
+ * only checked against them.
+ */
+static int
+fused_check_type_tup(PyUFuncObject *self, PyObject *type_tup,
+                     PyArray_Descr **in_dtypes, PyArray_Descr *out_dtype)
+{
+    int i, equiv, nop = self->nin + 1;
+    PyArray_Descr *dtype;
+
+    if (PyTuple_Check(type_tup) && PyTuple_GET_SIZE(type_tup) == nop) {
+        for (i = 0; i < nop; ++i) {
+            PyObject *item = PyTuple_GET_ITEM(type_tup, i);
+
+            if (item == Py_None) {
+                continue;
+            }
+            dtype = NULL;
+            if (!PyArray_DescrConverter(item, &dtype)) {
+                return -1;
+            }
+            equiv = PyArray_EquivTypes(dtype,
+                                       i < self->nin ? in_dtypes[i]
+                                                     : out_dtype);
+            Py_DECREF(dtype);
+            if (!equiv) {
+                goto mismatch;
+            }
+        }
+        return 0;
+    }
+
+    if (PyTuple_Check(type_tup) && PyTuple_GET_SIZE(type_tup) == 1) {
+        type_tup = PyTuple_GET_ITEM(type_tup, 0);
+    }
+    dtype = NULL;
+    if (!PyArray_DescrConverter(type_tup, &dtype)) {
+        return -1;
+    }
+    equiv = PyArray_EquivTypes(dtype, out_dtype);
+    Py_DECREF(dtype);
+    if (equiv) {
+        return 0;
+    }
+
+mismatch:
+    PyErr_Format(PyExc_TypeError,
+            "fused ufunc %s has no loop matching the requested types",
+            self->name);
+    return -1;
+}
+
+static int
+fused_type_resolver(PyUFuncObject *self,
+                    NPY_CASTING casting,
+                    PyArrayObject **operands,
+                    PyObject *type_tup,
+                    PyArray_Descr **out_dtypes)
+{
+    fused_program *prog = (fused_program *)NpyCapsule_AsVoidPtr(self->obj);
+    int nin = prog->nin, nnodes = prog->nnodes, i, j, retval = -1;
+    PyArray_Descr **dtypes = NULL, *in_dtypes[NPY_MAXARGS];
+    PyArrayObject **values = NULL;
+    char *signature = NULL;
+    npy_intp siglen = 0;
+    fused_plan *plan;
+
+    for (i = 0; i < nin; ++i) {
+        if (operands[i] == NULL) {
+            PyErr_Format(PyExc_TypeError,
+                    "fused ufunc %s requires all its inputs", self->name);
+            return -1;
+        }
+    }
+
+    dtypes = PyArray_malloc(nnodes * NPY_MAXARGS * sizeof(PyArray_Descr *));
+    values = PyArray_malloc((nin + nnodes) * sizeof(PyArrayObject *));
+    signature = PyArray_malloc(nin + nnodes * NPY_MAXARGS);
+    if (dtypes == NULL || values == NULL || signature == NULL) {
+        PyErr_NoMemory();
+        goto finish;
+    }
+    memset(dtypes, 0, nnodes * NPY_MAXARGS * sizeof(PyArray_Descr *));
+    memset(values, 0, (nin + nnodes) * sizeof(PyArrayObject *));
+    for (i = 0; i < nin; ++i) {
+        values[i] = operands[i];
+        Py_INCREF(values[i]);
+    }
+
+    /*
+     * Resolve the nodes in order.  The result of a node is represented
+     * by a one element array of its type for the resolution of the
+     * following nodes, or by a 0-d array if the node only reads 0-d
+     * operands, so that scalars are treated as in unfused calls.
+     */
+    for (j = 0; j < nnodes; ++j) {
+        fused_node *node = &prog->nodes[j];
+        PyUFuncObject *ufunc = node->ufunc;
+        PyArray_Descr **node_dtypes = dtypes + j * NPY_MAXARGS;
+        PyArrayObject *ops[NPY_MAXARGS];
+        npy_intp one = 1;
+        int ndim = 0;
+
+        for (i = 0; i < ufunc->nin; ++i) {
+            ops[i] = node->src[i] < 0 ? node->constants[i]
+                                      : values[node->src[i]];
+            if (PyArray_NDIM(ops[i]) > 0) {
+                ndim = 1;
+            }
+        }
+        ops[ufunc->nin] = (j == nnodes - 1) ? operands[nin] : NULL;
+
+        if (ufunc->type_resolver(ufunc, casting, ops, NULL,
+                                 node_dtypes) < 0) {
+            /* -2 without an exception asks binary operators to defer */
+            if (!PyErr_Occurred()) {
+                PyErr_Format(PyExc_TypeError,
+                        "ufunc %s used by fused ufunc %s does not support "
+                        "the input types", ufunc->name, self->name);
+            }
+            goto finish;
+        }
+        for (i = 0; i <= ufunc->nin; ++i) {
+            if (!fused_dtype_supported(node_dtypes[i])) {
+                PyErr_Format(PyExc_TypeError,
+                        "fused ufunc %s does not support the type '%c' "
+                        "used by %s", self->name,
+                        node_dtypes[i]->type, ufunc->name);
+                goto finish;
+            }
+            signature[siglen++] = (char)node_dtypes[i]->type_num;
+        }
+
+        if (j < nnodes - 1) {
+            Py_INCREF(node_dtypes[ufunc->nin]);
+            values[nin + j] = (PyArrayObject *)PyArray_Zeros(ndim, &one,
+                                            node_dtypes[ufunc->nin], 0);
+            if (values[nin + j] == NULL) {
+                goto finish;
+            }
+        }
+    }
+
+    for (i = 0; i < nin; ++i) {
+        in_dtypes[i] = fused_input_dtype(prog, dtypes, i, operands[i]);
+        if (in_dtypes[i] != NULL) {
+            signature[siglen++] = (char)in_dtypes[i]->type_num;
+        }
+        else {
+            /* The input isn't used, any type does */
+            in_dtypes[i] = PyArray_DESCR(operands[i]);
+            signature[siglen++] = (char)-1;
+        }
+    }
+
+    if (type_tup != NULL && fused_check_type_tup(self, type_tup, in_dtypes,
+                    dtypes[(nnodes - 1) * NPY_MAXARGS +
+                           prog->nodes[nnodes - 1].ufunc->nin]) < 0) {
+        goto finish;
+    }
+
+    for (plan = prog->plans; plan != NULL; plan = plan->next) {
+        if (plan->siglen == siglen &&
+                    memcmp(plan->signature, signature, siglen) == 0) {
+            break;
+        }
+    }
+    if (plan == NULL) {
+        plan = fused_build_plan(prog, dtypes, in_dtypes, signature, siglen);
+        if (plan == NULL) {
+            goto finish;
+        }
+        plan->next = prog->plans;
+        prog->plans = plan;
+    }
+    prog->current = plan;
+
+    for (i = 0; i < nin; ++i) {
+        out_dtypes[i] = in_dtypes[i];
+        Py_INCREF(out_dtypes[i]);
+    }
+    out_dtypes[nin] = dtypes[(nnodes - 1) * NPY_MAXARGS +
+                             prog->nodes[nnodes - 1].ufunc->nin];
+    Py_INCREF(out_dtypes[nin]);
+    retval = 0;
+
+finish:
+    if (dtypes != NULL) {
+        for (i = 0; i < nnodes * NPY_MAXARGS; ++i) {
+            Py_XDECREF(dtypes[i]);
+        }
+    }
+    if (values != NULL) {
+        for (i = 0; i < nin + nnodes; ++i) {
+            Py_XDECREF(values[i]);
+        }
+    }
+    PyArray_free(dtypes);
+    PyArray_free(values);
+    PyArray_free(signature);
+    return retval;
+}
+
+static int
+fused_loop_selector(PyUFuncObject *self,
+                    PyArray_Descr **NPY_UNUSED(dtypes),
+                    PyUFuncGenericFunction *out_innerloop,
+                    void **out_innerloopdata,
+                    int *out_needs_api)
+{
+    fused_program *prog = (fused_program *)NpyCapsule_AsVoidPtr(self->obj);
+
+    /* The plan always comes from the type resolution just before */
+    if (prog->current == NULL) {
+        PyErr_Format(PyExc_RuntimeError,
+                "no loop resolved for fused ufunc %s", self->name);
+        return -1;
+    }
+    *out_innerloop = &fused_loop;
+    *out_innerloopdata = prog->current;
+    *out_needs_api = 0;
+
+    return 0;
+}
+
+/*
+ * Parses node 'j' of the program, a (ufunc, args) tuple where args
+ * holds an integer per input of the ufunc, referring to an input of
+ * the fused ufunc or the result of an earlier node, or a 0-d array
+ * constant.
+ */
+static int
+fused_parse_node(fused_program *prog, int j, PyObject *item)
+{
+    fused_node *node = &prog->nodes[j];
+    PyObject *ufunc_obj, *args_obj, *args;
+    PyUFuncObject *ufunc;
+    int i;
+
+    if (!PyTuple_Check(item) || !PyArg_ParseTuple(item, "OO",
+                                                  &ufunc_obj, &args_obj)) {
+        PyErr_SetString(PyExc_TypeError,
+                "fused ufunc nodes must be (ufunc, args) tuples");
+        return -1;
+    }
+    if (!PyObject_TypeCheck(ufunc_obj, &PyUFunc_Type)) {
+        PyErr_SetString(PyExc_TypeError,
+                "fused ufunc nodes must apply ufuncs");
+        return -1;
+    }
+    ufunc = (PyUFuncObject *)ufunc_obj;
+    if (ufunc->nout != 1 || ufunc->core_enabled ||
+                    ufunc->legacy_inner_loop_selector == NULL ||
+                    ufunc->type_resolver == &fused_type_resolver) {
+        PyErr_Format(PyExc_TypeError,
+                "ufunc %s can't be fused, only elementwise ufuncs with "
+                "a single output can", ufunc->name);
+        return -1;
+    }
+    for (i = 0; i < ufunc->nin; ++i) {
+        if (ufunc->op_flags[i] & (NPY_ITER_READWRITE | NPY_ITER_WRITEONLY)) {
+            PyErr_Format(PyExc_TypeError,
+                    "ufunc %s writes to its inputs and can't be fused",
+                    ufunc->name);
+            return -1;
+        }
+    }
+
+    args = PySequence_Fast(args_obj, "fused ufunc node args must be a sequence");
+    if (args == NULL) {
+        return -1;
+    }
+    if (PySequence_Fast_GET_SIZE(args) != ufunc->nin) {
+        PyErr_Format(PyExc_ValueError,
+                "ufunc %s takes %d arguments, the fused ufunc node "
+                "gives %d", ufunc->name, ufunc->nin,
+                (int)PySequence_Fast_GET_SIZE(args));
+        Py_DECREF(args);
+        return -1;
+    }
+    for (i = 0; i < ufunc->nin; ++i) {
+        PyObject *arg = PySequence_Fast_GET_ITEM(args, i);
+
+        if (PyArray_Check(arg)) {
+            if (PyArray_NDIM((PyArrayObject *)arg) != 0) {
+                PyErr_SetString(PyExc_ValueError,
+                        "fused ufunc constants must be 0-d arrays");
+                Py_DECREF(args);
+                return -1;
+            }
+            Py_INCREF(arg);
+            node->constants[i] = (PyArrayObject *)arg;
+            node->src[i] = -1;
+        }
+        else {
+            long src = PyInt_AsLong(arg);
+
+            if (src == -1 && PyErr_Occurred()) {
+                Py_DECREF(args);
+                return -1;
+            }
+            if (src < 0 || src >= prog->nin + j) {
+                PyErr_Format(PyExc_ValueError,
+                        "fused ufunc node %d reads the invalid value %ld",
+                        j, src);
+                Py_DECREF(args);
+                return -1;
+            }
+            node->src[i] = (int)src;
+        }
+    }
+    Py_DECREF(args);
+
+    Py_INCREF(ufunc);
+    node->ufunc = ufunc;
+    return 0;
+}
+
+/*
+ * Creates a fused ufunc from a name, the number of inputs, and the
+ * sequence of nodes computing the output.  This is the backend of
+ * numpy.fuse, which builds the nodes by tracing a Python function.
+ */
+NPY_NO_EXPORT PyObject *
+ufunc_fuse(PyObject *NPY_UNUSED(dummy), PyObject *args)
+{
+    PyObject *nodes_obj, *nodes, *capsule;
+    char *name;
+    int nin, nnodes, j;
+    fused_program *prog;
+    PyUFuncObject *self;
+
+    if (!PyArg_ParseTuple(args, "siO", &name, &nin, &nodes_obj)) {
+        return NULL;
+    }
+    if (nin < 1 || nin >= NPY_MAXARGS) {
+        PyErr_Format(PyExc_ValueError,
+                "fused ufuncs must have between 1 and %d inputs",
+                NPY_MAXARGS - 1);
+        return NULL;
+    }
+    nodes = PySequence_Fast(nodes_obj, "fused ufunc nodes must be a sequence");
+    if (nodes == NULL) {
+        return NULL;
+    }
+    nnodes = (int)PySequence_Fast_GET_SIZE(nodes);
+    if (nnodes == 0) {
+        PyErr_SetString(PyExc_ValueError,
+                "fused ufuncs need at least one node");
+        Py_DECREF(nodes);
+        return NULL;
+    }
+
+    prog = PyArray_malloc(sizeof(fused_program));
+    if (prog == NULL) {
+        Py_DECREF(nodes);
+        return PyErr_NoMemory();
+    }
+    memset(prog, 0, sizeof(fused_program));
+    prog->nin = nin;
+    prog->nodes = PyArray_malloc(nnodes * sizeof(fused_node));
+    if (prog->nodes == NULL) {
+        PyArray_free(prog);
+        Py_DECREF(nodes);
+        return PyErr_NoMemory();
+    }
+    memset(prog->nodes, 0, nnodes * sizeof(fused_node));
+    prog->nnodes = nnodes;
+    capsule = NpyCapsule_FromVoidPtr(prog, &fused_program_capsule_dtor);
+    if (capsule == NULL) {
+        fused_program_free(prog);
+        Py_DECREF(nodes);
+        return NULL;
+    }
+
+    for (j = 0; j < nnodes; ++j) {
+        if (fused_parse_node(prog, j,
+                             PySequence_Fast_GET_ITEM(nodes, j)) < 0) {
+            Py_DECREF(capsule);
+            Py_DECREF(nodes);
+            return NULL;
+        }
+    }
+    Py_DECREF(nodes);
+
+    self = PyArray_malloc(sizeof(PyUFuncObject));
+    if (self == NULL) {
+        Py_DECREF(capsule);
+        return PyErr_NoMemory();
+    }
+    PyObject_Init((PyObject *)self, &PyUFunc_Type);
+
+    self->nin = nin;
+    self->nout = 1;
+    self->nargs = nin + 1;
+    self->identity = PyUFunc_None;
+    self->functions = NULL;
+    self->data = NULL;
+    self->types = NULL;
+    self->ntypes = 0;
+    self->check_return = 0;
+    self->userloops = NULL;
+    self->obj = capsule;
+    self->doc = "fused ufunc evaluating an expression of other ufuncs";
+
+    self->core_enabled = 0;
+    self->core_num_dim_ix = 0;
+    self->core_num_dims = NULL;
+    self->core_dim_ixs = NULL;
+    self->core_offsets = NULL;
+    self->core_signature = NULL;
+    self->core_threadsafe = 0;
+    self->iter_flags = 0;
+
+    self->type_resolver = &fused_type_resolver;
+    self->legacy_inner_loop_selector = &fused_loop_selector;
+    self->inner_loop_selector = NULL;
+    self->masked_inner_loop_selector = &PyUFunc_DefaultMaskedInnerLoopSelector;
+
+    /* self->ptr holds the name, freed with the ufunc */
+    self->ptr = NULL;
+    self->op_flags = PyArray_malloc(sizeof(npy_uint32) * self->nargs);
+    if (self->op_flags == NULL) {
+        Py_DECREF(self);
+        return PyErr_NoMemory();
+    }
+    memset(self->op_flags, 0, sizeof(npy_uint32) * self->nargs);
+    self->ptr = PyArray_malloc(strlen(name) + 1);
+    if (self->ptr == NULL) {
+        self->name = "?";
+        Py_DECREF(self);
+        return PyErr_NoMemory();
+    }
+    strcpy(self->ptr, name);
+    self->name = self->ptr;
+
+    return (PyObject *)self;
+}
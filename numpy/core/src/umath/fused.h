@@ -0,0 +1,7 @@
+#ifndef _NPY_UMATH_FUSED_H_
+#define _NPY_UMATH_FUSED_H_
+
+NPY_NO_EXPORT PyObject *
+ufunc_fuse(PyObject *NPY_UNUSED(dummy), PyObject *args);
+
+#endif
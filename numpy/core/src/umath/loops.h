@@ -40,6 +40,10 @@
 #define BOOL_fmax BOOL_maximum
 #define BOOL_fmin BOOL_minimum
 
+/* Selects the SIMD kernels used by the loops for the running cpu */
+NPY_NO_EXPORT void
+npy_simd_init(void);
+
 /*
  *****************************************************************************
  **                             BOOLEAN LOOPS                               **
@@ -1545,10 +1549,52 @@ ULONGLONG_remainder(char **args, npy_intp *dimensions, npy_intp *steps, void *NP
 NPY_NO_EXPORT void
 FLOAT_sqrt(char **args, npy_intp *dimensions, npy_intp *steps, void *NPY_UNUSED(func));
 
+#line 194
+NPY_NO_EXPORT void
+FLOAT_exp(char **args, npy_intp *dimensions, npy_intp *steps, void *NPY_UNUSED(func));
+
+#line 194
+NPY_NO_EXPORT void
+FLOAT_log(char **args, npy_intp *dimensions, npy_intp *steps, void *NPY_UNUSED(func));
+
+#line 194
+NPY_NO_EXPORT void
+FLOAT_sin(char **args, npy_intp *dimensions, npy_intp *steps, void *NPY_UNUSED(func));
+
+#line 194
+NPY_NO_EXPORT void
+FLOAT_cos(char **args, npy_intp *dimensions, npy_intp *steps, void *NPY_UNUSED(func));
+
+#line 194
+NPY_NO_EXPORT void
+FLOAT_tanh(char **args, npy_intp *dimensions, npy_intp *steps, void *NPY_UNUSED(func));
+
+
 #line 187
 NPY_NO_EXPORT void
 DOUBLE_sqrt(char **args, npy_intp *dimensions, npy_intp *steps, void *NPY_UNUSED(func));
 
+#line 194
+NPY_NO_EXPORT void
+DOUBLE_exp(char **args, npy_intp *dimensions, npy_intp *steps, void *NPY_UNUSED(func));
+
+#line 194
+NPY_NO_EXPORT void
+DOUBLE_log(char **args, npy_intp *dimensions, npy_intp *steps, void *NPY_UNUSED(func));
+
+#line 194
+NPY_NO_EXPORT void
+DOUBLE_sin(char **args, npy_intp *dimensions, npy_intp *steps, void *NPY_UNUSED(func));
+
+#line 194
+NPY_NO_EXPORT void
+DOUBLE_cos(char **args, npy_intp *dimensions, npy_intp *steps, void *NPY_UNUSED(func));
+
+#line 194
+NPY_NO_EXPORT void
+DOUBLE_tanh(char **args, npy_intp *dimensions, npy_intp *steps, void *NPY_UNUSED(func));
+
+
 
 #line 197
 
@@ -23,8 +23,10 @@
 #include "npy_config.h"
 #include "npy_pycompat.h"
 
+#include "numpy/ufuncobject.h"
 #include "lowlevel_strided_loops.h"
 #include "reduction.h"
+#include "ufunc_object.h"
 
 /*
  * Allocates a result array for a reduction operation, with
@@ -374,6 +376,412 @@ PyArray_InitializeReduceResult(
     return op_view;
 }
 
+/*
+ * Creates the iterator which visits the elements of 'op_view' together
+ * with the element of 'result' they are reduced into.
+ */
+static NpyIter *
+reduce_iter_new(PyArrayObject *result, PyArrayObject *op_view,
+                PyArray_Descr *result_dtype, PyArray_Descr *operand_dtype,
+                NPY_CASTING casting, npy_intp buffersize)
+{
+    PyArrayObject *op[2];
+    PyArray_Descr *op_dtypes[2];
+    npy_uint32 flags, op_flags[2];
+
+    op[0] = result;
+    op[1] = op_view;
+    op_dtypes[0] = result_dtype;
+    op_dtypes[1] = operand_dtype;
+
+    flags = NPY_ITER_BUFFERED |
+            NPY_ITER_EXTERNAL_LOOP |
+            NPY_ITER_GROWINNER |
+            NPY_ITER_DONT_NEGATE_STRIDES |
+            NPY_ITER_ZEROSIZE_OK |
+            NPY_ITER_REDUCE_OK |
+            NPY_ITER_REFS_OK;
+    op_flags[0] = NPY_ITER_READWRITE |
+                  NPY_ITER_ALIGNED |
+                  NPY_ITER_NO_SUBTYPE;
+    op_flags[1] = NPY_ITER_READONLY |
+                  NPY_ITER_ALIGNED;
+
+    return NpyIter_AdvancedNew(2, op, flags,
+                               NPY_KEEPORDER, casting,
+                               op_flags,
+                               op_dtypes,
+                               -1, NULL, NULL, buffersize);
+}
+
+/*
+ * Runs the reduction loop over an iterator created by reduce_iter_new.
+ * Must be called with the GIL held, which is released during the loop
+ * unless the loop or the iteration needs the Python API.
+ */
+static int
+reduce_iter_run(NpyIter *iter, PyArray_ReduceLoopFunc *loop,
+                int loop_needs_api, npy_intp skip_first_count, void *data)
+{
+    NpyIter_IterNextFunc *iternext;
+    int needs_api, retval;
+    NPY_BEGIN_THREADS_DEF;
+
+    if (NpyIter_GetIterSize(iter) == 0) {
+        return 0;
+    }
+
+    iternext = NpyIter_GetIterNext(iter, NULL);
+    if (iternext == NULL) {
+        return -1;
+    }
+    needs_api = loop_needs_api || NpyIter_IterationNeedsAPI(iter);
+
+    if (!needs_api) {
+        NPY_BEGIN_THREADS;
+    }
+
+    retval = loop(iter, NpyIter_GetDataPtrArray(iter),
+                  NpyIter_GetInnerStrideArray(iter),
+                  NpyIter_GetInnerLoopSizePtr(iter),
+                  iternext, needs_api, skip_first_count, data);
+
+    if (!needs_api) {
+        NPY_END_THREADS;
+    }
+
+    return retval;
+}
+
+/*
+ * Returns the number of tasks a reduction over 'operand' should be split
+ * into, or 1 if it should run serially.  Only reductions over builtin
+ * dtypes which don't need the Python API, and whose 'out' doesn't overlap
+ * the operand, are run in parallel.
+ */
+static int
+reduce_parallel_task_count(PyArrayObject *operand, PyArrayObject *out,
+                           PyArray_Descr *operand_dtype,
+                           PyArray_Descr *result_dtype)
+{
+    PyArray_Descr *dtypes[3];
+    int i;
+
+    if (PyArray_GetNumThreads() <= 1 || PyArray_NDIM(operand) == 0) {
+        return 1;
+    }
+
+    dtypes[0] = PyArray_DESCR(operand);
+    dtypes[1] = operand_dtype;
+    dtypes[2] = result_dtype;
+    for (i = 0; i < 3; ++i) {
+        if (dtypes[i]->type_num >= NPY_NTYPES ||
+                PyDataType_REFCHK(dtypes[i]) ||
+                PyDataType_FLAGCHK(dtypes[i], NPY_NEEDS_PYAPI)) {
+            return 1;
+        }
+    }
+
+    if (out != NULL) {
+        npy_uintp op_start, op_end, out_start, out_end;
+
+        get_array_byte_extent(operand, &op_start, &op_end);
+        get_array_byte_extent(out, &out_start, &out_end);
+        if (op_start < out_end && out_start < op_end) {
+            return 1;
+        }
+    }
+
+    return PyArray_ParallelTaskCount(PyArray_SIZE(operand),
+                                     NPY_UFUNC_PARALLEL_MINCHUNK);
+}
+
+/*
+ * Chooses the axis along which a parallel reduction splits 'operand',
+ * returning -1 if there is none, and clips *ntasks to its length.
+ *
+ * Splitting along an axis which is not reduced gives every task its own
+ * part of the result.  Splitting along a reduced axis, which requires
+ * a reorderable reduction, needs a partial result per task which are
+ * combined at the end, so it is preferred only when the result is small
+ * compared to the operand.  Among the candidates the axis with the
+ * largest stride is chosen, so each task works on a compact block.
+ */
+static int
+reduce_parallel_axis(PyArrayObject *operand, PyArrayObject *result,
+                     npy_bool *axis_flags, int reorderable, int *ntasks)
+{
+    int idim, ndim = PyArray_NDIM(operand);
+    int kept_axis = -1, reduced_axis = -1, axis;
+    npy_intp *shape = PyArray_DIMS(operand);
+    npy_intp *strides = PyArray_STRIDES(operand);
+    npy_intp kept_stride = -1, reduced_stride = -1;
+
+    for (idim = 0; idim < ndim; ++idim) {
+        npy_intp stride = strides[idim] < 0 ? -strides[idim] : strides[idim];
+
+        if (shape[idim] < 2) {
+            continue;
+        }
+        if (axis_flags[idim]) {
+            if (reorderable && stride > reduced_stride) {
+                reduced_axis = idim;
+                reduced_stride = stride;
+            }
+        }
+        else if (stride > kept_stride) {
+            kept_axis = idim;
+            kept_stride = stride;
+        }
+    }
+
+    if (reduced_axis >= 0 && (kept_axis < 0 ||
+                (reduced_stride > kept_stride &&
+                 PyArray_SIZE(result) * (*ntasks) * 4 <=
+                                        PyArray_SIZE(operand)))) {
+        axis = reduced_axis;
+    }
+    else {
+        axis = kept_axis;
+    }
+
+    if (axis >= 0 && shape[axis] < *ntasks) {
+        *ntasks = (int)shape[axis];
+    }
+    return axis;
+}
+
+/*
+ * Returns a view of 'arr' restricted to [start, start+count) along 'axis'.
+ */
+static PyArrayObject *
+reduce_slice_view(PyArrayObject *arr, int axis, npy_intp start,
+                  npy_intp count)
+{
+    PyArrayObject *view;
+
+    view = (PyArrayObject *)PyArray_View(arr, NULL, &PyArray_Type);
+    if (view == NULL) {
+        return NULL;
+    }
+    ((PyArrayObject_fields *)view)->data += start * PyArray_STRIDE(arr, axis);
+    PyArray_DIMS(view)[axis] = count;
+    PyArray_UpdateFlags(view, NPY_ARRAY_UPDATE_ALL);
+
+    return view;
+}
+
+typedef struct {
+    PyArray_ReduceLoopFunc *loop;
+    void *data;
+    /* Per task iterators, NULL if the task has nothing to reduce */
+    NpyIter **iters;
+    NpyIter_IterNextFunc **iternexts;
+    npy_intp *skip_first_counts;
+    int *retvals;
+    /* Floating point error flags raised by each task */
+    int *fpe_status;
+} reduce_parallel_data;
+
+static void
+reduce_parallel_task(void *data, npy_intp itask)
+{
+    reduce_parallel_data *d = (reduce_parallel_data *)data;
+    NpyIter *iter = d->iters[itask];
+    int status;
+
+    if (iter != NULL) {
+        d->retvals[itask] = d->loop(iter, NpyIter_GetDataPtrArray(iter),
+                                    NpyIter_GetInnerStrideArray(iter),
+                                    NpyIter_GetInnerLoopSizePtr(iter),
+                                    d->iternexts[itask], 0,
+                                    d->skip_first_counts[itask], d->data);
+    }
+
+    UFUNC_CHECK_STATUS(status);
+    d->fpe_status[itask] = status;
+}
+
+/*
+ * Computes the reduction of 'operand' into 'result' by splitting it into
+ * 'ntasks' pieces along 'split_axis', which are reduced concurrently on
+ * the thread pool.  When 'split_axis' is one of the reduction axes, every
+ * piece is reduced into its own partial result, and the partial results
+ * are then combined pairwise in a tree into 'result'.
+ *
+ * Returns 0 on success, -1 on failure.
+ */
+static int
+reduce_parallel(PyArrayObject *operand, PyArrayObject *result,
+                PyArray_Descr *operand_dtype, PyArray_Descr *result_dtype,
+                NPY_CASTING casting, npy_bool *axis_flags, int reorderable,
+                int split_axis, int ntasks,
+                PyArray_AssignReduceIdentityFunc *assign_identity,
+                PyArray_ReduceLoopFunc *loop, void *data,
+                npy_intp buffersize, const char *funcname)
+{
+    reduce_parallel_data d;
+    PyArrayObject **results, **views;
+    npy_intp chunksize, length = PyArray_DIM(operand, split_axis);
+    int itask, step, status = 0, retval = -1;
+    int partial = axis_flags[split_axis];
+    NPY_BEGIN_THREADS_DEF;
+
+    chunksize = (length + ntasks - 1) / ntasks;
+    ntasks = (int)((length + chunksize - 1) / chunksize);
+
+    results = PyArray_malloc(ntasks * sizeof(PyArrayObject *));
+    views = PyArray_malloc(ntasks * sizeof(PyArrayObject *));
+    d.iters = PyArray_malloc(ntasks * sizeof(NpyIter *));
+    d.iternexts = PyArray_malloc(ntasks * sizeof(NpyIter_IterNextFunc *));
+    d.skip_first_counts = PyArray_malloc(ntasks * sizeof(npy_intp));
+    d.retvals = PyArray_malloc(ntasks * sizeof(int));
+    d.fpe_status = PyArray_malloc(ntasks * sizeof(int));
+    if (results == NULL || views == NULL || d.iters == NULL ||
+            d.iternexts == NULL || d.skip_first_counts == NULL ||
+            d.retvals == NULL || d.fpe_status == NULL) {
+        PyErr_NoMemory();
+        ntasks = 0;
+        goto finish;
+    }
+    for (itask = 0; itask < ntasks; ++itask) {
+        results[itask] = NULL;
+        views[itask] = NULL;
+        d.iters[itask] = NULL;
+        d.skip_first_counts[itask] = 0;
+        d.retvals[itask] = 0;
+    }
+    d.loop = loop;
+    d.data = data;
+
+    /* Set up the result, operand view and iterator of each task */
+    for (itask = 0; itask < ntasks; ++itask) {
+        npy_intp start = itask * chunksize, count = chunksize;
+        PyArrayObject *sub;
+
+        if (start + count > length) {
+            count = length - start;
+        }
+        sub = reduce_slice_view(operand, split_axis, start, count);
+        if (sub == NULL) {
+            goto finish;
+        }
+
+        if (!partial) {
+            results[itask] = reduce_slice_view(result, split_axis,
+                                               start, count);
+        }
+        else if (itask == 0) {
+            results[itask] = result;
+            Py_INCREF(result);
+        }
+        else {
+            Py_INCREF(result_dtype);
+            results[itask] = (PyArrayObject *)PyArray_NewFromDescr(
+                                    &PyArray_Type, result_dtype,
+                                    PyArray_NDIM(result),
+                                    PyArray_DIMS(result),
+                                    NULL, NULL, 0, NULL);
+        }
+        if (results[itask] == NULL) {
+            Py_DECREF(sub);
+            goto finish;
+        }
+
+        if (assign_identity != NULL) {
+            if (assign_identity(results[itask], data) < 0) {
+                Py_DECREF(sub);
+                goto finish;
+            }
+            views[itask] = sub;
+        }
+        else {
+            views[itask] = PyArray_InitializeReduceResult(results[itask],
+                                    sub, axis_flags, reorderable,
+                                    &d.skip_first_counts[itask], funcname);
+            Py_DECREF(sub);
+            if (views[itask] == NULL) {
+                goto finish;
+            }
+        }
+
+        if (PyArray_SIZE(views[itask]) == 0) {
+            continue;
+        }
+        d.iters[itask] = reduce_iter_new(results[itask], views[itask],
+                                         result_dtype, operand_dtype,
+                                         casting, buffersize);
+        if (d.iters[itask] == NULL) {
+            goto finish;
+        }
+        if (NpyIter_GetIterSize(d.iters[itask]) == 0) {
+            NpyIter_Deallocate(d.iters[itask]);
+            d.iters[itask] = NULL;
+            continue;
+        }
+        if (NpyIter_IterationNeedsAPI(d.iters[itask])) {
+            PyErr_SetString(PyExc_RuntimeError,
+                    "parallel reduction requires an iteration "
+                    "which does not need the Python API");
+            goto finish;
+        }
+        d.iternexts[itask] = NpyIter_GetIterNext(d.iters[itask], NULL);
+        if (d.iternexts[itask] == NULL) {
+            goto finish;
+        }
+    }
+
+    NPY_BEGIN_THREADS;
+    PyArray_ParallelRun(&reduce_parallel_task, &d, ntasks);
+    NPY_END_THREADS;
+
+    for (itask = 0; itask < ntasks; ++itask) {
+        status |= d.fpe_status[itask];
+        if (d.retvals[itask] < 0) {
+            goto finish;
+        }
+    }
+    ufunc_set_fpe_status(status);
+
+    /* Combine the partial results pairwise into the first one */
+    if (partial) {
+        for (step = 1; step < ntasks; step *= 2) {
+            for (itask = 0; itask + step < ntasks; itask += 2 * step) {
+                NpyIter *iter = reduce_iter_new(results[itask],
+                                    results[itask + step], result_dtype,
+                                    result_dtype, casting, buffersize);
+                if (iter == NULL) {
+                    goto finish;
+                }
+                if (reduce_iter_run(iter, loop, 0, 0, data) < 0) {
+                    NpyIter_Deallocate(iter);
+                    goto finish;
+                }
+                NpyIter_Deallocate(iter);
+            }
+        }
+    }
+
+    retval = 0;
+
+finish:
+    for (itask = 0; itask < ntasks; ++itask) {
+        if (d.iters[itask] != NULL) {
+            NpyIter_Deallocate(d.iters[itask]);
+        }
+        Py_XDECREF(results[itask]);
+        Py_XDECREF(views[itask]);
+    }
+    PyArray_free(results);
+    PyArray_free(views);
+    PyArray_free(d.iters);
+    PyArray_free(d.iternexts);
+    PyArray_free(d.skip_first_counts);
+    PyArray_free(d.retvals);
+    PyArray_free(d.fpe_status);
+    return retval;
+}
+
 /*
  * This function executes all the standard NumPy reduction function
  * boilerplate code, just calling assign_identity and the appropriate
@@ -401,6 +809,8 @@ PyArray_InitializeReduceResult(
  *               this function is called to initialize the result to
  *               the reduction's unit.
  * loop        : The loop which does the reduction.
+ * loop_needs_api : If true, 'loop' uses the Python API, so the reduction
+ *               keeps the GIL and is not split across the thread pool.
  * data        : Data which is passed to assign_identity and the inner loop.
  * buffersize  : Buffer size for the iterator. For the default, pass in 0.
  * funcname    : The name of the reduction function, for error messages.
@@ -424,17 +834,13 @@ PyUFunc_ReduceWrapper(PyArrayObject *operand, PyArrayObject *out,
                       int keepdims,
                       int subok,
                       PyArray_AssignReduceIdentityFunc *assign_identity,
-                      PyArray_ReduceLoopFunc *loop,
+                      PyArray_ReduceLoopFunc *loop, int loop_needs_api,
                       void *data, npy_intp buffersize, const char *funcname)
 {
     PyArrayObject *result = NULL, *op_view = NULL;
     npy_intp skip_first_count = 0;
-
-    /* Iterator parameters */
     NpyIter *iter = NULL;
-    PyArrayObject *op[2];
-    PyArray_Descr *op_dtypes[2];
-    npy_uint32 flags, op_flags[2];
+    int split_axis, ntasks;
 
     /* Validate that the parameters for future expansion are NULL */
     if (wheremask != NULL) {
@@ -444,6 +850,22 @@ PyUFunc_ReduceWrapper(PyArrayObject *operand, PyArrayObject *out,
         return NULL;
     }
 
+    if (loop == NULL) {
+        PyErr_Format(PyExc_RuntimeError,
+                "reduction operation %s did not supply an "
+                "inner loop function", funcname);
+        return NULL;
+    }
+
+    /*
+     * If this reduction is non-reorderable, make sure there are
+     * only 0 or 1 axes in axis_flags.
+     */
+    if (!reorderable && check_nonreorderable_axes(PyArray_NDIM(operand),
+                                    axis_flags, funcname) < 0) {
+        return NULL;
+    }
+
     /*
      * This either conforms 'out' to the ndim of 'operand', or allocates
      * a new array appropriate for this reduction.
@@ -456,20 +878,31 @@ PyUFunc_ReduceWrapper(PyArrayObject *operand, PyArrayObject *out,
         goto fail;
     }
 
+    /* Large reductions are split across the thread pool */
+    ntasks = 1;
+    if (!loop_needs_api) {
+        ntasks = reduce_parallel_task_count(operand, out, operand_dtype,
+                                            result_dtype);
+    }
+    if (ntasks > 1) {
+        split_axis = reduce_parallel_axis(operand, result, axis_flags,
+                                          reorderable, &ntasks);
+        if (split_axis >= 0) {
+            if (reduce_parallel(operand, result, operand_dtype,
+                            result_dtype, casting, axis_flags, reorderable,
+                            split_axis, ntasks, assign_identity, loop, data,
+                            buffersize, funcname) < 0) {
+                goto fail;
+            }
+            goto finish;
+        }
+    }
+
     /*
      * Initialize the result to the reduction unit if possible,
      * otherwise copy the initial values and get a view to the rest.
      */
     if (assign_identity != NULL) {
-        /*
-         * If this reduction is non-reorderable, make sure there are
-         * only 0 or 1 axes in axis_flags.
-         */
-        if (!reorderable && check_nonreorderable_axes(PyArray_NDIM(operand),
-                                        axis_flags, funcname) < 0) {
-            goto fail;
-        }
-
         if (assign_identity(result, data) < 0) {
             goto fail;
         }
@@ -491,64 +924,14 @@ PyUFunc_ReduceWrapper(PyArrayObject *operand, PyArrayObject *out,
         }
     }
 
-    /* Set up the iterator */
-    op[0] = result;
-    op[1] = op_view;
-    op_dtypes[0] = result_dtype;
-    op_dtypes[1] = operand_dtype;
-
-    flags = NPY_ITER_BUFFERED |
-            NPY_ITER_EXTERNAL_LOOP |
-            NPY_ITER_GROWINNER |
-            NPY_ITER_DONT_NEGATE_STRIDES |
-            NPY_ITER_ZEROSIZE_OK |
-            NPY_ITER_REDUCE_OK |
-            NPY_ITER_REFS_OK;
-    op_flags[0] = NPY_ITER_READWRITE |
-                  NPY_ITER_ALIGNED |
-                  NPY_ITER_NO_SUBTYPE;
-    op_flags[1] = NPY_ITER_READONLY |
-                  NPY_ITER_ALIGNED;
-
-    iter = NpyIter_AdvancedNew(2, op, flags,
-                               NPY_KEEPORDER, casting,
-                               op_flags,
-                               op_dtypes,
-                               -1, NULL, NULL, buffersize);
+    iter = reduce_iter_new(result, op_view, result_dtype, operand_dtype,
+                           casting, buffersize);
     if (iter == NULL) {
         goto fail;
     }
-
-    if (NpyIter_GetIterSize(iter) != 0) {
-        NpyIter_IterNextFunc *iternext;
-        char **dataptr;
-        npy_intp *strideptr;
-        npy_intp *countptr;
-        int needs_api;
-
-        iternext = NpyIter_GetIterNext(iter, NULL);
-        if (iternext == NULL) {
-            goto fail;
-        }
-        dataptr = NpyIter_GetDataPtrArray(iter);
-        strideptr = NpyIter_GetInnerStrideArray(iter);
-        countptr = NpyIter_GetInnerLoopSizePtr(iter);
-
-        needs_api = NpyIter_IterationNeedsAPI(iter);
-
-        /* Straightforward reduction */
-        if (loop == NULL) {
-            PyErr_Format(PyExc_RuntimeError,
-                    "reduction operation %s did not supply an "
-                    "inner loop function", funcname);
-            goto fail;
-        }
-
-        if (loop(iter, dataptr, strideptr, countptr,
-                        iternext, needs_api, skip_first_count, data) < 0) {
-
-            goto fail;
-        }
+    if (reduce_iter_run(iter, loop, loop_needs_api,
+                        skip_first_count, data) < 0) {
+        goto fail;
     }
 
     NpyIter_Deallocate(iter);
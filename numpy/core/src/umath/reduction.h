@@ -21,9 +21,11 @@ typedef int (PyArray_AssignReduceIdentityFunc)(PyArrayObject *result,
 /*
  * This is a function for the reduce loop.
  *
- * The needs_api parameter indicates whether it's ok to release the GIL during
- * the loop, such as when the iternext() function never calls
- * a function which could raise a Python exception.
+ * The needs_api parameter indicates whether the loop is called with the GIL
+ * held.  When it is False, PyArray_ReduceWrapper has already released the
+ * GIL, and the loop may be running concurrently with other instances of
+ * itself on the thread pool, each reducing a different piece of the
+ * operand.  It must then not touch any Python objects.
  *
  * Ths skip_first_count parameter indicates how many elements need to be
  * skipped based on NpyIter_IsFirstVisit checks. This can only be positive
@@ -33,10 +35,6 @@ typedef int (PyArray_AssignReduceIdentityFunc)(PyArrayObject *result,
  * The loop gets two data pointers and two strides, and should
  * look roughly like this:
  *  {
- *      NPY_BEGIN_THREADS_DEF;
- *      if (!needs_api) {
- *          NPY_BEGIN_THREADS;
- *      }
  *      // This first-visit loop can be skipped if 'assign_identity' was non-NULL
  *      if (skip_first_count > 0) {
  *          do {
@@ -88,9 +86,6 @@ typedef int (PyArray_AssignReduceIdentityFunc)(PyArrayObject *result,
  *          }
  *      } while (iternext(iter));
  *  finish_loop:
- *      if (!needs_api) {
- *          NPY_END_THREADS;
- *      }
  *      return (needs_api && PyErr_Occurred()) ? -1 : 0;
  *  }
  *
@@ -125,7 +120,10 @@ typedef int (PyArray_ReduceLoopFunc)(NpyIter *iter,
  *               means specifying multiple axes of reduction at once is ok,
  *               and the reduction code may calculate the reduction in an
  *               arbitrary order. The calculation may be reordered because
- *               of cache behavior or multithreading requirements.
+ *               of cache behavior or multithreading requirements. Large
+ *               reorderable reductions may be split along a reduction
+ *               axis across the thread pool, and the partial results
+ *               combined by calling 'loop' on them afterwards.
  * keepdims    : If true, leaves the reduction dimensions in the result
  *               with size one.
  * subok       : If true, the result uses the subclass of operand, otherwise
@@ -134,6 +132,8 @@ typedef int (PyArray_ReduceLoopFunc)(NpyIter *iter,
  *               this function is called to initialize the result to
  *               the reduction's unit.
  * loop        : The loop which does the reduction.
+ * loop_needs_api : If true, 'loop' uses the Python API, so the reduction
+ *               keeps the GIL and is not split across the thread pool.
  * data        : Data which is passed to assign_identity and the inner loop.
  * buffersize  : Buffer size for the iterator. For the default, pass in 0.
  * funcname    : The name of the reduction function, for error messages.
@@ -148,7 +148,7 @@ PyUFunc_ReduceWrapper(PyArrayObject *operand, PyArrayObject *out,
                       int keepdims,
                       int subok,
                       PyArray_AssignReduceIdentityFunc *assign_identity,
-                      PyArray_ReduceLoopFunc *loop,
+                      PyArray_ReduceLoopFunc *loop, int loop_needs_api,
                       void *data, npy_intp buffersize, const char *funcname);
 
 #endif
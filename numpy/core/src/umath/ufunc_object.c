@@ -28,6 +28,11 @@
 
 #include "Python.h"
 
+#include <time.h>
+#ifndef _WIN32
+#include <sys/time.h>
+#endif
+
 #include "npy_config.h"
 #ifdef ENABLE_SEPARATE_COMPILATION
 #define PY_ARRAY_UNIQUE_SYMBOL _npy_umathmodule_ARRAY_API
@@ -224,6 +229,100 @@ PyUFunc_clearfperr()
     PyUFunc_getfperr();
 }
 
+/* Profiling hook for ufunc calls */
+static PyUFunc_ProfileHookFunc *ufunc_profile_hook = NULL;
+static void *ufunc_profile_hook_user_data = NULL;
+
+/*UFUNC_API
+ * Sets the profiling hook for ufunc calls.
+ * Takes a PyUFunc_ProfileHookFunc *, which has the signature:
+ *        void hook(PyUFuncObject *ufunc, const char *method,
+ *                  PyUFunc_ProfileInfo *info, void *user_data).
+ *   Also takes a void *user_data, and void **old_data.
+ *
+ * Returns a pointer to the previous hook or NULL.  If old_data is
+ * non-NULL, the previous user_data pointer will be copied to it.
+ *
+ * If not NULL, hook will be called at the end of every successful ufunc
+ * call and reduce, accumulate and reduceat, with method set to
+ * "__call__" or the name of the method, and info holding the counters
+ * of that call.
+ *
+ * When the hook is called, the GIL will be held by the calling
+ * thread.  The hook must not raise Python exceptions.
+ */
+NPY_NO_EXPORT PyUFunc_ProfileHookFunc *
+PyUFunc_SetProfileHook(PyUFunc_ProfileHookFunc *newhook,
+                       void *user_data, void **old_data)
+{
+    PyGILState_STATE gilstate = PyGILState_Ensure();
+    PyUFunc_ProfileHookFunc *temp = ufunc_profile_hook;
+    ufunc_profile_hook = newhook;
+    if (old_data != NULL) {
+        *old_data = ufunc_profile_hook_user_data;
+    }
+    ufunc_profile_hook_user_data = user_data;
+    PyGILState_Release(gilstate);
+    return temp;
+}
+
+/*
+ * A monotonic clock in seconds for the profiling counters.
+ */
+static double
+ufunc_profile_clock(void)
+{
+#if defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+#elif defined(_WIN32)
+    return (double)clock() / CLOCKS_PER_SEC;
+#else
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec + 1e-6 * (double)tv.tv_usec;
+#endif
+}
+
+/*
+ * Starts the counters of a ufunc call.  Returns 'prof' if a profiling
+ * hook is set, NULL otherwise, and the start time in 'start'.
+ */
+static PyUFunc_ProfileInfo *
+ufunc_profile_start(PyUFunc_ProfileInfo *prof, double *start)
+{
+    if (ufunc_profile_hook == NULL) {
+        return NULL;
+    }
+    memset(prof, 0, sizeof(PyUFunc_ProfileInfo));
+    *start = ufunc_profile_clock();
+    return prof;
+}
+
+/*
+ * Passes the counters of a finished ufunc call to the profiling hook.
+ * Any time since 'start' that wasn't counted as loop or buffer time
+ * is setup time.
+ */
+static void
+ufunc_profile_report(PyUFuncObject *ufunc, const char *method,
+                     PyUFunc_ProfileInfo *prof, double start)
+{
+    prof->setup_time = ufunc_profile_clock() - start -
+                       prof->loop_time - prof->buffer_time;
+    if (prof->setup_time < 0) {
+        prof->setup_time = 0;
+    }
+    /* The hook may have been removed while the GIL was released */
+    if (ufunc_profile_hook != NULL) {
+        (*ufunc_profile_hook)(ufunc, method, prof,
+                              ufunc_profile_hook_user_data);
+    }
+}
+
 /*
  * This function analyzes the input arguments
  * and determines an appropriate __array_prepare__ function to call
@@ -369,21 +468,43 @@ static PyObject *PyUFunc_PYVALS_NAME = NULL;
 
 
 /*
- * Extracts some values from the global pyvals tuple.
- * ref - should hold the global tuple
- * name - is the name of the ufunc (ufuncobj->name)
+ * The last error object list parsed by _parse_pyvals and the values
+ * parsed from it.  References to the list and to its items are held,
+ * so comparing identities is enough to know that the values are still
+ * valid, even if the list was modified in place.  Calling seterrobj
+ * installs a new list, which makes the next call parse it again.
+ */
+static struct {
+    PyObject *ref;
+    PyObject *items[3];
+    int bufsize;
+    int errmask;
+} pyvals_cache = {NULL, {NULL, NULL, NULL}, 0, 0};
+
+/*
+ * Parses the values of a pyvals list.
+ * ref - should hold the global list
  * bufsize - receives the buffer size to use
  * errmask - receives the bitmask for error handling
- * errobj - receives the python object to call with the error,
- *          if an error handling method is 'call'
+ * callback - receives a borrowed reference to the error callback,
+ *            or Py_None
  */
 static int
-_extract_pyvals(PyObject *ref, char *name, int *bufsize,
-                int *errmask, PyObject **errobj)
+_parse_pyvals(PyObject *ref, int *bufsize, int *errmask, PyObject **callback)
 {
-    PyObject *retval;
+    PyObject *retval, *old_ref, *old_items[3];
+    int i;
+
+    if (ref == pyvals_cache.ref && PyList_GET_SIZE(ref) == 3 &&
+            PyList_GET_ITEM(ref, 0) == pyvals_cache.items[0] &&
+            PyList_GET_ITEM(ref, 1) == pyvals_cache.items[1] &&
+            PyList_GET_ITEM(ref, 2) == pyvals_cache.items[2]) {
+        *bufsize = pyvals_cache.bufsize;
+        *errmask = pyvals_cache.errmask;
+        *callback = pyvals_cache.items[2];
+        return 0;
+    }
 
-    *errobj = NULL;
     if (!PyList_Check(ref) || (PyList_GET_SIZE(ref)!=3)) {
         PyErr_Format(PyExc_TypeError,
                 "%s must be a length 3 list.", UFUNC_PYVALS_NAME);
@@ -394,7 +515,8 @@ _extract_pyvals(PyObject *ref, char *name, int *bufsize,
     if ((*bufsize == -1) && PyErr_Occurred()) {
         return -1;
     }
-    if ((*bufsize < NPY_MIN_BUFSIZE) ||
+    /* A buffer size of 0 lets the iterator choose one */
+    if ((*bufsize != 0 && *bufsize < NPY_MIN_BUFSIZE) ||
             (*bufsize > NPY_MAX_BUFSIZE) ||
             (*bufsize % 16 != 0)) {
         PyErr_Format(PyExc_ValueError,
@@ -429,6 +551,48 @@ _extract_pyvals(PyObject *ref, char *name, int *bufsize,
         }
         Py_DECREF(temp);
     }
+    *callback = retval;
+
+    /*
+     * Remember the parsed values.  The old references are released
+     * last, since that may run arbitrary code.
+     */
+    old_ref = pyvals_cache.ref;
+    Py_INCREF(ref);
+    pyvals_cache.ref = ref;
+    for (i = 0; i < 3; ++i) {
+        old_items[i] = pyvals_cache.items[i];
+        pyvals_cache.items[i] = PyList_GET_ITEM(ref, i);
+        Py_INCREF(pyvals_cache.items[i]);
+    }
+    pyvals_cache.bufsize = *bufsize;
+    pyvals_cache.errmask = *errmask;
+    for (i = 0; i < 3; ++i) {
+        Py_XDECREF(old_items[i]);
+    }
+    Py_XDECREF(old_ref);
+    return 0;
+}
+
+/*
+ * Extracts some values from the global pyvals tuple.
+ * ref - should hold the global tuple
+ * name - is the name of the ufunc (ufuncobj->name)
+ * bufsize - receives the buffer size to use
+ * errmask - receives the bitmask for error handling
+ * errobj - receives the python object to call with the error,
+ *          if an error handling method is 'call'
+ */
+static int
+_extract_pyvals(PyObject *ref, char *name, int *bufsize,
+                int *errmask, PyObject **errobj)
+{
+    PyObject *retval;
+
+    *errobj = NULL;
+    if (_parse_pyvals(ref, bufsize, errmask, &retval) < 0) {
+        return -1;
+    }
 
     *errobj = Py_BuildValue("NO", PyBytes_FromString(name), retval);
     if (*errobj == NULL) {
@@ -437,7 +601,79 @@ _extract_pyvals(PyObject *ref, char *name, int *bufsize,
     return 0;
 }
 
+/*
+ * Returns a borrowed reference to the pyvals list of the current
+ * thread, or NULL if the defaults are in use.
+ */
+static PyObject *
+_get_pyvals_ref(void)
+{
+    PyObject *thedict;
+
+#if USE_USE_DEFAULTS==1
+    if (PyUFunc_NUM_NODEFAULTS == 0) {
+        return NULL;
+    }
+#endif
+    if (PyUFunc_PYVALS_NAME == NULL) {
+        PyUFunc_PYVALS_NAME = PyUString_InternFromString(UFUNC_PYVALS_NAME);
+    }
+    thedict = PyThreadState_GetDict();
+    if (thedict == NULL) {
+        thedict = PyEval_GetBuiltins();
+    }
+    return PyDict_GetItem(thedict, PyUFunc_PYVALS_NAME);
+}
+
+/*
+ * Like PyUFunc_GetPyValues, but for the extobj= parameter or the
+ * thread's pyvals.  Instead of building the error object, which is
+ * only needed once a floating point error has to be handled, returns
+ * a new reference to the error callback.
+ */
+static int
+_get_pyvals(PyObject *extobj, int *bufsize, int *errmask,
+                PyObject **callback)
+{
+    if (extobj == NULL) {
+        extobj = _get_pyvals_ref();
+    }
+    if (extobj == NULL) {
+        *errmask = UFUNC_ERR_DEFAULT;
+        *bufsize = 0;
+        *callback = Py_None;
+    }
+    else if (_parse_pyvals(extobj, bufsize, errmask, callback) < 0) {
+        *callback = NULL;
+        return -1;
+    }
+    Py_INCREF(*callback);
+    return 0;
+}
+
+/*
+ * Checks the floating point status after a loop ran and handles any
+ * errors according to errmask, building the error object on demand.
+ */
+static int
+_check_fperr_callback(int errmask, PyObject *callback, char *name,
+                int *first)
+{
+    PyObject *errobj;
+    int retstatus, ret;
 
+    retstatus = PyUFunc_getfperr();
+    if (retstatus == 0) {
+        return 0;
+    }
+    errobj = Py_BuildValue("NO", PyBytes_FromString(name), callback);
+    if (errobj == NULL) {
+        return -1;
+    }
+    ret = PyUFunc_handlefperr(errmask, errobj, retstatus, first);
+    Py_DECREF(errobj);
+    return ret;
+}
 
 /*UFUNC_API
  *
@@ -447,27 +683,12 @@ _extract_pyvals(PyObject *ref, char *name, int *bufsize,
 NPY_NO_EXPORT int
 PyUFunc_GetPyValues(char *name, int *bufsize, int *errmask, PyObject **errobj)
 {
-    PyObject *thedict;
-    PyObject *ref = NULL;
+    PyObject *ref = _get_pyvals_ref();
 
-#if USE_USE_DEFAULTS==1
-    if (PyUFunc_NUM_NODEFAULTS != 0) {
-#endif
-        if (PyUFunc_PYVALS_NAME == NULL) {
-            PyUFunc_PYVALS_NAME = PyUString_InternFromString(UFUNC_PYVALS_NAME);
-        }
-        thedict = PyThreadState_GetDict();
-        if (thedict == NULL) {
-            thedict = PyEval_GetBuiltins();
-        }
-        ref = PyDict_GetItem(thedict, PyUFunc_PYVALS_NAME);
-#if USE_USE_DEFAULTS==1
-    }
-#endif
     if (ref == NULL) {
         *errmask = UFUNC_ERR_DEFAULT;
         *errobj = Py_BuildValue("NO", PyBytes_FromString(name), Py_None);
-        *bufsize = NPY_BUFSIZE;
+        *bufsize = 0;
         return 0;
     }
     return _extract_pyvals(ref, name, bufsize, errmask, errobj);
@@ -1041,6 +1262,10 @@ check_for_trivial_loop(PyUFuncObject *ufunc,
 {
     npy_intp i, nin = ufunc->nin, nop = nin + ufunc->nout;
 
+    if (buffersize <= 0) {
+        buffersize = NPY_BUFSIZE;
+    }
+
     for (i = 0; i < nop; ++i) {
         /*
          * If the dtype doesn't match, or the array isn't aligned,
@@ -1077,13 +1302,212 @@ check_for_trivial_loop(PyUFuncObject *ufunc,
     return 1;
 }
 
+/*
+ * Re-raises floating point error flags, collected from other threads
+ * with UFUNC_CHECK_STATUS, in the calling thread.
+ */
+NPY_NO_EXPORT void
+ufunc_set_fpe_status(int status)
+{
+    if (status & UFUNC_FPE_DIVIDEBYZERO) {
+        npy_set_floatstatus_divbyzero();
+    }
+    if (status & UFUNC_FPE_OVERFLOW) {
+        npy_set_floatstatus_overflow();
+    }
+    if (status & UFUNC_FPE_UNDERFLOW) {
+        npy_set_floatstatus_underflow();
+    }
+    if (status & UFUNC_FPE_INVALID) {
+        npy_set_floatstatus_invalid();
+    }
+}
+
+/*
+ * Computes the range of bytes [*start, *end) spanned by the array.
+ */
+NPY_NO_EXPORT void
+get_array_byte_extent(PyArrayObject *arr, npy_uintp *start, npy_uintp *end)
+{
+    int idim, ndim = PyArray_NDIM(arr);
+    npy_intp *shape = PyArray_DIMS(arr), *strides = PyArray_STRIDES(arr);
+    npy_uintp low = (npy_uintp)PyArray_DATA(arr);
+    npy_uintp high = low + PyArray_ITEMSIZE(arr);
+
+    for (idim = 0; idim < ndim; ++idim) {
+        if (shape[idim] == 0) {
+            *start = *end = low;
+            return;
+        }
+        if (strides[idim] < 0) {
+            low += strides[idim] * (shape[idim] - 1);
+        }
+        else {
+            high += strides[idim] * (shape[idim] - 1);
+        }
+    }
+    *start = low;
+    *end = high;
+}
+
+/*
+ * Returns 1 if it is safe to split the loop over the operands into
+ * independent pieces executed by different threads, 0 otherwise.
+ *
+ * This requires builtin, non-object dtypes, a loop which doesn't want
+ * the arrays themselves, and that no output overlaps another operand
+ * unless it is exactly the same view of memory (as in an in-place
+ * operation), since overlapping loops depend on the serial order.
+ */
+static int
+ufunc_loop_can_parallelize(PyUFuncObject *ufunc, PyArrayObject **op,
+                           void *innerloopdata)
+{
+    int i, j, nin = ufunc->nin, nop = ufunc->nin + ufunc->nout;
+
+    if (PyArray_GetNumThreads() <= 1 ||
+                        _does_loop_use_arrays(innerloopdata)) {
+        return 0;
+    }
+    for (i = 0; i < nop; ++i) {
+        if (op[i] == NULL) {
+            continue;
+        }
+        if (PyArray_DESCR(op[i])->type_num >= NPY_NTYPES ||
+                        PyDataType_REFCHK(PyArray_DESCR(op[i]))) {
+            return 0;
+        }
+        if (i < nin && (ufunc->op_flags[i] &
+                        (NPY_ITER_READWRITE | NPY_ITER_WRITEONLY))) {
+            return 0;
+        }
+    }
+    for (i = nin; i < nop; ++i) {
+        npy_uintp out_start, out_end;
+
+        if (op[i] == NULL) {
+            continue;
+        }
+        get_array_byte_extent(op[i], &out_start, &out_end);
+        for (j = 0; j < nop; ++j) {
+            npy_uintp start, end;
+
+            if (j == i || op[j] == NULL) {
+                continue;
+            }
+            get_array_byte_extent(op[j], &start, &end);
+            if (start >= out_end || out_start >= end) {
+                continue;
+            }
+            if (PyArray_BYTES(op[j]) != PyArray_BYTES(op[i]) ||
+                    PyArray_NDIM(op[j]) != PyArray_NDIM(op[i]) ||
+                    !PyArray_CompareLists(PyArray_DIMS(op[j]),
+                                          PyArray_DIMS(op[i]),
+                                          PyArray_NDIM(op[i])) ||
+                    !PyArray_CompareLists(PyArray_STRIDES(op[j]),
+                                          PyArray_STRIDES(op[i]),
+                                          PyArray_NDIM(op[i]))) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+typedef struct {
+    PyUFuncGenericFunction innerloop;
+    void *innerloopdata;
+    int nop;
+    char *data[NPY_MAXARGS];
+    npy_intp stride[NPY_MAXARGS];
+    npy_intp count, chunksize;
+    /* Floating point error flags raised by each task */
+    int *fpe_status;
+} trivial_parallel_data;
+
+static void
+trivial_parallel_task(void *data, npy_intp itask)
+{
+    trivial_parallel_data *d = (trivial_parallel_data *)data;
+    char *dataptr[NPY_MAXARGS];
+    npy_intp count[NPY_MAXARGS];
+    npy_intp start = itask * d->chunksize;
+    int iop, status;
+
+    for (iop = 0; iop < d->nop; ++iop) {
+        dataptr[iop] = d->data[iop] + start * d->stride[iop];
+        count[iop] = d->count - start;
+        if (count[iop] > d->chunksize) {
+            count[iop] = d->chunksize;
+        }
+    }
+    d->innerloop(dataptr, count, d->stride, d->innerloopdata);
+
+    UFUNC_CHECK_STATUS(status);
+    d->fpe_status[itask] = status;
+}
+
+/*
+ * Runs a trivial loop, splitting it across the thread pool when
+ * 'parallel_ok' is set and the loop is big enough.  Must be called
+ * with the GIL released.
+ */
+static void
+trivial_loop_run(int nop, char **data, npy_intp count, npy_intp *stride,
+                 PyUFuncGenericFunction innerloop, void *innerloopdata,
+                 int parallel_ok)
+{
+    npy_intp counts[NPY_MAXARGS];
+    int iop, ntasks = 1;
+
+    if (parallel_ok) {
+        ntasks = PyArray_ParallelTaskCount(count,
+                                           NPY_UFUNC_PARALLEL_MINCHUNK);
+    }
+    if (ntasks > 1) {
+        trivial_parallel_data d;
+        int itask, status = 0;
+
+        d.fpe_status = malloc(ntasks * sizeof(int));
+        if (d.fpe_status != NULL) {
+            d.innerloop = innerloop;
+            d.innerloopdata = innerloopdata;
+            d.nop = nop;
+            d.count = count;
+            /* Keep the chunks a multiple of 16 elements for the SIMD loops */
+            d.chunksize = ((count + ntasks - 1) / ntasks + 15) & ~(npy_intp)15;
+            for (iop = 0; iop < nop; ++iop) {
+                d.data[iop] = data[iop];
+                d.stride[iop] = stride[iop];
+            }
+            ntasks = (int)((count + d.chunksize - 1) / d.chunksize);
+
+            PyArray_ParallelRun(&trivial_parallel_task, &d, ntasks);
+
+            for (itask = 0; itask < ntasks; ++itask) {
+                status |= d.fpe_status[itask];
+            }
+            free(d.fpe_status);
+            ufunc_set_fpe_status(status);
+            return;
+        }
+    }
+
+    for (iop = 0; iop < nop; ++iop) {
+        counts[iop] = count;
+    }
+    innerloop(data, counts, stride, innerloopdata);
+}
+
 static void
 trivial_two_operand_loop(PyArrayObject **op,
                     PyUFuncGenericFunction innerloop,
-                    void *innerloopdata)
+                    void *innerloopdata,
+                    int parallel_ok,
+                    PyUFunc_ProfileInfo *prof)
 {
     char *data[2];
-    npy_intp count[2], stride[2];
+    npy_intp count, stride[2];
     int needs_api;
     NPY_BEGIN_THREADS_DEF;
 
@@ -1091,17 +1515,26 @@ trivial_two_operand_loop(PyArrayObject **op,
                 PyDataType_REFCHK(PyArray_DESCR(op[1]));
 
     PyArray_PREPARE_TRIVIAL_PAIR_ITERATION(op[0], op[1],
-                                            count[0],
+                                            count,
                                             data[0], data[1],
                                             stride[0], stride[1]);
-    count[1] = count[0];
-    NPY_UF_DBG_PRINT1("two operand loop count %d\n", (int)count[0]);
+    NPY_UF_DBG_PRINT1("two operand loop count %d\n", (int)count);
 
     if (!needs_api) {
-        NPY_BEGIN_THREADS_THRESHOLDED(count[0]);
+        NPY_BEGIN_THREADS_THRESHOLDED(count);
     }
 
-    innerloop(data, count, stride, innerloopdata);
+    if (prof != NULL) {
+        double start = ufunc_profile_clock();
+
+        trivial_loop_run(2, data, count, stride, innerloop, innerloopdata,
+                         parallel_ok && !needs_api);
+        prof->loop_time += ufunc_profile_clock() - start;
+    }
+    else {
+        trivial_loop_run(2, data, count, stride, innerloop, innerloopdata,
+                         parallel_ok && !needs_api);
+    }
 
     if (!needs_api) {
         NPY_END_THREADS;
@@ -1111,10 +1544,12 @@ trivial_two_operand_loop(PyArrayObject **op,
 static void
 trivial_three_operand_loop(PyArrayObject **op,
                     PyUFuncGenericFunction innerloop,
-                    void *innerloopdata)
+                    void *innerloopdata,
+                    int parallel_ok,
+                    PyUFunc_ProfileInfo *prof)
 {
     char *data[3];
-    npy_intp count[3], stride[3];
+    npy_intp count, stride[3];
     int needs_api;
     NPY_BEGIN_THREADS_DEF;
 
@@ -1123,18 +1558,26 @@ trivial_three_operand_loop(PyArrayObject **op,
                 PyDataType_REFCHK(PyArray_DESCR(op[2]));
 
     PyArray_PREPARE_TRIVIAL_TRIPLE_ITERATION(op[0], op[1], op[2],
-                                            count[0],
+                                            count,
                                             data[0], data[1], data[2],
                                             stride[0], stride[1], stride[2]);
-    count[1] = count[0];
-    count[2] = count[0];
-    NPY_UF_DBG_PRINT1("three operand loop count %d\n", (int)count[0]);
+    NPY_UF_DBG_PRINT1("three operand loop count %d\n", (int)count);
 
     if (!needs_api) {
-        NPY_BEGIN_THREADS_THRESHOLDED(count[0]);
+        NPY_BEGIN_THREADS_THRESHOLDED(count);
     }
 
-    innerloop(data, count, stride, innerloopdata);
+    if (prof != NULL) {
+        double start = ufunc_profile_clock();
+
+        trivial_loop_run(3, data, count, stride, innerloop, innerloopdata,
+                         parallel_ok && !needs_api);
+        prof->loop_time += ufunc_profile_clock() - start;
+    }
+    else {
+        trivial_loop_run(3, data, count, stride, innerloop, innerloopdata,
+                         parallel_ok && !needs_api);
+    }
 
     if (!needs_api) {
         NPY_END_THREADS;
@@ -1204,33 +1647,220 @@ prepare_ufunc_output(PyUFuncObject *ufunc,
     return 0;
 }
 
-static int
-iterator_loop(PyUFuncObject *ufunc,
-                    PyArrayObject **op,
-                    PyArray_Descr **dtype,
-                    NPY_ORDER order,
-                    npy_intp buffersize,
-                    PyObject **arr_prep,
-                    PyObject *arr_prep_args,
-                    PyUFuncGenericFunction innerloop,
-                    void *innerloopdata)
+/*
+ * The loop of iterator_loop when profiling, timing the inner loop
+ * separately from the buffer copies and casts done by iternext.
+ */
+static void
+iterator_loop_profiled(NpyIter *iter, NpyIter_IterNextFunc *iternext,
+                       PyUFuncGenericFunction innerloop,
+                       void *innerloopdata,
+                       PyUFunc_ProfileInfo *prof)
 {
-    npy_intp i, nin = ufunc->nin, nout = ufunc->nout;
-    npy_intp nop = nin + nout;
-    npy_uint32 op_flags[NPY_MAXARGS];
-    NpyIter *iter;
-    char *baseptrs[NPY_MAXARGS];
-    int needs_api;
+    char **dataptr = NpyIter_GetDataPtrArray(iter);
+    npy_intp *stride = NpyIter_GetInnerStrideArray(iter);
+    npy_intp *count_ptr = NpyIter_GetInnerLoopSizePtr(iter);
+    int buffered = NpyIter_RequiresBuffering(iter), more;
+    double t0, t1, t2;
 
-    NpyIter_IterNextFunc *iternext;
-    char **dataptr;
-    npy_intp *stride;
-    npy_intp *count_ptr;
-
-    PyArrayObject **op_it;
-    npy_uint32 iter_flags;
+    t0 = ufunc_profile_clock();
+    do {
+        innerloop(dataptr, count_ptr, stride, innerloopdata);
+        t1 = ufunc_profile_clock();
+        more = iternext(iter);
+        t2 = ufunc_profile_clock();
+        /* Each inner loop call is on one filling of the buffers */
+        if (buffered) {
+            prof->loop_time += t1 - t0;
+            prof->buffer_time += t2 - t1;
+            prof->buffer_fills++;
+        }
+        else {
+            prof->loop_time += t2 - t0;
+        }
+        t0 = t2;
+    } while (more);
+}
 
-    NPY_BEGIN_THREADS_DEF;
+typedef struct {
+    PyUFuncGenericFunction innerloop;
+    void *innerloopdata;
+    /* Per task iterators, each reset to its own iteration range */
+    NpyIter **iters;
+    NpyIter_IterNextFunc **iternexts;
+    /* Floating point error flags raised by each task */
+    int *fpe_status;
+    /* Profiling counters of each task, NULL when not profiling */
+    PyUFunc_ProfileInfo *profs;
+} iterator_parallel_data;
+
+static void
+iterator_parallel_task(void *data, npy_intp itask)
+{
+    iterator_parallel_data *d = (iterator_parallel_data *)data;
+    NpyIter *iter = d->iters[itask];
+    NpyIter_IterNextFunc *iternext = d->iternexts[itask];
+    char **dataptr = NpyIter_GetDataPtrArray(iter);
+    npy_intp *stride = NpyIter_GetInnerStrideArray(iter);
+    npy_intp *count_ptr = NpyIter_GetInnerLoopSizePtr(iter);
+    int status;
+
+    if (d->profs != NULL) {
+        iterator_loop_profiled(iter, iternext, d->innerloop,
+                               d->innerloopdata, &d->profs[itask]);
+    }
+    else {
+        do {
+            d->innerloop(dataptr, count_ptr, stride, d->innerloopdata);
+        } while (iternext(iter));
+    }
+
+    UFUNC_CHECK_STATUS(status);
+    d->fpe_status[itask] = status;
+}
+
+/*
+ * Executes the loop of a ranged iterator by splitting its iteration
+ * range into 'ntasks' pieces, each driven by a copy of the iterator
+ * on the thread pool.  The ranges are multiples of the buffer size, so
+ * every piece sees the same buffering as the serial loop would.
+ *
+ * If 'prof' is not NULL, the buffer fills of all the tasks are added to
+ * it, and the elapsed time of the tasks is split between loop and buffer
+ * time in the proportion the tasks spent on each.
+ *
+ * Must be called with the GIL held, returns -1 on error.
+ */
+static int
+parallel_iterator_loop(NpyIter *iter, int ntasks,
+                       PyUFuncGenericFunction innerloop,
+                       void *innerloopdata,
+                       PyUFunc_ProfileInfo *prof)
+{
+    iterator_parallel_data d;
+    npy_intp itersize = NpyIter_GetIterSize(iter), chunksize;
+    npy_intp buffersize = NpyIter_GetBufferSize(iter);
+    int itask, ncopies = 0, status = 0, retval = -1;
+    double start = 0, elapsed, loop_time = 0, buffer_time = 0;
+    NPY_BEGIN_THREADS_DEF;
+
+    if (buffersize <= 0) {
+        buffersize = NPY_BUFSIZE;
+    }
+    chunksize = (itersize + ntasks - 1) / ntasks;
+    chunksize = ((chunksize + buffersize - 1) / buffersize) * buffersize;
+    ntasks = (int)((itersize + chunksize - 1) / chunksize);
+
+    d.innerloop = innerloop;
+    d.innerloopdata = innerloopdata;
+    d.iters = PyArray_malloc(ntasks * sizeof(NpyIter *));
+    d.iternexts = PyArray_malloc(ntasks * sizeof(NpyIter_IterNextFunc *));
+    d.fpe_status = PyArray_malloc(ntasks * sizeof(int));
+    d.profs = NULL;
+    if (prof != NULL) {
+        d.profs = PyArray_malloc(ntasks * sizeof(PyUFunc_ProfileInfo));
+        if (d.profs != NULL) {
+            memset(d.profs, 0, ntasks * sizeof(PyUFunc_ProfileInfo));
+        }
+    }
+    if (d.iters == NULL || d.iternexts == NULL || d.fpe_status == NULL ||
+            (prof != NULL && d.profs == NULL)) {
+        PyErr_NoMemory();
+        goto finish;
+    }
+
+    /* The first task uses the original iterator */
+    d.iters[0] = iter;
+    for (ncopies = 1; ncopies < ntasks; ++ncopies) {
+        d.iters[ncopies] = NpyIter_Copy(iter);
+        if (d.iters[ncopies] == NULL) {
+            goto finish;
+        }
+    }
+    for (itask = 0; itask < ntasks; ++itask) {
+        npy_intp istart = itask * chunksize, iend = istart + chunksize;
+
+        if (iend > itersize) {
+            iend = itersize;
+        }
+        if (NpyIter_ResetToIterIndexRange(d.iters[itask],
+                                        istart, iend, NULL) != NPY_SUCCEED) {
+            goto finish;
+        }
+        d.iternexts[itask] = NpyIter_GetIterNext(d.iters[itask], NULL);
+        if (d.iternexts[itask] == NULL) {
+            goto finish;
+        }
+    }
+
+    if (prof != NULL) {
+        start = ufunc_profile_clock();
+    }
+    NPY_BEGIN_THREADS;
+    PyArray_ParallelRun(&iterator_parallel_task, &d, ntasks);
+    NPY_END_THREADS;
+
+    for (itask = 0; itask < ntasks; ++itask) {
+        status |= d.fpe_status[itask];
+    }
+    ufunc_set_fpe_status(status);
+
+    if (prof != NULL) {
+        elapsed = ufunc_profile_clock() - start;
+        for (itask = 0; itask < ntasks; ++itask) {
+            loop_time += d.profs[itask].loop_time;
+            buffer_time += d.profs[itask].buffer_time;
+            prof->buffer_fills += d.profs[itask].buffer_fills;
+        }
+        if (loop_time + buffer_time > 0) {
+            buffer_time = elapsed * buffer_time / (loop_time + buffer_time);
+        }
+        prof->buffer_time += buffer_time;
+        prof->loop_time += elapsed - buffer_time;
+    }
+    retval = 0;
+
+finish:
+    for (itask = 1; itask < ncopies; ++itask) {
+        NpyIter_Deallocate(d.iters[itask]);
+    }
+    PyArray_free(d.iters);
+    PyArray_free(d.iternexts);
+    PyArray_free(d.fpe_status);
+    PyArray_free(d.profs);
+    return retval;
+}
+
+static int
+iterator_loop(PyUFuncObject *ufunc,
+                    PyArrayObject **op,
+                    PyArray_Descr **dtype,
+                    NPY_ORDER order,
+                    npy_intp buffersize,
+                    PyObject **arr_prep,
+                    PyObject *arr_prep_args,
+                    PyUFuncGenericFunction innerloop,
+                    void *innerloopdata,
+                    int parallel_ok,
+                    PyUFunc_ProfileInfo *prof)
+{
+    npy_intp i, nin = ufunc->nin, nout = ufunc->nout;
+    npy_intp nop = nin + nout;
+    npy_uint32 op_flags[NPY_MAXARGS];
+    NpyIter *iter;
+    char *baseptrs[NPY_MAXARGS];
+    int needs_api, ntasks = 1;
+
+    NpyIter_IterNextFunc *iternext;
+    char **dataptr;
+    npy_intp *stride;
+    npy_intp *count_ptr;
+
+    PyArrayObject **op_it;
+    npy_uint32 iter_flags;
+    double start = 0;
+
+    NPY_BEGIN_THREADS_DEF;
 
     /* Set up the flags */
     for (i = 0; i < nin; ++i) {
@@ -1260,6 +1890,9 @@ iterator_loop(PyUFuncObject *ufunc,
                  NPY_ITER_BUFFERED |
                  NPY_ITER_GROWINNER |
                  NPY_ITER_DELAY_BUFALLOC;
+    if (parallel_ok) {
+        iter_flags |= NPY_ITER_RANGED;
+    }
 
     /*
      * Allocate the iterator.  Because the types of the inputs
@@ -1305,10 +1938,32 @@ iterator_loop(PyUFuncObject *ufunc,
         for (i = nin; i < nop; ++i) {
             baseptrs[i] = PyArray_BYTES(op[i]);
         }
+        /* With the delayed allocation, this fills the first buffers */
+        if (prof != NULL) {
+            start = ufunc_profile_clock();
+        }
         if (NpyIter_ResetBasePointers(iter, baseptrs, NULL) != NPY_SUCCEED) {
             NpyIter_Deallocate(iter);
             return -1;
         }
+        if (prof != NULL) {
+            prof->buffer_time += ufunc_profile_clock() - start;
+        }
+
+        if (parallel_ok && !needs_api) {
+            ntasks = PyArray_ParallelTaskCount(NpyIter_GetIterSize(iter),
+                                               NPY_UFUNC_PARALLEL_MINCHUNK);
+        }
+        if (ntasks > 1) {
+            NPY_UF_DBG_PRINT1("parallel iterator loop tasks %d\n", ntasks);
+            if (parallel_iterator_loop(iter, ntasks, innerloop,
+                                       innerloopdata, prof) < 0) {
+                NpyIter_Deallocate(iter);
+                return -1;
+            }
+            NpyIter_Deallocate(iter);
+            return 0;
+        }
 
         /* Get the variables needed for the loop */
         iternext = NpyIter_GetIterNext(iter, NULL);
@@ -1325,10 +1980,17 @@ iterator_loop(PyUFuncObject *ufunc,
         }
 
         /* Execute the loop */
-        do {
-            NPY_UF_DBG_PRINT1("iterator loop count %d\n", (int)*count_ptr);
-            innerloop(dataptr, count_ptr, stride, innerloopdata);
-        } while (iternext(iter));
+        if (prof != NULL) {
+            iterator_loop_profiled(iter, iternext,
+                                   innerloop, innerloopdata, prof);
+        }
+        else {
+            do {
+                NPY_UF_DBG_PRINT1("iterator loop count %d\n",
+                                  (int)*count_ptr);
+                innerloop(dataptr, count_ptr, stride, innerloopdata);
+            } while (iternext(iter));
+        }
 
         if (!needs_api) {
             NPY_END_THREADS;
@@ -1349,6 +2011,8 @@ iterator_loop(PyUFuncObject *ufunc,
  * arr_prep        - the __array_prepare__ functions for the outputs
  * innerloop       - the inner loop function
  * innerloopdata   - data to pass to the inner loop
+ * needs_api       - whether the inner loop needs the Python API
+ * prof            - if not NULL, the profiling counters to update
  */
 static int
 execute_legacy_ufunc_loop(PyUFuncObject *ufunc,
@@ -1358,17 +2022,17 @@ execute_legacy_ufunc_loop(PyUFuncObject *ufunc,
                     NPY_ORDER order,
                     npy_intp buffersize,
                     PyObject **arr_prep,
-                    PyObject *arr_prep_args)
+                    PyObject *arr_prep_args,
+                    PyUFuncGenericFunction innerloop,
+                    void *innerloopdata,
+                    int needs_api,
+                    PyUFunc_ProfileInfo *prof)
 {
     npy_intp nin = ufunc->nin, nout = ufunc->nout;
-    PyUFuncGenericFunction innerloop;
-    void *innerloopdata;
-    int needs_api = 0;
+    int parallel_ok;
 
-    if (ufunc->legacy_inner_loop_selector(ufunc, dtypes,
-                    &innerloop, &innerloopdata, &needs_api) < 0) {
-        return -1;
-    }
+    parallel_ok = !needs_api &&
+                  ufunc_loop_can_parallelize(ufunc, op, innerloopdata);
     /* If the loop wants the arrays, provide them. */
     if (_does_loop_use_arrays(innerloopdata)) {
         innerloopdata = (void*)op;
@@ -1397,7 +2061,8 @@ execute_legacy_ufunc_loop(PyUFuncObject *ufunc,
                 }
 
                 NPY_UF_DBG_PRINT("trivial 1 input with allocated output\n");
-                trivial_two_operand_loop(op, innerloop, innerloopdata);
+                trivial_two_operand_loop(op, innerloop, innerloopdata,
+                                         parallel_ok, prof);
 
                 return 0;
             }
@@ -1412,7 +2077,8 @@ execute_legacy_ufunc_loop(PyUFuncObject *ufunc,
                 }
 
                 NPY_UF_DBG_PRINT("trivial 1 input\n");
-                trivial_two_operand_loop(op, innerloop, innerloopdata);
+                trivial_two_operand_loop(op, innerloop, innerloopdata,
+                                         parallel_ok, prof);
 
                 return 0;
             }
@@ -1449,7 +2115,8 @@ execute_legacy_ufunc_loop(PyUFuncObject *ufunc,
                 }
 
                 NPY_UF_DBG_PRINT("trivial 2 input with allocated output\n");
-                trivial_three_operand_loop(op, innerloop, innerloopdata);
+                trivial_three_operand_loop(op, innerloop, innerloopdata,
+                                           parallel_ok, prof);
 
                 return 0;
             }
@@ -1465,7 +2132,8 @@ execute_legacy_ufunc_loop(PyUFuncObject *ufunc,
                 }
 
                 NPY_UF_DBG_PRINT("trivial 2 input\n");
-                trivial_three_operand_loop(op, innerloop, innerloopdata);
+                trivial_three_operand_loop(op, innerloop, innerloopdata,
+                                           parallel_ok, prof);
 
                 return 0;
             }
@@ -1480,7 +2148,7 @@ execute_legacy_ufunc_loop(PyUFuncObject *ufunc,
     NPY_UF_DBG_PRINT("iterator loop\n");
     if (iterator_loop(ufunc, op, dtypes, order,
                     buffersize, arr_prep, arr_prep_args,
-                    innerloop, innerloopdata) < 0) {
+                    innerloop, innerloopdata, parallel_ok, prof) < 0) {
         return -1;
     }
 
@@ -1497,6 +2165,7 @@ execute_legacy_ufunc_loop(PyUFuncObject *ufunc,
  * arr_prep        - the __array_prepare__ functions for the outputs
  * innerloop       - the inner loop function
  * innerloopdata   - data to pass to the inner loop
+ * prof            - if not NULL, the profiling counters to update
  */
 static int
 execute_fancy_ufunc_loop(PyUFuncObject *ufunc,
@@ -1506,7 +2175,8 @@ execute_fancy_ufunc_loop(PyUFuncObject *ufunc,
                     NPY_ORDER order,
                     npy_intp buffersize,
                     PyObject **arr_prep,
-                    PyObject *arr_prep_args)
+                    PyObject *arr_prep_args,
+                    PyUFunc_ProfileInfo *prof)
 {
     int i, nin = ufunc->nin, nout = ufunc->nout;
     int nop = nin + nout;
@@ -1522,6 +2192,7 @@ execute_fancy_ufunc_loop(PyUFuncObject *ufunc,
 
     PyArrayObject **op_it;
     npy_uint32 iter_flags;
+    double start = 0;
 
     NPY_BEGIN_THREADS_DEF;
 
@@ -1657,13 +2328,26 @@ execute_fancy_ufunc_loop(PyUFuncObject *ufunc,
         }
 
         NPY_UF_DBG_PRINT("Actual inner loop:\n");
+        /* The masked loop isn't split into loop and buffer time */
+        if (prof != NULL) {
+            start = ufunc_profile_clock();
+        }
         /* Execute the loop */
         do {
             NPY_UF_DBG_PRINT1("iterator loop count %d\n", (int)*countptr);
             innerloop(dataptr, strides,
                         dataptr[nop], strides[nop],
                         *countptr, innerloopdata);
+            if (prof != NULL) {
+                prof->buffer_fills++;
+            }
         } while (iternext(iter));
+        if (prof != NULL) {
+            prof->loop_time += ufunc_profile_clock() - start;
+            if (!NpyIter_RequiresBuffering(iter)) {
+                prof->buffer_fills = 0;
+            }
+        }
 
         if (!needs_api) {
             NPY_END_THREADS;
@@ -1714,6 +2398,87 @@ make_arr_prep_args(npy_intp nin, PyObject *args, PyObject *kwds)
     }
 }
 
+typedef struct {
+    PyUFuncGenericFunction innerloop;
+    void *innerloopdata;
+    int nop;
+    char **data;
+    /* dimensions[0] is the outer loop size, followed by the core sizes */
+    npy_intp *dimensions;
+    int ndimensions;
+    npy_intp *steps;
+    npy_intp chunksize;
+    /* Floating point error flags raised by each task */
+    int *fpe_status;
+} gufunc_parallel_data;
+
+static void
+gufunc_parallel_task(void *data, npy_intp itask)
+{
+    gufunc_parallel_data *d = (gufunc_parallel_data *)data;
+    char *dataptr[NPY_MAXARGS];
+    npy_intp dimensions[NPY_MAXDIMS+1];
+    npy_intp start = itask * d->chunksize;
+    int iop, status;
+
+    for (iop = 0; iop < d->nop; ++iop) {
+        dataptr[iop] = d->data[iop] + start * d->steps[iop];
+    }
+    memcpy(dimensions, d->dimensions, d->ndimensions * sizeof(npy_intp));
+    dimensions[0] -= start;
+    if (dimensions[0] > d->chunksize) {
+        dimensions[0] = d->chunksize;
+    }
+    d->innerloop(dataptr, dimensions, d->steps, d->innerloopdata);
+
+    UFUNC_CHECK_STATUS(status);
+    d->fpe_status[itask] = status;
+}
+
+/*
+ * Runs one call of a generalized ufunc inner loop, splitting its outer
+ * loop across the thread pool when every thread gets at least
+ * 'minchunk' outer iterations.  Each piece is a separate call of the
+ * inner loop, so loops which allocate their workspace per call get
+ * one workspace per thread.  Must be called with the GIL released.
+ */
+static void
+gufunc_loop_run(int nop, char **data, npy_intp *dimensions, int ndimensions,
+                npy_intp *steps, PyUFuncGenericFunction innerloop,
+                void *innerloopdata, npy_intp minchunk)
+{
+    gufunc_parallel_data d;
+    int itask, ntasks, status = 0;
+
+    ntasks = PyArray_ParallelTaskCount(dimensions[0], minchunk);
+    d.fpe_status = NULL;
+    if (ntasks > 1) {
+        d.fpe_status = malloc(ntasks * sizeof(int));
+    }
+    if (d.fpe_status == NULL) {
+        innerloop(data, dimensions, steps, innerloopdata);
+        return;
+    }
+
+    d.innerloop = innerloop;
+    d.innerloopdata = innerloopdata;
+    d.nop = nop;
+    d.data = data;
+    d.dimensions = dimensions;
+    d.ndimensions = ndimensions;
+    d.steps = steps;
+    d.chunksize = (dimensions[0] + ntasks - 1) / ntasks;
+    ntasks = (int)((dimensions[0] + d.chunksize - 1) / d.chunksize);
+
+    PyArray_ParallelRun(&gufunc_parallel_task, &d, ntasks);
+
+    for (itask = 0; itask < ntasks; ++itask) {
+        status |= d.fpe_status[itask];
+    }
+    free(d.fpe_status);
+    ufunc_set_fpe_status(status);
+}
+
 static int
 PyUFunc_GeneralizedFunction(PyUFuncObject *ufunc,
                         PyObject *args, PyObject *kwds,
@@ -1723,7 +2488,7 @@ PyUFunc_GeneralizedFunction(PyUFuncObject *ufunc,
     int i, j, idim, nop;
     char *ufunc_name;
     int retval = -1, subok = 1;
-    int needs_api = 0;
+    int needs_api = 0, uses_arrays = 0, parallel_ok;
 
     PyArray_Descr *dtypes[NPY_MAXARGS];
 
@@ -1768,11 +2533,19 @@ PyUFunc_GeneralizedFunction(PyUFuncObject *ufunc,
     /* When provided, extobj and typetup contain borrowed references */
     PyObject *extobj = NULL, *type_tup = NULL;
 
+    /* The profiling counters, if a profiling hook is set */
+    PyUFunc_ProfileInfo profile, *prof;
+    double prof_start = 0, loop_start = 0;
+
+    NPY_BEGIN_THREADS_DEF;
+
     if (ufunc == NULL) {
         PyErr_SetString(PyExc_ValueError, "function not supported");
         return -1;
     }
 
+    prof = ufunc_profile_start(&profile, &prof_start);
+
     nin = ufunc->nin;
     nout = ufunc->nout;
     nop = nin + nout;
@@ -2027,6 +2800,7 @@ PyUFunc_GeneralizedFunction(PyUFuncObject *ufunc,
     /* If the loop wants the arrays, provide them */
     if (_does_loop_use_arrays(innerloopdata)) {
         innerloopdata = (void*)op;
+        uses_arrays = 1;
     }
 
     /*
@@ -2165,10 +2939,47 @@ PyUFunc_GeneralizedFunction(PyUFuncObject *ufunc,
         dataptr = NpyIter_GetDataPtrArray(iter);
         count_ptr = NpyIter_GetInnerLoopSizePtr(iter);
 
-        do {
-            inner_dimensions[0] = *count_ptr;
-            innerloop(dataptr, inner_dimensions, inner_strides, innerloopdata);
-        } while (iternext(iter));
+        /*
+         * The outer loop of a thread safe gufunc may be split across
+         * the thread pool, under the same conditions as elementwise
+         * loops, checked on the operands the loop actually sees.
+         */
+        parallel_ok = ufunc->core_threadsafe && !needs_api &&
+                      !uses_arrays &&
+                      ufunc_loop_can_parallelize(ufunc,
+                                NpyIter_GetOperandArray(iter), innerloopdata);
+        if (prof != NULL) {
+            loop_start = ufunc_profile_clock();
+        }
+        if (parallel_ok) {
+            npy_intp core_size = 1, minchunk;
+
+            for (i = 0; i < ufunc->core_num_dim_ix; ++i) {
+                if (core_dim_sizes[i] > 1) {
+                    core_size *= core_dim_sizes[i];
+                }
+            }
+            minchunk = NPY_GUFUNC_PARALLEL_MINCHUNK / core_size;
+
+            NPY_BEGIN_THREADS;
+            do {
+                inner_dimensions[0] = *count_ptr;
+                gufunc_loop_run(nop, dataptr, inner_dimensions,
+                                ufunc->core_num_dim_ix + 1, inner_strides,
+                                innerloop, innerloopdata, minchunk);
+            } while (iternext(iter));
+            NPY_END_THREADS;
+        }
+        else {
+            do {
+                inner_dimensions[0] = *count_ptr;
+                innerloop(dataptr, inner_dimensions, inner_strides,
+                          innerloopdata);
+            } while (iternext(iter));
+        }
+        if (prof != NULL) {
+            prof->loop_time += ufunc_profile_clock() - loop_start;
+        }
     } else {
         /**
          * For each output operand, check if it has non-zero size,
@@ -2208,6 +3019,12 @@ PyUFunc_GeneralizedFunction(PyUFuncObject *ufunc,
         goto fail;
     }
 
+    if (prof != NULL) {
+        /* Counts the outer loop, each iteration a call of the core */
+        prof->nelements = NpyIter_GetIterSize(iter);
+        ufunc_profile_report(ufunc, "__call__", prof, prof_start);
+    }
+
     PyArray_free(inner_strides);
     NpyIter_Deallocate(iter);
     /* The caller takes ownership of all the references in op */
@@ -2244,6 +3061,216 @@ fail:
     return retval;
 }
 
+/*
+ * A small direct-mapped cache of type resolution results.  Repeated
+ * calls with the same kinds of operands then skip both the type
+ * resolver and the inner loop search, which dominate the cost of
+ * calls on small arrays.  Entries are keyed on the ufunc, the casting
+ * rule and the operand dtypes, plus the values of 0-d inputs since
+ * those take part in value-based casting.  Only native-byteorder
+ * numeric and boolean dtypes are cached, so the result never depends
+ * on dtype metadata.
+ *
+ * Entries of a ufunc are dropped when it is deallocated or its loops
+ * change, and are ignored if its resolver functions are replaced.
+ */
+#define NPY_UFUNC_CACHE_SIZE 256
+#define NPY_UFUNC_CACHE_MAXOP 4
+#define NPY_UFUNC_CACHE_MAXITEMSIZE 16
+#define NPY_UFUNC_CACHE_KEYSIZE \
+            (1 + NPY_UFUNC_CACHE_MAXOP * (1 + NPY_UFUNC_CACHE_MAXITEMSIZE))
+
+typedef struct {
+    PyUFuncObject *ufunc;
+    PyUFunc_TypeResolutionFunc *type_resolver;
+    PyUFunc_LegacyInnerLoopSelectionFunc *legacy_inner_loop_selector;
+    npy_intp keylen;
+    unsigned char key[NPY_UFUNC_CACHE_KEYSIZE];
+    PyArray_Descr *dtypes[NPY_UFUNC_CACHE_MAXOP];
+    PyUFuncGenericFunction innerloop;
+    void *innerloopdata;
+    int needs_api;
+} ufunc_cache_entry;
+
+static ufunc_cache_entry ufunc_cache[NPY_UFUNC_CACHE_SIZE];
+
+/*
+ * Builds the cache key for the operands into 'key', returning its
+ * length, or -1 if the call can't be cached.
+ */
+static npy_intp
+ufunc_cache_make_key(PyUFuncObject *ufunc, NPY_CASTING casting,
+                    PyArrayObject **op, unsigned char *key)
+{
+    int i, nin = ufunc->nin, nop = ufunc->nin + ufunc->nout;
+    npy_intp keylen = 0;
+
+    if (nop > NPY_UFUNC_CACHE_MAXOP) {
+        return -1;
+    }
+
+    key[keylen++] = (unsigned char)casting;
+    for (i = 0; i < nop; ++i) {
+        PyArray_Descr *descr;
+        int type_num;
+
+        if (op[i] == NULL) {
+            key[keylen++] = 0xff;
+            continue;
+        }
+        descr = PyArray_DESCR(op[i]);
+        type_num = descr->type_num;
+        if ((type_num >= NPY_OBJECT && type_num != NPY_HALF) ||
+                    !PyArray_ISNBO(descr->byteorder) ||
+                    descr->metadata != NULL) {
+            return -1;
+        }
+        if (i < nin && PyArray_NDIM(op[i]) == 0) {
+            if (descr->elsize > NPY_UFUNC_CACHE_MAXITEMSIZE) {
+                return -1;
+            }
+            key[keylen++] = (unsigned char)(type_num | 0x80);
+            memcpy(key + keylen, PyArray_DATA(op[i]), descr->elsize);
+            keylen += descr->elsize;
+        }
+        else {
+            key[keylen++] = (unsigned char)type_num;
+        }
+    }
+
+    return keylen;
+}
+
+static NPY_INLINE ufunc_cache_entry *
+ufunc_cache_lookup(PyUFuncObject *ufunc, unsigned char *key, npy_intp keylen)
+{
+    /* FNV-1a, seeded with the ufunc address */
+    npy_uint32 hash = 2166136261u ^ (npy_uint32)((npy_uintp)ufunc >> 4);
+    npy_intp i;
+
+    for (i = 0; i < keylen; ++i) {
+        hash = (hash ^ key[i]) * 16777619u;
+    }
+    hash ^= hash >> 16;
+
+    return &ufunc_cache[hash & (NPY_UFUNC_CACHE_SIZE - 1)];
+}
+
+static void
+ufunc_cache_entry_clear(ufunc_cache_entry *entry)
+{
+    int i;
+
+    entry->ufunc = NULL;
+    for (i = 0; i < NPY_UFUNC_CACHE_MAXOP; ++i) {
+        Py_XDECREF(entry->dtypes[i]);
+        entry->dtypes[i] = NULL;
+    }
+}
+
+/* Drops all the cache entries belonging to the ufunc */
+static void
+ufunc_cache_clear(PyUFuncObject *ufunc)
+{
+    int i;
+
+    for (i = 0; i < NPY_UFUNC_CACHE_SIZE; ++i) {
+        if (ufunc_cache[i].ufunc == ufunc) {
+            ufunc_cache_entry_clear(&ufunc_cache[i]);
+        }
+    }
+}
+
+/*
+ * Resolves the dtypes with the ufunc's type resolver and selects the
+ * legacy inner loop for them, going through the cache when possible.
+ * On success, the caller owns the references in 'dtypes'.
+ */
+static int
+resolve_legacy_ufunc_loop(PyUFuncObject *ufunc, NPY_CASTING casting,
+                    PyArrayObject **op, PyObject *type_tup,
+                    PyArray_Descr **dtypes,
+                    PyUFuncGenericFunction *out_innerloop,
+                    void **out_innerloopdata,
+                    int *out_needs_api)
+{
+    int i, nop = ufunc->nin + ufunc->nout;
+    unsigned char key[NPY_UFUNC_CACHE_KEYSIZE];
+    npy_intp keylen = -1;
+    ufunc_cache_entry *entry = NULL;
+
+    if (type_tup == NULL) {
+        keylen = ufunc_cache_make_key(ufunc, casting, op, key);
+    }
+    if (keylen >= 0) {
+        entry = ufunc_cache_lookup(ufunc, key, keylen);
+        if (entry->ufunc == ufunc &&
+                entry->type_resolver == ufunc->type_resolver &&
+                entry->legacy_inner_loop_selector ==
+                                    ufunc->legacy_inner_loop_selector &&
+                entry->keylen == keylen &&
+                memcmp(entry->key, key, keylen) == 0) {
+            for (i = 0; i < nop; ++i) {
+                dtypes[i] = entry->dtypes[i];
+                Py_INCREF(dtypes[i]);
+            }
+            *out_innerloop = entry->innerloop;
+            *out_innerloopdata = entry->innerloopdata;
+            *out_needs_api = entry->needs_api;
+            return 0;
+        }
+    }
+
+    if (ufunc->type_resolver(ufunc, casting, op, type_tup, dtypes) < 0) {
+        return -1;
+    }
+    *out_needs_api = 0;
+    if (ufunc->legacy_inner_loop_selector(ufunc, dtypes,
+                    out_innerloop, out_innerloopdata, out_needs_api) < 0) {
+        return -1;
+    }
+
+    /*
+     * Operands which get the deprecation warning for casting between
+     * kinds have to go through the type resolver each time, so that
+     * the warning is still given.
+     */
+    if (entry != NULL &&
+            casting == NPY_INTERNAL_UNSAFE_CASTING_BUT_WARN_UNLESS_SAME_KIND) {
+        for (i = 0; i < nop; ++i) {
+            if (op[i] == NULL) {
+                continue;
+            }
+            if (i < ufunc->nin ?
+                    !PyArray_CanCastTypeTo(PyArray_DESCR(op[i]), dtypes[i],
+                                           NPY_SAME_KIND_CASTING) :
+                    !PyArray_CanCastTypeTo(dtypes[i], PyArray_DESCR(op[i]),
+                                           NPY_SAME_KIND_CASTING)) {
+                entry = NULL;
+                break;
+            }
+        }
+    }
+
+    if (entry != NULL) {
+        ufunc_cache_entry_clear(entry);
+        entry->ufunc = ufunc;
+        entry->type_resolver = ufunc->type_resolver;
+        entry->legacy_inner_loop_selector = ufunc->legacy_inner_loop_selector;
+        entry->keylen = keylen;
+        memcpy(entry->key, key, keylen);
+        for (i = 0; i < nop; ++i) {
+            entry->dtypes[i] = dtypes[i];
+            Py_INCREF(dtypes[i]);
+        }
+        entry->innerloop = *out_innerloop;
+        entry->innerloopdata = *out_innerloopdata;
+        entry->needs_api = *out_needs_api;
+    }
+
+    return 0;
+}
+
 /*UFUNC_API
  *
  * This generic function is called with the ufunc object, the arguments to it,
@@ -2266,9 +3293,14 @@ PyUFunc_GenericFunction(PyUFuncObject *ufunc,
 
     /* These parameters come from extobj= or from a TLS global */
     int buffersize = 0, errormask = 0;
-    PyObject *errobj = NULL;
+    PyObject *callback = NULL;
     int first_error = 1;
 
+    /* The legacy inner loop, unless the masked loop is needed */
+    PyUFuncGenericFunction innerloop = NULL;
+    void *innerloopdata = NULL;
+    int needs_api = 0;
+
     /* The mask provided in the 'where=' parameter */
     PyArrayObject *wheremask = NULL;
 
@@ -2288,6 +3320,10 @@ PyUFunc_GenericFunction(PyUFuncObject *ufunc,
     /* When provided, extobj and typetup contain borrowed references */
     PyObject *extobj = NULL, *type_tup = NULL;
 
+    /* The profiling counters, if a profiling hook is set */
+    PyUFunc_ProfileInfo profile, *prof;
+    double prof_start = 0;
+
     if (ufunc == NULL) {
         PyErr_SetString(PyExc_ValueError, "function not supported");
         return -1;
@@ -2297,6 +3333,8 @@ PyUFunc_GenericFunction(PyUFuncObject *ufunc,
         return PyUFunc_GeneralizedFunction(ufunc, args, kwds, op);
     }
 
+    prof = ufunc_profile_start(&profile, &prof_start);
+
     nin = ufunc->nin;
     nout = ufunc->nout;
     nop = nin + nout;
@@ -2329,26 +3367,23 @@ PyUFunc_GenericFunction(PyUFuncObject *ufunc,
         need_fancy = 1;
     }
 
-    /* Get the buffersize, errormask, and error object globals */
-    if (extobj == NULL) {
-        if (PyUFunc_GetPyValues(ufunc_name,
-                                &buffersize, &errormask, &errobj) < 0) {
-            retval = -1;
-            goto fail;
-        }
-    }
-    else {
-        if (_extract_pyvals(extobj, ufunc_name,
-                                &buffersize, &errormask, &errobj) < 0) {
-            retval = -1;
-            goto fail;
-        }
+    /* Get the buffersize, errormask, and error callback globals */
+    if (_get_pyvals(extobj, &buffersize, &errormask, &callback) < 0) {
+        retval = -1;
+        goto fail;
     }
 
     NPY_UF_DBG_PRINT("Finding inner loop\n");
 
-    retval = ufunc->type_resolver(ufunc, casting,
+    if (!need_fancy && ufunc->legacy_inner_loop_selector != NULL) {
+        retval = resolve_legacy_ufunc_loop(ufunc, casting,
+                            op, type_tup, dtypes,
+                            &innerloop, &innerloopdata, &needs_api);
+    }
+    else {
+        retval = ufunc->type_resolver(ufunc, casting,
                             op, type_tup, dtypes);
+    }
     if (retval < 0) {
         goto fail;
     }
@@ -2425,7 +3460,7 @@ PyUFunc_GenericFunction(PyUFuncObject *ufunc,
 
         retval = execute_fancy_ufunc_loop(ufunc, wheremask,
                             op, dtypes, order,
-                            buffersize, arr_prep, arr_prep_args);
+                            buffersize, arr_prep, arr_prep_args, prof);
     }
     else {
         NPY_UF_DBG_PRINT("Executing legacy inner loop\n");
@@ -2433,7 +3468,8 @@ PyUFunc_GenericFunction(PyUFuncObject *ufunc,
         if (ufunc->legacy_inner_loop_selector != NULL) {
             retval = execute_legacy_ufunc_loop(ufunc, trivial_loop_ok,
                                 op, dtypes, order,
-                                buffersize, arr_prep, arr_prep_args);
+                                buffersize, arr_prep, arr_prep_args,
+                                innerloop, innerloopdata, needs_api, prof);
         }
         else {
             /*
@@ -2453,17 +3489,23 @@ PyUFunc_GenericFunction(PyUFuncObject *ufunc,
 
     /* Check whether any errors occurred during the loop */
     if (PyErr_Occurred() || (errormask &&
-            PyUFunc_checkfperr(errormask, errobj, &first_error))) {
+            _check_fperr_callback(errormask, callback,
+                                  ufunc_name, &first_error))) {
         retval = -1;
         goto fail;
     }
 
+    if (prof != NULL) {
+        prof->nelements = nout > 0 ? PyArray_SIZE(op[nin]) : 0;
+        ufunc_profile_report(ufunc, "__call__", prof, prof_start);
+    }
+
     /* The caller takes ownership of all the references in op */
     for (i = 0; i < nop; ++i) {
         Py_XDECREF(dtypes[i]);
         Py_XDECREF(arr_prep[i]);
     }
-    Py_XDECREF(errobj);
+    Py_XDECREF(callback);
     Py_XDECREF(type_tup);
     Py_XDECREF(arr_prep_args);
     Py_XDECREF(wheremask);
@@ -2480,7 +3522,7 @@ fail:
         Py_XDECREF(dtypes[i]);
         Py_XDECREF(arr_prep[i]);
     }
-    Py_XDECREF(errobj);
+    Py_XDECREF(callback);
     Py_XDECREF(type_tup);
     Py_XDECREF(arr_prep_args);
     Py_XDECREF(wheremask);
@@ -2652,36 +3694,24 @@ assign_reduce_identity_one(PyArrayObject *result)
     return PyArray_FillWithScalar(result, PyArrayScalar_True);
 }
 
+/* The data passed through PyUFunc_ReduceWrapper to reduce_loop */
+typedef struct {
+    PyUFuncObject *ufunc;
+    PyUFuncGenericFunction innerloop;
+    void *innerloopdata;
+} reduce_loop_data;
+
 static int
 reduce_loop(NpyIter *iter, char **dataptrs, npy_intp *strides,
             npy_intp *countptr, NpyIter_IterNextFunc *iternext,
             int needs_api, npy_intp skip_first_count, void *data)
 {
-    PyArray_Descr *dtypes[3], **iter_dtypes;
-    PyUFuncObject *ufunc = (PyUFuncObject *)data;
+    reduce_loop_data *loop_data = (reduce_loop_data *)data;
+    PyUFuncGenericFunction innerloop = loop_data->innerloop;
+    void *innerloopdata = loop_data->innerloopdata;
     char *dataptrs_copy[3];
     npy_intp strides_copy[3];
 
-    /* The normal selected inner loop */
-    PyUFuncGenericFunction innerloop = NULL;
-    void *innerloopdata = NULL;
-
-    NPY_BEGIN_THREADS_DEF;
-
-    /* Get the inner loop */
-    iter_dtypes = NpyIter_GetDescrArray(iter);
-    dtypes[0] = iter_dtypes[0];
-    dtypes[1] = iter_dtypes[1];
-    dtypes[2] = iter_dtypes[0];
-    if (ufunc->legacy_inner_loop_selector(ufunc, dtypes,
-                            &innerloop, &innerloopdata, &needs_api) < 0) {
-        return -1;
-    }
-
-    if (!needs_api) {
-        NPY_BEGIN_THREADS;
-    }
-
     if (skip_first_count > 0) {
         do {
             npy_intp count = *countptr;
@@ -2733,10 +3763,6 @@ reduce_loop(NpyIter *iter, char **dataptrs, npy_intp *strides,
     } while (iternext(iter));
 
 finish_loop:
-    if (!needs_api) {
-        NPY_END_THREADS;
-    }
-
     return (needs_api && PyErr_Occurred()) ? -1 : 0;
 }
 
@@ -2761,10 +3787,11 @@ static PyArrayObject *
 PyUFunc_Reduce(PyUFuncObject *ufunc, PyArrayObject *arr, PyArrayObject *out,
         int naxes, int *axes, PyArray_Descr *odtype, int keepdims)
 {
-    int iaxes, reorderable, ndim;
+    int iaxes, reorderable, ndim, needs_api = 0;
     npy_bool axis_flags[NPY_MAXDIMS];
-    PyArray_Descr *dtype;
+    PyArray_Descr *dtype, *dtypes[3];
     PyArrayObject *result;
+    reduce_loop_data loop_data;
     PyArray_AssignReduceIdentityFunc *assign_identity = NULL;
     char *ufunc_name = ufunc->name ? ufunc->name : "(unknown)";
     /* These parameters come from a TLS global */
@@ -2833,13 +3860,27 @@ PyUFunc_Reduce(PyUFuncObject *ufunc, PyArrayObject *arr, PyArrayObject *out,
         return NULL;
     }
 
+    /*
+     * Get the inner loop here with the GIL held, the reduction
+     * may call reduce_loop from several threads at once.
+     */
+    dtypes[0] = dtypes[1] = dtypes[2] = dtype;
+    loop_data.ufunc = ufunc;
+    if (ufunc->legacy_inner_loop_selector(ufunc, dtypes,
+                            &loop_data.innerloop, &loop_data.innerloopdata,
+                            &needs_api) < 0) {
+        Py_DECREF(dtype);
+        Py_XDECREF(errobj);
+        return NULL;
+    }
+
     result = PyUFunc_ReduceWrapper(arr, out, NULL, dtype, dtype,
                                    NPY_UNSAFE_CASTING,
                                    axis_flags, reorderable,
                                    keepdims, 0,
                                    assign_identity,
-                                   reduce_loop,
-                                   ufunc, buffersize, ufunc_name);
+                                   reduce_loop, needs_api,
+                                   &loop_data, buffersize, ufunc_name);
 
     Py_DECREF(dtype);
     Py_XDECREF(errobj);
@@ -3572,180 +4613,824 @@ fail:
 }
 
 
+/* The operations reduceby has typed loops for */
+enum {
+    REDUCEBY_LOOP,
+    REDUCEBY_ADD,
+    REDUCEBY_MULTIPLY,
+    REDUCEBY_MAXIMUM,
+    REDUCEBY_MINIMUM
+};
+
 /*
- * This code handles reduce, reduceat, and accumulate
- * (accumulate and reduce are special cases of the more general reduceat
- * but they are handled separately for speed)
+ * Returns the typed operation reduceby can use instead of calling the
+ * inner loop of 'ufunc' for every row of a single item, or REDUCEBY_LOOP.
  */
-static PyObject *
-PyUFunc_GenericReduction(PyUFuncObject *ufunc, PyObject *args,
-                         PyObject *kwds, int operation)
+static int
+reduceby_typed_op(PyUFuncObject *ufunc, PyArray_Descr *dtype)
 {
-    int i, naxes=0, ndim;
-    int axes[NPY_MAXDIMS];
-    PyObject *axes_in = NULL;
-    PyArrayObject *mp, *ret = NULL;
-    PyObject *op, *res = NULL;
-    PyObject *obj_ind, *context;
-    PyArrayObject *indices = NULL;
-    PyArray_Descr *otype = NULL;
-    PyArrayObject *out = NULL;
-    int keepdims = 0;
-    static char *kwlist1[] = {"array", "axis", "dtype",
-                                "out", "keepdims", NULL};
-    static char *kwlist2[] = {"array", "indices", "axis",
-                                "dtype", "out", NULL};
-    static char *_reduce_type[] = {"reduce", "accumulate", "reduceat", NULL};
-
-    if (ufunc == NULL) {
-        PyErr_SetString(PyExc_ValueError, "function not supported");
-        return NULL;
+    if (ufunc->name == NULL || !PyArray_ISNBO(dtype->byteorder)) {
+        return REDUCEBY_LOOP;
+    }
+    switch (dtype->type_num) {
+        case NPY_BYTE: case NPY_UBYTE: case NPY_SHORT: case NPY_USHORT:
+        case NPY_INT: case NPY_UINT: case NPY_LONG: case NPY_ULONG:
+        case NPY_LONGLONG: case NPY_ULONGLONG:
+        case NPY_FLOAT: case NPY_DOUBLE:
+            break;
+        default:
+            return REDUCEBY_LOOP;
     }
-    if (ufunc->core_enabled) {
-        PyErr_Format(PyExc_RuntimeError,
-                     "Reduction not defined on ufunc with signature");
-        return NULL;
+    if (strcmp(ufunc->name, "add") == 0) {
+        return REDUCEBY_ADD;
     }
-    if (ufunc->nin != 2) {
-        PyErr_Format(PyExc_ValueError,
-                     "%s only supported for binary functions",
-                     _reduce_type[operation]);
-        return NULL;
+    if (strcmp(ufunc->name, "multiply") == 0) {
+        return REDUCEBY_MULTIPLY;
     }
-    if (ufunc->nout != 1) {
-        PyErr_Format(PyExc_ValueError,
-                     "%s only supported for functions "
-                     "returning a single value",
-                     _reduce_type[operation]);
-        return NULL;
+    if (strcmp(ufunc->name, "maximum") == 0) {
+        return REDUCEBY_MAXIMUM;
+    }
+    if (strcmp(ufunc->name, "minimum") == 0) {
+        return REDUCEBY_MINIMUM;
     }
+    return REDUCEBY_LOOP;
+}
 
-    if (operation == UFUNC_REDUCEAT) {
-        PyArray_Descr *indtype;
-        indtype = PyArray_DescrFromType(NPY_INTP);
-        if (!PyArg_ParseTupleAndKeywords(args, kwds, "OO|OO&O&", kwlist2,
-                                        &op,
-                                        &obj_ind,
-                                        &axes_in,
-                                        PyArray_DescrConverter2, &otype,
-                                        PyArray_OutputConverter, &out)) {
-            Py_XDECREF(otype);
-            return NULL;
+/* Like the inner loops, maximum and minimum propagate NaNs */
+#define _REDUCEBY_ADD(a, b) ((a) + (b))
+#define _REDUCEBY_MULTIPLY(a, b) ((a) * (b))
+#define _REDUCEBY_MAXIMUM(a, b) (((a) >= (b) || (a) != (a)) ? (a) : (b))
+#define _REDUCEBY_MINIMUM(a, b) (((a) <= (b) || (a) != (a)) ? (a) : (b))
+
+#define _REDUCEBY_TYPED_LOOP(type, OP)                                  \
+    do {                                                                \
+        for (i = 0; i < nrows; ++i) {                                   \
+            npy_intp g = labels[i];                                     \
+            type *io1 = (type *)(acc + g * accstride);                  \
+            type in2 = *(type *)(values + i * vstride);                 \
+            if (seen != NULL && !seen[g]) {                             \
+                *io1 = in2;                                             \
+                seen[g] = 1;                                            \
+            }                                                           \
+            else {                                                      \
+                *io1 = OP(*io1, in2);                                   \
+            }                                                           \
+        }                                                               \
+    } while (0)
+
+#define _REDUCEBY_TYPED_CASE(NAME, type)                                \
+    case NPY_##NAME:                                                    \
+        switch (op) {                                                   \
+            case REDUCEBY_ADD:                                          \
+                _REDUCEBY_TYPED_LOOP(type, _REDUCEBY_ADD);              \
+                break;                                                  \
+            case REDUCEBY_MULTIPLY:                                     \
+                _REDUCEBY_TYPED_LOOP(type, _REDUCEBY_MULTIPLY);         \
+                break;                                                  \
+            case REDUCEBY_MAXIMUM:                                      \
+                _REDUCEBY_TYPED_LOOP(type, _REDUCEBY_MAXIMUM);          \
+                break;                                                  \
+            case REDUCEBY_MINIMUM:                                      \
+                _REDUCEBY_TYPED_LOOP(type, _REDUCEBY_MINIMUM);          \
+                break;                                                  \
+        }                                                               \
+        break
+
+/*
+ * Reduces single item rows like reduceby_rows, using the typed
+ * operation 'op' from reduceby_typed_op on items of type 'type_num'.
+ */
+static void
+reduceby_items_typed(int op, int type_num, char *acc, npy_intp accstride,
+                     npy_bool *seen, char *values, npy_intp vstride,
+                     npy_intp *labels, npy_intp nrows)
+{
+    npy_intp i;
+
+    switch (type_num) {
+        _REDUCEBY_TYPED_CASE(BYTE, npy_byte);
+        _REDUCEBY_TYPED_CASE(UBYTE, npy_ubyte);
+        _REDUCEBY_TYPED_CASE(SHORT, npy_short);
+        _REDUCEBY_TYPED_CASE(USHORT, npy_ushort);
+        _REDUCEBY_TYPED_CASE(INT, npy_int);
+        _REDUCEBY_TYPED_CASE(UINT, npy_uint);
+        _REDUCEBY_TYPED_CASE(LONG, npy_long);
+        _REDUCEBY_TYPED_CASE(ULONG, npy_ulong);
+        _REDUCEBY_TYPED_CASE(LONGLONG, npy_longlong);
+        _REDUCEBY_TYPED_CASE(ULONGLONG, npy_ulonglong);
+        _REDUCEBY_TYPED_CASE(FLOAT, npy_float);
+        _REDUCEBY_TYPED_CASE(DOUBLE, npy_double);
+    }
+}
+
+#undef _REDUCEBY_TYPED_CASE
+#undef _REDUCEBY_TYPED_LOOP
+
+/*
+ * Reduces the rows [0, nrows) of 'values' into the rows of 'acc' selected
+ * by 'labels'.  Every row holds 'rowsize' items; the rows of 'acc' are
+ * 'accstride' and those of 'values' 'vstride' bytes apart, and both are
+ * contiguous themselves unless rowsize is 1.
+ *
+ * When 'seen' is not NULL, the first row of every group is copied into
+ * 'acc' instead of being combined with it, and flagged in 'seen'.
+ * Otherwise 'acc' must already hold the identity.  Single item rows
+ * use the typed operation 'op' of type 'type_num' if there is one.
+ *
+ * Returns 0 on success, -1 if an object inner loop raised an error.
+ */
+static int
+reduceby_rows(PyUFuncGenericFunction innerloop, void *innerloopdata,
+              int op, int type_num, char *acc, npy_intp accstride,
+              npy_bool *seen, char *values, npy_intp vstride,
+              npy_intp *labels, npy_intp nrows, npy_intp rowsize,
+              npy_intp itemsize, int objects)
+{
+    npy_intp i, k, count, rowbytes = rowsize * itemsize;
+    npy_intp row_strides[3] = {itemsize, itemsize, itemsize};
+    npy_intp run_strides[3] = {0, vstride, 0};
+    char *args[3];
+
+    if (op != REDUCEBY_LOOP && rowsize == 1) {
+        reduceby_items_typed(op, type_num, acc, accstride, seen,
+                             values, vstride, labels, nrows);
+        return 0;
+    }
+
+    for (i = 0; i < nrows; i += count) {
+        npy_intp g = labels[i];
+
+        args[0] = args[2] = acc + g * accstride;
+        args[1] = values + i * vstride;
+        count = 1;
+
+        if (seen != NULL && !seen[g]) {
+            if (objects) {
+                PyObject **dst = (PyObject **)args[0];
+                PyObject **src = (PyObject **)args[1];
+
+                for (k = 0; k < rowsize; ++k) {
+                    Py_XINCREF(src[k]);
+                    Py_XDECREF(dst[k]);
+                    dst[k] = src[k];
+                }
+            }
+            else {
+                memcpy(args[0], args[1], rowbytes);
+            }
+            seen[g] = 1;
+            continue;
         }
-        indices = (PyArrayObject *)PyArray_FromAny(obj_ind, indtype,
-                                           1, 1, NPY_ARRAY_CARRAY, NULL);
-        if (indices == NULL) {
-            Py_XDECREF(otype);
-            return NULL;
+
+        if (rowsize == 1) {
+            /* Reduce a run of equal labels with a single call */
+            while (i + count < nrows && labels[i + count] == g) {
+                ++count;
+            }
+            innerloop(args, &count, run_strides, innerloopdata);
         }
-    }
-    else if (operation == UFUNC_ACCUMULATE) {
-        if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|OO&O&i", kwlist1,
-                                        &op,
-                                        &axes_in,
-                                        PyArray_DescrConverter2, &otype,
-                                        PyArray_OutputConverter, &out,
-                                        &keepdims)) {
-            Py_XDECREF(otype);
-            return NULL;
+        else {
+            innerloop(args, &rowsize, row_strides, innerloopdata);
         }
-    }
-    else {
-        if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|OO&O&i", kwlist1,
-                                        &op,
-                                        &axes_in,
-                                        PyArray_DescrConverter2, &otype,
-                                        PyArray_OutputConverter, &out,
-                                        &keepdims)) {
-            Py_XDECREF(otype);
-            return NULL;
+        if (objects && PyErr_Occurred()) {
+            return -1;
         }
     }
-    /* Ensure input is an array */
-    if (!PyArray_Check(op) && !PyArray_IsScalar(op, Generic)) {
-        context = Py_BuildValue("O(O)i", ufunc, op, 0);
-    }
-    else {
-        context = NULL;
-    }
-    mp = (PyArrayObject *)PyArray_FromAny(op, NULL, 0, 0, 0, context);
-    Py_XDECREF(context);
-    if (mp == NULL) {
-        return NULL;
-    }
 
-    ndim = PyArray_NDIM(mp);
+    return 0;
+}
 
-    /* Check to see that type (and otype) is not FLEXIBLE */
-    if (PyArray_ISFLEXIBLE(mp) ||
-        (otype && PyTypeNum_ISFLEXIBLE(otype->type_num))) {
-        PyErr_Format(PyExc_TypeError,
-                     "cannot perform %s with flexible type",
-                     _reduce_type[operation]);
-        Py_XDECREF(otype);
-        Py_DECREF(mp);
-        return NULL;
+typedef struct {
+    PyUFuncGenericFunction innerloop;
+    void *innerloopdata;
+    int op, type_num;
+    char *values;
+    npy_intp vstride, *labels, nrows, chunksize, rowsize, itemsize;
+    /* The accumulator and seen flags of each task */
+    char **accs;
+    npy_bool **seen;
+    /* Floating point error flags raised by each task */
+    int *fpe_status;
+} reduceby_parallel_data;
+
+static void
+reduceby_parallel_task(void *data, npy_intp itask)
+{
+    reduceby_parallel_data *d = (reduceby_parallel_data *)data;
+    npy_intp start = itask * d->chunksize, count = d->chunksize;
+    int status;
+
+    if (start + count > d->nrows) {
+        count = d->nrows - start;
     }
+    reduceby_rows(d->innerloop, d->innerloopdata, d->op, d->type_num,
+                  d->accs[itask], d->rowsize * d->itemsize,
+                  d->seen ? d->seen[itask] : NULL,
+                  d->values + start * d->vstride, d->vstride,
+                  d->labels + start, count, d->rowsize, d->itemsize, 0);
 
-    /* Convert the 'axis' parameter into a list of axes */
-    if (axes_in == NULL) {
-        naxes = 1;
-        axes[0] = 0;
+    UFUNC_CHECK_STATUS(status);
+    d->fpe_status[itask] = status;
+}
+
+/*
+ * Splits the rows of 'values' across the thread pool.  Every task but
+ * the first reduces its rows into a private accumulator, which are then
+ * combined into 'acc' group by group.  Must be called with the GIL
+ * released.
+ *
+ * Returns 0 on success, -1 on a memory error, in which case nothing
+ * has been done yet.
+ */
+static int
+reduceby_parallel(PyUFuncGenericFunction innerloop, void *innerloopdata,
+                  int op, int type_num, char *acc, npy_bool *seen, npy_intp ngroups,
+                  char *values, npy_intp vstride, npy_intp *labels,
+                  npy_intp nrows, npy_intp rowsize, npy_intp itemsize,
+                  int ntasks)
+{
+    reduceby_parallel_data d;
+    npy_intp g, rowbytes = rowsize * itemsize;
+    npy_intp accbytes = ngroups * rowbytes;
+    npy_intp strides[3] = {itemsize, itemsize, itemsize};
+    char *accbuf = NULL;
+    npy_bool *seenbuf = NULL;
+    int itask, status = 0, retval = -1;
+
+    d.chunksize = (nrows + ntasks - 1) / ntasks;
+    ntasks = (int)((nrows + d.chunksize - 1) / d.chunksize);
+
+    d.accs = malloc(ntasks * sizeof(char *));
+    d.seen = NULL;
+    d.fpe_status = malloc(ntasks * sizeof(int));
+    accbuf = malloc((ntasks - 1) * accbytes);
+    if (d.accs == NULL || d.fpe_status == NULL || accbuf == NULL) {
+        goto finish;
     }
-    /* Convert 'None' into all the axes */
-    else if (axes_in == Py_None) {
-        naxes = ndim;
-        for (i = 0; i < naxes; ++i) {
-            axes[i] = i;
+    if (seen != NULL) {
+        d.seen = malloc(ntasks * sizeof(npy_bool *));
+        seenbuf = calloc((ntasks - 1) * ngroups, 1);
+        if (d.seen == NULL || seenbuf == NULL) {
+            goto finish;
         }
+        d.seen[0] = seen;
     }
-    else if (PyTuple_Check(axes_in)) {
-        naxes = PyTuple_Size(axes_in);
-        if (naxes < 0 || naxes > NPY_MAXDIMS) {
-            PyErr_SetString(PyExc_ValueError,
-                    "too many values for 'axis'");
-            Py_XDECREF(otype);
-            Py_DECREF(mp);
-            return NULL;
+    d.accs[0] = acc;
+    for (itask = 1; itask < ntasks; ++itask) {
+        d.accs[itask] = accbuf + (itask - 1) * accbytes;
+        if (seen != NULL) {
+            d.seen[itask] = seenbuf + (itask - 1) * ngroups;
         }
-        for (i = 0; i < naxes; ++i) {
-            PyObject *tmp = PyTuple_GET_ITEM(axes_in, i);
-            long axis = PyInt_AsLong(tmp);
-            if (axis == -1 && PyErr_Occurred()) {
-                Py_XDECREF(otype);
-                Py_DECREF(mp);
-                return NULL;
+        else {
+            /* 'acc' holds the identity */
+            memcpy(d.accs[itask], acc, accbytes);
+        }
+    }
+    d.innerloop = innerloop;
+    d.innerloopdata = innerloopdata;
+    d.op = op;
+    d.type_num = type_num;
+    d.values = values;
+    d.vstride = vstride;
+    d.labels = labels;
+    d.nrows = nrows;
+    d.rowsize = rowsize;
+    d.itemsize = itemsize;
+
+    PyArray_ParallelRun(&reduceby_parallel_task, &d, ntasks);
+
+    for (itask = 0; itask < ntasks; ++itask) {
+        status |= d.fpe_status[itask];
+    }
+    ufunc_set_fpe_status(status);
+
+    /* Combine the private accumulators into the first one */
+    for (itask = 1; itask < ntasks; ++itask) {
+        char *args[3];
+
+        if (seen == NULL) {
+            npy_intp count = ngroups * rowsize;
+
+            args[0] = args[2] = acc;
+            args[1] = d.accs[itask];
+            innerloop(args, &count, strides, innerloopdata);
+            continue;
+        }
+        for (g = 0; g < ngroups; ++g) {
+            if (!d.seen[itask][g]) {
+                continue;
             }
-            if (axis < 0) {
-                axis += ndim;
+            args[0] = args[2] = acc + g * rowbytes;
+            args[1] = d.accs[itask] + g * rowbytes;
+            if (seen[g]) {
+                innerloop(args, &rowsize, strides, innerloopdata);
             }
-            if (axis < 0 || axis >= ndim) {
-                PyErr_SetString(PyExc_ValueError,
-                        "'axis' entry is out of bounds");
-                Py_XDECREF(otype);
-                Py_DECREF(mp);
-                return NULL;
+            else {
+                memcpy(args[0], args[1], rowbytes);
+                seen[g] = 1;
             }
-            axes[i] = (int)axis;
         }
     }
-    /* Try to interpret axis as an integer */
-    else {
-        long axis = PyInt_AsLong(axes_in);
-        /* TODO: PyNumber_Index would be good to use here */
-        if (axis == -1 && PyErr_Occurred()) {
-            Py_XDECREF(otype);
-            Py_DECREF(mp);
-            return NULL;
-        }
-        if (axis < 0) {
-            axis += ndim;
-        }
-        /* Special case letting axis={0 or -1} slip through for scalars */
-        if (ndim == 0 && (axis == 0 || axis == -1)) {
-            axis = 0;
-        }
-        else if (axis < 0 || axis >= ndim) {
+    retval = 0;
+
+finish:
+    free(d.accs);
+    free(d.seen);
+    free(d.fpe_status);
+    free(accbuf);
+    free(seenbuf);
+    return retval;
+}
+
+/*
+ * Reduces the subarrays of 'arr' along 'axis' which share a label into
+ * one subarray per group, in a single pass without sorting.  'labels'
+ * must be a contiguous 1-D intp array with one entry per element along
+ * 'axis', and 'ngroups' negative to use one more than the largest label.
+ *
+ * The rows are combined in order, so the result does not depend on the
+ * number of threads for ufuncs whose results are exact.  Large reductions
+ * into few groups are split across the thread pool, each thread keeping
+ * its own accumulators.
+ */
+static PyObject *
+PyUFunc_Reduceby(PyUFuncObject *ufunc, PyArrayObject *arr,
+                 PyArrayObject *labels, npy_intp ngroups,
+                 PyArrayObject *out, int axis, int otype)
+{
+    PyArrayObject *values = NULL, *result = NULL, *ret = NULL, *tmp;
+    PyArray_Descr *dtype = NULL;
+    PyArray_Dims permute;
+    npy_intp perm[NPY_MAXDIMS], shape[NPY_MAXDIMS];
+    npy_intp *label_data, nrows, rowsize, itemsize, vstride, i;
+    npy_bool *seen = NULL;
+    int idim, ndim, otype_final, objects, op, ntasks = 1, retval = 0;
+    int (*assign_identity)(PyArrayObject *) = NULL;
+    PyUFuncGenericFunction innerloop = NULL;
+    void *innerloopdata = NULL;
+    char *ufunc_name = ufunc->name ? ufunc->name : "(unknown)";
+    NPY_BEGIN_THREADS_DEF;
+
+    switch (ufunc->identity) {
+        case PyUFunc_Zero:
+            assign_identity = &assign_reduce_identity_zero;
+            break;
+        case PyUFunc_One:
+            assign_identity = &assign_reduce_identity_one;
+            break;
+        case PyUFunc_ReorderableNone:
+            break;
+        default:
+            PyErr_Format(PyExc_ValueError,
+                    "reduceby requires an identity or a reorderable "
+                    "operation, which ufunc %s does not have", ufunc_name);
+            return NULL;
+    }
+
+    ndim = PyArray_NDIM(arr);
+    nrows = PyArray_DIM(arr, axis);
+    label_data = (npy_intp *)PyArray_DATA(labels);
+    if (PyArray_DIM(labels, 0) != nrows) {
+        PyErr_Format(PyExc_ValueError,
+                "labels of length %" NPY_INTP_FMT " do not match axis %d "
+                "of length %" NPY_INTP_FMT " in %s.reduceby",
+                PyArray_DIM(labels, 0), axis, nrows, ufunc_name);
+        return NULL;
+    }
+
+    /* Check the labels, finding the number of groups if not given */
+    if (ngroups < 0) {
+        for (i = 0; i < nrows; ++i) {
+            if (label_data[i] >= ngroups) {
+                ngroups = label_data[i] + 1;
+            }
+        }
+        if (ngroups < 0) {
+            ngroups = 0;
+        }
+    }
+    for (i = 0; i < nrows; ++i) {
+        if (label_data[i] < 0 || label_data[i] >= ngroups) {
+            PyErr_Format(PyExc_IndexError,
+                "label %" NPY_INTP_FMT " out-of-bounds in %s.reduceby "
+                "[0, %" NPY_INTP_FMT ")", label_data[i], ufunc_name, ngroups);
+            return NULL;
+        }
+    }
+
+    otype_final = otype;
+    if (get_binary_op_function(ufunc, &otype_final,
+                                &innerloop, &innerloopdata) < 0) {
+        dtype = PyArray_DescrFromType(otype);
+        PyErr_Format(PyExc_ValueError,
+                     "could not find a matching type for %s.reduceby, "
+                     "requested type has type code '%c'",
+                            ufunc_name, dtype ? dtype->type : '-');
+        Py_XDECREF(dtype);
+        return NULL;
+    }
+
+    /* Keep the input's data type if possible to preserve metadata */
+    if (PyArray_DESCR(arr)->type_num == otype_final) {
+        if (PyArray_ISNBO(PyArray_DESCR(arr)->byteorder)) {
+            dtype = PyArray_DESCR(arr);
+            Py_INCREF(dtype);
+        }
+        else {
+            dtype = PyArray_DescrNewByteorder(PyArray_DESCR(arr),
+                                              NPY_NATIVE);
+        }
+    }
+    else {
+        dtype = PyArray_DescrFromType(otype_final);
+    }
+    if (dtype == NULL) {
+        return NULL;
+    }
+    itemsize = dtype->elsize;
+    objects = PyDataType_REFCHK(dtype);
+    op = reduceby_typed_op(ufunc, dtype);
+
+    /*
+     * Work on the array with 'axis' moved to the front, so every label
+     * selects one contiguous row of the values and of the result.
+     */
+    perm[0] = axis;
+    shape[0] = ngroups;
+    for (idim = 0; idim < ndim; ++idim) {
+        if (idim != axis) {
+            perm[idim + (idim < axis)] = idim;
+            shape[idim + (idim < axis)] = PyArray_DIM(arr, idim);
+        }
+    }
+    permute.ptr = perm;
+    permute.len = ndim;
+    values = (PyArrayObject *)PyArray_Transpose(arr, &permute);
+    if (values == NULL) {
+        goto fail;
+    }
+    Py_INCREF(dtype);
+    tmp = (PyArrayObject *)PyArray_FromArray(values, dtype,
+                            NPY_ARRAY_FORCECAST | (ndim == 1 ?
+                                NPY_ARRAY_ALIGNED : NPY_ARRAY_CARRAY));
+    Py_DECREF(values);
+    values = tmp;
+    if (values == NULL) {
+        goto fail;
+    }
+    rowsize = (nrows == 0) ? 1 : PyArray_SIZE(values) / nrows;
+    vstride = PyArray_STRIDE(values, 0);
+    if (ndim > 1) {
+        vstride = rowsize * itemsize;
+    }
+
+    /* Reduce straight into 'out' when its layout allows it */
+    if (out != NULL) {
+        npy_uintp vstart, vend, ostart, oend;
+
+        for (idim = 0; idim < ndim; ++idim) {
+            if (PyArray_DIM(out, perm[idim]) != shape[idim]) {
+                PyErr_Format(PyExc_ValueError,
+                        "output operand for %s.reduceby has the wrong "
+                        "shape", ufunc_name);
+                goto fail;
+            }
+        }
+        result = (PyArrayObject *)PyArray_Transpose(out, &permute);
+        if (result == NULL) {
+            goto fail;
+        }
+        get_array_byte_extent(values, &vstart, &vend);
+        get_array_byte_extent(out, &ostart, &oend);
+        if (!PyArray_ISCARRAY(result) ||
+                !PyArray_EquivTypes(PyArray_DESCR(result), dtype) ||
+                (vstart < oend && ostart < vend)) {
+            Py_CLEAR(result);
+        }
+    }
+    if (result == NULL) {
+        Py_INCREF(dtype);
+        result = (PyArrayObject *)PyArray_NewFromDescr(&PyArray_Type,
+                                    dtype, ndim, shape, NULL, NULL, 0, NULL);
+        if (result == NULL) {
+            goto fail;
+        }
+    }
+
+    if (assign_identity != NULL && assign_identity(result) < 0) {
+        goto fail;
+    }
+    /*
+     * Without an identity, and for objects where the identity isn't
+     * generally usable, each group starts at its first row instead.
+     */
+    if (assign_identity == NULL || objects) {
+        seen = calloc(ngroups ? ngroups : 1, 1);
+        if (seen == NULL) {
+            PyErr_NoMemory();
+            goto fail;
+        }
+    }
+
+    if (!objects && dtype->type_num < NPY_NTYPES &&
+            !PyDataType_FLAGCHK(dtype, NPY_NEEDS_PYAPI) &&
+            PyArray_GetNumThreads() > 1 &&
+            PyArray_SIZE(result) * 4 <= PyArray_SIZE(values)) {
+        ntasks = PyArray_ParallelTaskCount(PyArray_SIZE(values),
+                                           NPY_UFUNC_PARALLEL_MINCHUNK);
+        /* Keep the private accumulators small compared to the values */
+        while (ntasks > 1 &&
+                PyArray_SIZE(result) * ntasks * 4 > PyArray_SIZE(values)) {
+            --ntasks;
+        }
+    }
+
+    if (!objects) {
+        NPY_BEGIN_THREADS;
+    }
+    /* The parallel reduction falls back to this one if out of memory */
+    if (ntasks <= 1 || reduceby_parallel(innerloop, innerloopdata,
+                            op, dtype->type_num, PyArray_BYTES(result), seen, ngroups,
+                            PyArray_BYTES(values), vstride, label_data,
+                            nrows, rowsize, itemsize, ntasks) < 0) {
+        retval = reduceby_rows(innerloop, innerloopdata,
+                            op, dtype->type_num, PyArray_BYTES(result),
+                            rowsize * itemsize, seen,
+                            PyArray_BYTES(values), vstride, label_data,
+                            nrows, rowsize, itemsize, objects);
+    }
+    if (!objects) {
+        NPY_END_THREADS;
+    }
+    if (retval < 0) {
+        goto fail;
+    }
+
+    if (assign_identity == NULL) {
+        for (i = 0; i < ngroups; ++i) {
+            if (!seen[i]) {
+                PyErr_Format(PyExc_ValueError,
+                        "empty group %" NPY_INTP_FMT " in %s.reduceby, "
+                        "which has no identity", i, ufunc_name);
+                goto fail;
+            }
+        }
+    }
+
+    if (out != NULL) {
+        ret = out;
+        Py_INCREF(ret);
+        if (PyArray_BASE(result) != (PyObject *)out &&
+                (PyObject *)result != (PyObject *)out) {
+            /* Copy the reduction into 'out', in its original axis order */
+            for (idim = 0; idim < ndim; ++idim) {
+                perm[idim] = (idim < axis) ? idim + 1 : (idim == axis) ?
+                                                        0 : idim;
+            }
+            tmp = (PyArrayObject *)PyArray_Transpose(result, &permute);
+            if (tmp == NULL || PyArray_CopyInto(out, tmp) < 0) {
+                Py_DECREF(ret);
+                ret = NULL;
+            }
+            Py_XDECREF(tmp);
+        }
+    }
+    else {
+        for (idim = 0; idim < ndim; ++idim) {
+            perm[idim] = (idim < axis) ? idim + 1 : (idim == axis) ? 0 : idim;
+        }
+        ret = (PyArrayObject *)PyArray_Transpose(result, &permute);
+    }
+
+    free(seen);
+    Py_XDECREF(result);
+    Py_DECREF(values);
+    Py_DECREF(dtype);
+    return (PyObject *)ret;
+
+fail:
+    free(seen);
+    Py_XDECREF(result);
+    Py_XDECREF(values);
+    Py_XDECREF(dtype);
+    return NULL;
+}
+
+/*
+ * This code handles reduce, reduceat, accumulate and reduceby
+ * (accumulate and reduce are special cases of the more general reduceat
+ * but they are handled separately for speed)
+ */
+static PyObject *
+PyUFunc_GenericReduction(PyUFuncObject *ufunc, PyObject *args,
+                         PyObject *kwds, int operation)
+{
+    int i, naxes=0, ndim;
+    int axes[NPY_MAXDIMS];
+    PyObject *axes_in = NULL;
+    PyArrayObject *mp, *ret = NULL;
+    PyObject *op, *res = NULL;
+    PyObject *obj_ind, *obj_ngroups = NULL, *context;
+    PyArrayObject *indices = NULL;
+    npy_intp ngroups = -1;
+    PyArray_Descr *otype = NULL;
+    PyArrayObject *out = NULL;
+    int keepdims = 0;
+    static char *kwlist1[] = {"array", "axis", "dtype",
+                                "out", "keepdims", NULL};
+    static char *kwlist2[] = {"array", "indices", "axis",
+                                "dtype", "out", NULL};
+    static char *kwlist3[] = {"array", "labels", "ngroups", "axis",
+                                "dtype", "out", NULL};
+    static char *_reduce_type[] = {"reduce", "accumulate", "reduceat",
+                                   "outer", "reduceby", NULL};
+    /* The profiling counters, if a profiling hook is set */
+    PyUFunc_ProfileInfo profile, *prof;
+    double prof_start = 0, loop_start = 0;
+
+    if (ufunc == NULL) {
+        PyErr_SetString(PyExc_ValueError, "function not supported");
+        return NULL;
+    }
+    prof = ufunc_profile_start(&profile, &prof_start);
+    if (ufunc->core_enabled) {
+        PyErr_Format(PyExc_RuntimeError,
+                     "Reduction not defined on ufunc with signature");
+        return NULL;
+    }
+    if (ufunc->nin != 2) {
+        PyErr_Format(PyExc_ValueError,
+                     "%s only supported for binary functions",
+                     _reduce_type[operation]);
+        return NULL;
+    }
+    if (ufunc->nout != 1) {
+        PyErr_Format(PyExc_ValueError,
+                     "%s only supported for functions "
+                     "returning a single value",
+                     _reduce_type[operation]);
+        return NULL;
+    }
+
+    if (operation == UFUNC_REDUCEAT) {
+        PyArray_Descr *indtype;
+        indtype = PyArray_DescrFromType(NPY_INTP);
+        if (!PyArg_ParseTupleAndKeywords(args, kwds, "OO|OO&O&", kwlist2,
+                                        &op,
+                                        &obj_ind,
+                                        &axes_in,
+                                        PyArray_DescrConverter2, &otype,
+                                        PyArray_OutputConverter, &out)) {
+            Py_XDECREF(otype);
+            return NULL;
+        }
+        indices = (PyArrayObject *)PyArray_FromAny(obj_ind, indtype,
+                                           1, 1, NPY_ARRAY_CARRAY, NULL);
+        if (indices == NULL) {
+            Py_XDECREF(otype);
+            return NULL;
+        }
+    }
+    else if (operation == UFUNC_REDUCEBY) {
+        PyArray_Descr *indtype;
+        indtype = PyArray_DescrFromType(NPY_INTP);
+        if (!PyArg_ParseTupleAndKeywords(args, kwds, "OO|OOO&O&", kwlist3,
+                                        &op,
+                                        &obj_ind,
+                                        &obj_ngroups,
+                                        &axes_in,
+                                        PyArray_DescrConverter2, &otype,
+                                        PyArray_OutputConverter, &out)) {
+            Py_XDECREF(otype);
+            return NULL;
+        }
+        if (obj_ngroups != NULL && obj_ngroups != Py_None) {
+            ngroups = PyArray_PyIntAsIntp(obj_ngroups);
+            if (ngroups == -1 && PyErr_Occurred()) {
+                Py_XDECREF(otype);
+                return NULL;
+            }
+            if (ngroups < 0) {
+                PyErr_SetString(PyExc_ValueError,
+                        "ngroups must be non-negative");
+                Py_XDECREF(otype);
+                return NULL;
+            }
+        }
+        indices = (PyArrayObject *)PyArray_FromAny(obj_ind, indtype,
+                                           1, 1, NPY_ARRAY_CARRAY, NULL);
+        if (indices == NULL) {
+            Py_XDECREF(otype);
+            return NULL;
+        }
+    }
+    else if (operation == UFUNC_ACCUMULATE) {
+        if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|OO&O&i", kwlist1,
+                                        &op,
+                                        &axes_in,
+                                        PyArray_DescrConverter2, &otype,
+                                        PyArray_OutputConverter, &out,
+                                        &keepdims)) {
+            Py_XDECREF(otype);
+            return NULL;
+        }
+    }
+    else {
+        if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|OO&O&i", kwlist1,
+                                        &op,
+                                        &axes_in,
+                                        PyArray_DescrConverter2, &otype,
+                                        PyArray_OutputConverter, &out,
+                                        &keepdims)) {
+            Py_XDECREF(otype);
+            return NULL;
+        }
+    }
+    /* Ensure input is an array */
+    if (!PyArray_Check(op) && !PyArray_IsScalar(op, Generic)) {
+        context = Py_BuildValue("O(O)i", ufunc, op, 0);
+    }
+    else {
+        context = NULL;
+    }
+    mp = (PyArrayObject *)PyArray_FromAny(op, NULL, 0, 0, 0, context);
+    Py_XDECREF(context);
+    if (mp == NULL) {
+        return NULL;
+    }
+
+    ndim = PyArray_NDIM(mp);
+
+    /* Check to see that type (and otype) is not FLEXIBLE */
+    if (PyArray_ISFLEXIBLE(mp) ||
+        (otype && PyTypeNum_ISFLEXIBLE(otype->type_num))) {
+        PyErr_Format(PyExc_TypeError,
+                     "cannot perform %s with flexible type",
+                     _reduce_type[operation]);
+        Py_XDECREF(otype);
+        Py_DECREF(mp);
+        return NULL;
+    }
+
+    /* Convert the 'axis' parameter into a list of axes */
+    if (axes_in == NULL) {
+        naxes = 1;
+        axes[0] = 0;
+    }
+    /* Convert 'None' into all the axes */
+    else if (axes_in == Py_None) {
+        naxes = ndim;
+        for (i = 0; i < naxes; ++i) {
+            axes[i] = i;
+        }
+    }
+    else if (PyTuple_Check(axes_in)) {
+        naxes = PyTuple_Size(axes_in);
+        if (naxes < 0 || naxes > NPY_MAXDIMS) {
+            PyErr_SetString(PyExc_ValueError,
+                    "too many values for 'axis'");
+            Py_XDECREF(otype);
+            Py_DECREF(mp);
+            return NULL;
+        }
+        for (i = 0; i < naxes; ++i) {
+            PyObject *tmp = PyTuple_GET_ITEM(axes_in, i);
+            long axis = PyInt_AsLong(tmp);
+            if (axis == -1 && PyErr_Occurred()) {
+                Py_XDECREF(otype);
+                Py_DECREF(mp);
+                return NULL;
+            }
+            if (axis < 0) {
+                axis += ndim;
+            }
+            if (axis < 0 || axis >= ndim) {
+                PyErr_SetString(PyExc_ValueError,
+                        "'axis' entry is out of bounds");
+                Py_XDECREF(otype);
+                Py_DECREF(mp);
+                return NULL;
+            }
+            axes[i] = (int)axis;
+        }
+    }
+    /* Try to interpret axis as an integer */
+    else {
+        long axis = PyInt_AsLong(axes_in);
+        /* TODO: PyNumber_Index would be good to use here */
+        if (axis == -1 && PyErr_Occurred()) {
+            Py_XDECREF(otype);
+            Py_DECREF(mp);
+            return NULL;
+        }
+        if (axis < 0) {
+            axis += ndim;
+        }
+        /* Special case letting axis={0 or -1} slip through for scalars */
+        if (ndim == 0 && (axis == 0 || axis == -1)) {
+            axis = 0;
+        }
+        else if (axis < 0 || axis >= ndim) {
             PyErr_SetString(PyExc_ValueError,
                     "'axis' entry is out of bounds");
             Py_XDECREF(otype);
@@ -3808,6 +5493,13 @@ PyUFunc_GenericReduction(PyUFuncObject *ufunc, PyObject *args,
         otype = PyArray_DescrFromType(typenum);
     }
 
+    /*
+     * The reduction functions set up their own iterators, which
+     * are counted as loop time.
+     */
+    if (prof != NULL) {
+        loop_start = ufunc_profile_clock();
+    }
 
     switch(operation) {
     case UFUNC_REDUCE:
@@ -3837,6 +5529,24 @@ PyUFunc_GenericReduction(PyUFuncObject *ufunc, PyObject *args,
                                             axes[0], otype->type_num);
         Py_DECREF(indices);
         break;
+    case UFUNC_REDUCEBY:
+        if (naxes != 1) {
+            PyErr_SetString(PyExc_ValueError,
+                        "reduceby does not allow multiple axes");
+            Py_XDECREF(otype);
+            Py_DECREF(mp);
+            return NULL;
+        }
+        ret = (PyArrayObject *)PyUFunc_Reduceby(ufunc, mp, indices, ngroups,
+                                            out, axes[0], otype->type_num);
+        Py_DECREF(indices);
+        break;
+    }
+    if (prof != NULL && ret != NULL) {
+        prof->loop_time = ufunc_profile_clock() - loop_start;
+        prof->nelements = PyArray_SIZE(mp);
+        ufunc_profile_report(ufunc, _reduce_type[operation],
+                             prof, prof_start);
     }
     Py_DECREF(mp);
     Py_DECREF(otype);
@@ -4147,7 +5857,7 @@ ufunc_geterr(PyObject *NPY_UNUSED(dummy), PyObject *args)
     if (res == NULL) {
         return NULL;
     }
-    PyList_SET_ITEM(res, 0, PyInt_FromLong(NPY_BUFSIZE));
+    PyList_SET_ITEM(res, 0, PyInt_FromLong(0));
     PyList_SET_ITEM(res, 1, PyInt_FromLong(UFUNC_ERR_DEFAULT));
     PyList_SET_ITEM(res, 2, Py_None); Py_INCREF(Py_None);
     return res;
@@ -4174,49 +5884,155 @@ ufunc_update_use_defaults(void)
         Py_XDECREF(errobj);
         return -1;
     }
-    if ((errmask != UFUNC_ERR_DEFAULT) || (bufsize != NPY_BUFSIZE)
+    if ((errmask != UFUNC_ERR_DEFAULT) || (bufsize != 0)
             || (PyTuple_GET_ITEM(errobj, 1) != Py_None)) {
         PyUFunc_NUM_NODEFAULTS += 1;
     }
-    else if (PyUFunc_NUM_NODEFAULTS > 0) {
-        PyUFunc_NUM_NODEFAULTS -= 1;
+    else if (PyUFunc_NUM_NODEFAULTS > 0) {
+        PyUFunc_NUM_NODEFAULTS -= 1;
+    }
+    Py_XDECREF(errobj);
+    return 0;
+}
+#endif
+
+NPY_NO_EXPORT PyObject *
+ufunc_seterr(PyObject *NPY_UNUSED(dummy), PyObject *args)
+{
+    PyObject *thedict;
+    int res;
+    PyObject *val;
+    static char *msg = "Error object must be a list of length 3";
+
+    if (!PyArg_ParseTuple(args, "O", &val)) {
+        return NULL;
+    }
+    if (!PyList_CheckExact(val) || PyList_GET_SIZE(val) != 3) {
+        PyErr_SetString(PyExc_ValueError, msg);
+        return NULL;
+    }
+    if (PyUFunc_PYVALS_NAME == NULL) {
+        PyUFunc_PYVALS_NAME = PyUString_InternFromString(UFUNC_PYVALS_NAME);
+    }
+    thedict = PyThreadState_GetDict();
+    if (thedict == NULL) {
+        thedict = PyEval_GetBuiltins();
+    }
+    res = PyDict_SetItem(thedict, PyUFunc_PYVALS_NAME, val);
+    if (res < 0) {
+        return NULL;
+    }
+#if USE_USE_DEFAULTS==1
+    if (ufunc_update_use_defaults() < 0) {
+        return NULL;
+    }
+#endif
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+/*
+ * The profiling hook installed by numpy.ufunc_profile.  It adds the
+ * counters of each call to a list [calls, elements, buffer_fills,
+ * setup_time, loop_time, buffer_time] in the stats dict, keyed by
+ * the ufunc name with ".method" appended for the methods.
+ */
+static void
+ufunc_profile_dict_hook(PyUFuncObject *ufunc, const char *method,
+                        PyUFunc_ProfileInfo *info, void *user_data)
+{
+    PyObject *stats = (PyObject *)user_data;
+    PyObject *key, *entry, *item;
+    char *name = ufunc->name ? ufunc->name : "<unnamed ufunc>";
+    npy_intp counts[3];
+    double times[3];
+    int i;
+
+    if (strcmp(method, "__call__") == 0) {
+        key = PyUString_FromString(name);
+    }
+    else {
+        key = PyUString_FromFormat("%s.%s", name, method);
+    }
+    if (key == NULL) {
+        goto fail;
+    }
+    entry = PyDict_GetItem(stats, key);
+    if (entry == NULL) {
+        entry = Py_BuildValue("[iiiddd]", 0, 0, 0, 0., 0., 0.);
+        if (entry == NULL || PyDict_SetItem(stats, key, entry) < 0) {
+            Py_XDECREF(entry);
+            Py_DECREF(key);
+            goto fail;
+        }
+        Py_DECREF(entry);
+    }
+    Py_DECREF(key);
+    if (!PyList_Check(entry) || PyList_GET_SIZE(entry) != 6) {
+        return;
+    }
+
+    counts[0] = 1;
+    counts[1] = info->nelements;
+    counts[2] = info->buffer_fills;
+    times[0] = info->setup_time;
+    times[1] = info->loop_time;
+    times[2] = info->buffer_time;
+    for (i = 0; i < 3; ++i) {
+        item = PyInt_FromLong(PyInt_AsLong(
+                            PyList_GET_ITEM(entry, i)) + (long)counts[i]);
+        if (item == NULL) {
+            goto fail;
+        }
+        PyList_SetItem(entry, i, item);
+    }
+    for (i = 0; i < 3; ++i) {
+        item = PyFloat_FromDouble(PyFloat_AsDouble(
+                            PyList_GET_ITEM(entry, i + 3)) + times[i]);
+        if (item == NULL) {
+            goto fail;
+        }
+        PyList_SetItem(entry, i + 3, item);
     }
-    Py_XDECREF(errobj);
-    return 0;
+    return;
+
+fail:
+    /* The hook can't report errors, the call is just not counted */
+    PyErr_Clear();
 }
-#endif
 
+/*
+ * Installs ufunc_profile_dict_hook recording into the given dict, or
+ * removes the profiling hook if None is given.  Returns the dict the
+ * previous hook recorded into, or None.
+ */
 NPY_NO_EXPORT PyObject *
-ufunc_seterr(PyObject *NPY_UNUSED(dummy), PyObject *args)
+ufunc_setprofile(PyObject *NPY_UNUSED(dummy), PyObject *args)
 {
-    PyObject *thedict;
-    int res;
-    PyObject *val;
-    static char *msg = "Error object must be a list of length 3";
+    PyObject *stats;
+    PyUFunc_ProfileHookFunc *old_hook;
+    void *old_data;
 
-    if (!PyArg_ParseTuple(args, "O", &val)) {
+    if (!PyArg_ParseTuple(args, "O", &stats)) {
         return NULL;
     }
-    if (!PyList_CheckExact(val) || PyList_GET_SIZE(val) != 3) {
-        PyErr_SetString(PyExc_ValueError, msg);
+    if (stats != Py_None && !PyDict_Check(stats)) {
+        PyErr_SetString(PyExc_TypeError,
+                "profile statistics must be a dict or None");
         return NULL;
     }
-    if (PyUFunc_PYVALS_NAME == NULL) {
-        PyUFunc_PYVALS_NAME = PyUString_InternFromString(UFUNC_PYVALS_NAME);
-    }
-    thedict = PyThreadState_GetDict();
-    if (thedict == NULL) {
-        thedict = PyEval_GetBuiltins();
+    if (stats == Py_None) {
+        old_hook = PyUFunc_SetProfileHook(NULL, NULL, &old_data);
     }
-    res = PyDict_SetItem(thedict, PyUFunc_PYVALS_NAME, val);
-    if (res < 0) {
-        return NULL;
+    else {
+        Py_INCREF(stats);
+        old_hook = PyUFunc_SetProfileHook(&ufunc_profile_dict_hook,
+                                          stats, &old_data);
     }
-#if USE_USE_DEFAULTS==1
-    if (ufunc_update_use_defaults() < 0) {
-        return NULL;
+    /* The reference held by the previous hook goes to the caller */
+    if (old_hook == &ufunc_profile_dict_hook) {
+        return (PyObject *)old_data;
     }
-#endif
     Py_INCREF(Py_None);
     return Py_None;
 }
@@ -4246,6 +6062,7 @@ PyUFunc_ReplaceLoopBySignature(PyUFuncObject *func,
             *oldfunc = func->functions[i];
         }
         func->functions[i] = newfunc;
+        ufunc_cache_clear(func);
         res = 0;
         break;
     }
@@ -4317,6 +6134,7 @@ PyUFunc_FromFuncAndDataAndSignature(PyUFuncGenericFunction *func, void **data,
 
     /* generalized ufunc */
     ufunc->core_enabled = 0;
+    ufunc->core_threadsafe = 0;
     ufunc->core_num_dim_ix = 0;
     ufunc->core_num_dims = NULL;
     ufunc->core_dim_ixs = NULL;
@@ -4467,6 +6285,7 @@ PyUFunc_RegisterLoopForDescr(PyUFuncObject *ufunc,
             "unknown user defined struct dtype");
         return -1;
     }
+    ufunc_cache_clear(ufunc);
 
     key = PyInt_FromLong((long) user_dtype->type_num);
     if (key == NULL) {
@@ -4562,6 +6381,7 @@ PyUFunc_RegisterLoopForType(PyUFuncObject *ufunc,
         return -1;
     }
     Py_DECREF(descr);
+    ufunc_cache_clear(ufunc);
 
     if (ufunc->userloops == NULL) {
         ufunc->userloops = PyDict_New();
@@ -4667,6 +6487,7 @@ PyUFunc_RegisterLoopForType(PyUFuncObject *ufunc,
 static void
 ufunc_dealloc(PyUFuncObject *ufunc)
 {
+    ufunc_cache_clear(ufunc);
     if (ufunc->core_num_dims) {
         PyArray_free(ufunc->core_num_dims);
     }
@@ -4820,6 +6641,452 @@ ufunc_reduceat(PyUFuncObject *ufunc, PyObject *args, PyObject *kwds)
     return PyUFunc_GenericReduction(ufunc, args, kwds, UFUNC_REDUCEAT);
 }
 
+static PyObject *
+ufunc_reduceby(PyUFuncObject *ufunc, PyObject *args, PyObject *kwds)
+{
+    return PyUFunc_GenericReduction(ufunc, args, kwds, UFUNC_REDUCEBY);
+}
+
+/*
+ * Converts the index of ufunc.at into a contiguous intp array with the
+ * negative values wrapped, if it is a list or integer array of a single
+ * dimension indexing a 1-D array of length 'n'.  Returns NULL without an
+ * error set if the index is of another kind.
+ */
+static PyArrayObject *
+ufunc_at_1d_indices(PyObject *idx, npy_intp n)
+{
+    PyArrayObject *ind, *tmp;
+    npy_intp i, nind, *data;
+
+    if (!PyList_Check(idx) && !PyArray_Check(idx)) {
+        return NULL;
+    }
+    ind = (PyArrayObject *)PyArray_FromAny(idx, NULL, 0, 0, 0, NULL);
+    if (ind == NULL) {
+        PyErr_Clear();
+        return NULL;
+    }
+    if (PyArray_NDIM(ind) != 1 || !PyArray_ISINTEGER(ind)) {
+        Py_DECREF(ind);
+        return NULL;
+    }
+    tmp = (PyArrayObject *)PyArray_FromArray(ind,
+                                PyArray_DescrFromType(NPY_INTP),
+                                NPY_ARRAY_CARRAY | NPY_ARRAY_FORCECAST);
+    Py_DECREF(ind);
+    if (tmp == NULL) {
+        return NULL;
+    }
+    ind = tmp;
+
+    nind = PyArray_DIM(ind, 0);
+    data = (npy_intp *)PyArray_DATA(ind);
+    for (i = 0; i < nind; ++i) {
+        if (data[i] < -n || data[i] >= n) {
+            PyErr_Format(PyExc_IndexError,
+                    "index %" NPY_INTP_FMT " is out of bounds "
+                    "for axis 0 with size %" NPY_INTP_FMT, data[i], n);
+            Py_DECREF(ind);
+            return NULL;
+        }
+    }
+    for (i = 0; i < nind; ++i) {
+        if (data[i] >= 0) {
+            continue;
+        }
+        /* Wrap the negative indices in a copy of the caller's array */
+        if ((PyObject *)ind == idx) {
+            tmp = (PyArrayObject *)PyArray_NewCopy(ind, NPY_CORDER);
+            Py_DECREF(ind);
+            if (tmp == NULL) {
+                return NULL;
+            }
+            ind = tmp;
+            data = (npy_intp *)PyArray_DATA(ind);
+        }
+        for (; i < nind; ++i) {
+            if (data[i] < 0) {
+                data[i] += n;
+            }
+        }
+    }
+    return ind;
+}
+
+/* Returns 1 if 'obj' is an integer, slice, Ellipsis or None index */
+static int
+ufunc_at_is_basic_index_item(PyObject *obj)
+{
+    return (!PyBool_Check(obj) && (PyInt_Check(obj) || PyLong_Check(obj))) ||
+           PyArray_IsScalar(obj, Integer) || PySlice_Check(obj) ||
+           obj == Py_Ellipsis || obj == Py_None;
+}
+
+/*
+ * Applies ufunc.at with an index made of integers, slices, Ellipsis and
+ * None only.  Such an index selects every item at most once, so the ufunc
+ * is simply called on the view it selects.
+ */
+static PyObject *
+ufunc_at_basic_index(PyUFuncObject *ufunc, PyArrayObject *a, PyObject *idx,
+                     PyObject *op2)
+{
+    PyObject *index, *base, *view, *args, *kwds, *ret;
+    Py_ssize_t i, n = 1;
+    int has_ellipsis = (idx == Py_Ellipsis);
+
+    if (PyTuple_Check(idx)) {
+        n = PyTuple_GET_SIZE(idx);
+        for (i = 0; i < n; ++i) {
+            has_ellipsis |= (PyTuple_GET_ITEM(idx, i) == Py_Ellipsis);
+        }
+    }
+    /* With an Ellipsis, integer indices give a 0-d view, not a scalar */
+    index = PyTuple_New(n + !has_ellipsis);
+    if (index == NULL) {
+        return NULL;
+    }
+    for (i = 0; i < n; ++i) {
+        PyObject *item = PyTuple_Check(idx) ? PyTuple_GET_ITEM(idx, i) : idx;
+
+        Py_INCREF(item);
+        PyTuple_SET_ITEM(index, i, item);
+    }
+    if (!has_ellipsis) {
+        Py_INCREF(Py_Ellipsis);
+        PyTuple_SET_ITEM(index, n, Py_Ellipsis);
+    }
+
+    base = PyArray_View(a, NULL, &PyArray_Type);
+    if (base == NULL) {
+        Py_DECREF(index);
+        return NULL;
+    }
+    view = PyObject_GetItem(base, index);
+    Py_DECREF(base);
+    Py_DECREF(index);
+    if (view == NULL) {
+        return NULL;
+    }
+
+    if (op2 != NULL) {
+        args = Py_BuildValue("OOO", view, op2, view);
+    }
+    else {
+        args = Py_BuildValue("OO", view, view);
+    }
+    Py_DECREF(view);
+    if (args == NULL) {
+        return NULL;
+    }
+    kwds = Py_BuildValue("{s:s}", "casting", "unsafe");
+    if (kwds == NULL) {
+        Py_DECREF(args);
+        return NULL;
+    }
+    ret = PyObject_Call((PyObject *)ufunc, args, kwds);
+    Py_DECREF(args);
+    Py_DECREF(kwds);
+    if (ret == NULL) {
+        return NULL;
+    }
+    Py_DECREF(ret);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+/*
+ * Call ufunc only on selected array items and store result in first operand.
+ * For add ufunc, method call is equivalent to op1[idx] += op2 with no
+ * buffering of the first operand, so that repeated indices accumulate.
+ *
+ * The items of op1 are passed to the inner loop in place when its data
+ * type is the one of the loop, otherwise each item is cast to and from
+ * the loop type on its own.
+ */
+static PyObject *
+ufunc_at(PyUFuncObject *ufunc, PyObject *args)
+{
+    PyObject *op1 = NULL, *idx = NULL, *op2 = NULL;
+    PyArrayObject *a, *op2_array = NULL, *ind = NULL, *operands[3];
+    PyArrayMapIterObject *mit = NULL;
+    PyArrayIterObject *it2 = NULL;
+    PyArray_Descr *dtypes[3] = {NULL, NULL, NULL};
+    PyArray_VectorUnaryFunc *castin = NULL, *castout = NULL;
+    PyArray_CopySwapFunc *copyswap;
+    PyUFuncGenericFunction innerloop;
+    void *innerloopdata;
+    /* The item of op1 and the loop operands when they need casting */
+    npy_clongdouble abuf, inbuf, outbuf;
+    char *dataptr[3];
+    npy_intp i, count = 1, stride[3] = {0, 0, 0};
+    int nin = ufunc->nin, needs_api, direct, swap, retval = -1;
+    int iop, buffersize = 0, errormask = 0, first_error = 1;
+    PyObject *errobj = NULL;
+    char *ufunc_name = ufunc->name ? ufunc->name : "(unknown)";
+    NPY_BEGIN_THREADS_DEF;
+
+    if (ufunc->core_enabled) {
+        PyErr_Format(PyExc_TypeError,
+                "%s.at does not support ufunc with non-trivial signature",
+                ufunc_name);
+        return NULL;
+    }
+    if (nin > 2 || nin < 1) {
+        PyErr_SetString(PyExc_ValueError,
+                "Only unary and binary ufuncs supported at this time");
+        return NULL;
+    }
+    if (ufunc->nout != 1) {
+        PyErr_SetString(PyExc_ValueError,
+                "Only single output ufuncs supported at this time");
+        return NULL;
+    }
+    if (!PyArg_ParseTuple(args, "OO|O", &op1, &idx, &op2)) {
+        return NULL;
+    }
+    if (nin == 2 && op2 == NULL) {
+        PyErr_SetString(PyExc_ValueError,
+                        "second operand needed for ufunc");
+        return NULL;
+    }
+    if (nin == 1 && op2 != NULL) {
+        PyErr_SetString(PyExc_ValueError,
+                        "second operand provided when ufunc is unary");
+        return NULL;
+    }
+    if (!PyArray_Check(op1)) {
+        PyErr_SetString(PyExc_TypeError,
+                        "first operand must be array");
+        return NULL;
+    }
+    a = (PyArrayObject *)op1;
+    if (PyArray_FailUnlessWriteable(a, "input/output array") < 0) {
+        return NULL;
+    }
+    if (PyArray_NDIM(a) == 0) {
+        PyErr_SetString(PyExc_IndexError, "0-d arrays can't be indexed.");
+        return NULL;
+    }
+
+    if (ufunc_at_is_basic_index_item(idx)) {
+        return ufunc_at_basic_index(ufunc, a, idx, op2);
+    }
+    if (PyTuple_Check(idx)) {
+        Py_ssize_t n = PyTuple_GET_SIZE(idx);
+
+        for (i = 0; i < n; ++i) {
+            if (!ufunc_at_is_basic_index_item(PyTuple_GET_ITEM(idx, i))) {
+                break;
+            }
+        }
+        if (i == n) {
+            return ufunc_at_basic_index(ufunc, a, idx, op2);
+        }
+    }
+
+    if (op2 != NULL) {
+        op2_array = (PyArrayObject *)PyArray_FromAny(op2, NULL,
+                                                    0, 0, 0, NULL);
+        if (op2_array == NULL) {
+            goto fail;
+        }
+    }
+
+    /* Find the loop, with op1 standing in for the output */
+    operands[0] = a;
+    operands[1] = (nin == 2) ? op2_array : NULL;
+    operands[2] = NULL;
+    if (ufunc->type_resolver(ufunc, NPY_UNSAFE_CASTING,
+                             operands, NULL, dtypes) < 0) {
+        goto fail;
+    }
+    if (ufunc->legacy_inner_loop_selector(ufunc, dtypes,
+                            &innerloop, &innerloopdata, &needs_api) < 0) {
+        goto fail;
+    }
+
+    direct = PyArray_ISALIGNED(a) &&
+             PyArray_EquivTypes(PyArray_DESCR(a), dtypes[0]) &&
+             PyArray_EquivTypes(PyArray_DESCR(a), dtypes[nin]);
+    if (!direct) {
+        for (iop = 0; iop <= nin; iop += nin) {
+            if (PyDataType_REFCHK(dtypes[iop]) ||
+                    PyDataType_ISFLEXIBLE(dtypes[iop]) ||
+                    dtypes[iop]->elsize > sizeof(npy_clongdouble)) {
+                break;
+            }
+        }
+        if (iop <= nin || PyArray_ISOBJECT(a) || PyArray_ISFLEXIBLE(a)) {
+            PyErr_Format(PyExc_TypeError,
+                    "%s.at cannot operate in place on an array of this "
+                    "data type", ufunc_name);
+            goto fail;
+        }
+        if (dtypes[0]->type_num != PyArray_TYPE(a)) {
+            castin = PyArray_GetCastFunc(PyArray_DESCR(a),
+                                         dtypes[0]->type_num);
+            if (castin == NULL) {
+                goto fail;
+            }
+        }
+        if (dtypes[nin]->type_num != PyArray_TYPE(a)) {
+            castout = PyArray_GetCastFunc(dtypes[nin], PyArray_TYPE(a));
+            if (castout == NULL) {
+                goto fail;
+            }
+        }
+    }
+
+    if (op2_array != NULL) {
+        PyArrayObject *tmp;
+
+        Py_INCREF(dtypes[1]);
+        tmp = (PyArrayObject *)PyArray_FromArray(op2_array, dtypes[1],
+                                NPY_ARRAY_ALIGNED | NPY_ARRAY_FORCECAST);
+        Py_DECREF(op2_array);
+        op2_array = tmp;
+        if (op2_array == NULL) {
+            goto fail;
+        }
+    }
+
+    if (PyUFunc_GetPyValues("at", &buffersize, &errormask, &errobj) < 0) {
+        goto fail;
+    }
+    PyUFunc_clearfperr();
+
+    /*
+     * A list or integer array indexing a 1-D array is applied like a
+     * reduceby into op1, with the typed loops and without the map iterator.
+     */
+    if (nin == 2 && direct && PyArray_NDIM(a) == 1 &&
+            PyArray_NDIM(op2_array) <= 1) {
+        ind = ufunc_at_1d_indices(idx, PyArray_DIM(a, 0));
+        if (ind == NULL && PyErr_Occurred()) {
+            goto fail;
+        }
+    }
+    if (ind != NULL && (PyArray_SIZE(op2_array) == 1 ||
+                PyArray_DIM(op2_array, 0) == PyArray_DIM(ind, 0))) {
+        npy_intp vstride = 0;
+
+        if (PyArray_SIZE(op2_array) != 1) {
+            vstride = PyArray_STRIDE(op2_array, 0);
+        }
+        if (!needs_api) {
+            NPY_BEGIN_THREADS;
+        }
+        retval = reduceby_rows(innerloop, innerloopdata,
+                        reduceby_typed_op(ufunc, dtypes[0]),
+                        dtypes[0]->type_num,
+                        PyArray_BYTES(a), PyArray_STRIDE(a, 0), NULL,
+                        PyArray_BYTES(op2_array), vstride,
+                        (npy_intp *)PyArray_DATA(ind), PyArray_DIM(ind, 0),
+                        1, dtypes[0]->elsize, needs_api);
+        if (!needs_api) {
+            NPY_END_THREADS;
+        }
+        if (retval < 0) {
+            goto fail;
+        }
+        goto finish;
+    }
+
+    mit = (PyArrayMapIterObject *)PyArray_MapIterArray(a, idx);
+    if (mit == NULL) {
+        goto fail;
+    }
+    if (op2_array != NULL) {
+        /* Line the second operand up with the iteration, like setitem */
+        if (mit->subspace != NULL && mit->consec) {
+            PyArray_MapIterSwapAxes(mit, &op2_array, 0);
+            if (op2_array == NULL) {
+                goto fail;
+            }
+        }
+        it2 = (PyArrayIterObject *)PyArray_BroadcastToShape(
+                    (PyObject *)op2_array, mit->dimensions, mit->nd);
+        if (it2 == NULL) {
+            goto fail;
+        }
+    }
+
+    copyswap = PyArray_DESCR(a)->f->copyswap;
+    swap = !PyArray_ISNBO(PyArray_DESCR(a)->byteorder);
+
+    if (!needs_api) {
+        NPY_BEGIN_THREADS;
+    }
+    for (i = 0; i < mit->size; ++i) {
+        char *aptr = mit->dataptr;
+
+        if (direct) {
+            dataptr[0] = dataptr[nin] = aptr;
+        }
+        else {
+            copyswap(&abuf, aptr, swap, a);
+            dataptr[0] = (char *)&abuf;
+            dataptr[nin] = (char *)&abuf;
+            if (castin != NULL) {
+                castin(&abuf, &inbuf, 1, a, NULL);
+                dataptr[0] = (char *)&inbuf;
+            }
+            if (castout != NULL) {
+                dataptr[nin] = (char *)&outbuf;
+            }
+        }
+        if (it2 != NULL) {
+            dataptr[1] = it2->dataptr;
+        }
+
+        innerloop(dataptr, &count, stride, innerloopdata);
+        if (needs_api && PyErr_Occurred()) {
+            break;
+        }
+
+        if (!direct) {
+            if (castout != NULL) {
+                castout(&outbuf, &abuf, 1, NULL, a);
+            }
+            copyswap(aptr, &abuf, swap, a);
+        }
+        PyArray_MapIterNext(mit);
+        if (it2 != NULL) {
+            PyArray_ITER_NEXT(it2);
+        }
+    }
+    if (!needs_api) {
+        NPY_END_THREADS;
+    }
+
+finish:
+    /* Check whether any errors occurred during the loop */
+    retval = 0;
+    if (PyErr_Occurred() || (errormask &&
+            PyUFunc_checkfperr(errormask, errobj, &first_error))) {
+        retval = -1;
+    }
+
+fail:
+    Py_XDECREF(op2_array);
+    Py_XDECREF(ind);
+    Py_XDECREF(mit);
+    Py_XDECREF(it2);
+    for (iop = 0; iop < 3; ++iop) {
+        Py_XDECREF(dtypes[iop]);
+    }
+    Py_XDECREF(errobj);
+
+    if (retval < 0) {
+        return NULL;
+    }
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
 
 static struct PyMethodDef ufunc_methods[] = {
     {"reduce",
@@ -4831,9 +7098,15 @@ static struct PyMethodDef ufunc_methods[] = {
     {"reduceat",
         (PyCFunction)ufunc_reduceat,
         METH_VARARGS | METH_KEYWORDS, NULL },
+    {"reduceby",
+        (PyCFunction)ufunc_reduceby,
+        METH_VARARGS | METH_KEYWORDS, NULL },
     {"outer",
         (PyCFunction)ufunc_outer,
         METH_VARARGS | METH_KEYWORDS, NULL},
+    {"at",
+        (PyCFunction)ufunc_at,
+        METH_VARARGS, NULL},
     {NULL, NULL, 0, NULL}           /* sentinel */
 };
 
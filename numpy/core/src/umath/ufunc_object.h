@@ -7,4 +7,27 @@ ufunc_geterr(PyObject *NPY_UNUSED(dummy), PyObject *args);
 NPY_NO_EXPORT PyObject *
 ufunc_seterr(PyObject *NPY_UNUSED(dummy), PyObject *args);
 
+NPY_NO_EXPORT PyObject *
+ufunc_setprofile(PyObject *NPY_UNUSED(dummy), PyObject *args);
+
+/*
+ * Elementwise loops and reductions are only split across the thread pool
+ * (see numpy.setnumthreads) when every thread gets at least this many
+ * elements, so that small operations don't pay for the dispatch.
+ */
+#define NPY_UFUNC_PARALLEL_MINCHUNK 32768
+
+/*
+ * The outer loop of a thread safe generalized ufunc is split when every
+ * thread gets at least this many elements of core data, counting all
+ * the core dimensions of one outer iteration.
+ */
+#define NPY_GUFUNC_PARALLEL_MINCHUNK 4096
+
+NPY_NO_EXPORT void
+ufunc_set_fpe_status(int status);
+
+NPY_NO_EXPORT void
+get_array_byte_extent(PyArrayObject *arr, npy_uintp *start, npy_uintp *end);
+
 #endif
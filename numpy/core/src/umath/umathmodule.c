@@ -40,6 +40,7 @@
 #include "loops.h"
 #include "ufunc_object.h"
 #include "ufunc_type_resolution.h"
+#include "fused.h"
 #include "__umath_generated.c"
 #include "__ufunc_api.c"
 
@@ -129,6 +130,7 @@ ufunc_frompyfunc(PyObject *NPY_UNUSED(dummy), PyObject *args, PyObject *NPY_UNUS
     }
     memset(self->op_flags, 0, sizeof(npy_uint32)*self->nargs);
     self->iter_flags = 0;
+    self->core_threadsafe = 0;
 
     self->type_resolver = &object_ufunc_type_resolver;
     self->legacy_inner_loop_selector = &object_ufunc_loop_selector;
@@ -307,6 +309,12 @@ static struct PyMethodDef methods[] = {
     {"geterrobj",
         (PyCFunction) ufunc_geterr,
         METH_VARARGS, NULL},
+    {"_setprofile",
+        (PyCFunction) ufunc_setprofile,
+        METH_VARARGS, NULL},
+    {"_fuse",
+        (PyCFunction) ufunc_fuse,
+        METH_VARARGS, NULL},
     {NULL, NULL, 0, NULL}                /* sentinel */
 };
 
@@ -364,6 +372,9 @@ PyMODINIT_FUNC initumath(void)
     if (PyType_Ready(&PyUFunc_Type) < 0)
         return RETVAL;
 
+    /* Select the loop implementations for this cpu */
+    npy_simd_init();
+
     /* Add some symbolic constants to the module */
     d = PyModule_GetDict(m);
 
@@ -421,7 +432,7 @@ PyMODINIT_FUNC initumath(void)
 
 #undef ADDCONST
 #undef ADDSCONST
-    PyModule_AddIntConstant(m, "UFUNC_BUFSIZE_DEFAULT", (long)NPY_BUFSIZE);
+    PyModule_AddIntConstant(m, "UFUNC_BUFSIZE_DEFAULT", 0);
 
     PyModule_AddObject(m, "PINF", PyFloat_FromDouble(NPY_INFINITY));
     PyModule_AddObject(m, "NINF", PyFloat_FromDouble(-NPY_INFINITY));
@@ -3,4 +3,6 @@
 #include "ufunc_object.c"
 #include "ufunc_type_resolution.c"
 #include "reduction.c"
+#include "cpuid.c"
+#include "fused.c"
 #include "umathmodule.c"
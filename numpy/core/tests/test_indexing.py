@@ -124,6 +124,99 @@ class TestIndexing(TestCase):
                          [0, 8, 0]])
 
 
+    def test_boolean_indexing_words(self):
+        # contiguous masks are processed by words of eight values, check
+        # lengths around the word size, runs, types and unaligned data
+        np.random.seed(4)
+        for n in [5, 8, 13, 16, 100]:
+            for p in [0, 0.3, 0.9, 1]:
+                m = np.random.rand(n) < p
+                m[n // 4:3 * n // 4] = True
+                ref = np.nonzero(m.astype(int))[0]
+                for dt in ['i1', '>i2', 'f4', 'c16', 'S3',
+                           [('a', 'i1'), ('b', 'f8')], 'O']:
+                    a = (np.arange(n) % 91).astype(dt)
+                    xs = [a, a[::-1]]
+                    if dt != 'O':
+                        u = np.zeros(a.nbytes + 1, 'u1')[1:].view(a.dtype)
+                        u[...] = a
+                        xs.append(u)
+                    for x in xs:
+                        assert_equal(x[m], x[ref])
+                        assert_equal(np.compress(m, x), x[ref])
+                        y, z = x.copy(), x.copy()
+                        y[m] = x[::-1][:len(ref)]
+                        z[ref] = x[::-1][:len(ref)]
+                        assert_equal(y, z)
+                        y[m] = x[3]
+                        z[ref] = x[3]
+                        assert_equal(y, z)
+        # bytes other than 0 and 1 are True
+        m = np.array([0, 2, 1, 1, 1, 1, 1, 1, 1, 1, 255, 0], 'u1').view(bool)
+        a = np.arange(12)
+        assert_equal(a[m], np.arange(1, 11))
+        a[m] = -a[m]
+        assert_equal(a, [0] + list(range(-1, -11, -1)) + [11])
+
+    def test_single_fancy_index(self):
+        # a single integer index with full slices copies blocks directly,
+        # compare with the general path taken for slices with a step
+        s = slice(None, None, 1)
+        for dt in ['i1', '>i2', 'f8', 'c16', 'S3', [('a', 'i4'), ('b', 'f2')]]:
+            a = (np.arange(60) % 37).astype(dt).reshape(3, 4, 5)
+            for b in [a, a[:, ::-1, ::2]]:
+                for ind in [[0, -1, 1, 1], np.array([[2], [-2]], 'i1'),
+                            np.array([], int)]:
+                    assert_equal(b[ind], b[ind, s])
+                    assert_equal(b[:, ind], b[s, ind])
+                    assert_equal(b[:, :, ind], b[s, s, ind])
+                    assert_equal(b[:, ind, :], b[s, ind, s])
+                    c, d = b.copy(), b.copy()
+                    v = b[:, ind][::-1]
+                    c[:, ind] = v
+                    d[s, ind] = v
+                    assert_equal(c, d)
+                    c[ind] = b[0]
+                    d[ind, s] = b[0]
+                    assert_equal(c, d)
+                    c[:, :, ind] = b[0, 0, 0]
+                    d[s, s, ind] = b[0, 0, 0]
+                    assert_equal(c, d)
+        # repeated indices assign the last value
+        a = np.zeros((2, 3))
+        a[:, [1, 1, 0]] = [1, 2, 3]
+        assert_equal(a, [[3, 2, 0], [3, 2, 0]])
+        # values overlapping the array are read before they are changed
+        a = np.arange(12).reshape(4, 3)
+        a[[1, 2, 3]] = a[:3]
+        assert_equal(a, [[0, 1, 2], [0, 1, 2], [3, 4, 5], [6, 7, 8]])
+        # values which do not broadcast are reported as before
+        assert_raises(ValueError, a.__setitem__, (slice(None), [0, 1]),
+                      [[1], [2], [3]])
+        assert_raises(IndexError, a.__getitem__, (slice(None), [3]))
+        assert_raises(IndexError, a.__getitem__, [-5])
+        assert_raises(IndexError, np.zeros((0, 3)).__getitem__, [0])
+
+    def test_single_fancy_index_parallel(self):
+        # large results are copied on several threads
+        np.random.seed(3)
+        a = np.random.rand(100000, 3)
+        ind = np.random.randint(-100000, 100000, 200000)
+        with with_threads(1):
+            r1, r2 = a[ind], a[:, [2, 0, 1, 2]]
+            b1 = a.copy()
+            b1[ind] = -a[ind]
+        with with_threads(4):
+            assert_equal(a[ind], r1)
+            assert_equal(a[:, [2, 0, 1, 2]], r2)
+            assert_equal(a[:, [2, 0, 1, 2]].flags.c_contiguous, True)
+            b2 = a.copy()
+            b2[ind] = -a[ind]
+            assert_equal(b2, b1)
+            b2[:, [1, 1]] = [1, 2]
+            assert_equal(b2[:, 1], 2)
+
+
 class TestMultiIndexingAutomated(TestCase):
     """
      These test use code to mimic the C-Code indexing for selection.
@@ -59,7 +59,63 @@ class TestTake(TestCase):
             a.take(b, out=a[:6])
             del a
             assert_(all(sys.getrefcount(o) == 3 for o in objects))
-    
+
+    def test_typed_copies(self):
+        # take copies items of these sizes with typed loads and stores,
+        # make sure byte order and odd sizes survive in all modes.
+        types = ['i1', '>i2', 'f8', 'c16', 'S3',
+                 np.dtype([('a', 'i1'), ('b', '<f4')])]
+        arrays = [np.arange(3*5*4).reshape(3, 5, 4).astype(t) for t in types]
+        arrays.append(arrays[3].view('V16'))
+        ind = np.array([4, -1, 0, 7, -8, 3, 12, 3])
+        for a in arrays:
+            for axis in range(3):
+                n = a.shape[axis]
+                norm = {'wrap': ind % n, 'clip': np.clip(ind, 0, n - 1)}
+                for mode in ('wrap', 'clip'):
+                    sl = [slice(None)] * 3
+                    sl[axis] = norm[mode]
+                    assert_array_equal(a.take(ind, axis=axis, mode=mode),
+                                       a[tuple(sl)])
+                ok = ind[(ind < n) & (ind >= -n)]
+                sl = [slice(None)] * 3
+                sl[axis] = ok
+                assert_array_equal(a.take(ok, axis=axis), a[tuple(sl)])
+                assert_raises(IndexError, a.take, [n], axis=axis)
+                assert_raises(IndexError, a.take, [-n - 1], axis=axis)
+
+    def test_put_repeated(self):
+        # repeated indices are assigned in order, values cycle
+        for t in ['i1', '>i4', 'c16', 'S3']:
+            v = np.arange(1, 4).astype(t)
+            a = np.zeros(7, dtype=int).astype(t)
+            a.put([1, 8, -6, 3, 5], v, mode='wrap')
+            assert_array_equal(a, np.array([0, 3, 0, 1, 0, 2, 0]).astype(t))
+            a = np.zeros(7, dtype=int).astype(t)
+            a.put([-3, 9, 2], v, mode='clip')
+            assert_array_equal(a, np.array([1, 0, 3, 0, 0, 0, 2]).astype(t))
+            a = np.zeros(7, dtype=t)
+            assert_raises(IndexError, a.put, [0, 7], v)
+            # unaligned values
+            buf = np.zeros(v.nbytes + 1, dtype=np.uint8)
+            vu = buf[1:].view(t)
+            vu[...] = v
+            a = np.zeros(7, dtype=t)
+            a.put([0, 6], vu)
+            assert_array_equal(a[[0, 6]], v[:2])
+
+    def test_parallel(self):
+        a = np.arange(300000, dtype=np.int16).reshape(1000, 300)
+        ind = np.random.randint(-300, 300, size=1000)
+        res = []
+        for n in (1, 4):
+            with with_threads(n):
+                b = np.zeros(600000, dtype=np.int16)
+                b.put(ind * 7, np.arange(1000))
+                res.append((a.take(ind, axis=1), b))
+        assert_array_equal(res[0][0], res[1][0])
+        assert_array_equal(res[0][1], res[1][1])
+
 
 if __name__ == "__main__":
     run_module_suite()
@@ -18,7 +18,8 @@ from numpy.core.multiarray_tests import (
 from numpy.testing import (
         TestCase, run_module_suite, assert_, assert_raises,
         assert_equal, assert_almost_equal, assert_array_equal,
-        assert_array_almost_equal, assert_allclose, runstring, dec
+        assert_array_almost_equal, assert_allclose, runstring, dec,
+        with_threads
         )
 
 # Need to test an object that does not fully implement math interface
@@ -666,6 +667,106 @@ class TestMethods(TestCase):
         assert_fortran(a.copy('F'))
         assert_c(a.copy('A'))
 
+    def test_sort_stable_runs(self):
+        # the stable sort merges runs already present in the data, check
+        # stability and correctness for typical run patterns
+        np.random.seed(7)
+        n = 2000
+        sorted_part = np.sort(np.random.randint(0, 100, n))
+        patterns = [
+            np.random.randint(0, 100, n),
+            sorted_part,
+            sorted_part[::-1],
+            np.concatenate([sorted_part, np.random.randint(0, 100, 50)]),
+            np.arange(n) % 37,
+            np.concatenate([sorted_part[::-1], sorted_part]),
+            np.zeros(n, dtype=int),
+        ]
+        for x in patterns:
+            ref = np.array(sorted(range(len(x)), key=lambda i: x[i]))
+            for t in ['i8', 'f4', 'c16', object, 'M8[D]']:
+                a = x.astype(t)
+                for kind in ['mergesort', 'stable']:
+                    assert_equal(a.argsort(kind=kind), ref)
+                    assert_equal(np.sort(a, kind=kind), a[ref])
+
+    def test_sort_parallel(self):
+        # large sorts are split over the thread pool, a single lane into
+        # chunks that are merged, many lanes in blocks; the results must
+        # be those of the serial sorts, including the stable index order
+        np.random.seed(11)
+        x = np.random.randint(0, 50, 300007)
+        y = np.random.randint(0, 50, (600, 500))
+        for t in ['i1', 'i8', '>i4', 'f8', 'c8', 'M8[s]']:
+            for a in [x.astype(t), x.astype(t)[::2], y.astype(t),
+                      y.astype(t).T]:
+                for kind in ['q', 'h', 'm', 'r']:
+                    with with_threads(1):
+                        s = np.sort(a, kind=kind)
+                        i = a.argsort(kind=kind)
+                    with with_threads(4):
+                        r = np.sort(a, kind=kind)
+                        j = a.argsort(kind=kind)
+                    msg = "type %s, shape %s, kind %s" % (t, a.shape, kind)
+                    assert_equal(r, s, err_msg=msg)
+                    if kind in 'mr':
+                        assert_equal(j, i, err_msg=msg)
+                    else:
+                        k = np.indices(a.shape)
+                        assert_equal(a[k[0], j] if a.ndim == 2 else a[j],
+                                     s, err_msg=msg)
+        p = y.astype('f4')
+        with with_threads(4):
+            assert_equal(np.partition(p, 250, axis=1)[:, 250],
+                         np.sort(p, axis=1)[:, 250])
+
+    def test_sort_radix(self):
+        # the radix sort is stable and sorts like the merge sort, which
+        # also checks the key transformations of signed and float types
+        np.random.seed(5)
+        types = np.typecodes['AllInteger'] + 'efd?'
+        for t in types:
+            for n in [0, 1, 2, 10, 255, 256, 1000]:
+                a = (np.random.randn(n) * 100).astype(t)
+                for kind in ['r', 'radixsort', 'q']:
+                    msg = "type %s, size %d, kind %s" % (t, n, kind)
+                    assert_equal(np.sort(a, kind=kind), np.sort(a, kind='m'),
+                                 err_msg=msg)
+                    assert_equal(a[a.argsort(kind=kind)],
+                                 np.sort(a, kind='m'), err_msg=msg)
+                assert_equal(a.argsort(kind='r'), a.argsort(kind='m'))
+
+        # nans sort to the end, -0. and 0. keep their order
+        for t in 'efd':
+            a = np.array([np.nan, 1, -np.inf, -0., np.nan, 0., -1, -np.nan,
+                          np.inf, 0., -0.], dtype=t)
+            i = a.argsort(kind='r')
+            assert_equal(i, [2, 6, 3, 5, 9, 10, 1, 8, 0, 4, 7])
+            assert_equal(np.sort(a, kind='r'), a[i])
+            b = a.byteswap().newbyteorder()
+            assert_equal(b.argsort(kind='r'), i)
+
+        # wide types with small values, strided and multidimensional
+        a = np.arange(1000, dtype=np.int64)[::-1] * 3 - 1500
+        assert_equal(np.sort(a, kind='r'), np.sort(a))
+        a = np.random.randint(-100, 100, (30, 40)).astype(np.int16)
+        for axis in [0, 1]:
+            assert_equal(np.sort(a, axis=axis, kind='r'),
+                         np.sort(a, axis=axis, kind='m'))
+            assert_equal(a.argsort(axis=axis, kind='r'),
+                         a.argsort(axis=axis, kind='m'))
+
+        # datetimes, NaT sorts first like in the other sorts
+        a = np.array([3, 'NaT', 1, 2], dtype='M8[D]')
+        assert_equal(a.argsort(kind='r'), a.argsort(kind='m'))
+
+        # types without a radix sort use the merge sort
+        for a in [np.array([3, 1, 2, 1], dtype=np.complex128),
+                  np.array(['b', 'a', 'c', 'a']),
+                  np.array([3, 1, 2, 1], dtype=object)]:
+            assert_equal(np.sort(a, kind='r'), np.sort(a, kind='m'))
+            assert_equal(a.argsort(kind='r'), a.argsort(kind='m'))
+
     def test_sort_order(self):
         # Test sorting an array with fields
         x1=np.array([21,32,14])
@@ -819,6 +920,109 @@ class TestMethods(TestCase):
         a = np.array(['aaaaaaaaa' for i in range(100)], dtype=np.unicode)
         assert_equal(a.argsort(kind='m'), r)
 
+    def assert_partitioned(self, d, kth):
+        prev = 0
+        for k in np.sort(kth):
+            assert_((d[prev:k] <= d[k]).all(),
+                    msg="kth %d, %r not less equal %d" % (k, d[prev:k], d[k]))
+            assert_((d[k:] >= d[k]).all(),
+                    msg="kth %d, %r not greater equal %d" % (k, d[k:], d[k]))
+            prev = k + 1
+
+    def test_partition(self):
+        # all types with a selection, the sizes test the small kth
+        # selection, the median of 3 and the median of medians pivots
+        types = np.typecodes['AllInteger'] + np.typecodes['AllFloat'] + '?'
+        for t in types:
+            for n in [1, 2, 3, 10, 37, 1000]:
+                a = (np.arange(n) % 128).astype(t)[::-1]
+                s = np.sort(a)
+                for k in set([0, 1, 2, n // 2, n - 1]):
+                    if k >= n:
+                        continue
+                    p = np.partition(a, k)
+                    assert_equal(p[k], s[k], err_msg="%s %d %d" % (t, n, k))
+                    assert_((p[:k] <= p[k]).all())
+                    assert_((p[k:] >= p[k]).all())
+                    assert_equal(a[np.argpartition(a, k)], p)
+
+        # median of 3 killer, forces the median of medians pivot
+        d = np.roll(np.arange(10000), 5000)
+        for k in [0, 4999, 5000, 9999]:
+            p = np.partition(d, k)
+            assert_equal(p[k], k)
+            self.assert_partitioned(p, [k])
+            assert_equal(d[np.argpartition(d, k)][k], k)
+
+        # random data, several kth at once, negative kth
+        np.random.seed(3)
+        d = np.random.rand(1000)
+        kth = [0, 3, 3, 100, 999, -500, 42]
+        p = np.partition(d, kth)
+        s = np.sort(d)
+        assert_equal(p[kth], s[kth])
+        self.assert_partitioned(p, [0, 3, 42, 100, 500, 999])
+        assert_equal(d[np.argpartition(d, kth)], p)
+
+        # nans and complex use the sort order
+        d = np.array([np.nan, 3, 1, np.nan, 2, 0])
+        assert_equal(np.partition(d, 3)[3], 3)
+        assert_(np.isnan(np.partition(d, 4)[4]))
+        assert_equal(np.argpartition(d, 2)[2], 4)
+        d = np.array([1+1j, 1+0j, 0+2j, np.nan, 1j])
+        assert_equal(np.partition(d, 2)[2], 1+0j)
+
+        # byteswapped and unaligned input
+        d = np.arange(100, dtype='>i4')[::-1]
+        assert_equal(np.partition(d, 40)[40], 40)
+        assert_equal(np.argpartition(d, 40)[40], 59)
+        d = np.arange(51, dtype='<f8').tostring()
+        d = np.frombuffer(d[1:] + d[:1], dtype='<f8', count=50)
+        assert_(not d.flags.aligned)
+        assert_equal(np.partition(d, 10)[10], np.sort(d)[10])
+
+        # axis
+        d = np.arange(49).reshape(7, 7)[::-1, ::-1].copy()
+        p = np.partition(d, 3, axis=0)
+        assert_equal(p[3], np.sort(d, axis=0)[3])
+        p = np.partition(d, 3, axis=1)
+        assert_equal(p[:, 3], np.sort(d, axis=1)[:, 3])
+        assert_equal(np.partition(d, 10, axis=None)[10], 10)
+        i = np.argpartition(d, 3, axis=0)
+        assert_equal(d[i, np.arange(7)][3], np.sort(d, axis=0)[3])
+        assert_equal(np.argpartition(d, 10, axis=None),
+                     np.argpartition(d.ravel(), 10))
+
+        # in-place method
+        d = np.arange(10)[::-1].copy()
+        d.partition(5)
+        assert_equal(d[5], 5)
+        self.assert_partitioned(d, [5])
+
+        # types without a selection are sorted
+        for d in [np.array(['c', 'a', 'b']),
+                  np.array([3, 1, 2], dtype=object),
+                  np.array([3, 1, 2], dtype='M8[D]')]:
+            assert_equal(np.partition(d, 1), np.sort(d))
+            assert_equal(np.argpartition(d, 1), [1, 2, 0])
+
+        # structured arrays with order
+        d = np.array([(1, 3), (2, 2), (3, 1)],
+                     dtype=[('x', int), ('y', int)])
+        assert_equal(np.partition(d, 0, order='y')[0], d[2])
+        assert_equal(np.argpartition(d, 0, order='y')[0], 2)
+
+        # bad arguments
+        d = np.arange(10)
+        assert_raises(ValueError, d.partition, 10)
+        assert_raises(ValueError, d.partition, -11)
+        assert_raises(ValueError, d.partition, [[1]])
+        assert_raises(TypeError, d.partition, 1.)
+        assert_raises(ValueError, d.partition, 1, axis=1)
+        assert_raises(ValueError, d.partition, 1, kind='quicksort')
+        assert_raises(ValueError, np.argpartition, d, 10)
+        assert_raises(ValueError, np.partition, np.ones(0), 0)
+
     def test_searchsorted(self):
         # test for floats and complex containing nans. The logic is the
         # same for all float types so only test double types for now.
@@ -854,6 +1058,43 @@ class TestMethods(TestCase):
         b = a.searchsorted(np.array(128,dtype='>i4'))
         assert_equal(b, 1, msg)
 
+    def test_searchsorted_typed(self):
+        # the numeric types have typed kernels which gallop from the
+        # previous result for increasing keys, check them against a
+        # linear count for sorted, reversed, random and repeated keys
+        np.random.seed(13)
+        a = np.sort(np.random.randint(0, 40, 500))
+        keys = [np.arange(-2, 43), np.arange(42, -3, -1),
+                np.random.randint(-2, 43, 200), np.repeat([3, 1, 3, 39], 5),
+                np.sort(np.random.randint(0, 40, 1000)), np.array([], int)]
+        s = np.random.permutation(len(a))
+        for t in np.typecodes['AllInteger'] + 'efdgFDG' + '?':
+            b = a.astype(t)
+            for k in keys:
+                k = k.astype(t)
+                left = (b[:, np.newaxis] < k).sum(0)
+                right = (b[:, np.newaxis] <= k).sum(0)
+                msg = "type %s, keys %s" % (t, k[:5])
+                assert_equal(b.searchsorted(k, 'left'), left, err_msg=msg)
+                assert_equal(b.searchsorted(k, 'right'), right, err_msg=msg)
+                bs = b[s]
+                sorter = bs.argsort(kind='m')
+                assert_equal(bs.searchsorted(k, 'left', sorter), left,
+                             err_msg=msg)
+                assert_equal(bs.searchsorted(k, 'right', sorter), right,
+                             err_msg=msg)
+
+        # nans sort last, also as increasing keys
+        a = np.array([0., 1, 2, np.nan, np.nan])
+        k = np.array([0.5, 2, np.nan, np.nan, 1])
+        assert_equal(a.searchsorted(k, 'left'), [1, 2, 3, 3, 1])
+        assert_equal(a.searchsorted(k, 'right'), [1, 3, 5, 5, 2])
+
+        # datetimes
+        a = np.array(['NaT', '2000-01-01', '2001-01-01'], dtype='M8[D]')
+        k = np.array(['1999-01-01', '2000-01-01', 'NaT'], dtype='M8[D]')
+        assert_equal(a.searchsorted(k), [1, 1, 0])
+
     def test_searchsorted_unicode(self):
         # Test searchsorted on unicode strings.
 
@@ -1342,6 +1583,32 @@ class TestArgmax(TestCase):
             assert_equal(np.argmax(arr), pos, err_msg="%r"%arr)
             assert_equal(arr[np.argmax(arr)], np.max(arr), err_msg="%r"%arr)
 
+    def test_blocks(self):
+        # The vectorized types reduce blocks of 1024 values first
+        for dt in np.typecodes['AllInteger'] + 'fd?':
+            for n in [1, 7, 1023, 1024, 1025, 5000]:
+                for i in sorted(set([0, n // 2, n - 1])):
+                    a = np.zeros(n, dt)
+                    a[i] = 1
+                    assert_equal(a.argmax(), i)
+                    a[-1] = 1
+                    assert_equal(a.argmax(), i)
+                    b = np.ones(n, dt)
+                    b[i] = 0
+                    assert_equal(b.argmin(), i)
+                    b[-1] = 0
+                    assert_equal(b.argmin(), i)
+        for dt in 'fd':
+            a = np.arange(3000, dtype=dt)
+            assert_equal(a.argmax(), 2999)
+            a[[1500, 2000]] = np.nan
+            assert_equal(a.argmax(), 1500)
+            assert_equal(a.argmin(), 1500)
+            a = np.zeros(2000, dt)
+            a[1200] = -0.0
+            assert_equal(a.argmax(), 0)
+            assert_equal(a.argmin(), 0)
+
 
 class TestArgmin(TestCase):
 
@@ -1623,6 +1890,58 @@ class TestLexsort(TestCase):
 
         assert_array_equal(x[1][idx],np.sort(x[1]))
 
+    def check_keys(self, keys, axis=-1):
+        # Compare with stable argsorts of the keys one after the other
+        idx = np.lexsort(keys, axis=axis)
+        keys = [np.rollaxis(np.asarray(k), axis, k.ndim) for k in keys]
+        shape = keys[0].shape
+        keys = [k.reshape(-1, shape[-1]) for k in keys]
+        expected = np.empty(keys[0].shape, dtype=np.intp)
+        for l in range(len(expected)):
+            e = np.arange(shape[-1])
+            for k in keys:
+                e = e[k[l][e].argsort(kind='mergesort')]
+            expected[l] = e
+        expected = np.rollaxis(expected.reshape(shape), len(shape) - 1, axis)
+        assert_array_equal(idx, expected)
+
+    def test_types(self):
+        # Integer keys with small enough ranges are packed into one key
+        np.random.seed(3)
+        x = np.random.randint(-20, 50, 6000)
+        for dts in [('i4',), ('i8', 'u1'), ('?', 'i2', 'u8'), ('f8', 'i4'),
+                    ('S2', 'i4'), ('M8[s]', 'm8[s]'), ('>i4', 'i4')]:
+            keys = [abs(x[i::len(dts)]).astype(dt) for i, dt in enumerate(dts)]
+            self.check_keys(keys)
+        # too wide ranges
+        for dt in ['i8', 'u8']:
+            info = np.iinfo(dt)
+            a = np.array([info.min, info.max, 0, 1, info.max, info.min], dt)
+            self.check_keys([a, a[::-1]])
+        self.check_keys([np.zeros(10, 'i1'), np.ones(10, 'i8')])
+
+    def test_axis(self):
+        np.random.seed(4)
+        a = np.random.randint(0, 5, (20, 30, 3))
+        b = np.random.randint(-2, 2, (20, 30, 3))
+        c = np.random.rand(20, 30, 3)
+        for axis in range(3):
+            for keys in [(a, b), (a, c), (a[:, ::2], b[:, ::2])]:
+                self.check_keys(keys, axis)
+
+    def test_parallel(self):
+        np.random.seed(5)
+        keys = [np.random.randint(0, 1000, (4, 70000)),
+                np.random.randint(0, 3, (4, 70000)),
+                np.random.rand(4, 70000)]
+        with with_threads(1):
+            expected = [np.lexsort(keys), np.lexsort(keys[:2], axis=0),
+                        np.lexsort([k[0] for k in keys])]
+        with with_threads(4):
+            assert_array_equal(np.lexsort(keys), expected[0])
+            assert_array_equal(np.lexsort(keys[:2], axis=0), expected[1])
+            assert_array_equal(np.lexsort([k[0] for k in keys]), expected[2])
+
 
 class TestIO(object):
     """Test tofile, fromfile, tostring, and fromstring"""
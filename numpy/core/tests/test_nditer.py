@@ -1551,6 +1551,24 @@ def test_iter_write_buffering():
         i.iternext()
     assert_equal(a.ravel(order='C'), np.arange(24))
 
+def test_iter_buffersize():
+    # Test the buffer size chosen when none is requested
+    a = np.arange(10**6, dtype='f4')
+    i = nditer(a, ['buffered'], op_dtypes='f8', casting='same_kind')
+    assert_equal(i.buffersize % 16, 0)
+    assert_(1024 <= i.buffersize <= 65536)
+    # Wider operands never get a larger buffer
+    j = nditer([a, None], ['buffered'], [['readonly'], ['writeonly',
+                'allocate']], op_dtypes=['c16', 'c16'], casting='same_kind')
+    assert_(j.buffersize <= i.buffersize)
+    # An explicit size is used as is, and capped at the iteration size
+    i = nditer(a, ['buffered'], buffersize=100)
+    assert_equal(i.buffersize, 100)
+    i = nditer(a[:10], ['buffered'])
+    assert_equal(i.buffersize, 10)
+    # Unbuffered iterators have no buffer
+    assert_equal(nditer(a).buffersize, 0)
+
 def test_iter_buffering_delayed_alloc():
     # Test that delaying buffer allocation works
 
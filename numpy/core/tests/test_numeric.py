@@ -732,6 +732,155 @@ class TestNonzero(TestCase):
         assert_equal(np.nonzero(x['a'].T), ([0,1,1,2],[1,1,2,0]))
         assert_equal(np.nonzero(x['b'].T), ([0,0,1,2,2],[0,1,2,0,2]))
 
+    def test_nonzero_bool_words(self):
+        # contiguous booleans are counted and searched by words, check
+        # lengths around the word sizes, runs and bytes other than 0 and 1
+        np.random.seed(5)
+        for n in [1, 7, 8, 9, 16, 17, 31, 32, 33, 100, 1000]:
+            for p in [0, 0.1, 0.5, 0.9, 1]:
+                b = np.random.rand(n) < p
+                b[n // 3:2 * n // 3] = True
+                ref = [i for i in range(n) if b[i]]
+                assert_equal(np.count_nonzero(b), len(ref))
+                assert_equal(np.nonzero(b), (ref,))
+                assert_equal(np.compress(b, np.arange(n)), ref)
+                b2 = np.tile(b, (3, 1))
+                assert_equal(np.nonzero(b2), np.nonzero(b2.astype(int)))
+                assert_equal(np.compress(b, np.tile(np.arange(n), (3, 1)),
+                                         axis=1), np.tile(ref, (3, 1)))
+        b = np.array([0, 2, 0, 255] + [1] * 16 + [3], 'u1').view(bool)
+        assert_equal(np.count_nonzero(b), 19)
+        assert_equal(np.nonzero(b), ([1] + list(range(3, 21)),))
+        assert_equal(np.compress(b, np.arange(21)), [1] + list(range(3, 21)))
+        # conditions longer than the axis are still checked
+        assert_equal(np.compress([True, False, False], [1, 2]), [1])
+        assert_raises(IndexError, np.compress, [False, False, True], [1, 2])
+
+class TestMinMax(TestCase):
+    def test_types(self):
+        for dt in np.typecodes['All']:
+            if dt in 'OSUVcmM':
+                continue
+            a = np.array([3, 1, 4, 1, 5, 9, 2, 6] * 10, dtype=dt)
+            assert_equal(np.minmax(a), (a.min(), a.max()), err_msg=dt)
+        a = np.array(['2013-01-05', '1999-03-01', '2010-07-04'], 'M8[D]')
+        assert_equal(np.minmax(a), (a[1], a[0]))
+        assert_equal(np.minmax(a - a[0]), (a[1] - a[0], a[0] - a[0]))
+
+    def test_axis(self):
+        a = np.random.rand(3, 1000, 7)
+        for axis in [None, 0, 1, 2, -1]:
+            mn, mx = np.minmax(a, axis)
+            assert_equal(mn, a.min(axis))
+            assert_equal(mx, a.max(axis))
+            assert_equal(np.ptp(a, axis), a.max(axis) - a.min(axis))
+
+    def test_nan(self):
+        for dt in [np.float32, np.float64, np.longdouble]:
+            a = np.arange(100, dtype=dt)
+            a[50] = np.nan
+            assert_(np.all(np.isnan(np.minmax(a))))
+            b = np.arange(200, dtype=dt).reshape(100, 2)
+            b[50, 0] = np.nan
+            mn, mx = np.minmax(b, 0)
+            assert_equal(mn, [np.nan, 1])
+            assert_equal(mx, [np.nan, 199])
+
+    def test_unaligned(self):
+        b = np.random.rand(10, 3)
+        a = np.zeros(b.size * 8 + 1, dtype=np.uint8)[1:].view(np.float64)
+        a = a.reshape(b.shape)
+        a[...] = b
+        assert_(not a.flags.aligned)
+        for axis in [None, 0, 1]:
+            assert_equal(np.minmax(a, axis), (b.min(axis), b.max(axis)))
+            assert_equal(np.ptp(a, axis), np.ptp(b, axis))
+
+    def test_errors(self):
+        assert_raises(ValueError, np.minmax, [])
+        assert_raises(ValueError, np.minmax, [1, 2], axis=1)
+
+    def test_subclass(self):
+        m = np.matrix([[1, 2], [3, 4]])
+        mn, mx = np.minmax(m, 0)
+        assert_(isinstance(mn, np.matrix))
+        assert_equal(mx, [[3, 4]])
+
+class TestTopK(TestCase):
+    def check(self, a, k, axis=-1):
+        # Compare with stable argsorts of the lanes, ties by lowest index
+        a = np.asarray(a)
+        if axis is None:
+            b, ax = a.ravel(), 0
+        else:
+            b, ax = a, axis % a.ndim
+        lanes = np.rollaxis(b, ax, b.ndim).reshape(-1, b.shape[ax])
+        for largest in [True, False]:
+            val, ind = np.topk(a, k, axis=axis, largest=largest)
+            assert_equal(val.dtype, a.dtype)
+            assert_equal(ind.dtype, np.intp)
+            val = np.rollaxis(val, ax, b.ndim).reshape(len(lanes), k)
+            ind = np.rollaxis(ind, ax, b.ndim).reshape(len(lanes), k)
+            for l in range(len(lanes)):
+                lane = lanes[l]
+                if largest:
+                    n = len(lane)
+                    idx = n - 1 - lane[::-1].argsort(kind='mergesort')[::-1]
+                else:
+                    idx = lane.argsort(kind='mergesort')
+                assert_equal(ind[l], idx[:k])
+                assert_equal(val[l], lane[idx[:k]])
+            # unsorted results hold the same elements
+            v2, i2 = np.topk(a, k, axis=axis, largest=largest, sorted=False)
+            i2 = np.rollaxis(i2, ax, b.ndim).reshape(len(lanes), k)
+            assert_equal(np.sort(i2), np.sort(ind))
+
+    def test_types(self):
+        x = [3, 1, 4, 1, 5, 9, 2, 6, 5, 3, 5, 8, 9, 7, 9] * 3
+        for dt in np.typecodes['All']:
+            if dt in 'SUVmM':
+                continue
+            a = np.array(x, dtype=dt)
+            for k in [0, 1, 4, len(x)]:
+                self.check(a, k)
+        a = np.array(x, dtype='>i4')
+        self.check(a, 5)
+        self.check(a[::3], 3)
+        a = np.array(x, dtype='M8[D]')
+        self.check(a, 5)
+        self.check(a - a[0], 5)
+        self.check(np.array([str(i) for i in x]), 5)
+
+    def test_axis(self):
+        np.random.seed(7)
+        a = np.random.randint(0, 20, (6, 30, 5))
+        for axis in [0, 1, 2, -1]:
+            self.check(a, 3, axis)
+        assert_equal(np.topk(a, 4, axis=None),
+                     np.topk(a.ravel(), 4))
+
+    def test_nan(self):
+        a = np.array([1., np.nan, 3., np.nan, 2.])
+        val, ind = np.topk(a, 3)
+        assert_equal(ind, [1, 3, 2])
+        val, ind = np.topk(a, 2, largest=False)
+        assert_equal(ind, [0, 4])
+
+    def test_errors(self):
+        assert_raises(ValueError, np.topk, [1, 2, 3], 4)
+        assert_raises(ValueError, np.topk, [1, 2, 3], -1)
+        assert_raises(ValueError, np.topk, [1, 2, 3], 1, axis=1)
+
+    def test_parallel(self):
+        np.random.seed(8)
+        a = np.random.rand(64, 5000)
+        with with_threads(1):
+            expected = np.topk(a, 10)
+        with with_threads(4):
+            res = np.topk(a, 10)
+        assert_equal(res[0], expected[0])
+        assert_equal(res[1], expected[1])
+
 class TestIndex(TestCase):
     def test_boolean(self):
         a = rand(3,5,8)
@@ -520,6 +520,55 @@ class TestUfunc(TestCase):
         assert_equal(np.logical_or.reduce(a), 3)
         assert_equal(np.logical_and.reduce(a), None)
 
+    def test_sum_stability(self):
+        a = np.ones(500, dtype=np.float32)
+        assert_almost_equal((a / 10.).sum() - a.size / 10., 0, 4)
+
+        a = np.ones(500, dtype=np.float64)
+        assert_almost_equal((a / 10.).sum() - a.size / 10., 0, 13)
+
+    def test_sum(self):
+        for dt in (np.float32, np.float64, np.longdouble):
+            for v in (0, 1, 2, 7, 8, 9, 15, 16, 19, 127, 128, 1024, 1235):
+                tgt = dt(v * (v + 1) / 2)
+                d = np.arange(1, v + 1, dtype=dt)
+                assert_almost_equal(np.sum(d), tgt)
+                assert_almost_equal(np.sum(d[::-1]), tgt)
+                assert_almost_equal(np.sum(d[::3]), np.sum(d.copy()[::3]))
+
+            d = np.ones(500, dtype=dt)
+            assert_almost_equal(np.sum(d[::2]), 250.)
+            assert_almost_equal(np.sum(d[1::2]), 250.)
+            assert_almost_equal(np.sum(d[::3]), 167.)
+            assert_almost_equal(np.sum(d[1::3]), 167.)
+            assert_almost_equal(np.sum(d[::-2]), 250.)
+            assert_almost_equal(np.sum(d[-1::-2]), 250.)
+            assert_almost_equal(np.sum(d[::-3]), 167.)
+            assert_almost_equal(np.sum(d[-1::-3]), 167.)
+            # sum with first reduction entry != 0
+            d = np.ones((1,), dtype=dt)
+            d += d
+            assert_almost_equal(d, 2.)
+
+    def test_sum_complex(self):
+        for dt in (np.complex64, np.complex128, np.clongdouble):
+            for v in (0, 1, 2, 7, 8, 9, 15, 16, 19, 127, 128, 1024, 1235):
+                tgt = dt(v * (v + 1) / 2) - dt((v * (v + 1) / 2) * 1j)
+                d = np.empty(v, dtype=dt)
+                d.real = np.arange(1, v + 1)
+                d.imag = -np.arange(1, v + 1)
+                assert_almost_equal(np.sum(d), tgt)
+                assert_almost_equal(np.sum(d[::-1]), tgt)
+
+            d = np.ones(500, dtype=dt) + 1j
+            assert_almost_equal(np.sum(d[::2]), 250. + 250j)
+            assert_almost_equal(np.sum(d[1::2]), 250. + 250j)
+            assert_almost_equal(np.sum(d[::3]), 167. + 167j)
+            assert_almost_equal(np.sum(d[-1::-3]), 167. + 167j)
+            # sum along an axis with an initial value
+            d = np.ones((3, 300), dtype=dt)
+            assert_almost_equal(d.sum(axis=1), [300.] * 3)
+
     def test_object_array_reduction(self):
         # Reductions on object arrays
         a = np.array(['a', 'b', 'c'], dtype=object)
@@ -786,6 +835,114 @@ class TestUfunc(TestCase):
         assert_no_warnings(np.add, a, 1.1, out=a, casting="unsafe")
         assert_array_equal(a, [4, 5, 6])
 
+    def test_repeated_calls(self):
+        # The resolved loop is reused by calls with the same kinds of
+        # operands, scalar values must still decide the result type
+        a = np.arange(3, dtype=np.int8)
+        for i in range(3):
+            assert_equal(np.add(a, 1).dtype, np.int8)
+            assert_equal(np.add(a, 1000).dtype, np.int16)
+            assert_equal(np.add(a, -1).dtype, np.int8)
+            assert_equal(np.add(a.astype(np.uint8), -1).dtype, np.int16)
+        assert_raises(TypeError, np.add, a, 1, casting='no')
+        b = np.ones(3, dtype=np.int8)
+        for i in range(3):
+            assert_warns(DeprecationWarning, np.add, b, 1.5, out=b)
+
+    def test_repeated_calls_errstate(self):
+        # Changes to the error handling take effect on the next call
+        z = np.zeros(3)
+        for i in range(3):
+            with np.errstate(divide='raise'):
+                assert_raises(FloatingPointError, np.divide, 1., z)
+            with np.errstate(divide='ignore'):
+                assert_equal(np.divide(1., z), np.inf)
+        # Including when the error object list is modified in place
+        with np.errstate(divide='ignore'):
+            errobj = np.geterrobj()
+            old = errobj[1]
+            with np.errstate(divide='raise'):
+                mask = np.geterrobj()[1]
+            np.divide(1., z)
+            errobj[1] = mask
+            try:
+                assert_raises(FloatingPointError, np.divide, 1., z)
+            finally:
+                errobj[1] = old
+            np.divide(1., z)
+
+    def test_automatic_bufsize(self):
+        # The default buffer size of 0 lets the iterator choose one, and
+        # getbufsize reports the one it chooses for doubles
+        assert_equal(np.geterrobj()[0], 0)
+        assert_equal(np.UFUNC_BUFSIZE_DEFAULT, 0)
+        default = np.getbufsize()
+        x = np.ones(10**6)
+        it = np.nditer([x, x, x], ['buffered'],
+                       [['readonly'], ['readonly'], ['writeonly']])
+        assert_equal(it.buffersize, default)
+        assert_(1024 <= default <= 65536 and default % 16 == 0)
+        a = np.arange(100000, dtype='f4')
+        b = np.arange(100000, dtype='f8')
+        expected = np.add(a.astype('f8'), b)
+        old = np.setbufsize(8208)
+        try:
+            assert_equal(old, 0)
+            assert_equal(np.add(a, b), expected)
+            assert_equal(np.setbufsize(0), 8208)
+            assert_equal(np.add(a, b), expected)
+            assert_equal(np.add.reduce(a, dtype='f8'), a.astype('f8').sum())
+            # An explicit size is used as is, even the reported default
+            np.setbufsize(default)
+            assert_equal(np.getbufsize(), default)
+            with with_threads(1):
+                with np.ufunc_profile() as prof:
+                    np.add(a, b)
+            assert_equal(prof.stats['add']['buffer_fills'],
+                         -(-a.size // default))
+        finally:
+            np.setbufsize(old)
+        assert_equal(np.geterrobj()[0], 0)
+
+    def test_ufunc_profile(self):
+        a = np.arange(10000, dtype='f4')
+        with np.ufunc_profile() as prof:
+            np.add(a, np.arange(10000.))
+            np.add(a, 1)
+            np.add.reduce(a)
+            np.sqrt(np.arange(100000.).astype('>f8'))
+            umt.inner1d(np.ones((5, 3)), np.ones((5, 3)))
+        stats = prof.stats
+        assert_equal(sorted(stats),
+                     ['add', 'add.reduce', 'inner1d', 'sqrt'])
+        assert_equal(stats['add']['calls'], 2)
+        assert_equal(stats['add']['elements'], 20000)
+        assert_equal(stats['add.reduce']['elements'], 10000)
+        assert_equal(stats['inner1d']['elements'], 5)
+        # The byte swapped input goes through the buffers
+        assert_(stats['sqrt']['buffer_fills'] > 0)
+        for counters in stats.values():
+            for name in ('setup_time', 'loop_time', 'buffer_time'):
+                assert_(counters[name] >= 0)
+        # Nothing is recorded outside the context
+        np.add(a, a)
+        assert_equal(prof.stats['add']['calls'], 2)
+
+    def test_ufunc_profile_threads(self):
+        # Loops split across threads count the buffer fills of every task
+        a = np.arange(10**6, dtype='f4')
+        fills = []
+        for n in (1, 4):
+            with with_threads(n):
+                with np.ufunc_profile() as prof:
+                    np.add(a, np.arange(10**6.))
+            counters = prof.stats['add']
+            assert_(counters['buffer_time'] >= 0)
+            assert_(counters['loop_time'] >= 0)
+            fills.append(counters['buffer_fills'])
+        assert_(fills[0] > 0)
+        assert_(fills[1] >= fills[0])
+
     def test_ufunc_custom_out(self):
         # Test ufunc with built in input types and custom output type
 
@@ -864,5 +1021,332 @@ class TestUfunc(TestCase):
         assert_(MyThing.rmul_count == 1, MyThing.rmul_count)
         assert_(MyThing.getitem_count <= 2, MyThing.getitem_count)
 
+    def test_reduceby(self):
+        def reduceby(func, a, labels, ngroups, axis=0):
+            a = np.rollaxis(np.asarray(a), axis)
+            r = [func.reduce(a[labels == g], axis=0) for g in range(ngroups)]
+            return np.rollaxis(np.array(r), 0, axis + 1)
+
+        labels = np.array([2, 0, 1, 3, 2, 0, 3])
+        for dt in ['i1', 'u4', '>i8', 'f4', 'f8', 'c16']:
+            a = np.arange(7*3).reshape(7, 3).astype(dt)
+            for func in [np.add, np.multiply, np.maximum, np.minimum]:
+                for arr, axis in [(a, 0), (a[:, 1], 0), (a.T, 1),
+                                  (a[::-1], 0)]:
+                    if func in (np.maximum, np.minimum) and dt == 'c16':
+                        continue
+                    res = func.reduceby(arr, labels, 4, axis=axis)
+                    if func in (np.maximum, np.minimum):
+                        assert_raises(ValueError, func.reduceby, arr,
+                                      labels, 5, axis=axis)
+                        continue
+                    assert_array_equal(res, reduceby(func, arr, labels, 4,
+                                                     axis))
+                    # Groups without rows are the identity
+                    res = func.reduceby(arr, labels, 5, axis=axis)
+                    assert_equal(res.shape[axis], 5)
+                    assert_array_equal(res.take(4, axis=axis),
+                                       func.identity)
+        # Maximum and minimum propagate NaNs
+        a = np.array([1., np.nan, 3., 2.])
+        assert_equal(np.maximum.reduceby(a, [0, 0, 1, 1]), [np.nan, 3])
+        assert_equal(np.minimum.reduceby(a, [1, 0, 1, 0]), [np.nan, 1])
+        # Objects and small integers summed like reduce
+        a = np.array([1, 2, 3], dtype=object)
+        assert_equal(np.add.reduceby(a, [1, 0, 1]), [2, 4])
+        assert_equal(np.add.reduceby([True, True, False], [0, 0, 1]).dtype,
+                     np.add.reduce([True]).dtype)
+        assert_equal(np.add.reduceby([], []).shape, (0,))
+
+    def test_reduceby_out(self):
+        a = np.arange(12.).reshape(3, 4)
+        out = np.zeros((4, 2), dtype=np.float32).T
+        assert_(np.add.reduceby(a, [0, 1, 1], out=out) is out)
+        assert_array_equal(out, [[0, 1, 2, 3], [12, 14, 16, 18]])
+        np.add.reduceby(a, [0, 0, 1], out=a[:2])
+        assert_array_equal(a[:2], [[4, 6, 8, 10], [8, 9, 10, 11]])
+        assert_raises(ValueError, np.add.reduceby, a, [0, 1, 1],
+                      out=np.zeros((3, 4)))
+
+    def test_reduceby_errors(self):
+        a = np.arange(6)
+        assert_raises(ValueError, np.subtract.reduceby, a, [0] * 6)
+        assert_raises(ValueError, np.add.reduceby, a, [0] * 5)
+        assert_raises(IndexError, np.add.reduceby, a, [0, 1, 2, 0, 1, -1])
+        assert_raises(IndexError, np.add.reduceby, a, [0, 1, 2, 0, 1, 2], 2)
+        assert_raises(ValueError, np.add.reduceby, a, [0] * 6, -1)
+        assert_raises(ValueError, np.add.reduceby, a.reshape(2, 3), [0, 0],
+                      axis=None)
+        assert_raises(TypeError, np.add.reduceby, np.array(1), [0])
+
+    def test_at(self):
+        # repeated indices accumulate, on the typed path and the generic one
+        for t in ['i1', 'u4', 'i8', 'f4', '>f8', 'c16', 'O']:
+            a = np.arange(5).astype(t)
+            np.add.at(a, [0, 1, 1, -1, 0, 1], np.arange(6).astype(t))
+            assert_array_equal(a, np.array([4, 9, 2, 3, 7]).astype(t))
+            a = np.arange(5).astype(t)
+            np.multiply.at(a, [1, 1, 4], 2)
+            assert_array_equal(a, np.array([0, 4, 2, 3, 8]).astype(t))
+        a = np.array([1., np.nan, 3., 0.])
+        with np.errstate(invalid='ignore'):
+            np.maximum.at(a, [0, 0, 1, 3], [5., 2., 1., np.nan])
+            assert_equal(a, [5., np.nan, 3., np.nan])
+            np.fmin.at(a, [1, 2, 2], [0., -1., 4.])
+        assert_equal(a, [5., 0., -1., np.nan])
+        a = np.arange(5)
+        np.subtract.at(a, [2, 2, 3], 1)
+        assert_array_equal(a, [0, 1, 0, 2, 4])
+        # strided and unaligned
+        a = np.zeros(10)
+        np.add.at(a[::2], [0, 4, 4], 1)
+        assert_array_equal(a, [1, 0, 0, 0, 0, 0, 0, 0, 2, 0])
+        u = np.zeros(5 * 8 + 1, dtype=np.uint8)[1:].view(np.float64)
+        u[...] = 0
+        np.add.at(u, [1, 1, 3], [1., 2., 3.])
+        assert_array_equal(u, [0, 3, 0, 3, 0])
+        # casting to the loop type and back
+        a = np.zeros(3, dtype=np.int16)
+        np.add.at(a, [0, 0, 2], 1.75)
+        assert_array_equal(a, [2, 0, 1])
+        a = np.array([True, False, False])
+        np.logical_xor.at(a, [0, 1, 1], True)
+        assert_array_equal(a, [False, False, False])
+        # unary ufuncs
+        a = np.arange(4.)
+        np.negative.at(a, [0, 1, 1, 3])
+        assert_array_equal(a, [0, 1, 2, -3])
+
+    def test_at_multidim(self):
+        a = np.zeros((3, 4))
+        np.add.at(a, [0, 2, 0], [1, 2, 3, 4])
+        assert_array_equal(a[0], [2, 4, 6, 8])
+        assert_array_equal(a[2], [1, 2, 3, 4])
+        a = np.zeros((3, 4))
+        np.add.at(a, (slice(None), [1, 1, 3]), [[1, 2, 3]] * 3)
+        assert_array_equal(a, [[0, 3, 0, 3]] * 3)
+        a = np.zeros((3, 4))
+        np.add.at(a, ([0, 0, 2], [1, 1, 3]), 1)
+        assert_array_equal(a.nonzero(), [[0, 2], [1, 3]])
+        assert_array_equal(a[[0, 2], [1, 3]], [2, 1])
+        a = np.zeros((2, 3))
+        np.add.at(a, a == 0, np.arange(6))
+        assert_array_equal(a, np.arange(6).reshape(2, 3))
+        # indices without index arrays
+        a = np.zeros((2, 3))
+        np.add.at(a, (0, slice(1, None)), 1)
+        np.add.at(a, 1, [1, 2, 3])
+        np.negative.at(a, (Ellipsis, 2))
+        assert_array_equal(a, [[0, 1, -1], [1, 2, -3]])
+
+    def test_at_errors(self):
+        a = np.arange(5.)
+        assert_raises(IndexError, np.add.at, a, [5], 1)
+        assert_raises(IndexError, np.add.at, a, [-6], 1)
+        assert_raises(ValueError, np.add.at, a, [0, 1], [1, 2, 3])
+        assert_raises(ValueError, np.add.at, a, [0])
+        assert_raises(ValueError, np.negative.at, a, [0], 1)
+        assert_raises(TypeError, np.add.at, [1, 2], [0], 1)
+        assert_raises(IndexError, np.add.at, np.array(1.), [0], 1)
+        a.flags.writeable = False
+        assert_raises(ValueError, np.add.at, a, [0], 1)
+        assert_raises(TypeError, np.add.at, np.array(['a']), [0], 'b')
+        assert_raises(TypeError, np.add.at, np.array([None, 1]), [0, 1], 1)
+        # the index array is not modified when negative items are wrapped
+        ind = np.array([-1, 0])
+        np.add.at(np.zeros(3), ind, 1)
+        assert_array_equal(ind, [-1, 0])
+        with np.errstate(divide='raise'):
+            assert_raises(FloatingPointError, np.divide.at, np.ones(3), [0],
+                          0.)
+
+
+class TestParallelUfunc(TestCase):
+    def setUp(self):
+        self.old_nthreads = np.setnumthreads(4)
+
+    def tearDown(self):
+        np.setnumthreads(self.old_nthreads)
+
+    def test_numthreads(self):
+        assert_equal(np.getnumthreads(), 4)
+        assert_equal(np.setnumthreads(2), 4)
+        assert_equal(np.getnumthreads(), 2)
+        assert_raises(ValueError, np.setnumthreads, 0)
+
+    def _serial(self, func, *args):
+        with with_threads(1):
+            return func(*args)
+
+    def test_trivial_loops(self):
+        a = np.random.rand(200001)
+        b = np.random.rand(200001)
+        for func, args in [(np.add, (a, b)), (np.exp, (a,)),
+                           (np.sqrt, (a.astype(np.float32),)),
+                           (np.maximum, (a, 0.5))]:
+            assert_array_equal(func(*args), self._serial(func, *args))
+        # In place
+        c = a.copy()
+        np.multiply(c, b, out=c)
+        assert_array_equal(c, a * b)
+
+    def test_iterator_loops(self):
+        a = np.random.rand(1000, 301)
+        b = np.random.rand(301)
+        # Broadcasting, non-contiguous and casting operands
+        for args in [(a, b), (a.T, a[:, ::-1].T), (a, b.astype(np.float32)),
+                     (a[::2], a[1::2, ::-1])]:
+            assert_array_equal(np.add(*args), self._serial(np.add, *args))
+        out = np.empty(a.shape, dtype=np.float32)
+        np.subtract(a, b, out=out, casting='unsafe')
+        assert_array_equal(out, (a - b).astype(np.float32))
+
+    def test_overlapping_output(self):
+        a = np.arange(100000, dtype=np.float64)
+        b = a.copy()
+        np.add(a[:-1], 1, out=a[1:])
+        self._serial(np.add, b[:-1], 1, b[1:])
+        assert_array_equal(a, b)
+
+    def test_fp_errors(self):
+        a = np.ones(100000)
+        b = np.ones(100000)
+        b[-1] = 0
+        with np.errstate(divide='raise'):
+            assert_raises(FloatingPointError, np.divide, a, b)
+
+    def test_reduce_exact(self):
+        a = np.random.randint(-1000, 1000, size=(300, 700))
+        b = a > 0
+        for func, arr in [(np.add, a), (np.maximum, a), (np.minimum, a.T),
+                          (np.logical_or, b), (np.logical_and, b[::-1])]:
+            for axis in [None, 0, 1, (0, 1)]:
+                assert_array_equal(func.reduce(arr, axis=axis),
+                                   self._serial(func.reduce, arr, axis))
+        # Non-reorderable reductions are only split along other axes
+        assert_array_equal(np.subtract.reduce(a, axis=0),
+                           self._serial(np.subtract.reduce, a, 0))
+        assert_array_equal(np.subtract.reduce(a, axis=1),
+                           self._serial(np.subtract.reduce, a, 1))
+
+    def test_reduce_float(self):
+        a = np.random.rand(500, 401)
+        for axis in [None, 0, 1]:
+            assert_allclose(np.add.reduce(a, axis=axis),
+                            self._serial(np.add.reduce, a, axis))
+            b = 1 + 1e-5 * a
+            assert_allclose(np.multiply.reduce(b, axis=axis),
+                            self._serial(np.multiply.reduce, b, axis))
+        assert_allclose(a.astype(np.float32).sum(dtype=np.float64), a.sum(),
+                        rtol=1e-6)
+        out = np.zeros((1, 401))
+        np.add.reduce(a, axis=0, out=out, keepdims=True)
+        assert_allclose(out, a.sum(axis=0, keepdims=True))
+
+    def test_reduceby(self):
+        labels = np.random.randint(0, 10, size=200001)
+        a = np.random.randint(-1000, 1000, size=200001)
+        b = np.random.rand(100001, 3)
+        for func in [np.add, np.maximum, np.minimum, np.bitwise_or]:
+            assert_array_equal(func.reduceby(a, labels),
+                               self._serial(func.reduceby, a, labels))
+        for func in [np.add, np.minimum, np.fmax]:
+            assert_allclose(func.reduceby(b, labels[:100001]),
+                            self._serial(func.reduceby, b, labels[:100001]))
+        # Groups only some of the threads see
+        labels = np.arange(200001) // 50001
+        assert_array_equal(np.maximum.reduceby(a, labels),
+                           np.maximum.reduceat(a, np.arange(4) * 50001))
+
+    def test_reduce_out_in_operand_base(self):
+        a = np.ones((401, 400))
+        np.add.reduce(a[1:], axis=0, out=a[0])
+        assert_array_equal(a[0], 400)
+
+    def test_gufunc(self):
+        a = np.random.rand(5001, 3, 4)
+        b = np.random.rand(5001, 4, 2)
+        for args in [(a, b), (a[::-2], b[::2]), (a, b[0]),
+                     (a.astype(np.float32), b.astype(np.float32))]:
+            assert_array_equal(umt.matrix_multiply(*args),
+                               self._serial(umt.matrix_multiply, *args))
+        c = np.random.rand(3, 7001, 5)
+        assert_array_equal(umt.inner1d(c, c[::-1]),
+                           self._serial(umt.inner1d, c, c[::-1]))
+        out = np.empty((5001, 3, 2))
+        umt.matrix_multiply(a, b, out)
+        assert_array_equal(out, self._serial(umt.matrix_multiply, a, b))
+
+
+class TestFuse(TestCase):
+    def test_expression(self):
+        a, b, c, d, e = [np.random.rand(50001) for i in range(5)]
+        f = np.fuse(lambda a, b, c, d, e: a*b + c*d - e)
+        assert_(isinstance(f, np.ufunc))
+        assert_equal((f.nin, f.nout), (5, 1))
+        assert_array_equal(f(a, b, c, d, e), a*b + c*d - e)
+        # Ufunc calls, constants and a value used twice
+        g = np.fuse(lambda x, y: np.sqrt(x*x + np.maximum(y, 0.5)) / 2)
+        assert_array_equal(g(a, b), np.sqrt(a*a + np.maximum(b, 0.5)) / 2)
+        h = np.fuse(lambda x: (x > 0.25) & ~(x >= 0.75))
+        assert_array_equal(h(a), (a > 0.25) & ~(a >= 0.75))
+        # Enough live temporaries to need more scratch than the stack has
+        k = np.fuse(lambda a, b, c, d: (a*b + c*d) * (a*c + b*d) -
+                                       (a*d + b*c) * (a - b))
+        assert_array_equal(k(a, b, c, d),
+                           (a*b + c*d) * (a*c + b*d) - (a*d + b*c) * (a - b))
+
+    def test_types(self):
+        i = np.arange(-10, 10, dtype=np.int32)
+        x = np.linspace(-1, 1, 20).astype(np.float32)
+        f = np.fuse(lambda i, x: (i + 1) * x - i // 3)
+        for args in [(i, x), (i, 2), (x, i), (1.5, i), (i, np.float32(2))]:
+            expected = (args[0] + 1) * args[1] - args[0] // 3
+            assert_equal(f(*args).dtype, expected.dtype)
+            assert_array_equal(f(*args), expected)
+        assert_equal(f(2, 3), 9)
+        assert_raises(TypeError, f, i, x, dtype=np.float16)
+        assert_raises(TypeError, f, i.astype(object), x)
+
+    def test_iteration(self):
+        a = np.random.rand(301, 40)
+        b = np.random.rand(40).astype(np.float32)
+        f = np.fuse(lambda x, y: x * y + 1)
+        # Broadcasting, strided and unaligned operands
+        for args in [(a, b), (a.T, a[::-1, ::-1].T), (a[::3, ::2], 3)]:
+            assert_array_equal(f(*args), args[0] * args[1] + 1)
+        u = np.zeros(40 * 8 + 1, dtype=np.uint8)[1:].view(np.float64)
+        u[...] = b
+        assert_array_equal(f(a, u), a * u + 1)
+        # Output argument, in place and casting
+        out = np.empty_like(a)
+        assert_(f(a, b, out=out) is out)
+        assert_array_equal(out, a * b + 1)
+        c = a.copy()
+        f(c, b, out=c)
+        assert_array_equal(c, a * b + 1)
+        out = np.empty(a.shape, dtype=np.float32)
+        f(a, b, out=out, casting='unsafe')
+        assert_array_equal(out, (a * b + 1).astype(np.float32))
+        # Methods
+        assert_equal(f.reduce([1., 2., 3., 4.]), 41)
+        assert_array_equal(f.outer([1., 2.], [3., 4.]), [[4., 5.], [7., 9.]])
+
+    def test_fp_errors(self):
+        f = np.fuse(lambda x: 1. / (x - 1))
+        with np.errstate(divide='raise'):
+            assert_raises(FloatingPointError, f, np.ones(10))
+
+    def test_invalid(self):
+        a = np.arange(3)
+        assert_raises(TypeError, np.fuse, lambda x: x)
+        assert_raises(TypeError, np.fuse, lambda x: x + a)
+        assert_raises(TypeError, np.fuse, lambda x: x if x else -x)
+        assert_raises(TypeError, np.fuse, lambda x: np.modf(x)[0])
+        assert_raises(TypeError, np.fuse, lambda x: np.add.reduce(x))
+        f = np.fuse(lambda x: x + 1)
+        assert_raises(TypeError, np.fuse, lambda x: f(x) * 2)
+
+
 if __name__ == "__main__":
     run_module_suite()
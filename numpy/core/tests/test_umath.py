@@ -710,6 +710,155 @@ class TestAbsolute(TestCase):
                             assert_array_equal(out, d, err_msg=msg)
 
 
+class TestSIMDWidths(TestCase):
+    """
+    Compare the vectorized loops, whose width depends on the cpu (up to 64
+    bytes with avx512), against the same operation on strided data, which
+    is not vectorized. Sizes and offsets cover the alignment peeling and
+    the remainder loops.
+    """
+    sizes = list(range(1, 70)) + [127, 128, 129, 1000]
+
+    def _strided(self, a):
+        b = np.empty(2 * a.size, dtype=a.dtype)[::2]
+        b[...] = a
+        return b
+
+    def _data(self, dt):
+        for n in self.sizes:
+            for o in range(4):
+                a = np.random.rand(n + o + 20).astype(dt)[o:o + n] - 0.5
+                yield a, 'size=%d, offset=%d, dtype=%r' % (n, o, dt)
+
+    def test_binary(self):
+        for dt in [np.float32, np.float64]:
+            for a, msg in self._data(dt):
+                b = np.random.rand(a.size).astype(dt) + 0.5
+                sa, sb = self._strided(a), self._strided(b)
+                for f in [np.add, np.subtract, np.multiply, np.divide]:
+                    assert_array_equal(f(a, b), f(sa, sb), err_msg=msg)
+                    assert_array_equal(f(a, dt(3)), f(sa, dt(3)), err_msg=msg)
+                    assert_array_equal(f(dt(3), b), f(dt(3), sb), err_msg=msg)
+                # in place and aliased within one vector
+                for shift in [k for k in [0, 1, 3, 7] if k < a.size]:
+                    c = a.copy()
+                    exp = a[shift:] + a[:a.size - shift]
+                    np.add(c[shift:], c[:c.size - shift], out=c[:c.size - shift])
+                    assert_array_equal(c[:c.size - shift], exp, err_msg=msg)
+
+    def test_unary(self):
+        for dt in [np.float32, np.float64]:
+            for a, msg in self._data(dt):
+                sa = self._strided(a)
+                assert_array_equal(np.absolute(a), np.absolute(sa), err_msg=msg)
+                assert_array_equal(np.sqrt(np.absolute(a)),
+                                   np.sqrt(np.absolute(sa)), err_msg=msg)
+
+    def test_minmax_reduce(self):
+        for dt in [np.float32, np.float64]:
+            for a, msg in self._data(dt):
+                sa = self._strided(a)
+                assert_equal(np.maximum.reduce(a), np.maximum.reduce(sa),
+                             err_msg=msg)
+                assert_equal(np.minimum.reduce(a), np.minimum.reduce(sa),
+                             err_msg=msg)
+                for i in set([0, a.size // 3, a.size // 2, a.size - 1]):
+                    b = a.copy()
+                    b[i] = np.nan
+                    with np.errstate(invalid='ignore'):
+                        assert_(np.isnan(np.maximum.reduce(b)), msg)
+                        assert_(np.isnan(np.minimum.reduce(b)), msg)
+
+
+class TestTranscendentalSIMD(TestCase):
+    """
+    exp, log, sin, cos and tanh have vectorized loops for contiguous float
+    and double arrays on cpus supporting avx2 or avx512f. Check their
+    accuracy, the special values and the floating point errors against the
+    scalar functions used for strided data.
+    """
+    funcs = [np.exp, np.log, np.sin, np.cos, np.tanh]
+
+    def _strided(self, a):
+        b = np.empty(2 * a.size, dtype=a.dtype)[::2]
+        b[...] = a
+        return b
+
+    def test_accuracy(self):
+        np.random.seed(1)
+        ranges = {np.exp: (-80, 80), np.log: (1e-30, 1e30),
+                  np.sin: (-100, 100), np.cos: (-100, 100),
+                  np.tanh: (-10, 10)}
+        for dt in [np.float32, np.float64]:
+            for f in self.funcs:
+                lo, hi = ranges[f]
+                if f is np.log:
+                    x = np.exp(np.random.uniform(np.log(lo), np.log(hi), 5000))
+                else:
+                    x = np.random.uniform(lo, hi, 5000)
+                x = np.concatenate([x, np.random.uniform(-1, 1, 5000)])
+                if f is np.log:
+                    x = np.abs(x)
+                x = x.astype(dt)
+                ref = f(x.astype(np.longdouble)).astype(dt)
+                assert_array_max_ulp(f(x), ref, maxulp=3, dtype=dt)
+
+    def test_sizes(self):
+        # the remainder uses a padded vector, results must not depend on
+        # the position in the array
+        for dt in [np.float32, np.float64]:
+            for n in list(range(1, 40)) + [127, 128, 129]:
+                a = np.linspace(0, 3, n + 1).astype(dt)[1:]
+                for f in self.funcs:
+                    res = f(a)
+                    for i in range(n - 1):
+                        assert_array_equal(f(a[i:]), res[i:],
+                                           err_msg='n=%d, i=%d' % (n, i))
+
+    def test_special_values(self):
+        for dt in [np.float32, np.float64]:
+            fi = np.finfo(dt)
+            x = np.array([np.nan, np.inf, -np.inf, 0., -0., 1., -1.,
+                          fi.tiny, fi.tiny / 4, -fi.tiny / 4, fi.max, -fi.max,
+                          1e-20, -1e-20, 0.625, -0.625, 30., -30., 85.,
+                          -85., 705., -705., 1000., -1000., 1e5, -3e7,
+                          1e20], dtype=dt)
+            for f in self.funcs:
+                with np.errstate(all='ignore'):
+                    res = f(x)
+                    exp = np.array([f(self._strided(np.repeat(v, 3)))[0]
+                                    for v in x])
+                fin = np.isfinite(exp)
+                assert_array_equal(res[~fin], exp[~fin])
+                assert_array_max_ulp(res[fin], exp[fin], maxulp=3, dtype=dt)
+                # the sign of nan is not specified
+                nan = np.isnan(exp)
+                assert_array_equal(np.signbit(res[~nan]), np.signbit(exp[~nan]))
+
+    def test_fp_errors(self):
+        cases = [(np.log, 0., 'divide'), (np.log, -1., 'invalid'),
+                 (np.log, -np.inf, 'invalid'), (np.sin, np.inf, 'invalid'),
+                 (np.cos, -np.inf, 'invalid'), (np.exp, 1000., 'over'),
+                 (np.exp, -1000., 'under')]
+        for dt in [np.float32, np.float64]:
+            for f, v, err in cases:
+                a = np.ones(40, dtype=dt)
+                a[17] = v
+                with np.errstate(all='ignore', **{err: 'raise'}):
+                    assert_raises(FloatingPointError, f, a)
+            # no spurious errors for the special values which raise none
+            quiet = [(np.exp, [np.nan, np.inf, -np.inf, 0., -0., -50.]),
+                     (np.log, [np.nan, np.inf, 1e-30, np.finfo(dt).max]),
+                     (np.sin, [np.nan, 0., -0., 1e-30, np.finfo(dt).max]),
+                     (np.cos, [np.nan, 0., -0., 1e-30, np.finfo(dt).max]),
+                     (np.tanh, [np.nan, np.inf, -np.inf, 0., -0., 1e-30,
+                                np.finfo(dt).max])]
+            for f, v in quiet:
+                a = np.array(v * 10, dtype=dt)
+                with np.errstate(all='raise'):
+                    f(a)
+
+
 class TestSpecialMethods(TestCase):
     def test_wrap(self):
         class with_wrap(object):
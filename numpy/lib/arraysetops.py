@@ -1,5 +1,5 @@
 """
-Set operations for 1D numeric arrays based on sorting.
+Set operations for 1D numeric arrays based on hashing or sorting.
 
 :Contains:
   ediff1d,
@@ -15,9 +15,9 @@ Set operations for 1D numeric arrays based on sorting.
 For floating point arrays, inaccurate results may appear due to usual round-off
 and floating point comparison issues.
 
-Speed could be gained in some operations by an implementation of
-sort(), that can provide directly the permutation vectors, avoiding
-thus calls to argsort().
+Arrays of booleans, integers, float32, float64, complex64, complex128,
+datetimes, timedeltas and strings are put in a hash table, taking expected
+linear time; other types are sorted.
 
 To do: Optionally return indices analogously to unique for all functions.
 
@@ -31,6 +31,14 @@ __all__ = ['ediff1d', 'intersect1d', 'setxor1d', 'union1d', 'setdiff1d',
 
 import numpy as np
 from numpy.lib.utils import deprecate
+from numpy.lib._compiled_base import _unique_hash, _in1d_hash
+
+# Type characters of the arrays supported by _unique_hash and _in1d_hash
+_hash_typechars = '?bBhHiIlLqQpPfdFDMmSU'
+
+def _hashable(ar):
+    # Subclasses like masked arrays keep the sorting, which they rely on
+    return type(ar) is np.ndarray and ar.dtype.char in _hash_typechars
 
 def ediff1d(ary, to_end=None, to_begin=None):
     """
@@ -90,14 +98,16 @@ def ediff1d(ary, to_end=None, to_begin=None):
 
     return ed
 
-def unique(ar, return_index=False, return_inverse=False):
+def unique(ar, return_index=False, return_inverse=False,
+           return_counts=False, sorted=True):
     """
     Find the unique elements of an array.
 
-    Returns the sorted unique elements of an array. There are two optional
+    Returns the sorted unique elements of an array. There are three optional
     outputs in addition to the unique elements: the indices of the input array
-    that give the unique values, and the indices of the unique array that
-    reconstruct the input array.
+    that give the unique values, the indices of the unique array that
+    reconstruct the input array, and the number of times each unique value
+    comes up in the input array.
 
     Parameters
     ----------
@@ -109,6 +119,17 @@ def unique(ar, return_index=False, return_inverse=False):
     return_inverse : bool, optional
         If True, also return the indices of the unique array that can be used
         to reconstruct `ar`.
+    return_counts : bool, optional
+        If True, also return the number of times each unique value comes up
+        in `ar`.
+
+        .. versionadded:: 1.8.0
+    sorted : bool, optional
+        If True (default), the unique values are sorted, otherwise they are
+        in the order of their first occurrence in `ar`, which is faster for
+        the types supported by the hash table.
+
+        .. versionadded:: 1.8.0
 
     Returns
     -------
@@ -120,12 +141,22 @@ def unique(ar, return_index=False, return_inverse=False):
     unique_inverse : ndarray, optional
         The indices to reconstruct the (flattened) original array from the
         unique array. Only provided if `return_inverse` is True.
+    unique_counts : ndarray, optional
+        The number of times each of the unique values comes up in the
+        original array. Only provided if `return_counts` is True.
 
     See Also
     --------
     numpy.lib.arraysetops : Module with a number of other functions for
                             performing set operations on arrays.
 
+    Notes
+    -----
+    Booleans, integers, float32, float64, complex64, complex128, datetimes,
+    timedeltas and strings are found with a hash table in expected linear
+    time, only the unique values are sorted. Other types are sorted. Nans
+    are never equal, so each nan is a unique value.
+
     Examples
     --------
     >>> np.unique([1, 1, 2, 2, 3, 3])
@@ -158,45 +189,75 @@ def unique(ar, return_index=False, return_inverse=False):
     >>> u[indices]
     array([1, 2, 6, 4, 2, 3, 2])
 
+    Count the unique values, in the order of their first occurrence:
+
+    >>> np.unique([3, 1, 3, 2, 3], return_counts=True, sorted=False)
+    (array([3, 1, 2]), array([3, 1, 1]))
+
     """
+    # The keyword `sorted` hides the builtin of that name in this function
+    optional_indices = return_index or return_inverse or return_counts
     try:
         ar = ar.flatten()
     except AttributeError:
-        if not return_inverse and not return_index:
-            items = sorted(set(ar))
+        if not optional_indices and sorted:
+            items = list(set(ar))
+            items.sort()
             return np.asarray(items)
         else:
             ar = np.asanyarray(ar).flatten()
 
     if ar.size == 0:
-        if return_inverse and return_index:
-            return ar, np.empty(0, np.bool), np.empty(0, np.bool)
-        elif return_inverse or return_index:
-            return ar, np.empty(0, np.bool)
-        else:
-            return ar
-
-    if return_inverse or return_index:
+        ret = (ar,)
         if return_index:
-            perm = ar.argsort(kind='mergesort')
-        else:
-            perm = ar.argsort()
-        aux = ar[perm]
-        flag = np.concatenate(([True], aux[1:] != aux[:-1]))
+            ret += (np.empty(0, np.bool),)
         if return_inverse:
-            iflag = np.cumsum(flag) - 1
-            iperm = perm.argsort()
-            if return_index:
-                return aux[flag], perm[flag], iflag[iperm]
-            else:
-                return aux[flag], iflag[iperm]
-        else:
-            return aux[flag], perm[flag]
+            ret += (np.empty(0, np.bool),)
+        if return_counts:
+            ret += (np.empty(0, np.intp),)
+        return ret if optional_indices else ar
 
-    else:
+    if not optional_indices and sorted:
+        # sorting in place beats hashing when only the values are needed
         ar.sort()
         flag = np.concatenate(([True], ar[1:] != ar[:-1]))
         return ar[flag]
+    elif _hashable(ar):
+        # the indices of the first occurrences in order of occurrence
+        first, inverse, counts = _unique_hash(ar, return_inverse,
+                                              return_counts)
+        order = ar[first].argsort(kind='mergesort') if sorted else None
+    else:
+        # the indices of the first occurrences in sorted order
+        perm = ar.argsort(kind='mergesort')
+        aux = ar[perm]
+        flag = np.concatenate(([True], aux[1:] != aux[:-1]))
+        first = perm[flag]
+        if return_inverse:
+            inverse = np.empty(ar.shape, dtype=np.intp)
+            inverse[perm] = np.cumsum(flag) - 1
+        if return_counts:
+            counts = np.diff(np.concatenate((np.nonzero(flag)[0],
+                                             [ar.size])))
+        order = None if sorted else first.argsort()
+
+    if order is not None:
+        first = first[order]
+        if return_inverse:
+            rank = np.empty(order.shape, dtype=np.intp)
+            rank[order] = np.arange(order.size)
+            inverse = rank[inverse]
+        if return_counts:
+            counts = counts[order]
+
+    ret = (ar[first],)
+    if return_index:
+        ret += (first,)
+    if return_inverse:
+        ret += (inverse,)
+    if return_counts:
+        ret += (counts,)
+    return ret if optional_indices else ret[0]
 
 
 def intersect1d(ar1, ar2, assume_unique=False):
@@ -229,6 +290,14 @@ def intersect1d(ar1, ar2, assume_unique=False):
     array([1, 3])
 
     """
+    ar1, ar2 = np.asanyarray(ar1).ravel(), np.asanyarray(ar2).ravel()
+    aux = np.concatenate((ar1[:0], ar2[:0]))
+    if _hashable(aux):
+        # Only ar1 needs to be unique for looking it up in ar2
+        ar1 = np.asarray(ar1, aux.dtype)
+        ar2 = np.asarray(ar2, aux.dtype)
+        ar1 = np.sort(ar1) if assume_unique else unique(ar1)
+        return ar1[_in1d_hash(ar1, ar2)]
     if not assume_unique:
         # Might be faster than unique( intersect1d( ar1, ar2 ) )?
         ar1 = unique(ar1)
@@ -274,6 +343,13 @@ def setxor1d(ar1, ar2, assume_unique=False):
     if aux.size == 0:
         return aux
 
+    if _hashable(aux):
+        ar1, ar2 = aux[:len(ar1)], aux[len(ar1):]
+        aux = np.concatenate((ar1[_in1d_hash(ar1, ar2, invert=True)],
+                              ar2[_in1d_hash(ar2, ar1, invert=True)]))
+        aux.sort()
+        return aux
+
     aux.sort()
 #    flag = ediff1d( aux, to_end = 1, to_begin = 1 ) == 0
     flag = np.concatenate( ([True], aux[1:] != aux[:-1], [True] ) )
@@ -321,6 +397,9 @@ def in1d(ar1, ar2, assume_unique=False, invert=False):
     python keyword `in`, for 1-D sequences. ``in1d(a, b)`` is roughly
     equivalent to ``np.array([item in b for item in a])``.
 
+    For the types supported by the hash table of `unique`, the values of
+    `ar2` are put in a hash table, taking expected linear time.
+
     .. versionadded:: 1.4.0
 
     Examples
@@ -354,6 +433,12 @@ def in1d(ar1, ar2, assume_unique=False, invert=False):
                 mask |= (ar1 == a)
         return mask
 
+    # Then a hash table of ar2 if the type allows
+    aux = np.concatenate((ar1[:0], ar2[:0]))
+    if _hashable(aux):
+        return _in1d_hash(np.asarray(ar1, aux.dtype),
+                          np.asarray(ar2, aux.dtype), invert)
+
     # Otherwise use sorting
     if not assume_unique:
         ar1, rev_idx = np.unique(ar1, return_inverse=True)
@@ -22,12 +22,14 @@ from numpy.core.numeric import ScalarType, dot, where, newaxis, intp, \
         integer, isscalar
 from numpy.core.umath import pi, multiply, add, arctan2,  \
         frompyfunc, isnan, cos, less_equal, sqrt, sin, mod, exp, log10
-from numpy.core.fromnumeric import ravel, nonzero, choose, sort, mean
+from numpy.core.fromnumeric import ravel, nonzero, choose, sort, mean, \
+        partition
 from numpy.core.numerictypes import typecodes, number
 from numpy.core import atleast_1d, atleast_2d
 from numpy.lib.twodim_base import diag
 from ._compiled_base import _insert, add_docstring
 from ._compiled_base import digitize, bincount, interp as compiled_interp
+from ._compiled_base import _histogram, _histogramdd
 from .utils import deprecate
 from ._compiled_base import add_newdoc_ufunc
 import numpy as np
@@ -38,6 +40,12 @@ from numpy.compat import long
 if sys.version_info[0] < 3:
     range = xrange
 
+# Type characters of the samples and weights supported by _histogram and
+# _histogramdd
+_hist_typechars = '?bBhHiIlLqQpPefd'
+_histdd_typechars = 'iIlLqQpPfd'
+_hist_weight_typechars = '?bBhHiIlLqQpPefdFD'
+
 def iterable(y):
     """
     Check whether or not an object can be iterated over.
@@ -190,8 +198,16 @@ def histogram(a, bins=10, range=None, normed=False, weights=None, density=None):
         ntype = int
     else:
         ntype = weights.dtype
-    n = np.zeros(bins.shape, ntype)
 
+    if a.dtype.char in _hist_typechars and (weights is None or
+            weights.dtype.char in _hist_weight_typechars):
+        # finds the bin of every value in one pass, without sorting
+        n = _histogram(a, bins, weights)
+        if n.dtype != ntype:
+            n = n.astype(ntype)
+        return _histogram_normalize(n, bins, normed, density)
+
+    n = np.zeros(bins.shape, ntype)
     block = 65536
     if weights is None:
         for i in arange(0, len(a), block):
@@ -212,7 +228,10 @@ def histogram(a, bins=10, range=None, normed=False, weights=None, density=None):
             n += cw[bin_index]
 
     n = np.diff(n)
+    return _histogram_normalize(n, bins, normed, density)
+
 
+def _histogram_normalize(n, bins, normed, density):
     if density is not None:
         if density:
             db = array(np.diff(bins), float)
@@ -349,22 +368,65 @@ def histogramdd(sample, bins=10, range=None, normed=False, weights=None):
     if N == 0:
         return np.zeros(nbin-2), edges
 
-    # Compute the bin number each sample falls into.
-    Ncount = {}
-    for i in arange(D):
-        Ncount[i] = digitize(sample[:,i], edges[i])
-
     # Using digitize, values that fall on an edge are put in the right bin.
     # For the rightmost bin, we want values equal to the right
     # edge to be counted in the last bin, and not as an outlier.
+    # Values equal to it at this rounding precision are moved left.
+    decimals = D*[None]
     for i in arange(D):
-        # Rounding precision
         mindiff = dedges[i].min()
         if not np.isinf(mindiff):
-            decimal = int(-log10(mindiff)) + 6
+            decimals[i] = int(-log10(mindiff)) + 6
+
+    # Rounding integers to tens can overflow their type, which
+    # _histogramdd doesn't reproduce
+    dtype = asarray(sample).dtype
+    if (dtype.char in _histdd_typechars and D <= np.MAXDIMS and
+            (dtype.kind == 'f' or
+                all(d is None or d >= 0 for d in decimals)) and
+            (weights is None or
+                weights.dtype.char in _hist_weight_typechars)):
+        # finds the bins of every sample in one pass, with outlier bins
+        hist = _histogramdd(sample, edges, decimals, weights)
+        if hist.dtype.kind != 'c':
+            hist = hist.astype(float)
+        hist = hist.reshape(nbin)
+    else:
+        hist = _histogramdd_digitize(sample, edges, decimals, nbin, weights)
+
+    # Remove outliers (indices 0 and -1 for each dimension).
+    core = D*[slice(1,-1)]
+    hist = hist[core]
+
+    # Normalize if normed is True
+    if normed:
+        s = hist.sum()
+        for i in arange(D):
+            shape = ones(D, int)
+            shape[i] = nbin[i] - 2
+            hist = hist / dedges[i].reshape(shape)
+        hist /= s
+
+    if (hist.shape != nbin - 2).any():
+        raise RuntimeError(
+                "Internal Shape Error")
+    return hist, edges
+
+
+def _histogramdd_digitize(sample, edges, decimals, nbin, weights):
+    # The histogram of the samples with outlier bins, using digitize
+    N, D = sample.shape
+
+    # Compute the bin number each sample falls into.
+    Ncount = {}
+    for i in arange(D):
+        Ncount[i] = digitize(sample[:,i], edges[i])
+
+    for i in arange(D):
+        if decimals[i] is not None:
             # Find which points are on the rightmost edge.
-            on_edge = where(around(sample[:,i], decimal) == around(edges[i][-1],
-                                                                   decimal))[0]
+            on_edge = where(around(sample[:,i], decimals[i]) ==
+                            around(edges[i][-1], decimals[i]))[0]
             # Shift these points one bin to the left.
             Ncount[i][on_edge] -= 1
 
@@ -382,9 +444,6 @@ def histogramdd(sample, bins=10, range=None, normed=False, weights=None):
 
     # Compute the number of repetitions in xy and assign it to the
     # flattened histmat.
-    if len(xy) == 0:
-        return zeros(nbin-2, int), edges
-
     flatcount = bincount(xy, weights)
     a = arange(len(flatcount))
     hist[a] = flatcount
@@ -395,24 +454,7 @@ def histogramdd(sample, bins=10, range=None, normed=False, weights=None):
         j = ni.argsort()[i]
         hist = hist.swapaxes(i,j)
         ni[i],ni[j] = ni[j],ni[i]
-
-    # Remove outliers (indices 0 and -1 for each dimension).
-    core = D*[slice(1,-1)]
-    hist = hist[core]
-
-    # Normalize if normed is True
-    if normed:
-        s = hist.sum()
-        for i in arange(D):
-            shape = ones(D, int)
-            shape[i] = nbin[i] - 2
-            hist = hist / dedges[i].reshape(shape)
-        hist /= s
-
-    if (hist.shape != nbin - 2).any():
-        raise RuntimeError(
-                "Internal Shape Error")
-    return hist, edges
+    return hist
 
 
 def average(a, axis=None, weights=None, returned=False):
@@ -2996,30 +3038,44 @@ def median(a, axis=None, out=None, overwrite_input=False):
     >>> assert not np.all(a==b)
 
     """
-    if overwrite_input:
+    if not overwrite_input:
+        a = np.asanyarray(a)
+    if a.ndim == 0:
+        # make 0-D arrays work
+        return a.item()
+    if axis is None:
+        sz = a.size
+    else:
+        sz = a.shape[axis]
+    # only the middle element(s) need to be in their sorted position
+    if sz % 2 == 0:
+        szh = sz // 2
+        kth = [szh - 1, szh]
+    else:
+        kth = [(sz - 1) // 2]
+    if sz == 0:
+        part = a.ravel() if axis is None else a
+    elif overwrite_input:
         if axis is None:
-            sorted = a.ravel()
-            sorted.sort()
+            part = a.ravel()
+            part.partition(kth)
         else:
-            a.sort(axis=axis)
-            sorted = a
+            a.partition(kth, axis=axis)
+            part = a
     else:
-        sorted = sort(a, axis=axis)
-    if sorted.shape == ():
-        # make 0-D arrays work
-        return sorted.item()
+        part = partition(a, kth, axis=axis)
     if axis is None:
         axis = 0
-    indexer = [slice(None)] * sorted.ndim
-    index = int(sorted.shape[axis]/2)
-    if sorted.shape[axis] % 2 == 1:
+    indexer = [slice(None)] * part.ndim
+    index = int(part.shape[axis]/2)
+    if part.shape[axis] % 2 == 1:
         # index with slice to allow mean (below) to work
         indexer[axis] = slice(index, index+1)
     else:
         indexer[axis] = slice(index-1, index+1)
     # Use mean in odd and even case to coerce data type
     # and check, use out array.
-    return mean(sorted[indexer], axis=axis, out=out)
+    return mean(part[indexer], axis=axis, out=out)
 
 def percentile(a, q, axis=None, out=None, overwrite_input=False):
     """
@@ -3106,19 +3162,38 @@ def percentile(a, q, axis=None, out=None, overwrite_input=False):
     elif q == 100:
         return a.max(axis=axis, out=out)
 
-    if overwrite_input:
+    # only the elements next to the qth ranks need to be in their sorted
+    # position, so partition at those instead of sorting
+    if axis is None:
+        Nx = a.size
+    else:
+        Nx = a.shape[axis]
+    kth = []
+    for qi in np.ravel(q):
+        qi = qi / 100.0
+        if (qi < 0) or (qi > 1):
+            raise ValueError("percentile must be either in the range [0,100]")
+        index = qi*(Nx-1)
+        i = int(index)
+        kth.append(i)
+        if i != index:
+            kth.append(i + 1)
+
+    if Nx == 0:
+        part = a.ravel() if axis is None else a
+    elif overwrite_input:
         if axis is None:
-            sorted = a.ravel()
-            sorted.sort()
+            part = a.ravel()
+            part.partition(kth)
         else:
-            a.sort(axis=axis)
-            sorted = a
+            a.partition(kth, axis=axis)
+            part = a
     else:
-        sorted = sort(a, axis=axis)
+        part = partition(a, kth, axis=axis)
     if axis is None:
         axis = 0
 
-    return _compute_qth_percentile(sorted, q, axis, out)
+    return _compute_qth_percentile(part, q, axis, out)
 
 # handle sequence of q's without calling sort multiple times
 def _compute_qth_percentile(sorted, q, axis, out):
@@ -5,121 +5,604 @@
 #include "numpy/npy_3kcompat.h"
 #include "npy_config.h"
 #include "numpy/ufuncobject.h"
+#include "numpy/npy_math.h"
 #include "string.h"
+#include <float.h>
 
 
-static npy_intp
-incr_slot_(double x, double *bins, npy_intp lbins)
+/**
+ * Returns -1 if the array is monotonic decreasing,
+ * +1 if the array is monotonic increasing,
+ * and 0 if the array is not monotonic.
+ */
+static int
+check_array_monotonic(double * a, int lena)
 {
-    npy_intp i;
+    int i;
 
-    for ( i = 0; i < lbins; i ++ ) {
-        if ( x < bins [i] ) {
-            return i;
+    if (a [0] <= a [1]) {
+        /* possibly monotonic increasing */
+        for (i = 1; i < lena - 1; i ++) {
+            if (a [i] > a [i + 1]) {
+                return 0;
+            }
         }
+        return 1;
+    }
+    else {
+        /* possibly monotonic decreasing */
+        for (i = 1; i < lena - 1; i ++) {
+            if (a [i] < a [i + 1]) {
+                return 0;
+            }
+        }
+        return -1;
     }
-    return lbins;
 }
 
-static npy_intp
-decr_slot_(double x, double * bins, npy_intp lbins)
+
+
+/*
+ * Histograms, for bincount, histogram and histogramdd.
+ *
+ * The values are read in blocks, converted to npy_intp (bincount) or
+ * double by the cast function of their type, and the bins of a block are
+ * found before its weights are added to them.  The bin of a value is
+ * found by bisection of the edges, or if the edges are nearly uniform by
+ * computing it from the value and correcting it by comparison with the
+ * neighbouring edges, so no sorting is needed.  Large inputs are split
+ * over the thread pool, every task adding to a histogram of its own,
+ * which are summed at the end.
+ */
+
+#define HIST_BLOCK 1024
+#define HIST_PARALLEL_MIN 32768
+
+/* How the bins are summed */
+enum {
+    HIST_COUNT,     /* npy_intp counts, no weights */
+    HIST_LONGLONG,  /* npy_longlong sums of integer weights */
+    HIST_DOUBLE,    /* double sums */
+    HIST_CDOUBLE    /* npy_cdouble sums */
+};
+
+/* How the values on the last edge are found by histogramdd */
+enum {
+    HIST_ROUND_NONE,
+    HIST_ROUND_DOUBLE,
+    HIST_ROUND_FLOAT,
+    HIST_ROUND_INT
+};
+
+typedef struct {
+    const double *edges;
+    npy_intp nedges;
+    /* if uniform the bin of x is about (x - edges[0]) * scale */
+    int uniform;
+    double scale;
+    /*
+     * histogramdd moves values that numpy.around(x, decimals) rounds to
+     * the rounded last edge one bin to the left
+     */
+    int round;
+    int decimals;
+    double last;
+} hist_edges;
+
+typedef struct {
+    /* the values, ndim columns of n elements of xsize bytes each */
+    int ndim;
+    npy_intp n;
+    const char *x[NPY_MAXDIMS];
+    npy_intp xsize;
+    PyArray_VectorUnaryFunc *xcast;
+    /* edges of every dimension, bincount has none */
+    hist_edges *edges;
+    npy_intp strides[NPY_MAXDIMS];
+    /* histogramdd has outlier bins, histogram drops the outliers */
+    int outliers;
+    /* the weights, NULL if none */
+    const char *w;
+    npy_intp wsize;
+    PyArray_VectorUnaryFunc *wcast;
+    int kind;
+    npy_intp nbins;
+    char **hists;
+    npy_intp ntasks;
+} hist_info;
+
+/* As power_of_ten in multiarray/calculation.c */
+static double
+hist_power_of_ten(int n)
 {
-    npy_intp i;
+    static const double p10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8};
+    double ret;
 
-    for ( i = lbins - 1; i >= 0; i -- ) {
-        if (x < bins [i]) {
-            return i + 1;
+    if (n < 9) {
+        ret = p10[n];
+    }
+    else {
+        ret = 1e9;
+        while (n-- > 9) {
+            ret *= 10.;
         }
     }
-    return 0;
+    return ret;
 }
 
-static npy_intp
-incr_slot_right_(double x, double *bins, npy_intp lbins)
+/* Rounds to the nearest integer, halfway cases to even */
+static double
+hist_rint(double x)
 {
-    npy_intp i;
+    double y = floor(x), r = x - y;
 
-    for ( i = 0; i < lbins; i ++ ) {
-        if ( x <= bins [i] ) {
-            return i;
+    if (r > 0.5 || (r == 0.5 && y - 2.0 * floor(0.5 * y) == 1.0)) {
+        y += 1.0;
+    }
+    return y;
+}
+
+/*
+ * numpy.around(x, decimals) for a value of the given rounding kind, which
+ * is computed in the precision of its type.
+ */
+static double
+hist_round(double x, int round, int decimals)
+{
+    const double f = hist_power_of_ten(decimals >= 0 ? decimals : -decimals);
+
+    if (round == HIST_ROUND_FLOAT) {
+        const float ff = (float)f;
+        float y;
+
+        if (decimals >= 0) {
+            y = (float)hist_rint((float)x * ff);
+            return (float)(y / ff);
         }
+        y = (float)hist_rint((float)x / ff);
+        return (float)(y * ff);
     }
-    return lbins;
+    if (decimals >= 0) {
+        return round == HIST_ROUND_INT ? x : hist_rint(x * f) / f;
+    }
+    return hist_rint(x / f) * f;
 }
 
-static npy_intp
-decr_slot_right_(double x, double * bins, npy_intp lbins)
+static void
+hist_edges_init(hist_edges *e, const double *edges, npy_intp nedges)
 {
     npy_intp i;
 
-    for ( i = lbins - 1; i >= 0; i -- ) {
-        if (x <= bins [i]) {
-            return i + 1;
+    e->edges = edges;
+    e->nedges = nedges;
+    e->uniform = 0;
+    e->round = HIST_ROUND_NONE;
+    if (nedges < 2 || !npy_isfinite(edges[0]) ||
+            !npy_isfinite(edges[nedges - 1]) ||
+            !(edges[nedges - 1] > edges[0])) {
+        return;
+    }
+    /* a guess less than a quarter bin off is corrected in one step */
+    e->scale = (nedges - 1) / (edges[nedges - 1] - edges[0]);
+    for (i = 1; i < nedges - 1; i++) {
+        double guess = (edges[i] - edges[0]) * e->scale;
+
+        if (!(fabs(guess - i) <= 0.25)) {
+            return;
         }
     }
-    return 0;
+    e->uniform = 1;
 }
 
-/**
- * Returns -1 if the array is monotonic decreasing,
- * +1 if the array is monotonic increasing,
- * and 0 if the array is not monotonic.
+/* The number of edges <= x, as digitize; nans are beyond all edges */
+static NPY_INLINE npy_intp
+hist_digitize(const hist_edges *e, double x)
+{
+    const double *edges = e->edges;
+    const npy_intp n = e->nedges;
+    npy_intp lo, hi;
+
+    if (!(x < edges[n - 1])) {
+        return n;
+    }
+    if (x < edges[0]) {
+        return 0;
+    }
+    if (e->uniform) {
+        lo = (npy_intp)((x - edges[0]) * e->scale);
+        if (lo > n - 2) {
+            lo = n - 2;
+        }
+        while (x < edges[lo]) {
+            lo--;
+        }
+        while (x >= edges[lo + 1]) {
+            lo++;
+        }
+        return lo + 1;
+    }
+    /* edges[lo] <= x < edges[hi] */
+    lo = 0;
+    hi = n - 1;
+    while (hi - lo > 1) {
+        const npy_intp mid = lo + ((hi - lo) >> 1);
+
+        if (x < edges[mid]) {
+            hi = mid;
+        }
+        else {
+            lo = mid;
+        }
+    }
+    return hi;
+}
+
+/* Elements i .. i+n of a column, converted into buf if needed */
+static NPY_INLINE const void *
+hist_load(const char *data, npy_intp size, PyArray_VectorUnaryFunc *cast,
+          npy_intp i, npy_intp n, void *buf)
+{
+    if (cast == NULL) {
+        return data + i * size;
+    }
+    cast((void *)(data + i * size), buf, n, NULL, NULL);
+    return buf;
+}
+
+/*
+ * The bins of the values i .. i+n in the flattened histogram, -1 for
+ * values outside of all bins.
  */
-static int
-check_array_monotonic(double * a, int lena)
+static void
+hist_block_bins(const hist_info *h, npy_intp i, npy_intp n, npy_intp *bins)
 {
-    int i;
+    double buf[HIST_BLOCK];
+    npy_intp k;
+    int d;
 
-    if (a [0] <= a [1]) {
-        /* possibly monotonic increasing */
-        for (i = 1; i < lena - 1; i ++) {
-            if (a [i] > a [i + 1]) {
-                return 0;
+    if (h->edges == NULL) {
+        const npy_intp *x = hist_load(h->x[0], h->xsize, h->xcast, i, n, buf);
+
+        memcpy(bins, x, n * sizeof(npy_intp));
+        return;
+    }
+    if (!h->outliers) {
+        /* histogram, the last bin includes its right edge */
+        const hist_edges *e = &h->edges[0];
+        const double *x = hist_load(h->x[0], h->xsize, h->xcast, i, n, buf);
+        const npy_intp nedges = e->nedges;
+
+        for (k = 0; k < n; k++) {
+            const npy_intp j = hist_digitize(e, x[k]);
+
+            if (j >= 1 && j < nedges) {
+                bins[k] = j - 1;
+            }
+            else if (j == nedges && x[k] == e->edges[nedges - 1]) {
+                bins[k] = nedges - 2;
+            }
+            else {
+                bins[k] = -1;
             }
         }
-        return 1;
+        return;
     }
-    else {
-        /* possibly monotonic decreasing */
-        for (i = 1; i < lena - 1; i ++) {
-            if (a [i] < a [i + 1]) {
-                return 0;
+    /* histogramdd, with outlier bins at both ends of every dimension */
+    memset(bins, 0, n * sizeof(npy_intp));
+    for (d = 0; d < h->ndim; d++) {
+        const hist_edges *e = &h->edges[d];
+        const double *x = hist_load(h->x[d], h->xsize, h->xcast, i, n, buf);
+        const npy_intp stride = h->strides[d];
+
+        for (k = 0; k < n; k++) {
+            npy_intp j = hist_digitize(e, x[k]);
+
+            /* only values beyond the last but one edge can round to it */
+            if (e->round != HIST_ROUND_NONE && j >= e->nedges - 1 &&
+                    hist_round(x[k], e->round, e->decimals) == e->last) {
+                j--;
             }
+            bins[k] += j * stride;
         }
-        return -1;
     }
 }
 
+/* Adds the weights of the values i .. i+n to their bins of hist */
+static void
+hist_block_add(const hist_info *h, npy_intp i, npy_intp n,
+               const npy_intp *bins, char *hist)
+{
+    npy_cdouble buf[HIST_BLOCK];
+    npy_intp k;
 
+    switch (h->kind) {
+        case HIST_COUNT: {
+            npy_intp *out = (npy_intp *)hist;
 
-/* find the index of the maximum element of an integer array */
-static npy_intp
-mxx (npy_intp *i , npy_intp len)
+            for (k = 0; k < n; k++) {
+                if (bins[k] >= 0) {
+                    out[bins[k]]++;
+                }
+            }
+            break;
+        }
+        case HIST_LONGLONG: {
+            npy_longlong *out = (npy_longlong *)hist;
+            const npy_longlong *w = hist_load(h->w, h->wsize, h->wcast,
+                                              i, n, buf);
+
+            for (k = 0; k < n; k++) {
+                if (bins[k] >= 0) {
+                    out[bins[k]] += w[k];
+                }
+            }
+            break;
+        }
+        case HIST_DOUBLE: {
+            double *out = (double *)hist;
+            const double *w = hist_load(h->w, h->wsize, h->wcast, i, n, buf);
+
+            for (k = 0; k < n; k++) {
+                if (bins[k] >= 0) {
+                    out[bins[k]] += w[k];
+                }
+            }
+            break;
+        }
+        case HIST_CDOUBLE: {
+            npy_cdouble *out = (npy_cdouble *)hist;
+            const npy_cdouble *w = hist_load(h->w, h->wsize, h->wcast,
+                                             i, n, buf);
+
+            for (k = 0; k < n; k++) {
+                if (bins[k] >= 0) {
+                    out[bins[k]].real += w[k].real;
+                    out[bins[k]].imag += w[k].imag;
+                }
+            }
+            break;
+        }
+    }
+}
+
+static void
+hist_task(void *data, npy_intp itask)
+{
+    const hist_info *h = (const hist_info *)data;
+    const npy_intp chunk = h->n / h->ntasks, rest = h->n % h->ntasks;
+    const npy_intp start = itask * chunk + PyArray_MIN(itask, rest);
+    const npy_intp stop = start + chunk + (itask < rest);
+    npy_intp bins[HIST_BLOCK];
+    npy_intp i;
+
+    for (i = start; i < stop; i += HIST_BLOCK) {
+        const npy_intp n = PyArray_MIN(HIST_BLOCK, stop - i);
+
+        hist_block_bins(h, i, n, bins);
+        hist_block_add(h, i, n, bins, h->hists[itask]);
+    }
+}
+
+/* The type of the result of the given summation kind */
+static int
+hist_kind_type(int kind)
 {
-    npy_intp mx = 0, max = i[0];
-    npy_intp j;
+    switch (kind) {
+        case HIST_COUNT:
+            return NPY_INTP;
+        case HIST_LONGLONG:
+            return NPY_LONGLONG;
+        case HIST_DOUBLE:
+            return NPY_DOUBLE;
+        default:
+            return NPY_CDOUBLE;
+    }
+}
 
-    for ( j = 1; j < len; j ++ ) {
-        if ( i [j] > max ) {
-            max = i [j];
-            mx = j;
+/*
+ * Returns the histogram of nbins bins of the values described by h, of
+ * the type of h->kind.
+ */
+static PyArrayObject *
+hist_run(hist_info *h)
+{
+    PyArrayObject *ret;
+    npy_intp ntasks, itemsize, t, i;
+    char *hists[2 * NPY_MAXDIMS];
+    char **phists = hists;
+    NPY_BEGIN_THREADS_DEF;
+
+    ret = (PyArrayObject *)PyArray_ZEROS(1, &h->nbins,
+                                         hist_kind_type(h->kind), 0);
+    if (ret == NULL) {
+        return NULL;
+    }
+    itemsize = PyArray_ITEMSIZE(ret);
+    ntasks = PyArray_ParallelTaskCount(h->n, HIST_PARALLEL_MIN);
+    /* a histogram per task only pays if it is smaller than its values */
+    ntasks = PyArray_MAX(1, PyArray_MIN(ntasks, h->n / h->nbins));
+    if (ntasks > 2 * NPY_MAXDIMS) {
+        phists = malloc(ntasks * sizeof(char *));
+        if (phists == NULL) {
+            Py_DECREF(ret);
+            return (PyArrayObject *)PyErr_NoMemory();
+        }
+    }
+    /* the first task adds to the result */
+    phists[0] = PyArray_DATA(ret);
+    for (t = 1; t < ntasks; t++) {
+        phists[t] = calloc(h->nbins, itemsize);
+        if (phists[t] == NULL) {
+            break;
+        }
+    }
+    if (t < ntasks) {
+        while (--t > 0) {
+            free(phists[t]);
+        }
+        if (phists != hists) {
+            free(phists);
         }
+        Py_DECREF(ret);
+        return (PyArrayObject *)PyErr_NoMemory();
     }
-    return mx;
+    h->hists = phists;
+    h->ntasks = ntasks;
+
+    NPY_BEGIN_THREADS;
+    PyArray_ParallelRun(&hist_task, h, ntasks);
+    for (t = 1; t < ntasks; t++) {
+        if (h->kind == HIST_COUNT) {
+            npy_intp *out = (npy_intp *)phists[0];
+            const npy_intp *in = (const npy_intp *)phists[t];
+
+            for (i = 0; i < h->nbins; i++) {
+                out[i] += in[i];
+            }
+        }
+        else if (h->kind == HIST_LONGLONG) {
+            npy_longlong *out = (npy_longlong *)phists[0];
+            const npy_longlong *in = (const npy_longlong *)phists[t];
+
+            for (i = 0; i < h->nbins; i++) {
+                out[i] += in[i];
+            }
+        }
+        else {
+            double *out = (double *)phists[0];
+            const double *in = (const double *)phists[t];
+            const npy_intp n = h->nbins * (h->kind == HIST_CDOUBLE ? 2 : 1);
+
+            for (i = 0; i < n; i++) {
+                out[i] += in[i];
+            }
+        }
+        free(phists[t]);
+    }
+    NPY_END_THREADS;
+    if (phists != hists) {
+        free(phists);
+    }
+    return ret;
 }
 
-/* find the index of the minimum element of an integer array */
-static npy_intp
-mnx (npy_intp *i , npy_intp len)
+/*
+ * obj as an aligned array of at most maxdim dimensions in native byte
+ * order, contiguous as given by requirements.
+ */
+static PyArrayObject *
+hist_array(PyObject *obj, int maxdim, int requirements)
 {
-    npy_intp mn = 0, min = i [0];
-    npy_intp j;
-
-    for ( j = 1; j < len; j ++ )
-        if ( i [j] < min )
-            {min = i [j];
-                mn = j;}
-    return mn;
+    PyArrayObject *arr, *ret;
+    PyArray_Descr *descr;
+
+    arr = (PyArrayObject *)PyArray_FromAny(obj, NULL, 0, maxdim, 0, NULL);
+    if (arr == NULL) {
+        return NULL;
+    }
+    descr = PyArray_DESCR(arr);
+    if (PyArray_ISNBO(descr->byteorder)) {
+        Py_INCREF(descr);
+    }
+    else {
+        descr = PyArray_DescrNewByteorder(descr, NPY_NATIVE);
+        if (descr == NULL) {
+            Py_DECREF(arr);
+            return NULL;
+        }
+    }
+    ret = (PyArrayObject *)PyArray_FromArray(arr, descr,
+                                        requirements | NPY_ARRAY_ALIGNED);
+    Py_DECREF(arr);
+    return ret;
+}
+
+/* Whether values of the type can be binned as double */
+static int
+hist_check_type(PyArrayObject *arr)
+{
+    const int type = PyArray_TYPE(arr);
+
+    if (type == NPY_BOOL || PyTypeNum_ISINTEGER(type) ||
+            (PyTypeNum_ISFLOAT(type) && type != NPY_LONGDOUBLE)) {
+        return 0;
+    }
+    PyErr_SetString(PyExc_TypeError, "unsupported type for histograms");
+    return -1;
+}
+
+/* Sets up reading the values arr as type_num, Returns -1 on failure */
+static int
+hist_set_values(hist_info *h, PyArrayObject *arr, int type_num)
+{
+    h->xsize = PyArray_ITEMSIZE(arr);
+    h->xcast = NULL;
+    if (PyArray_TYPE(arr) != type_num &&
+            !(PyArray_ITEMSIZE(arr) == sizeof(npy_intp) &&
+              PyArray_ISSIGNED(arr) && type_num == NPY_INTP)) {
+        h->xcast = PyArray_GetCastFunc(PyArray_DESCR(arr), type_num);
+        if (h->xcast == NULL) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Returns the weights obj of n values as an array that h reads, and sets
+ * how they are summed.  Integer weights are summed as npy_longlong if
+ * exact is set, as double otherwise.  Complex weights are summed as
+ * npy_cdouble, and other types converted to double.
+ */
+static PyArrayObject *
+hist_set_weights(hist_info *h, PyObject *obj, npy_intp n, int exact)
+{
+    PyArrayObject *w;
+    int type, sumtype;
+
+    w = hist_array(obj, 1, NPY_ARRAY_C_CONTIGUOUS);
+    if (w == NULL) {
+        return NULL;
+    }
+    type = PyArray_TYPE(w);
+    if (type == NPY_BOOL || PyTypeNum_ISINTEGER(type)) {
+        h->kind = exact ? HIST_LONGLONG : HIST_DOUBLE;
+    }
+    else if (type == NPY_CFLOAT || type == NPY_CDOUBLE) {
+        h->kind = HIST_CDOUBLE;
+    }
+    else {
+        h->kind = HIST_DOUBLE;
+        if (!PyTypeNum_ISFLOAT(type) || type == NPY_LONGDOUBLE) {
+            Py_DECREF(w);
+            w = (PyArrayObject *)PyArray_ContiguousFromAny(obj, NPY_DOUBLE,
+                                                            1, 1);
+            if (w == NULL) {
+                return NULL;
+            }
+            type = NPY_DOUBLE;
+        }
+    }
+    if (PyArray_NDIM(w) != 1 || PyArray_SIZE(w) != n) {
+        PyErr_SetString(PyExc_ValueError,
+                "The weights and list don't have the same length.");
+        Py_DECREF(w);
+        return NULL;
+    }
+    sumtype = hist_kind_type(h->kind);
+    h->w = PyArray_BYTES(w);
+    h->wsize = PyArray_ITEMSIZE(w);
+    h->wcast = NULL;
+    if (type != sumtype && !(sumtype == NPY_LONGLONG &&
+                PyArray_ITEMSIZE(w) == sizeof(npy_longlong) &&
+                PyArray_ISSIGNED(w))) {
+        h->wcast = PyArray_GetCastFunc(PyArray_DESCR(w), sumtype);
+        if (h->wcast == NULL) {
+            Py_DECREF(w);
+            return NULL;
+        }
+    }
+    return w;
 }
 
 
@@ -128,36 +611,43 @@ mnx (npy_intp *i , npy_intp len)
  *
  * bincount accepts one, two or three arguments. The first is an array of
  * non-negative integers The second, if present, is an array of weights,
- * which must be promotable to double. Call these arguments list and
- * weight. Both must be one-dimensional with len(weight) == len(list). If
- * weight is not present then bincount(list)[i] is the number of occurrences
- * of i in list.  If weight is present then bincount(self,list, weight)[i]
- * is the sum of all weight[j] where list [j] == i.  Self is not used.
- * The third argument, if present, is a minimum length desired for the
- * output array.
+ * which are summed as complex numbers if complex, and as doubles otherwise.
+ * Call these arguments list and weight. Both must be one-dimensional with
+ * len(weight) == len(list). If weight is not present then
+ * bincount(list)[i] is the number of occurrences of i in list.  If weight
+ * is present then bincount(self,list, weight)[i] is the sum of all
+ * weight[j] where list [j] == i.  Self is not used.  The third argument,
+ * if present, is a minimum length desired for the output array.
  */
 static PyObject *
 arr_bincount(PyObject *NPY_UNUSED(self), PyObject *args, PyObject *kwds)
 {
-    PyArray_Descr *type;
     PyObject *list = NULL, *weight=Py_None, *mlength=Py_None;
     PyArrayObject *lst=NULL, *ans=NULL, *wts=NULL;
-    npy_intp *numbers, *ians, len , mxi, mni, ans_size, minlength;
-    int i;
-    double *weights , *dans;
+    npy_intp len, mx, mn, i, ans_size, minlength;
     static char *kwlist[] = {"list", "weights", "minlength", NULL};
+    hist_info h;
 
     if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|OO",
                 kwlist, &list, &weight, &mlength)) {
             goto fail;
     }
 
-    lst = (PyArrayObject *)PyArray_ContiguousFromAny(list, NPY_INTP, 1, 1);
+    lst = hist_array(list, 1, NPY_ARRAY_C_CONTIGUOUS);
     if (lst == NULL) {
         goto fail;
     }
+    if (PyArray_NDIM(lst) != 1 ||
+            !PyArray_CanCastSafely(PyArray_TYPE(lst), NPY_INTP)) {
+        /* raises the error of the conversion */
+        Py_DECREF(lst);
+        lst = (PyArrayObject *)PyArray_ContiguousFromAny(list, NPY_INTP,
+                                                          1, 1);
+        if (lst == NULL) {
+            goto fail;
+        }
+    }
     len = PyArray_SIZE(lst);
-    type = PyArray_DescrFromType(NPY_INTP);
 
     /* handle empty list */
     if (len < 1) {
@@ -167,22 +657,43 @@ arr_bincount(PyObject *NPY_UNUSED(self), PyObject *args, PyObject *kwds)
         else if (!(minlength = PyArray_PyIntAsIntp(mlength))) {
             goto fail;
         }
-        if (!(ans = (PyArrayObject *)PyArray_Zeros(1, &minlength, type, 0))){
+        if (!(ans = (PyArrayObject *)PyArray_ZEROS(1, &minlength,
+                                                   NPY_INTP, 0))) {
             goto fail;
         }
         Py_DECREF(lst);
         return (PyObject *)ans;
     }
 
-    numbers = (npy_intp *) PyArray_DATA(lst);
-    mxi = mxx(numbers, len);
-    mni = mnx(numbers, len);
-    if (numbers[mni] < 0) {
+    memset(&h, 0, sizeof(h));
+    h.ndim = 1;
+    h.n = len;
+    h.x[0] = PyArray_BYTES(lst);
+    if (hist_set_values(&h, lst, NPY_INTP) < 0) {
+        goto fail;
+    }
+    mn = NPY_MAX_INTP;
+    mx = 0;
+    for (i = 0; i < len; i += HIST_BLOCK) {
+        npy_intp buf[HIST_BLOCK], k;
+        const npy_intp n = PyArray_MIN(HIST_BLOCK, len - i);
+        const npy_intp *x = hist_load(h.x[0], h.xsize, h.xcast, i, n, buf);
+
+        for (k = 0; k < n; k++) {
+            if (x[k] < mn) {
+                mn = x[k];
+            }
+            if (x[k] > mx) {
+                mx = x[k];
+            }
+        }
+    }
+    if (mn < 0) {
         PyErr_SetString(PyExc_ValueError,
                 "The first argument of bincount must be non-negative");
         goto fail;
     }
-    ans_size = numbers [mxi] + 1;
+    ans_size = mx + 1;
     if (mlength != Py_None) {
         if (!(minlength = PyArray_PyIntAsIntp(mlength))) {
             goto fail;
@@ -197,44 +708,17 @@ arr_bincount(PyObject *NPY_UNUSED(self), PyObject *args, PyObject *kwds)
             ans_size = minlength;
         }
     }
-    if (weight == Py_None) {
-        ans = (PyArrayObject *)PyArray_Zeros(1, &ans_size, type, 0);
-        if (ans == NULL) {
-            goto fail;
-        }
-        ians = (npy_intp *)(PyArray_DATA(ans));
-        NPY_BEGIN_ALLOW_THREADS;
-        for (i = 0; i < len; i++)
-            ians [numbers [i]] += 1;
-        NPY_END_ALLOW_THREADS;
-        Py_DECREF(lst);
-    }
-    else {
-        wts = (PyArrayObject *)PyArray_ContiguousFromAny(
-                                                weight, NPY_DOUBLE, 1, 1);
+    h.nbins = ans_size;
+    h.kind = HIST_COUNT;
+    if (weight != Py_None) {
+        wts = hist_set_weights(&h, weight, len, 0);
         if (wts == NULL) {
             goto fail;
         }
-        weights = (double *)PyArray_DATA (wts);
-        if (PyArray_SIZE(wts) != len) {
-            PyErr_SetString(PyExc_ValueError,
-                    "The weights and list don't have the same length.");
-            goto fail;
-        }
-        type = PyArray_DescrFromType(NPY_DOUBLE);
-        ans = (PyArrayObject *)PyArray_Zeros(1, &ans_size, type, 0);
-        if (ans == NULL) {
-            goto fail;
-        }
-        dans = (double *)PyArray_DATA(ans);
-        NPY_BEGIN_ALLOW_THREADS;
-        for (i = 0; i < len; i++) {
-            dans[numbers[i]] += weights[i];
-        }
-        NPY_END_ALLOW_THREADS;
-        Py_DECREF(lst);
-        Py_DECREF(wts);
     }
+    ans = hist_run(&h);
+    Py_DECREF(lst);
+    Py_XDECREF(wts);
     return (PyObject *)ans;
 
 fail:
@@ -245,6 +729,207 @@ fail:
 }
 
 
+/*
+ * _histogram(a, edges, weights=None) returns the histogram of the values
+ * of the flattened a in the bins between the increasing edges, the last
+ * of which includes its right edge, ignoring the values outside of them.
+ * The counts are npy_intp, integer weights are summed as npy_longlong,
+ * complex weights as npy_cdouble and others as double.
+ */
+static PyObject *
+arr_histogram(PyObject *NPY_UNUSED(self), PyObject *args, PyObject *kwds)
+{
+    PyObject *oa, *oedges, *oweights = Py_None;
+    PyArrayObject *a = NULL, *edges = NULL, *weights = NULL, *ret = NULL;
+    static char *kwlist[] = {"a", "edges", "weights", NULL};
+    hist_edges e;
+    hist_info h;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OO|O", kwlist, &oa,
+                &oedges, &oweights)) {
+        return NULL;
+    }
+    a = hist_array(oa, 0, NPY_ARRAY_C_CONTIGUOUS);
+    if (a == NULL || hist_check_type(a) < 0) {
+        goto finish;
+    }
+    edges = (PyArrayObject *)PyArray_ContiguousFromAny(oedges, NPY_DOUBLE,
+                                                       1, 1);
+    if (edges == NULL) {
+        goto finish;
+    }
+    if (PyArray_SIZE(edges) < 2) {
+        PyErr_SetString(PyExc_ValueError, "at least two edges are needed");
+        goto finish;
+    }
+
+    memset(&h, 0, sizeof(h));
+    hist_edges_init(&e, (const double *)PyArray_DATA(edges),
+                    PyArray_SIZE(edges));
+    h.ndim = 1;
+    h.n = PyArray_SIZE(a);
+    h.x[0] = PyArray_BYTES(a);
+    h.edges = &e;
+    h.nbins = PyArray_SIZE(edges) - 1;
+    h.kind = HIST_COUNT;
+    if (hist_set_values(&h, a, NPY_DOUBLE) < 0) {
+        goto finish;
+    }
+    if (oweights != Py_None) {
+        weights = hist_set_weights(&h, oweights, h.n, 1);
+        if (weights == NULL) {
+            goto finish;
+        }
+    }
+    ret = hist_run(&h);
+
+finish:
+    Py_XDECREF(a);
+    Py_XDECREF(edges);
+    Py_XDECREF(weights);
+    return (PyObject *)ret;
+}
+
+
+/*
+ * _histogramdd(sample, edges, decimals, weights=None) returns the
+ * flattened histogram of the (N, D) sample in bins between the edges of
+ * every dimension, with outlier bins at both ends, so that its shape is
+ * len(edges[i]) + 1 for every dimension i.  Values are binned as by
+ * digitize, except that those which numpy.around(x, decimals[i]) rounds to
+ * the rounded last edge are moved one bin to the left, unless
+ * decimals[i] is None.  Weights are summed as double, or npy_cdouble if
+ * complex, and counts as npy_intp.
+ */
+static PyObject *
+arr_histogramdd(PyObject *NPY_UNUSED(self), PyObject *args, PyObject *kwds)
+{
+    PyObject *osample, *oedges, *odecimals, *oweights = Py_None;
+    PyArrayObject *sample = NULL, *weights = NULL, *ret = NULL;
+    PyArrayObject *edges[NPY_MAXDIMS];
+    static char *kwlist[] = {"sample", "edges", "decimals", "weights", NULL};
+    hist_edges e[NPY_MAXDIMS];
+    hist_info h;
+    npy_intp D = 0, d, nbins = 1;
+    int round;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOO|O", kwlist, &osample,
+                &oedges, &odecimals, &oweights)) {
+        return NULL;
+    }
+    /* the columns of a Fortran array are contiguous */
+    sample = hist_array(osample, 2, NPY_ARRAY_F_CONTIGUOUS);
+    if (sample == NULL || hist_check_type(sample) < 0) {
+        goto finish;
+    }
+    if (PyArray_NDIM(sample) != 2 || PyArray_DIM(sample, 1) > NPY_MAXDIMS ||
+            PySequence_Size(oedges) != PyArray_DIM(sample, 1) ||
+            PySequence_Size(odecimals) != PyArray_DIM(sample, 1)) {
+        if (!PyErr_Occurred()) {
+            PyErr_Format(PyExc_ValueError,
+                    "expected an (N, D) sample, with D <= %d, and D edges "
+                    "and decimals", NPY_MAXDIMS);
+        }
+        goto finish;
+    }
+    switch (PyArray_TYPE(sample)) {
+        case NPY_DOUBLE:
+            round = HIST_ROUND_DOUBLE;
+            break;
+        case NPY_FLOAT:
+            round = HIST_ROUND_FLOAT;
+            break;
+        default:
+            /* smaller integers are compared with the edges as floats */
+            round = PyArray_ISINTEGER(sample) &&
+                    PyArray_ITEMSIZE(sample) >= 4 ? HIST_ROUND_INT : -1;
+    }
+    if (round < 0) {
+        PyErr_SetString(PyExc_TypeError, "unsupported type for histograms");
+        goto finish;
+    }
+
+    memset(&h, 0, sizeof(h));
+    for (d = 0; d < PyArray_DIM(sample, 1); d++) {
+        PyObject *item = PySequence_GetItem(oedges, d);
+        npy_intp nedges;
+
+        if (item == NULL) {
+            goto finish;
+        }
+        edges[d] = (PyArrayObject *)PyArray_ContiguousFromAny(item,
+                                                    NPY_DOUBLE, 1, 1);
+        Py_DECREF(item);
+        if (edges[d] == NULL) {
+            goto finish;
+        }
+        /* the number of edges to release */
+        D++;
+        nedges = PyArray_SIZE(edges[d]);
+        if (nedges < 1) {
+            PyErr_SetString(PyExc_ValueError, "at least one edge is needed");
+            goto finish;
+        }
+        hist_edges_init(&e[d], (const double *)PyArray_DATA(edges[d]),
+                        nedges);
+        item = PySequence_GetItem(odecimals, d);
+        if (item == NULL) {
+            goto finish;
+        }
+        if (item != Py_None) {
+            e[d].decimals = PyInt_AsLong(item);
+            if (e[d].decimals == -1 && PyErr_Occurred()) {
+                Py_DECREF(item);
+                goto finish;
+            }
+            e[d].round = round;
+            e[d].last = hist_round(e[d].edges[nedges - 1],
+                                   HIST_ROUND_DOUBLE, e[d].decimals);
+            /* float samples are compared with it as floats */
+            if (round == HIST_ROUND_FLOAT && fabs(e[d].last) <= FLT_MAX) {
+                e[d].last = (float)e[d].last;
+            }
+        }
+        Py_DECREF(item);
+    }
+    /* C order, with an outlier bin on both sides */
+    for (d = D - 1; d >= 0; d--) {
+        h.strides[d] = nbins;
+        if (nbins > NPY_MAX_INTP / (e[d].nedges + 1)) {
+            PyErr_SetString(PyExc_ValueError, "too many bins");
+            goto finish;
+        }
+        nbins *= e[d].nedges + 1;
+        h.x[d] = PyArray_BYTES(sample) + d * PyArray_STRIDE(sample, 1);
+    }
+
+    h.ndim = D;
+    h.n = PyArray_DIM(sample, 0);
+    h.edges = e;
+    h.outliers = 1;
+    h.nbins = nbins;
+    h.kind = HIST_COUNT;
+    if (hist_set_values(&h, sample, NPY_DOUBLE) < 0) {
+        goto finish;
+    }
+    if (oweights != Py_None) {
+        weights = hist_set_weights(&h, oweights, h.n, 0);
+        if (weights == NULL) {
+            goto finish;
+        }
+    }
+    ret = hist_run(&h);
+
+finish:
+    Py_XDECREF(sample);
+    Py_XDECREF(weights);
+    for (d = 0; d < D; d++) {
+        Py_DECREF(edges[d]);
+    }
+    return (PyObject *)ret;
+}
+
+
 /*
  * digitize (x, bins, right=False) returns an array of python integers the same
  * length of x. The values i returned are such that bins [i - 1] <= x <
@@ -260,14 +945,14 @@ arr_digitize(PyObject *NPY_UNUSED(self), PyObject *args, PyObject *kwds)
     /* self is not used */
     PyObject *ox, *obins;
     PyArrayObject *ax = NULL, *abins = NULL, *aret = NULL;
-    double *dx, *dbins;
+    double *dbins;
     npy_intp lbins, lx;             /* lengths */
     npy_intp right = 0; /* whether right or left is inclusive */
     npy_intp *iret;
-    int m, i;
+    npy_intp i;
+    int m;
     static char *kwlist[] = {"x", "bins", "right", NULL};
     PyArray_Descr *type;
-    char bins_non_monotonic = 0;
 
     if (!PyArg_ParseTupleAndKeywords(args, kwds, "OO|i", kwlist, &ox, &obins,
                 &right)) {
@@ -287,100 +972,547 @@ arr_digitize(PyObject *NPY_UNUSED(self), PyObject *args, PyObject *kwds)
     }
 
     lx = PyArray_SIZE(ax);
-    dx = (double *)PyArray_DATA(ax);
     lbins = PyArray_SIZE(abins);
     dbins = (double *)PyArray_DATA(abins);
-    aret = (PyArrayObject *)PyArray_SimpleNew(1, &lx, NPY_INTP);
-    if (aret == NULL) {
-        goto fail;
-    }
-    iret = (npy_intp *)PyArray_DATA(aret);
 
     if (lx <= 0 || lbins < 0) {
         PyErr_SetString(PyExc_ValueError,
                 "Both x and bins must have non-zero length");
             goto fail;
     }
-    NPY_BEGIN_ALLOW_THREADS;
-    if (lbins == 1)  {
-        if (right == 0) {
-            for (i = 0; i < lx; i++) {
-                if (dx [i] >= dbins[0]) {
-                    iret[i] = 1;
-                }
-                else {
-                    iret[i] = 0;
-                }
-            }
-        }
-        else {
-            for (i = 0; i < lx; i++) {
-                if (dx [i] > dbins[0]) {
-                    iret[i] = 1;
-                }
-                else {
-                    iret[i] = 0;
-                }
-            }
+    m = (lbins > 1) ? check_array_monotonic(dbins, lbins) : 1;
+    if (m == 0) {
+        PyErr_SetString(PyExc_ValueError,
+                "The bins must be monotonically increasing or decreasing");
+        goto fail;
+    }
+
+    /*
+     * With increasing bins the result is the number of bins <= x, or
+     * < x if right is set, which is what searchsorted returns for the
+     * right or left side.  Decreasing bins are searched reversed and
+     * the result counted from the other end.
+     */
+    if (m == -1) {
+        PyArrayObject *rbins;
+        double *drbins;
 
+        rbins = (PyArrayObject *)PyArray_SimpleNew(1, &lbins, NPY_DOUBLE);
+        if (rbins == NULL) {
+            goto fail;
+        }
+        drbins = (double *)PyArray_DATA(rbins);
+        for (i = 0; i < lbins; i++) {
+            drbins[i] = dbins[lbins - 1 - i];
         }
+        Py_DECREF(abins);
+        abins = rbins;
     }
-    else {
-        m = check_array_monotonic(dbins, lbins);
-        if (right == 0) {
-            if ( m == -1 ) {
-                for ( i = 0; i < lx; i ++ ) {
-                    iret [i] = decr_slot_ ((double)dx[i], dbins, lbins);
-                }
-            }
-            else if ( m == 1 ) {
-                for ( i = 0; i < lx; i ++ ) {
-                    iret [i] = incr_slot_ ((double)dx[i], dbins, lbins);
-                }
+    aret = (PyArrayObject *)PyArray_SearchSorted(abins, (PyObject *)ax,
+                                   right ? NPY_SEARCHLEFT : NPY_SEARCHRIGHT,
+                                   NULL);
+    if (aret == NULL) {
+        goto fail;
+    }
+    if (m == -1) {
+        iret = (npy_intp *)PyArray_DATA(aret);
+        for (i = 0; i < lx; i++) {
+            iret[i] = lbins - iret[i];
+        }
+    }
+    Py_DECREF(ax);
+    Py_DECREF(abins);
+    return (PyObject *)aret;
+
+fail:
+    Py_XDECREF(ax);
+    Py_XDECREF(abins);
+    Py_XDECREF(aret);
+    return NULL;
+}
+
+
+
+/*
+ * Hash sets for unique and in1d.
+ *
+ * Open addressing with linear probing; a slot holds the index of an
+ * element of the (contiguous) array, -1 if empty, the element itself is
+ * read from the array.  Booleans, integers, datetimes and strings are
+ * equal if their bytes are.  Floats are compared as floats, so that -0.0
+ * equals 0.0, and nans are never equal to anything, like with the sort
+ * based set operations; they are never stored in the table.  Long
+ * doubles can have undefined padding bytes and are not supported.
+ */
+
+enum {
+    HASH_BYTES,
+    HASH_FLOAT,
+    HASH_DOUBLE,
+    HASH_CFLOAT,
+    HASH_CDOUBLE
+};
+
+typedef struct {
+    const char *data;
+    npy_intp itemsize;
+    int kind;
+    npy_intp *slots;
+    /* the number of slots minus one, the number is a power of two */
+    npy_intp mask;
+    npy_intp used;
+} hashset;
+
+/* Returns how elements of the type are hashed, -1 if they can't be */
+static int
+hash_kind(PyArray_Descr *descr)
+{
+    switch (descr->type_num) {
+        case NPY_BOOL:
+        case NPY_BYTE:
+        case NPY_UBYTE:
+        case NPY_SHORT:
+        case NPY_USHORT:
+        case NPY_INT:
+        case NPY_UINT:
+        case NPY_LONG:
+        case NPY_ULONG:
+        case NPY_LONGLONG:
+        case NPY_ULONGLONG:
+        case NPY_DATETIME:
+        case NPY_TIMEDELTA:
+        case NPY_STRING:
+        case NPY_UNICODE:
+            return HASH_BYTES;
+        case NPY_FLOAT:
+            return HASH_FLOAT;
+        case NPY_DOUBLE:
+            return HASH_DOUBLE;
+        case NPY_CFLOAT:
+            return HASH_CFLOAT;
+        case NPY_CDOUBLE:
+            return HASH_CDOUBLE;
+        default:
+            return -1;
+    }
+}
+
+/* The finalizer of MurmurHash3, spreads the bits of h over all bits */
+static NPY_INLINE npy_uint64
+hash_mix(npy_uint64 h)
+{
+    h ^= h >> 33;
+    h *= ((npy_uint64)0xff51afd7 << 32) | 0xed558ccd;
+    h ^= h >> 33;
+    h *= ((npy_uint64)0xc4ceb9fe << 32) | 0x1a85ec53;
+    h ^= h >> 33;
+    return h;
+}
+
+static NPY_INLINE npy_uint64
+hash_double(double v)
+{
+    npy_uint64 u;
+
+    if (v == 0) {
+        /* -0.0 */
+        v = 0;
+    }
+    memcpy(&u, &v, sizeof(u));
+    return u;
+}
+
+static npy_uint64
+hashset_hash(const hashset *s, const char *p)
+{
+    switch (s->kind) {
+        case HASH_FLOAT:
+            return hash_mix(hash_double(*(const npy_float *)p));
+        case HASH_DOUBLE:
+            return hash_mix(hash_double(*(const npy_double *)p));
+        case HASH_CFLOAT:
+            return hash_mix(hash_double(((const npy_float *)p)[0]) ^
+                            hash_mix(hash_double(((const npy_float *)p)[1])));
+        case HASH_CDOUBLE:
+            return hash_mix(hash_double(((const npy_double *)p)[0]) ^
+                            hash_mix(hash_double(((const npy_double *)p)[1])));
+        default: {
+            npy_intp n = s->itemsize;
+            npy_uint64 h = n, chunk;
+
+            for (; n >= 8; n -= 8, p += 8) {
+                memcpy(&chunk, p, 8);
+                h = hash_mix(h ^ chunk);
             }
-            else {
-            /* defer PyErr_SetString until after NPY_END_ALLOW_THREADS */
-                bins_non_monotonic = 1;
+            if (n > 0) {
+                chunk = 0;
+                memcpy(&chunk, p, n);
+                h = hash_mix(h ^ chunk);
             }
+            return h;
         }
-        else {
-            if ( m == -1 ) {
-                for ( i = 0; i < lx; i ++ ) {
-                    iret [i] = decr_slot_right_ ((double)dx[i], dbins,
-                                                                lbins);
-                }
+    }
+}
+
+static NPY_INLINE int
+hashset_equal(const hashset *s, const char *a, const char *b)
+{
+    switch (s->kind) {
+        case HASH_FLOAT:
+            return *(const npy_float *)a == *(const npy_float *)b;
+        case HASH_DOUBLE:
+            return *(const npy_double *)a == *(const npy_double *)b;
+        case HASH_CFLOAT:
+            return ((const npy_float *)a)[0] == ((const npy_float *)b)[0] &&
+                   ((const npy_float *)a)[1] == ((const npy_float *)b)[1];
+        case HASH_CDOUBLE:
+            return ((const npy_double *)a)[0] == ((const npy_double *)b)[0] &&
+                   ((const npy_double *)a)[1] == ((const npy_double *)b)[1];
+        default:
+            return memcmp(a, b, s->itemsize) == 0;
+    }
+}
+
+static NPY_INLINE int
+hashset_isnan(const hashset *s, const char *p)
+{
+    switch (s->kind) {
+        case HASH_FLOAT:
+            return npy_isnan(*(const npy_float *)p);
+        case HASH_DOUBLE:
+            return npy_isnan(*(const npy_double *)p);
+        case HASH_CFLOAT:
+            return npy_isnan(((const npy_float *)p)[0]) ||
+                   npy_isnan(((const npy_float *)p)[1]);
+        case HASH_CDOUBLE:
+            return npy_isnan(((const npy_double *)p)[0]) ||
+                   npy_isnan(((const npy_double *)p)[1]);
+        default:
+            return 0;
+    }
+}
+
+/*
+ * Initializes s for the elements of arr with room for about size / 2
+ * distinct elements before it grows.  Returns -1 if out of memory.
+ */
+static int
+hashset_init(hashset *s, PyArrayObject *arr, int kind, npy_intp size)
+{
+    npy_intp nslots = 16, i;
+
+    while (nslots < size) {
+        nslots <<= 1;
+    }
+    s->data = PyArray_DATA(arr);
+    s->itemsize = PyArray_ITEMSIZE(arr);
+    s->kind = kind;
+    s->mask = nslots - 1;
+    s->used = 0;
+    s->slots = malloc(nslots * sizeof(npy_intp));
+    if (s->slots == NULL) {
+        return -1;
+    }
+    for (i = 0; i < nslots; i++) {
+        s->slots[i] = -1;
+    }
+    return 0;
+}
+
+/*
+ * Returns the slot of the element equal to the one at p, or the empty
+ * slot it goes in.
+ */
+static NPY_INLINE npy_intp
+hashset_lookup(const hashset *s, const char *p)
+{
+    npy_intp j = (npy_intp)(hashset_hash(s, p) & s->mask);
+
+    for (;;) {
+        const npy_intp k = s->slots[j];
+
+        if (k < 0 || hashset_equal(s, s->data + k * s->itemsize, p)) {
+            return j;
+        }
+        j = (j + 1) & s->mask;
+    }
+}
+
+/*
+ * Stores the element i in the empty slot j, doubling the table when it
+ * gets half full.  Returns -1 if out of memory.
+ */
+static int
+hashset_insert(hashset *s, npy_intp j, npy_intp i)
+{
+    npy_intp *old = s->slots;
+    npy_intp oldsize = s->mask + 1, k;
+
+    s->slots[j] = i;
+    if (++s->used * 2 <= oldsize) {
+        return 0;
+    }
+    s->slots = malloc(2 * oldsize * sizeof(npy_intp));
+    if (s->slots == NULL) {
+        s->slots = old;
+        return -1;
+    }
+    s->mask = 2 * oldsize - 1;
+    for (k = 0; k <= s->mask; k++) {
+        s->slots[k] = -1;
+    }
+    for (k = 0; k < oldsize; k++) {
+        if (old[k] >= 0) {
+            s->slots[hashset_lookup(s, s->data + old[k] * s->itemsize)] =
+                                                                    old[k];
+        }
+    }
+    free(old);
+    return 0;
+}
+
+/* Makes the contiguous, native byte order array of obj used by the sets */
+static PyArrayObject *
+hashset_array(PyObject *obj, PyArray_Descr *descr)
+{
+    Py_XINCREF(descr);
+    return (PyArrayObject *)PyArray_CheckFromAny(obj, descr, 0, 0,
+                            NPY_ARRAY_CARRAY_RO | NPY_ARRAY_NOTSWAPPED, NULL);
+}
+
+static int
+hashset_check_type(PyArrayObject *arr)
+{
+    int kind = hash_kind(PyArray_DESCR(arr));
+
+    if (kind < 0) {
+        PyErr_SetString(PyExc_TypeError,
+                "the array type is not supported by the hash set operations");
+    }
+    return kind;
+}
+
+
+/*
+ * _unique_hash(ar, return_inverse=False, return_counts=False) returns
+ * the indices of the first occurrences of the distinct values of the
+ * flattened ar, in the order of their occurrence, and if requested the
+ * index of the distinct value of every element and the number of
+ * occurrences of each, otherwise None.
+ */
+static PyObject *
+arr_unique_hash(PyObject *NPY_UNUSED(self), PyObject *args, PyObject *kwds)
+{
+    PyObject *oar;
+    PyArrayObject *ar = NULL, *inverse = NULL, *first = NULL, *counts = NULL;
+    int return_inverse = 0, return_counts = 0;
+    static char *kwlist[] = {"ar", "return_inverse", "return_counts", NULL};
+    hashset set;
+    npy_intp n, i, nuniq = 0, capacity = 16;
+    npy_intp *pinv, *pfirst = NULL, *pcounts = NULL;
+    int kind, err = 0;
+    PyObject *ret;
+    NPY_BEGIN_THREADS_DEF;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|ii", kwlist, &oar,
+                &return_inverse, &return_counts)) {
+        return NULL;
+    }
+    ar = hashset_array(oar, NULL);
+    if (ar == NULL) {
+        return NULL;
+    }
+    kind = hashset_check_type(ar);
+    if (kind < 0) {
+        goto fail;
+    }
+    n = PyArray_SIZE(ar);
+    /* the inverse finds the distinct value of the elements in the set */
+    inverse = (PyArrayObject *)PyArray_SimpleNew(1, &n, NPY_INTP);
+    if (inverse == NULL) {
+        goto fail;
+    }
+    pinv = (npy_intp *)PyArray_DATA(inverse);
+    if (hashset_init(&set, ar, kind, PyArray_MIN(2 * n, 4096)) < 0) {
+        PyErr_NoMemory();
+        goto fail;
+    }
+
+    NPY_BEGIN_THREADS;
+    pfirst = malloc(capacity * sizeof(npy_intp));
+    pcounts = malloc(capacity * sizeof(npy_intp));
+    if (pfirst == NULL || pcounts == NULL) {
+        err = 1;
+    }
+    for (i = 0; i < n && !err; i++) {
+        const char *p = set.data + i * set.itemsize;
+        npy_intp j = -1;
+
+        if (!hashset_isnan(&set, p)) {
+            j = hashset_lookup(&set, p);
+            if (set.slots[j] >= 0) {
+                const npy_intp u = pinv[set.slots[j]];
+                pinv[i] = u;
+                pcounts[u]++;
+                continue;
             }
-            else if ( m == 1 ) {
-                for ( i = 0; i < lx; i ++ ) {
-                    iret [i] = incr_slot_right_ ((double)dx[i], dbins,
-                                                               lbins);
-                }
+        }
+        if (nuniq == capacity) {
+            npy_intp *tmp;
+
+            capacity *= 2;
+            tmp = realloc(pfirst, capacity * sizeof(npy_intp));
+            if (tmp == NULL) {
+                err = 1;
+                break;
             }
-            else {
-            /* defer PyErr_SetString until after NPY_END_ALLOW_THREADS */
-                bins_non_monotonic = 1;
+            pfirst = tmp;
+            tmp = realloc(pcounts, capacity * sizeof(npy_intp));
+            if (tmp == NULL) {
+                err = 1;
+                break;
             }
-
+            pcounts = tmp;
+        }
+        pfirst[nuniq] = i;
+        pcounts[nuniq] = 1;
+        pinv[i] = nuniq++;
+        if (j >= 0 && hashset_insert(&set, j, i) < 0) {
+            err = 1;
         }
     }
-    NPY_END_ALLOW_THREADS;
-    if (bins_non_monotonic) {
-        PyErr_SetString(PyExc_ValueError,
-                "The bins must be monotonically increasing or decreasing");
+    NPY_END_THREADS;
+    free(set.slots);
+    if (err) {
+        PyErr_NoMemory();
         goto fail;
     }
-    Py_DECREF(ax);
-    Py_DECREF(abins);
-    return (PyObject *)aret;
+
+    first = (PyArrayObject *)PyArray_SimpleNew(1, &nuniq, NPY_INTP);
+    if (first == NULL) {
+        goto fail;
+    }
+    memcpy(PyArray_DATA(first), pfirst, nuniq * sizeof(npy_intp));
+    if (return_counts) {
+        counts = (PyArrayObject *)PyArray_SimpleNew(1, &nuniq, NPY_INTP);
+        if (counts == NULL) {
+            goto fail;
+        }
+        memcpy(PyArray_DATA(counts), pcounts, nuniq * sizeof(npy_intp));
+    }
+    free(pfirst);
+    free(pcounts);
+    Py_DECREF(ar);
+    if (!return_inverse) {
+        Py_DECREF(inverse);
+        inverse = NULL;
+    }
+    ret = Py_BuildValue("NOO", first,
+                        inverse ? (PyObject *)inverse : Py_None,
+                        counts ? (PyObject *)counts : Py_None);
+    Py_XDECREF(inverse);
+    Py_XDECREF(counts);
+    return ret;
 
 fail:
-    Py_XDECREF(ax);
-    Py_XDECREF(abins);
-    Py_XDECREF(aret);
+    free(pfirst);
+    free(pcounts);
+    Py_XDECREF(ar);
+    Py_XDECREF(inverse);
+    Py_XDECREF(first);
+    Py_XDECREF(counts);
     return NULL;
 }
 
 
+/*
+ * _in1d_hash(ar1, ar2, invert=False) returns for every element of the
+ * flattened ar1 whether it is in ar2, or not if invert is set.  Both
+ * arrays must have the same type.
+ */
+static PyObject *
+arr_in1d_hash(PyObject *NPY_UNUSED(self), PyObject *args, PyObject *kwds)
+{
+    PyObject *oar1, *oar2;
+    PyArrayObject *ar1 = NULL, *ar2 = NULL, *ret = NULL;
+    int invert = 0;
+    static char *kwlist[] = {"ar1", "ar2", "invert", NULL};
+    hashset set;
+    npy_intp n1, n2, i;
+    npy_bool *pret;
+    int kind, err = 0;
+    NPY_BEGIN_THREADS_DEF;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OO|i", kwlist, &oar1,
+                &oar2, &invert)) {
+        return NULL;
+    }
+    ar2 = hashset_array(oar2, NULL);
+    if (ar2 == NULL) {
+        return NULL;
+    }
+    ar1 = hashset_array(oar1, NULL);
+    if (ar1 == NULL) {
+        goto fail;
+    }
+    if (!PyArray_EquivTypes(PyArray_DESCR(ar1), PyArray_DESCR(ar2))) {
+        PyErr_SetString(PyExc_TypeError,
+                "the arrays must have the same type");
+        goto fail;
+    }
+    kind = hashset_check_type(ar2);
+    if (kind < 0) {
+        goto fail;
+    }
+    n1 = PyArray_SIZE(ar1);
+    n2 = PyArray_SIZE(ar2);
+    ret = (PyArrayObject *)PyArray_SimpleNew(1, &n1, NPY_BOOL);
+    if (ret == NULL) {
+        goto fail;
+    }
+    pret = (npy_bool *)PyArray_DATA(ret);
+    if (hashset_init(&set, ar2, kind, 2 * n2) < 0) {
+        PyErr_NoMemory();
+        goto fail;
+    }
+
+    NPY_BEGIN_THREADS;
+    for (i = 0; i < n2; i++) {
+        const char *p = set.data + i * set.itemsize;
+
+        if (!hashset_isnan(&set, p)) {
+            npy_intp j = hashset_lookup(&set, p);
+
+            if (set.slots[j] < 0 && hashset_insert(&set, j, i) < 0) {
+                err = 1;
+                break;
+            }
+        }
+    }
+    for (i = 0; i < n1 && !err; i++) {
+        const char *p = PyArray_BYTES(ar1) + i * set.itemsize;
+        int found = !hashset_isnan(&set, p) &&
+                    set.slots[hashset_lookup(&set, p)] >= 0;
+
+        pret[i] = (found != invert);
+    }
+    NPY_END_THREADS;
+    free(set.slots);
+    if (err) {
+        PyErr_NoMemory();
+        goto fail;
+    }
+    Py_DECREF(ar1);
+    Py_DECREF(ar2);
+    return (PyObject *)ret;
+
+fail:
+    Py_XDECREF(ar1);
+    Py_XDECREF(ar2);
+    Py_XDECREF(ret);
+    return NULL;
+}
+
 
 static char arr_insert__doc__[] = "Insert vals sequentially into equivalent 1-d positions indicated by mask.";
 
@@ -1646,8 +2778,16 @@ static struct PyMethodDef methods[] = {
         METH_VARARGS | METH_KEYWORDS, NULL},
     {"digitize", (PyCFunction)arr_digitize,
         METH_VARARGS | METH_KEYWORDS, NULL},
+    {"_histogram", (PyCFunction)arr_histogram,
+        METH_VARARGS | METH_KEYWORDS, NULL},
+    {"_histogramdd", (PyCFunction)arr_histogramdd,
+        METH_VARARGS | METH_KEYWORDS, NULL},
     {"interp", (PyCFunction)arr_interp,
         METH_VARARGS | METH_KEYWORDS, NULL},
+    {"_unique_hash", (PyCFunction)arr_unique_hash,
+        METH_VARARGS | METH_KEYWORDS, NULL},
+    {"_in1d_hash", (PyCFunction)arr_in1d_hash,
+        METH_VARARGS | METH_KEYWORDS, NULL},
     {"ravel_multi_index", (PyCFunction)arr_ravel_multi_index,
         METH_VARARGS | METH_KEYWORDS, NULL},
     {"unravel_index", (PyCFunction)arr_unravel_index,
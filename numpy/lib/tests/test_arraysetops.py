@@ -85,6 +85,11 @@ class TestSetOps(TestCase):
 
         assert_array_equal([], intersect1d([],[]))
 
+        # 0-d and scalar inputs
+        assert_array_equal(intersect1d(np.array(1), [1, 2]), [1])
+        assert_array_equal(intersect1d(np.int64(1), [1, 2]), [1])
+        assert_array_equal(intersect1d([2, 3], np.array(2.)), [2])
+
     def test_setxor1d( self ):
         a = np.array( [5, 7, 1, 2] )
         b = np.array( [2, 4, 3, 1, 5] )
@@ -253,6 +258,55 @@ class TestSetOps(TestCase):
         c2 = setdiff1d( aux2, aux1 )
         assert_array_equal( c1, c2 )
 
+    def test_unique_counts(self):
+        a = [5, 7, 1, 2, 1, 5, 7, 5]
+        types = []
+        types.extend(np.typecodes['AllInteger'])
+        types.extend(np.typecodes['AllFloat'])
+        types.extend(['O', 'S2', 'U2', 'datetime64[D]', 'timedelta64[D]'])
+        for dt in types:
+            msg = "failed for type '%s'" % dt
+            aa = np.array(a).astype(dt)
+            # the unique values in sorted and in occurrence order
+            for srt, b, i1, n in [(True, [1, 2, 5, 7], [2, 3, 0, 1],
+                                   [2, 1, 3, 2]),
+                                  (False, [5, 7, 1, 2], [0, 1, 2, 3],
+                                   [3, 2, 2, 1])]:
+                bb = np.array(b).astype(dt)
+                v, j1, j2, c = unique(aa, True, True, True, sorted=srt)
+                assert_array_equal(v, bb, msg)
+                assert_array_equal(j1, i1, msg)
+                assert_array_equal(v[j2], aa, msg)
+                assert_array_equal(c, n, msg)
+                assert_array_equal(unique(aa, sorted=srt), bb, msg)
+
+    def test_unique_float_special(self):
+        a = np.array([0.0, np.nan, -0.0, 1.0, np.nan, 0.0])
+        for dt in [np.float32, np.float64, np.complex64, np.complex128]:
+            v, c = unique(a.astype(dt), return_counts=True)
+            assert_array_equal(v, np.array([0, 1, np.nan, np.nan], dt))
+            assert_array_equal(c, [3, 1, 1, 1])
+
+    def test_hash_against_sort(self):
+        # Long doubles and objects are sorted, giving the reference results
+        np.random.seed(1234)
+        for dt, ref in [('i1', 'g'), ('u2', 'g'), ('i8', 'O'), ('f4', 'g'),
+                        ('f8', 'g'), ('c16', 'G'), ('S3', 'O'),
+                        ('M8[s]', 'O')]:
+            msg = "failed for type '%s'" % dt
+            a = np.random.randint(0, 500, 2000).astype(dt)
+            b = np.random.randint(250, 750, 1000).astype(dt)
+            ao, bo = a.astype(ref), b.astype(ref)
+            for r, ro in zip(unique(a, True, True, True),
+                             unique(ao, True, True, True)):
+                assert_array_equal(r, ro, msg)
+            assert_array_equal(in1d(a, b), in1d(ao, bo), msg)
+            assert_array_equal(in1d(a, b, invert=True),
+                               in1d(ao, bo, invert=True), msg)
+            assert_array_equal(intersect1d(a, b), intersect1d(ao, bo), msg)
+            assert_array_equal(setxor1d(a, b), setxor1d(ao, bo), msg)
+            assert_array_equal(setdiff1d(a, b), setdiff1d(ao, bo), msg)
+
 
 if __name__ == "__main__":
     run_module_suite()
@@ -5,7 +5,8 @@ import numpy as np
 from numpy.testing import (
         run_module_suite, TestCase, assert_, assert_equal,
         assert_array_equal, assert_almost_equal, assert_array_almost_equal,
-        assert_raises, assert_allclose, assert_array_max_ulp, assert_warns
+        assert_raises, assert_allclose, assert_array_max_ulp, assert_warns,
+        with_threads
         )
 from numpy.random import rand
 from numpy.lib import *
@@ -715,6 +716,18 @@ class TestDigitize(TestCase):
         bins = np.linspace(x.min(), x.max(), 10)
         assert_(np.all(digitize(x, bins, True) != 10))
 
+    def test_monotonic_with_repeats(self):
+        x = [-1, 0, 1, 1.5, 2, 3, 4]
+        bins = [0, 1, 1, 2, 3]
+        assert_array_equal(digitize(x, bins), [0, 1, 3, 3, 4, 5, 5])
+        assert_array_equal(digitize(x, bins, True), [0, 0, 1, 3, 3, 4, 5])
+        assert_array_equal(digitize(x, bins[::-1]), [5, 4, 2, 2, 1, 0, 0])
+        assert_array_equal(digitize(x, bins[::-1], True),
+                           [5, 5, 4, 2, 2, 1, 0])
+
+    def test_non_monotonic(self):
+        assert_raises(ValueError, digitize, [1, 2], [0, 2, 1])
+
 
 class TestUnwrap(TestCase):
     def test_simple(self):
@@ -981,6 +994,51 @@ class TestHistogram(TestCase):
         assert_array_equal(a, np.array([0]))
         assert_array_equal(b, np.array([0, 1]))
 
+    def check_bins(self, a, bins, weights=None):
+        # Compare with the counts of the sorted values between the edges
+        h, edges = histogram(a, bins, weights=weights)
+        a = np.asarray(a, float).ravel()
+        w = np.ones(a.size) if weights is None else np.asarray(weights)
+        for i in range(len(edges) - 1):
+            inside = (a >= edges[i]) & (a < edges[i + 1])
+            if i == len(edges) - 2:
+                inside |= a == edges[-1]
+            assert_almost_equal(h[i], w[inside].sum(), err_msg=str(i))
+
+    def test_types(self):
+        v = np.arange(-40, 60) / 7.
+        for dt in '?bBhHiIlLqQefdg':
+            a = v.astype(dt)
+            for bins in [1, 7, 30, [-1, 0, 0.5, 0.5, 2, 5], [-np.inf, 0, np.inf]]:
+                self.check_bins(a, bins)
+        for dt in '?bBhHiIlLqQefdFD':
+            w = (np.arange(100) % 3).astype(dt)
+            h, b = histogram(v, 8, weights=w)
+            assert_equal(h.dtype, w.dtype)
+            if dt != '?':
+                self.check_bins(v, 8, w)
+        # byte swapped and strided values
+        self.check_bins(v.astype('>f8')[::3], 5)
+        self.check_bins(v.reshape(10, 10)[:, ::2], [0, 1, 2, 4])
+
+    def test_nan(self):
+        a = np.array([0., 1., np.nan, 2., np.nan, 3.])
+        h, b = histogram(a, [0, 1.5, 3])
+        assert_array_equal(h, [2, 2])
+
+    def test_parallel(self):
+        a = rand(200000) * 10
+        w = rand(200000)
+        with with_threads(1):
+            expected = [histogram(a, 100), histogram(a, 100, weights=w),
+                        histogram(a, [0, 1, 2.5, 8, 9])]
+        with with_threads(4):
+            res = [histogram(a, 100), histogram(a, 100, weights=w),
+                   histogram(a, [0, 1, 2.5, 8, 9])]
+        for r, e in zip(res, expected):
+            assert_almost_equal(r[0], e[0])
+            assert_array_equal(r[1], e[1])
+
 
 class TestHistogramdd(TestCase):
     def test_simple(self):
@@ -1049,6 +1107,37 @@ class TestHistogramdd(TestCase):
         w_hist, edges = histogramdd(v, weights=np.ones(100, int) * 2)
         assert_array_equal(w_hist, 2 * hist)
 
+    def test_rightmost_edge(self):
+        # Values on the last edge, at rounding precision, are in the last bin
+        x = np.array([[0., 1.], [1., 1. + 1e-12], [0.5, .2], [.25, 1.001]])
+        for dt in [np.float32, np.float64]:
+            H, edges = histogramdd(x.astype(dt), bins=(2, 2),
+                                   range=[[0, 1], [0, 1]])
+            assert_array_equal(H, [[0, 1], [1, 1]])
+        H, edges = histogramdd(np.array([[0, 4], [3, 9], [9, 0]]), bins=3)
+        assert_array_equal(H, [[0, 1, 0], [0, 0, 1], [1, 0, 0]])
+
+    def test_types(self):
+        x = rand(200, 3) * 10
+        ref, edges = histogramdd(x, bins=(3, 4, 5))
+        for dt in 'iIlLqQfd':
+            H, e = histogramdd(x.astype(dt), bins=edges)
+            ref, e = histogramdd(x.astype(dt).astype(float), bins=edges)
+            assert_array_equal(H, ref, err_msg=dt)
+        for dt in '?ilfd':
+            w = np.arange(200).astype(dt)
+            H, e = histogramdd(x, bins=edges, weights=w)
+            assert_equal(H.dtype, np.float64)
+            assert_array_almost_equal(H, histogramdd(x, bins=edges,
+                                      weights=w.astype(float))[0])
+
+    def test_parallel(self):
+        x = rand(100000, 2)
+        with with_threads(1):
+            expected = histogramdd(x, bins=(7, 9))[0]
+        with with_threads(4):
+            assert_array_equal(histogramdd(x, bins=(7, 9))[0], expected)
+
     def test_identical_samples(self):
         x = np.zeros((10, 2), int)
         hist, edges = histogramdd(x, bins=2)
@@ -1457,6 +1546,37 @@ class TestBincount(TestCase):
         y = np.bincount(x, minlength=5)
         assert_array_equal(y, np.zeros(5, dtype=int))
 
+    def test_types(self):
+        x = np.array([0, 1, 1, 3, 2, 1, 7])
+        for dt in '?bBhHiIl':
+            y = np.bincount(x.astype(dt))
+            assert_array_equal(y, np.bincount(x.astype(dt).astype(int)))
+        assert_array_equal(np.bincount(x.astype('>i4')[::2]), [1, 1, 1, 0, 0, 0, 0, 1])
+        assert_raises(TypeError, np.bincount, x.astype(float))
+        assert_raises(TypeError, np.bincount, x.astype(np.uint64))
+
+    def test_weight_types(self):
+        x = np.array([1, 2, 4, 5, 2])
+        for dt in '?bhilfd':
+            w = np.array([2, 3, 5, 1, 2]).astype(dt)
+            y = np.bincount(x, w)
+            assert_equal(y.dtype, np.float64)
+            assert_array_equal(y, np.bincount(x, w.astype(float)))
+        w = np.array([1j, 2, 3j, 4, 5], np.complex64)
+        y = np.bincount(x, w)
+        assert_equal(y.dtype, np.complex128)
+        assert_array_equal(y, [0, 1j, 7, 0, 3j, 4])
+        assert_raises(ValueError, np.bincount, x, w[:3])
+
+    def test_parallel(self):
+        x = np.random.randint(0, 50, 200000)
+        w = rand(200000)
+        with with_threads(1):
+            expected = [np.bincount(x), np.bincount(x, w)]
+        with with_threads(4):
+            assert_array_equal(np.bincount(x), expected[0])
+            assert_array_almost_equal(np.bincount(x, w), expected[1])
+
 
 class TestInterp(TestCase):
     def test_exceptions(self):
@@ -42,11 +42,16 @@ def configuration(parent_package='',top_path=None):
 
     # umath_linalg module
 
+    umath_linalg_macros = []
+    if lapack_info:
+        umath_linalg_macros.append(('HAVE_EXTERNAL_LAPACK', 1))
+
     config.add_extension('_umath_linalg',
                          sources = [get_lapack_lite_sources],
                          depends =  ['umath_linalg.c.src'] + lapack_lite_src,
                          extra_info = lapack_info,
                          libraries = ['npymath'],
+                         define_macros = umath_linalg_macros,
                          )
 
     return config
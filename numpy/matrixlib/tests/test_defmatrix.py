@@ -279,6 +279,7 @@ class TestMatrixReturn(TestCase):
             'reshape' : (1,),
             'swapaxes' : (0,0),
             'dot': np.array([1.0]),
+            'argpartition': (0,),
             }
         excluded_methods = [
             'argmin', 'choose', 'dump', 'dumps', 'fill', 'getfield',
@@ -286,7 +287,7 @@ class TestMatrixReturn(TestCase):
             'searchsorted', 'setflags', 'setfield', 'sort', 'take',
             'tofile', 'tolist', 'tostring', 'all', 'any', 'sum',
             'argmax', 'argmin', 'min', 'max', 'mean', 'var', 'ptp',
-            'prod', 'std', 'ctypes', 'itemset', 'setasflat'
+            'prod', 'std', 'ctypes', 'itemset', 'setasflat', 'partition'
             ]
         for attrib in dir(a):
             if attrib.startswith('_') or attrib in excluded_methods:
@@ -10,7 +10,7 @@ import re
 import operator
 import warnings
 from .nosetester import import_nose
-from numpy.core import float32, empty, arange
+from numpy.core import float32, empty, arange, setnumthreads
 
 if sys.version_info[0] >= 3:
     from io import StringIO
@@ -24,7 +24,7 @@ __all__ = ['assert_equal', 'assert_almost_equal','assert_approx_equal',
            'raises', 'rand', 'rundocs', 'runstring', 'verbose', 'measure',
            'assert_', 'assert_array_almost_equal_nulp',
            'assert_array_max_ulp', 'assert_warns', 'assert_no_warnings',
-           'assert_allclose']
+           'assert_allclose', 'with_threads']
 
 
 verbose = 0
@@ -1509,6 +1509,37 @@ def assert_no_warnings(func, *args, **kw):
     return result
 
 
+class with_threads(object):
+    """
+    A context manager that runs its block with `n` threads in the thread
+    pool and restores the previous number upon exiting the context.
+
+    Parameters
+    ----------
+    n : int
+        The number of threads, see `numpy.setnumthreads`.
+
+    Examples
+    --------
+    Check that a result computed in parallel is that of the serial code:
+
+    >>> a = np.random.rand(100000)
+    >>> with with_threads(1):
+    ...     expected = np.sort(a)
+    >>> with with_threads(4):
+    ...     assert_equal(np.sort(a), expected)
+
+    """
+    def __init__(self, n):
+        self.n = n
+
+    def __enter__(self):
+        self.old = setnumthreads(self.n)
+
+    def __exit__(self, *exc_info):
+        setnumthreads(self.old)
+
+
 def gen_alignment_data(dtype=float32, type='binary', max_size=24):
     """
     generator producing data with different alignment and offsets